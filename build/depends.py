@@ -528,7 +528,8 @@ class SoundTouch(Dependence):
 
 class RubberBand(Dependence):
     def sources(self, build):
-        sources = ['src/engine/enginebufferscalerubberband.cpp', ]
+        sources = ['src/engine/enginebufferscalerubberband.cpp',
+                   'src/engine/enginebufferscalerubberbandpipelined.cpp', ]
         return sources
 
     def configure(self, build, conf, env=None):
@@ -599,6 +600,41 @@ class FpClassify(Dependence):
                 env['CCFLAGS'].remove('-ffast-math')
         return env.Object('src/util/fpclassify.cpp')
 
+class SimdKernels(Dependence):
+    # The SIMD variants of the SampleUtil kernels are compiled with the flags
+    # for their instruction set, independent of the optimization level of the
+    # build. mixxx::SampleKernels picks the best one for the CPU at runtime.
+
+    def configure(self, build, conf):
+        if build.architecture_is_x86:
+            build.env.Append(CPPDEFINES='__SIMDKERNELS__')
+
+    def sources(self, build):
+        if not build.architecture_is_x86:
+            return []
+        if build.toolchain_is_msvs:
+            # SSE2 is a core instruction set on x64
+            isa_flags = {
+                'sse2': [] if build.machine_is_64bit else ['/arch:SSE2'],
+                'avx2': ['/arch:AVX2'],
+                'avx512': ['/arch:AVX512'],
+            }
+        else:
+            # -mavx512f implies FMA. Don't let the compiler fuse
+            # multiplications and additions so that the results match
+            # the scalar kernels.
+            isa_flags = {
+                'sse2': ['-msse2', '-ffp-contract=off'],
+                'avx2': ['-mavx2', '-ffp-contract=off'],
+                'avx512': ['-mavx512f', '-ffp-contract=off'],
+            }
+        objects = []
+        for isa in ['sse2', 'avx2', 'avx512']:
+            env = build.env.Clone()
+            env.Append(CCFLAGS=isa_flags[isa])
+            objects.append(env.Object('src/util/samplekernels_%s.cpp' % isa))
+        return objects
+
 class QtScriptByteArray(Dependence):
     def configure(self, build, conf):
         build.env.Append(CPPPATH='#lib/qtscript-bytearray')
@@ -639,6 +675,7 @@ class MixxxCore(Feature):
                    "src/control/controlaudiotaperpot.cpp",
                    "src/control/controlbehavior.cpp",
                    "src/control/controleffectknob.cpp",
+                   "src/control/controlguidispatcher.cpp",
                    "src/control/controlindicator.cpp",
                    "src/control/controllinpotmeter.cpp",
                    "src/control/controllogpotmeter.cpp",
@@ -648,6 +685,7 @@ class MixxxCore(Feature):
                    "src/control/controlpotmeter.cpp",
                    "src/control/controlproxy.cpp",
                    "src/control/controlpushbutton.cpp",
+                   "src/control/controlregistry.cpp",
                    "src/control/controlttrotary.cpp",
                    "src/control/controlencoder.cpp",
 
@@ -732,8 +770,12 @@ class MixxxCore(Feature):
 
                    "src/engine/engineworker.cpp",
                    "src/engine/engineworkerscheduler.cpp",
+                   "src/engine/enginethreadpool.cpp",
+                   "src/engine/callbacklatencystats.cpp",
+                   "src/engine/controlsnapshot.cpp",
                    "src/engine/enginebuffer.cpp",
                    "src/engine/enginebufferscale.cpp",
+                   "src/engine/enginebufferscalecubic.cpp",
                    "src/engine/enginebufferscalelinear.cpp",
                    "src/engine/enginefilterbiquad1.cpp",
                    "src/engine/enginefiltermoogladder4.cpp",
@@ -759,7 +801,7 @@ class MixxxCore(Feature):
                    "src/engine/enginemicrophone.cpp",
                    "src/engine/enginedeck.cpp",
                    "src/engine/engineaux.cpp",
-                   "src/engine/channelmixer_autogen.cpp",
+                   "src/engine/channelmixer.cpp",
 
                    "src/engine/enginecontrol.cpp",
                    "src/engine/ratecontrol.cpp",
@@ -774,6 +816,9 @@ class MixxxCore(Feature):
                    "src/engine/enginetalkoverducking.cpp",
                    "src/engine/cachingreader.cpp",
                    "src/engine/cachingreaderchunk.cpp",
+                   "src/engine/cachingreaderchunkcache.cpp",
+                   "src/engine/cachingreaderdecoders.cpp",
+                   "src/engine/cachingreaderdiskcache.cpp",
                    "src/engine/cachingreaderworker.cpp",
 
                    "src/analyzer/analyzerqueue.cpp",
@@ -812,11 +857,13 @@ class MixxxCore(Feature):
                    "src/main.cpp",
                    "src/mixxx.cpp",
                    "src/mixxxapplication.cpp",
+                   "src/offlinerenderer.cpp",
                    "src/errordialoghandler.cpp",
 
                    "src/sources/audiosource.cpp",
                    "src/sources/audiosourcestereoproxy.cpp",
                    "src/sources/metadatasourcetaglib.cpp",
+                   "src/sources/seekindexstore.cpp",
                    "src/sources/soundsource.cpp",
                    "src/sources/soundsourceproviderregistry.cpp",
                    "src/sources/soundsourceproxy.cpp",
@@ -1094,6 +1141,7 @@ class MixxxCore(Feature):
 
                    "src/soundio/sounddevice.cpp",
                    "src/soundio/sounddevicenetwork.cpp",
+                   "src/soundio/sounddeviceoffline.cpp",
                    "src/engine/sidechain/enginenetworkstream.cpp",
                    "src/soundio/soundmanager.cpp",
                    "src/soundio/soundmanagerconfig.cpp",
@@ -1118,6 +1166,7 @@ class MixxxCore(Feature):
                    "src/util/time.cpp",
                    "src/util/timer.cpp",
                    "src/util/performancetimer.cpp",
+                   "src/util/latencyhistogram.cpp",
                    "src/util/threadcputimer.cpp",
                    "src/util/version.cpp",
                    "src/util/rlimit.cpp",
@@ -1144,6 +1193,8 @@ class MixxxCore(Feature):
                    "src/util/db/sqlstringformatter.cpp",
                    "src/util/db/sqltransaction.cpp",
                    "src/util/sample.cpp",
+                   "src/util/samplekernels.cpp",
+                   "src/util/cpufeatures.cpp",
                    "src/util/samplebuffer.cpp",
                    "src/util/readaheadsamplebuffer.cpp",
                    "src/util/rotary.cpp",
@@ -1372,6 +1423,11 @@ class MixxxCore(Feature):
                 raise Exception(
                     "Could not find libX11 or its development headers.")
 
+            # shm_open() for the control snapshot is in librt before glibc 2.17
+            if not conf.CheckLib(['rt', 'librt']):
+                raise Exception(
+                    "Could not find librt or its development headers.")
+
         elif build.platform_is_osx:
             # Stuff you may have compiled by hand
             if os.path.isdir('/usr/local/include'):
@@ -1439,7 +1495,8 @@ class MixxxCore(Feature):
         return [SoundTouch, ReplayGain, Ebur128Mit, PortAudio, PortMIDI, Qt, TestHeaders,
                 FidLib, SndFile, FLAC, OggVorbis, OpenGL, TagLib, ProtoBuf,
                 Chromaprint, RubberBand, SecurityFramework, CoreServices, IOKit,
-                QtScriptByteArray, Reverb, FpClassify, PortAudioRingBuffer, LAME]
+                QtScriptByteArray, Reverb, FpClassify, SimdKernels,
+                PortAudioRingBuffer, LAME]
 
     def post_dependency_check_configure(self, build, conf):
         """Sets up additional things in the Environment that must happen
@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+"""Compares a run of the effect benchmarks against a baseline.
+
+Run the benchmarks with
+    mixxx-test --benchmark --benchmark_filter=BM_.*Effect \\
+            --benchmark_format=csv > effects.csv
+and compare the result with
+    compare_effects_benchmark.py src/test/effects_benchmark_baseline.csv effects.csv
+
+Every effect, sample rate and buffer size that became slower than the
+threshold is reported and the script exits with 1. With --update the
+baseline is replaced by the results of the run. The timings depend on
+the machine, so pass --machine to note the one they were taken on.
+"""
+import argparse
+import csv
+import re
+import sys
+
+BASELINE_FIELDS = ['effect', 'sample_rate', 'buffer_frames', 'ns_per_frame']
+
+# BM_BuiltInEffect<44100>/3/1024
+NAME_PATTERN = re.compile(r'^BM_BuiltInEffect<(\d+)>/\d+/(\d+)$')
+# org.mixxx.effects.flanger 12.34 ns/frame
+LABEL_PATTERN = re.compile(r'^(\S+) ([0-9.]+) ns/frame$')
+
+
+def read_run(fname):
+    """reads the csv output of mixxx-test --benchmark and returns a dict
+       from (effect, sample rate, buffer frames) to ns/frame
+
+    """
+    results = {}
+    with open(fname) as f:
+        # Skip the context that the library prints before the table
+        lines = [line for line in f if line.strip()]
+        start = next((i for i, line in enumerate(lines)
+                      if line.startswith('name,')), None)
+        if start is None:
+            return results
+        for row in csv.DictReader(lines[start:]):
+            name = NAME_PATTERN.match(row['name'])
+            label = LABEL_PATTERN.match(row.get('label') or '')
+            if name is None or label is None:
+                continue
+            key = (label.group(1), int(name.group(1)), int(name.group(2)))
+            results[key] = float(label.group(2))
+    return results
+
+
+def read_baseline(fname):
+    results = {}
+    with open(fname) as f:
+        rows = csv.DictReader(line for line in f
+                              if line.strip() and not line.startswith('#'))
+        for row in rows:
+            key = (row['effect'], int(row['sample_rate']),
+                   int(row['buffer_frames']))
+            results[key] = float(row['ns_per_frame'])
+    return results
+
+
+def write_baseline(fname, results, machine):
+    with open(fname, 'w') as f:
+        f.write('# Time per frame of the effect benchmarks in '
+                'src/test/nativeeffects_test.cpp\n')
+        if machine:
+            f.write('# Measured on %s\n' % machine)
+        f.write('# Regenerate with scripts/compare_effects_benchmark.py '
+                '--update\n')
+        writer = csv.writer(f, lineterminator='\n')
+        writer.writerow(BASELINE_FIELDS)
+        for key in sorted(results):
+            writer.writerow(list(key) + ['%.2f' % results[key]])
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='compare the effect benchmarks against a baseline')
+    parser.add_argument('baseline', help='baseline csv file')
+    parser.add_argument('run', help='csv output of mixxx-test --benchmark')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='allowed slowdown in percent (default: 10)')
+    parser.add_argument('--update', action='store_true',
+                        help='replace the baseline with the run')
+    parser.add_argument('--machine',
+                        help='description of the machine for --update')
+    args = parser.parse_args()
+
+    run = read_run(args.run)
+    if not run:
+        sys.exit('no effect benchmarks found in ' + args.run)
+
+    if args.update:
+        write_baseline(args.baseline, run, args.machine)
+        return 0
+
+    baseline = read_baseline(args.baseline)
+    regressions = 0
+    for key in sorted(run):
+        if key not in baseline:
+            print('%s %d Hz %d frames: %.2f ns/frame (new)' % (key + (run[key],)))
+            continue
+        change = 100.0 * (run[key] / baseline[key] - 1.0)
+        if change > args.threshold:
+            regressions += 1
+            print('%s %d Hz %d frames: %.2f ns/frame, was %.2f (%+.1f%%)' % (
+                key + (run[key], baseline[key], change)))
+    for key in sorted(set(baseline) - set(run)):
+        print('%s %d Hz %d frames: missing' % key)
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,13 +3,14 @@
 
 #include "control/control.h"
 
+#include "util/performancetimer.h"
 #include "util/stat.h"
+#include "util/statsmanager.h"
 
 // Static member variable definition
 UserSettingsPointer ControlDoublePrivate::s_pUserConfig;
 
-QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > ControlDoublePrivate::s_qCOHash
-GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
+ControlRegistry ControlDoublePrivate::s_controlRegistry;
 
 QHash<ConfigKey, ConfigKey> ControlDoublePrivate::s_qCOAliasHash
 GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
@@ -33,6 +34,7 @@ ControlDoublePrivate::ControlDoublePrivate(ConfigKey key,
                                            bool bIgnoreNops, bool bTrack,
                                            bool bPersist, double defaultValue)
         : m_key(key),
+          m_id(kInvalidControlId),
           m_bPersistInConfiguration(bPersist),
           m_bIgnoreNops(bIgnoreNops),
           m_bTrack(bTrack),
@@ -68,8 +70,8 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 
 ControlDoublePrivate::~ControlDoublePrivate() {
     s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
-    s_qCOHash.remove(m_key);
+    //qDebug() << "ControlDoublePrivate::s_controlRegistry.removeExpired(" << m_key.group << "," << m_key.item << ")";
+    s_controlRegistry.removeExpired(m_key);
     s_qCOHashMutex.unlock();
 
     if (m_bPersistInConfiguration) {
@@ -84,20 +86,14 @@ ControlDoublePrivate::~ControlDoublePrivate() {
 void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey& key) {
     MMutexLocker locker(&s_qCOHashMutex);
 
-    auto it = s_qCOHash.constFind(key);
-    if (it == s_qCOHash.constEnd()) {
-        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null control" << key;
-        return;
-    }
-
-    QSharedPointer<ControlDoublePrivate> pControl = it.value();
+    QSharedPointer<ControlDoublePrivate> pControl = s_controlRegistry.lookup(key);
     if (pControl.isNull()) {
-        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for expired control" << key;
+        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null control" << key;
         return;
     }
 
     s_qCOAliasHash.insert(key, alias);
-    s_qCOHash.insert(alias, pControl);
+    s_controlRegistry.insert(alias, pControl);
 }
 
 // static
@@ -113,20 +109,13 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
     }
 
 
-    QSharedPointer<ControlDoublePrivate> pControl;
-    // Scope for MMutexLocker.
-    {
-        MMutexLocker locker(&s_qCOHashMutex);
-        auto it = s_qCOHash.constFind(key);
-        if (it != s_qCOHash.constEnd()) {
-            if (pCreatorCO) {
-                if (warn) {
-                    qDebug() << "ControlObject" << key.group << key.item << "already created";
-                }
-            } else {
-                pControl = it.value();
-            }
+    // Lock-free, does not wait for other threads that create controls.
+    QSharedPointer<ControlDoublePrivate> pControl = s_controlRegistry.lookup(key);
+    if (pCreatorCO && !pControl.isNull()) {
+        if (warn) {
+            qDebug() << "ControlObject" << key.group << key.item << "already created";
         }
+        pControl.clear();
     }
 
     if (pControl == NULL) {
@@ -135,8 +124,10 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
                     new ControlDoublePrivate(key, pCreatorCO, bIgnoreNops,
                                              bTrack, bPersist, defaultValue));
             MMutexLocker locker(&s_qCOHashMutex);
-            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
-            s_qCOHash.insert(key, pControl);
+            // No other thread can see the control before it is inserted
+            pControl->m_id = s_controlRegistry.reserveId(key);
+            //qDebug() << "ControlDoublePrivate::s_controlRegistry.insert(" << key.group << "," << key.item << ")";
+            s_controlRegistry.insert(key, pControl);
         } else if (warn) {
             qWarning() << "ControlDoublePrivate::getControl returning NULL for ("
                        << key.group << "," << key.item << ")";
@@ -145,18 +136,24 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
     return pControl;
 }
 
+// static
+QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControlById(
+        int controlId) {
+    return s_controlRegistry.lookup(controlId);
+}
+
+// static
+int ControlDoublePrivate::getControlId(const ConfigKey& key) {
+    return s_controlRegistry.lookupId(key);
+}
+
 // static
 void ControlDoublePrivate::getControls(
         QList<QSharedPointer<ControlDoublePrivate> >* pControlList) {
-    s_qCOHashMutex.lock();
+    // Clearing the list may delete controls, which lock s_qCOHashMutex
     pControlList->clear();
-    for (auto it = s_qCOHash.constBegin(); it != s_qCOHash.constEnd(); ++it) {
-        QSharedPointer<ControlDoublePrivate> pControl = it.value();
-        if (!pControl.isNull()) {
-            pControlList->push_back(pControl);
-        }
-    }
-    s_qCOHashMutex.unlock();
+    MMutexLocker locker(&s_qCOHashMutex);
+    s_controlRegistry.getControls(pControlList);
 }
 
 // static
@@ -195,7 +192,11 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
         return;
     }
     m_value.setValue(value);
-    emit(valueChanged(value, pSender));
+    if (StatsManager::controlTracingEnabled()) {
+        emitValueChangedTraced(value, pSender);
+    } else {
+        emit(valueChanged(value, pSender));
+    }
 
     if (m_bTrack) {
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
@@ -203,6 +204,20 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     }
 }
 
+void ControlDoublePrivate::emitValueChangedTraced(double value, QObject* pSender) {
+    ControlTraceReport report;
+    report.controlId = m_id;
+    report.listeners = receivers(SIGNAL(valueChanged(double, QObject*)));
+    PerformanceTimer timer;
+    timer.start();
+    emit(valueChanged(value, pSender));
+    report.dispatchNanos = timer.elapsed().toIntegerNanos();
+    StatsManager* pManager = StatsManager::instance();
+    if (pManager) {
+        pManager->maybeWriteControlTrace(report);
+    }
+}
+
 void ControlDoublePrivate::setBehavior(ControlNumericBehavior* pBehavior) {
     // This marks the old mpBehavior for deletion. It is deleted once it is not
     // used in any other function
@@ -7,6 +7,7 @@
 #include <QAtomicPointer>
 
 #include "control/controlbehavior.h"
+#include "control/controlregistry.h"
 #include "control/controlvalue.h"
 #include "preferences/usersettings.h"
 #include "util/mutex.h"
@@ -38,6 +39,15 @@ class ControlDoublePrivate : public QObject {
             ControlObject* pCreatorCO = NULL, bool bIgnoreNops = true, bool bTrack = false,
             bool bPersist = false, double defaultValue = 0.0);
 
+    // Gets the ControlDoublePrivate with the given id, which is cheaper than
+    // looking it up by its ConfigKey. Returns NULL if it does not exist.
+    static QSharedPointer<ControlDoublePrivate> getControlById(int controlId);
+
+    // Returns the id of the ConfigKey or kInvalidControlId if no control has
+    // been created for it yet. The id of a ConfigKey stays the same for the
+    // lifetime of the process.
+    static int getControlId(const ConfigKey& key);
+
     // Adds all ControlDoublePrivate that currently exist to pControlList
     static void getControls(QList<QSharedPointer<ControlDoublePrivate> >* pControlsList);
 
@@ -109,6 +119,10 @@ class ControlDoublePrivate : public QObject {
         return m_key;
     }
 
+    inline int getId() const {
+        return m_id;
+    }
+
     // Connects a slot to the ValueChange request for CO validation. All change
     // requests issued by set are routed though the connected slot. This can
     // decide with its own thread safe solution if the requested value can be
@@ -130,8 +144,12 @@ class ControlDoublePrivate : public QObject {
                          double defaultValue);
     void initialize(double defaultValue);
     void setInner(double value, QObject* pSender);
+    // Emits valueChanged() and reports it to the StatsManager
+    void emitValueChangedTraced(double value, QObject* pSender);
 
     ConfigKey m_key;
+    // The id of m_key, assigned before the control is registered.
+    int m_id;
 
     // Whether the control should persist in the Mixxx user configuration. The
     // value is loaded from configuration when the control is created and
@@ -171,13 +189,15 @@ class ControlDoublePrivate : public QObject {
     // configuration object would be arduous.
     static UserSettingsPointer s_pUserConfig;
 
-    // Hash of ControlDoublePrivate instantiations.
-    static QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > s_qCOHash;
+    // Registry of ControlDoublePrivate instantiations. Lookups are lock-free,
+    // modifications are serialized by s_qCOHashMutex.
+    static ControlRegistry s_controlRegistry;
     // Hash of aliases between ConfigKeys. Solely used for looking up the first
     // alias associated with a key.
     static QHash<ConfigKey, ConfigKey> s_qCOAliasHash;
 
-    // Mutex guarding access to s_qCOHash and s_qCOAliasHash.
+    // Mutex guarding modifications of s_controlRegistry and access to
+    // s_qCOAliasHash.
     static MMutex s_qCOHashMutex;
 };
 
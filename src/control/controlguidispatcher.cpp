@@ -0,0 +1,146 @@
+#include <QThread>
+#include <QtDebug>
+
+#include "control/controlguidispatcher.h"
+
+#include "control/control.h"
+#include "control/controlproxy.h"
+#include "util/assert.h"
+
+void ControlGuiChangeFlag::slotValueChanged(double value, QObject* pSetter) {
+    Q_UNUSED(value);
+    // The value is read when the change is delivered
+    m_pSetter.store(pSetter);
+    m_changed.store(true);
+}
+
+// static
+ControlGuiDispatcher* ControlGuiDispatcher::s_pInstance = nullptr;
+
+ControlGuiDispatcher::ControlGuiDispatcher()
+        : m_pThread(QThread::currentThread()),
+          m_bDelivering(false) {
+    DEBUG_ASSERT(s_pInstance == nullptr);
+    if (s_pInstance == nullptr) {
+        s_pInstance = this;
+    }
+}
+
+ControlGuiDispatcher::~ControlGuiDispatcher() {
+    if (s_pInstance == this) {
+        s_pInstance = nullptr;
+    }
+    // Proxies that are still subscribed do not unsubscribe anymore
+    for (Subscription* pSubscription : m_active) {
+        QObject::disconnect(pSubscription->pControl.data(),
+                SIGNAL(valueChanged(double, QObject*)),
+                &pSubscription->changeFlag,
+                SLOT(slotValueChanged(double, QObject*)));
+    }
+    qDeleteAll(m_subscriptions);
+}
+
+bool ControlGuiDispatcher::isDispatcherThread() const {
+    return QThread::currentThread() == m_pThread;
+}
+
+bool ControlGuiDispatcher::subscribe(ControlProxy* pProxy) {
+    DEBUG_ASSERT(isDispatcherThread());
+    const QSharedPointer<ControlDoublePrivate>& pControl = pProxy->m_pControl;
+    VERIFY_OR_DEBUG_ASSERT(!pControl.isNull() && pControl->getId() >= 0) {
+        return false;
+    }
+    const int controlId = pControl->getId();
+    if (controlId >= m_subscriptions.size()) {
+        m_subscriptions.resize(controlId + 1);
+    }
+    Subscription* pSubscription = m_subscriptions[controlId];
+    if (pSubscription == nullptr) {
+        pSubscription = new Subscription;
+        m_subscriptions[controlId] = pSubscription;
+    }
+    if (pSubscription->pControl.isNull()) {
+        pSubscription->pControl = pControl;
+        QObject::connect(pControl.data(),
+                SIGNAL(valueChanged(double, QObject*)),
+                &pSubscription->changeFlag,
+                SLOT(slotValueChanged(double, QObject*)),
+                Qt::DirectConnection);
+        m_active.append(pSubscription);
+    } else if (pSubscription->pControl != pControl) {
+        return false;
+    }
+    pSubscription->proxies.append(pProxy);
+    return true;
+}
+
+void ControlGuiDispatcher::unsubscribe(ControlProxy* pProxy) {
+    DEBUG_ASSERT(isDispatcherThread());
+    const int controlId = pProxy->getControlId();
+    if (controlId < 0 || controlId >= m_subscriptions.size() ||
+            m_subscriptions[controlId] == nullptr) {
+        return;
+    }
+    Subscription* pSubscription = m_subscriptions[controlId];
+    const int index = pSubscription->proxies.indexOf(pProxy);
+    if (index < 0) {
+        return;
+    }
+    if (m_bDelivering) {
+        // Removed by process() when it has finished
+        pSubscription->proxies[index] = nullptr;
+        return;
+    }
+    pSubscription->proxies.removeAt(index);
+    if (pSubscription->proxies.isEmpty()) {
+        release(pSubscription);
+        m_active.removeOne(pSubscription);
+    }
+}
+
+void ControlGuiDispatcher::release(Subscription* pSubscription) {
+    QObject::disconnect(pSubscription->pControl.data(),
+            SIGNAL(valueChanged(double, QObject*)),
+            &pSubscription->changeFlag,
+            SLOT(slotValueChanged(double, QObject*)));
+    pSubscription->pControl.clear();
+    // Drop a change that has not been delivered, the next subscriber reads
+    // the current value anyway
+    QObject* pSetter;
+    pSubscription->changeFlag.takeChange(&pSetter);
+}
+
+void ControlGuiDispatcher::process() {
+    DEBUG_ASSERT(isDispatcherThread());
+    m_bDelivering = true;
+    // The receivers may subscribe other proxies, which appends to m_active
+    for (int i = 0; i < m_active.size(); ++i) {
+        Subscription* pSubscription = m_active[i];
+        QObject* pSetter;
+        if (!pSubscription->changeFlag.takeChange(&pSetter)) {
+            continue;
+        }
+        const double value = pSubscription->pControl->get();
+        for (int j = 0; j < pSubscription->proxies.size(); ++j) {
+            ControlProxy* pProxy = pSubscription->proxies[j];
+            // Like the connections of the ControlProxy, do not notify the
+            // proxy that has set the value
+            if (pProxy != nullptr && pProxy != pSetter) {
+                emit(pProxy->valueChanged(value));
+            }
+        }
+    }
+    m_bDelivering = false;
+
+    QList<Subscription*>::iterator it = m_active.begin();
+    while (it != m_active.end()) {
+        Subscription* pSubscription = *it;
+        pSubscription->proxies.removeAll(nullptr);
+        if (pSubscription->proxies.isEmpty()) {
+            release(pSubscription);
+            it = m_active.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
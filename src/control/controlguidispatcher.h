@@ -0,0 +1,104 @@
+#ifndef CONTROLGUIDISPATCHER_H
+#define CONTROLGUIDISPATCHER_H
+
+#include <atomic>
+
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "util/class.h"
+
+class ControlDoublePrivate;
+class ControlProxy;
+class QThread;
+
+// Records that a control has changed for the ControlGuiDispatcher. The slot
+// is called by a direct connection in the thread that sets the control, so
+// it must not do more than storing two atomics.
+class ControlGuiChangeFlag : public QObject {
+    Q_OBJECT
+  public:
+    ControlGuiChangeFlag()
+            : m_changed(false),
+              m_pSetter(nullptr) {
+    }
+
+    // Returns whether the control has changed since the last call. If so,
+    // ppSetter is set to the object that has changed it last.
+    bool takeChange(QObject** ppSetter) {
+        if (!m_changed.exchange(false)) {
+            return false;
+        }
+        *ppSetter = m_pSetter.load();
+        return true;
+    }
+
+  public slots:
+    void slotValueChanged(double value, QObject* pSetter);
+
+  private:
+    std::atomic<bool> m_changed;
+    std::atomic<QObject*> m_pSetter;
+};
+
+// Delivers the value changes of controls to ControlProxies in the GUI thread
+// that only need the latest value, like the widgets of the skin. A jog wheel
+// or a VU meter changes its control several hundred times per second, but
+// the widgets are only painted at the frame rate of the screen. Instead of a
+// queued signal for every change, all changes of a control between two
+// calls of process() are coalesced into one, which is delivered to all of
+// its subscribers. process() is called by the GuiTick.
+//
+// All methods must be called from the thread that created the dispatcher.
+class ControlGuiDispatcher {
+  public:
+    ControlGuiDispatcher();
+    ~ControlGuiDispatcher();
+
+    // Returns the dispatcher or NULL if none has been created.
+    static ControlGuiDispatcher* instance() {
+        return s_pInstance;
+    }
+
+    // Returns whether proxies of the calling thread can subscribe
+    bool isDispatcherThread() const;
+
+    // Subscribes pProxy to the changes of its control. Returns false if the
+    // control cannot be subscribed, e.g. because another control with the
+    // same ConfigKey has replaced it.
+    bool subscribe(ControlProxy* pProxy);
+    void unsubscribe(ControlProxy* pProxy);
+
+    // Emits valueChanged() of all subscribers whose control has changed
+    // since the last call, with its current value.
+    void process();
+
+  private:
+    struct Subscription {
+        // Only set while there are subscribers, so that the dispatcher does
+        // not keep deleted controls alive
+        QSharedPointer<ControlDoublePrivate> pControl;
+        // Never deleted before the dispatcher, because the thread that sets
+        // the control may still be in its slot after disconnecting it
+        ControlGuiChangeFlag changeFlag;
+        // Unsubscribing while the changes are delivered leaves a NULL entry
+        QList<ControlProxy*> proxies;
+    };
+
+    void release(Subscription* pSubscription);
+
+    static ControlGuiDispatcher* s_pInstance;
+
+    QThread* const m_pThread;
+    // Indexed by control id
+    QVector<Subscription*> m_subscriptions;
+    // The subscriptions that currently have subscribers
+    QList<Subscription*> m_active;
+    bool m_bDelivering;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlGuiDispatcher);
+};
+
+#endif /* CONTROLGUIDISPATCHER_H */
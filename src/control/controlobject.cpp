@@ -69,6 +69,16 @@ ControlObject* ControlObject::getControl(const ConfigKey& key, bool warn) {
     return NULL;
 }
 
+// static
+ControlObject* ControlObject::getControlById(int controlId) {
+    QSharedPointer<ControlDoublePrivate> pCDP =
+            ControlDoublePrivate::getControlById(controlId);
+    if (pCDP) {
+        return pCDP->getCreatorCO();
+    }
+    return NULL;
+}
+
 void ControlObject::setValueFromMidi(MidiOpCode o, double v) {
     if (m_pControl) {
         m_pControl->setValueFromMidi(o, v);
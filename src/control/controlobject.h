@@ -51,6 +51,9 @@ class ControlObject : public QObject {
         ConfigKey key(group, item);
         return getControl(key, warn);
     }
+    // Returns a pointer to the ControlObject with the given id, see
+    // ControlDoublePrivate::getControlId(). Cheaper than getControl().
+    static ControlObject* getControlById(int controlId);
 
     QString name() const {
         return m_pControl ?  m_pControl->name() : QString();
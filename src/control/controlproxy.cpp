@@ -1,29 +1,36 @@
+#include <QThread>
 #include <QtDebug>
 
 #include "control/controlproxy.h"
 #include "control/control.h"
+#include "control/controlguidispatcher.h"
 
 ControlProxy::ControlProxy(QObject* pParent)
         : QObject(pParent),
-          m_pControl(NULL) {
+          m_pControl(NULL),
+          m_bCoalesced(false) {
 }
 
 ControlProxy::ControlProxy(const QString& g, const QString& i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(ConfigKey(g, i));
 }
 
 ControlProxy::ControlProxy(const char* g, const char* i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(ConfigKey(g, i));
 }
 
 ControlProxy::ControlProxy(const ConfigKey& key, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(key);
 }
 
 void ControlProxy::initialize(const ConfigKey& key, bool warn) {
+    unsubscribeCoalesced();
     m_key = key;
     // Don't bother looking up the control if key is NULL. Prevents log spew.
     if (!key.isNull()) {
@@ -31,8 +38,34 @@ void ControlProxy::initialize(const ConfigKey& key, bool warn) {
     }
 }
 
+void ControlProxy::initializeById(int controlId, bool warn) {
+    unsubscribeCoalesced();
+    m_pControl = ControlDoublePrivate::getControlById(controlId);
+    if (m_pControl) {
+        m_key = m_pControl->getKey();
+    } else {
+        m_key = ConfigKey();
+        if (warn) {
+            qWarning() << "ControlProxy::initializeById: no control with id"
+                       << controlId;
+        }
+    }
+}
+
 ControlProxy::~ControlProxy() {
     //qDebug() << "ControlProxy::~ControlProxy()";
+    unsubscribeCoalesced();
+}
+
+void ControlProxy::unsubscribeCoalesced() {
+    if (!m_bCoalesced) {
+        return;
+    }
+    m_bCoalesced = false;
+    ControlGuiDispatcher* pDispatcher = ControlGuiDispatcher::instance();
+    if (pDispatcher) {
+        pDispatcher->unsubscribe(this);
+    }
 }
 
 bool ControlProxy::connectValueChanged(const QObject* receiver,
@@ -104,3 +137,29 @@ bool ControlProxy::connectValueChanged(
     DEBUG_ASSERT(parent() != NULL);
     return connectValueChanged(parent(), method, type);
 }
+
+bool ControlProxy::connectValueChangedCoalesced(const QObject* receiver,
+        const char* method) {
+    if (!m_pControl) {
+        return false;
+    }
+
+    if (!m_bCoalesced) {
+        ControlGuiDispatcher* pDispatcher = ControlGuiDispatcher::instance();
+        if (pDispatcher == NULL || !pDispatcher->isDispatcherThread() ||
+                thread() != QThread::currentThread() ||
+                !pDispatcher->subscribe(this)) {
+            // Deliver every change
+            return connectValueChanged(receiver, method);
+        }
+        m_bCoalesced = true;
+    }
+
+    return connect((QObject*)this, SIGNAL(valueChanged(double)),
+            receiver, method, Qt::AutoConnection);
+}
+
+bool ControlProxy::connectValueChangedCoalesced(const char* method) {
+    DEBUG_ASSERT(parent() != NULL);
+    return connectValueChangedCoalesced(parent(), method);
+}
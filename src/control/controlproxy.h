@@ -8,6 +8,8 @@
 #include "control/control.h"
 #include "preferences/usersettings.h"
 
+class ControlGuiDispatcher;
+
 // This class is the successor of ControlObjectThread. It should be used for
 // new code to avoid unnecessary locking during send if no slot is connected.
 // Do not (re-)connect slots during runtime, since this locks the mutex in
@@ -25,16 +27,31 @@ class ControlProxy : public QObject {
     virtual ~ControlProxy();
 
     void initialize(const ConfigKey& key, bool warn = true);
+    // Like initialize(), but looks the control up by its id, which is
+    // cheaper than looking it up by its ConfigKey.
+    void initializeById(int controlId, bool warn = true);
 
     const ConfigKey& getKey() const {
         return m_key;
     }
 
+    // Returns the id of the connected control or kInvalidControlId.
+    int getControlId() const {
+        return m_pControl ? m_pControl->getId() : kInvalidControlId;
+    }
+
     bool connectValueChanged(const QObject* receiver,
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
     bool connectValueChanged(
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
 
+    // Like connectValueChanged(), for receivers in the GUI thread that only
+    // need the latest value, e.g. widgets. All changes of the control between
+    // two GUI ticks are delivered at once by the ControlGuiDispatcher. Falls
+    // back to connectValueChanged() if there is no dispatcher.
+    bool connectValueChangedCoalesced(const QObject* receiver, const char* method);
+    bool connectValueChangedCoalesced(const char* method);
+
     // Called from update();
     virtual void emitValueChanged() {
         emit(valueChanged(get()));
@@ -130,6 +147,14 @@ class ControlProxy : public QObject {
     ConfigKey m_key;
     // Pointer to connected control.
     QSharedPointer<ControlDoublePrivate> m_pControl;
+
+  private:
+    void unsubscribeCoalesced();
+
+    // Whether the proxy is subscribed to the ControlGuiDispatcher
+    bool m_bCoalesced;
+
+    friend class ControlGuiDispatcher;
 };
 
 #endif // CONTROLPROXY_H
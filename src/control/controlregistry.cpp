@@ -0,0 +1,317 @@
+#include <QtDebug>
+
+#include <limits>
+
+#include "control/controlregistry.h"
+
+#include "control/control.h"
+#include "util/assert.h"
+
+namespace {
+
+// Mixxx creates a few thousand controls, so the table starts big enough for
+// most of them
+const uint kInitialCapacity = 4096;
+
+// Deletes the objects that have been retired before epoch
+template<typename T>
+void deleteRetiredBefore(std::vector<std::pair<quint64, T*> >* pRetired,
+        quint64 epoch) {
+    // Sorted by epoch, because the epoch only grows
+    auto it = pRetired->begin();
+    for (; it != pRetired->end() && it->first < epoch; ++it) {
+        delete it->second;
+    }
+    pRetired->erase(pRetired->begin(), it);
+}
+
+} // anonymous namespace
+
+ControlRegistry::ReaderHandle::~ReaderHandle() {
+    DEBUG_ASSERT(pReader->epoch.load(std::memory_order_relaxed) == kIdle);
+    pReader->inUse.store(false);
+}
+
+ControlRegistry::ControlRegistry()
+        : m_pTable(nullptr),
+          m_epoch(kIdle + 1),
+          m_pReaders(nullptr),
+          m_usedSlots(0) {
+    for (int i = 0; i < kMaxIdChunks; ++i) {
+        m_idChunks[i].store(nullptr);
+    }
+}
+
+ControlRegistry::~ControlRegistry() {
+    Table* pTable = m_pTable.load();
+    if (pTable) {
+        for (uint i = 0; i < pTable->capacity(); ++i) {
+            delete pTable->slots[i].load();
+        }
+        delete pTable;
+    }
+    for (int i = 0; i < kMaxIdChunks; ++i) {
+        delete[] m_idChunks[i].load();
+    }
+    deleteRetiredBefore(&m_retiredEntries, std::numeric_limits<quint64>::max());
+    deleteRetiredBefore(&m_retiredTables, std::numeric_limits<quint64>::max());
+    // The handles of threads that are still running are not deleted anymore
+    // after m_threadReaders has been destroyed
+    Reader* pReader = m_pReaders.load();
+    while (pReader) {
+        Reader* pNext = pReader->pNext;
+        delete pReader;
+        pReader = pNext;
+    }
+}
+
+ControlRegistry::Reader* ControlRegistry::threadReader() const {
+    ReaderHandle* pHandle = m_threadReaders.localData();
+    if (pHandle) {
+        return pHandle->pReader;
+    }
+    // Reuse the reader of a thread that has exited, or add a new one
+    Reader* pReader = m_pReaders.load();
+    for (; pReader; pReader = pReader->pNext) {
+        bool inUse = false;
+        if (pReader->inUse.compare_exchange_strong(inUse, true)) {
+            break;
+        }
+    }
+    if (!pReader) {
+        pReader = new Reader();
+        Reader* pHead = m_pReaders.load();
+        do {
+            pReader->pNext = pHead;
+        } while (!m_pReaders.compare_exchange_weak(pHead, pReader));
+    }
+    m_threadReaders.setLocalData(new ReaderHandle(pReader));
+    return pReader;
+}
+
+ControlRegistry::Reader* ControlRegistry::beginLookup() const {
+    Reader* pReader = threadReader();
+    DEBUG_ASSERT(pReader->epoch.load(std::memory_order_relaxed) == kIdle);
+    // Entries and tables that are replaced while this lookup is in progress
+    // are not deleted until it has finished. The store is sequentially
+    // consistent, so the loads of the lookup cannot move before it.
+    pReader->epoch.store(m_epoch.load());
+    return pReader;
+}
+
+void ControlRegistry::endLookup(Reader* pReader) const {
+    pReader->epoch.store(kIdle, std::memory_order_release);
+}
+
+QSharedPointer<ControlDoublePrivate> ControlRegistry::lookup(
+        const ConfigKey& key) const {
+    const uint hash = qHash(key);
+    QSharedPointer<ControlDoublePrivate> pControl;
+    Reader* pReader = beginLookup();
+    Table* pTable = m_pTable.load();
+    if (pTable) {
+        for (uint i = hash & pTable->mask; ; i = (i + 1) & pTable->mask) {
+            const Entry* pEntry = pTable->slots[i].load();
+            if (!pEntry) {
+                break;
+            }
+            if (pEntry->hash == hash && pEntry->key == key) {
+                pControl = pEntry->pControl.toStrongRef();
+                break;
+            }
+        }
+    }
+    endLookup(pReader);
+    return pControl;
+}
+
+QSharedPointer<ControlDoublePrivate> ControlRegistry::lookup(int controlId) const {
+    QSharedPointer<ControlDoublePrivate> pControl;
+    Reader* pReader = beginLookup();
+    const std::atomic<Entry*>* pSlot = idSlot(controlId);
+    if (pSlot) {
+        const Entry* pEntry = pSlot->load();
+        if (pEntry) {
+            pControl = pEntry->pControl.toStrongRef();
+        }
+    }
+    endLookup(pReader);
+    return pControl;
+}
+
+int ControlRegistry::lookupId(const ConfigKey& key) const {
+    const uint hash = qHash(key);
+    int id = kInvalidControlId;
+    Reader* pReader = beginLookup();
+    Table* pTable = m_pTable.load();
+    if (pTable) {
+        for (uint i = hash & pTable->mask; ; i = (i + 1) & pTable->mask) {
+            const Entry* pEntry = pTable->slots[i].load();
+            if (!pEntry) {
+                break;
+            }
+            if (pEntry->hash == hash && pEntry->key == key) {
+                id = pEntry->id;
+                break;
+            }
+        }
+    }
+    endLookup(pReader);
+    return id;
+}
+
+std::atomic<ControlRegistry::Entry*>* ControlRegistry::findSlot(
+        Table* pTable, const ConfigKey& key, uint hash) const {
+    for (uint i = hash & pTable->mask; ; i = (i + 1) & pTable->mask) {
+        const Entry* pEntry = pTable->slots[i].load(std::memory_order_relaxed);
+        if (!pEntry || (pEntry->hash == hash && pEntry->key == key)) {
+            return &pTable->slots[i];
+        }
+    }
+}
+
+std::atomic<ControlRegistry::Entry*>* ControlRegistry::idSlot(int id) const {
+    if (id < 0 || id >= kMaxIdChunks * kIdChunkSize) {
+        return nullptr;
+    }
+    std::atomic<Entry*>* pChunk = m_idChunks[id >> kIdChunkBits].load();
+    if (!pChunk) {
+        return nullptr;
+    }
+    return &pChunk[id & (kIdChunkSize - 1)];
+}
+
+int ControlRegistry::reserveId(const ConfigKey& key) {
+    auto it = m_ids.constFind(key);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    const int id = m_ids.size();
+    VERIFY_OR_DEBUG_ASSERT(id < kMaxIdChunks * kIdChunkSize) {
+        qWarning() << "ControlRegistry: Out of control ids for" << key;
+        return kInvalidControlId;
+    }
+    if (!m_idChunks[id >> kIdChunkBits].load(std::memory_order_relaxed)) {
+        m_idChunks[id >> kIdChunkBits].store(
+                new std::atomic<Entry*>[kIdChunkSize]());
+    }
+    m_ids.insert(key, id);
+    return id;
+}
+
+void ControlRegistry::publish(std::atomic<Entry*>* pSlot, Entry* pEntry) {
+    Entry* pOldEntry = pSlot->exchange(pEntry);
+    std::atomic<Entry*>* pIdSlot = idSlot(pEntry->id);
+    if (pIdSlot) {
+        pIdSlot->store(pEntry);
+    }
+    if (pOldEntry) {
+        retire(pOldEntry);
+    } else {
+        ++m_usedSlots;
+    }
+}
+
+void ControlRegistry::insert(const ConfigKey& key,
+        const QSharedPointer<ControlDoublePrivate>& pControl) {
+    // Keep the load factor at or below 1/2, so that the probe sequences
+    // stay short and always end in an unused slot
+    Table* pTable = m_pTable.load(std::memory_order_relaxed);
+    if (!pTable || 2 * (m_usedSlots + 1) > static_cast<int>(pTable->capacity())) {
+        grow();
+        pTable = m_pTable.load(std::memory_order_relaxed);
+    }
+
+    const uint hash = qHash(key);
+    publish(findSlot(pTable, key, hash),
+            new Entry(key, hash, reserveId(key), pControl));
+    reclaim();
+}
+
+void ControlRegistry::removeExpired(const ConfigKey& key) {
+    Table* pTable = m_pTable.load(std::memory_order_relaxed);
+    if (!pTable) {
+        return;
+    }
+    const uint hash = qHash(key);
+    std::atomic<Entry*>* pSlot = findSlot(pTable, key, hash);
+    Entry* pEntry = pSlot->load(std::memory_order_relaxed);
+    if (!pEntry || !pEntry->pControl.isNull()) {
+        return;
+    }
+    // The key keeps its slot and its id. The new entry does not reference
+    // the deleted control anymore.
+    publish(pSlot, new Entry(key, hash, pEntry->id,
+            QSharedPointer<ControlDoublePrivate>()));
+    reclaim();
+}
+
+void ControlRegistry::getControls(
+        QList<QSharedPointer<ControlDoublePrivate> >* pControlList) const {
+    Table* pTable = m_pTable.load(std::memory_order_relaxed);
+    if (!pTable) {
+        return;
+    }
+    for (uint i = 0; i < pTable->capacity(); ++i) {
+        const Entry* pEntry = pTable->slots[i].load(std::memory_order_relaxed);
+        if (!pEntry) {
+            continue;
+        }
+        QSharedPointer<ControlDoublePrivate> pControl = pEntry->pControl.toStrongRef();
+        if (!pControl.isNull()) {
+            pControlList->push_back(pControl);
+        }
+    }
+}
+
+void ControlRegistry::grow() {
+    Table* pOldTable = m_pTable.load(std::memory_order_relaxed);
+    Table* pNewTable = new Table(
+            pOldTable ? 2 * pOldTable->capacity() : kInitialCapacity);
+    // The entries move to the new table. Their slots by id stay the same.
+    if (pOldTable) {
+        for (uint i = 0; i < pOldTable->capacity(); ++i) {
+            Entry* pEntry = pOldTable->slots[i].load(std::memory_order_relaxed);
+            if (pEntry) {
+                findSlot(pNewTable, pEntry->key, pEntry->hash)->store(
+                        pEntry, std::memory_order_relaxed);
+            }
+        }
+    }
+    m_pTable.store(pNewTable);
+    if (pOldTable) {
+        retire(pOldTable);
+    }
+}
+
+void ControlRegistry::retire(Entry* pEntry) {
+    m_retiredEntries.push_back(std::make_pair(
+            m_epoch.load(std::memory_order_relaxed), pEntry));
+}
+
+void ControlRegistry::retire(Table* pTable) {
+    m_retiredTables.push_back(std::make_pair(
+            m_epoch.load(std::memory_order_relaxed), pTable));
+}
+
+void ControlRegistry::reclaim() {
+    if (m_retiredEntries.empty() && m_retiredTables.empty()) {
+        return;
+    }
+    // A lookup that announces the new epoch has loaded it after everything
+    // that has been retired so far was replaced, so it cannot see any of it.
+    // A lookup that has loaded an older epoch but not announced it yet when
+    // its reader is checked below announces it after the check. All of these
+    // operations are sequentially consistent, so it cannot see anything that
+    // has been retired either.
+    quint64 oldestEpoch = m_epoch.fetch_add(1) + 1;
+    for (const Reader* pReader = m_pReaders.load(); pReader;
+            pReader = pReader->pNext) {
+        const quint64 epoch = pReader->epoch.load();
+        if (epoch != kIdle && epoch < oldestEpoch) {
+            oldestEpoch = epoch;
+        }
+    }
+    deleteRetiredBefore(&m_retiredEntries, oldestEpoch);
+    deleteRetiredBefore(&m_retiredTables, oldestEpoch);
+}
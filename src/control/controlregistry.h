@@ -0,0 +1,178 @@
+#ifndef CONTROLREGISTRY_H
+#define CONTROLREGISTRY_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QWeakPointer>
+#include <QtGlobal>
+
+#include "preferences/configobject.h"
+#include "util/class.h"
+
+class ControlDoublePrivate;
+
+// Every ConfigKey that a control has been registered for is assigned a
+// compact integer id, starting at 0. The id of a key never changes, even if
+// its control is deleted and created again. Looking up a control by its id
+// is much cheaper than hashing and comparing the two strings of the key.
+const int kInvalidControlId = -1;
+
+// The hash table from ConfigKey to ControlDoublePrivate behind
+// ControlDoublePrivate::getControl. Controller scripts, skins and the engine
+// look up controls far more often than controls are created, so lookups are
+// lock-free and never wait for a thread that creates or deletes a control.
+// Modifications must be serialized by the caller.
+//
+// The table uses open addressing with linear probing. Every slot points to an
+// immutable entry. Modifications publish new entries and, when the table
+// grows, a new table instead of changing them in place (read-copy-update).
+// The replaced entries and tables are retired and deleted by a later
+// modification once every lookup that might still see them has finished
+// (epoch-based reclamation). Lookups only write to a reader record of their
+// own thread, so they do not contend with each other. The entries are also
+// indexed by the id of their key.
+class ControlRegistry {
+  public:
+    ControlRegistry();
+    ~ControlRegistry();
+
+    // Returns the control for key or a null pointer if it does not exist.
+    // Lock-free, may be called from any thread.
+    QSharedPointer<ControlDoublePrivate> lookup(const ConfigKey& key) const;
+    // Returns the control for controlId or a null pointer if it does not
+    // exist. Lock-free, may be called from any thread.
+    QSharedPointer<ControlDoublePrivate> lookup(int controlId) const;
+    // Returns the id of key or kInvalidControlId if no control has been
+    // registered for it yet. Lock-free, may be called from any thread.
+    int lookupId(const ConfigKey& key) const;
+
+    // Returns the id of key and assigns a new one if it has none yet.
+    int reserveId(const ConfigKey& key);
+    // Inserts or replaces the control for key.
+    void insert(const ConfigKey& key,
+            const QSharedPointer<ControlDoublePrivate>& pControl);
+    // Removes the control for key if it has been deleted. A control that has
+    // been created for the same key in the meantime is kept.
+    void removeExpired(const ConfigKey& key);
+    // Appends all controls that currently exist to pControlList.
+    void getControls(QList<QSharedPointer<ControlDoublePrivate> >* pControlList) const;
+
+    // The number of entries and tables that have not been deleted yet
+    int retiredCountForTest() const {
+        return static_cast<int>(m_retiredEntries.size() + m_retiredTables.size());
+    }
+
+  private:
+    struct Entry {
+        Entry(const ConfigKey& key, uint hash, int id,
+                const QSharedPointer<ControlDoublePrivate>& pControl)
+                : key(key),
+                  hash(hash),
+                  id(id),
+                  pControl(pControl) {
+        }
+
+        const ConfigKey key;
+        const uint hash;
+        const int id;
+        const QWeakPointer<ControlDoublePrivate> pControl;
+    };
+
+    struct Table {
+        explicit Table(uint capacity)
+                : mask(capacity - 1),
+                  slots(new std::atomic<Entry*>[capacity]()) {
+        }
+
+        uint capacity() const {
+            return mask + 1;
+        }
+
+        const uint mask;
+        std::unique_ptr<std::atomic<Entry*>[]> slots;
+    };
+
+    // The epoch of a reader that is not looking up anything
+    static const quint64 kIdle = 0;
+
+    // Each thread that looks up controls owns a reader. A lookup announces
+    // the current epoch in it while it is in progress. Readers are never
+    // deleted before the registry, they are reused after their thread exits.
+    struct Reader {
+        Reader()
+                : epoch(kIdle),
+                  inUse(true),
+                  pNext(nullptr) {
+        }
+
+        // Keeps epoch off the cache lines of other allocations, which are
+        // written by other threads
+        char paddingBefore[64];
+        std::atomic<quint64> epoch;
+        std::atomic<bool> inUse;
+        Reader* pNext;
+        char paddingAfter[64];
+    };
+
+    // Deleted by QThreadStorage when its thread exits
+    struct ReaderHandle {
+        explicit ReaderHandle(Reader* pReader)
+                : pReader(pReader) {
+        }
+        ~ReaderHandle();
+
+        Reader* const pReader;
+    };
+
+    template<typename T>
+    using RetiredList = std::vector<std::pair<quint64, T*> >;
+
+    // The entries by id are stored in chunks that are allocated on demand
+    // and never move, so they do not need to be reclaimed like tables
+    static const int kIdChunkBits = 10;
+    static const int kIdChunkSize = 1 << kIdChunkBits;
+    static const int kMaxIdChunks = 1024;
+
+    // Returns the slot of key or the first unused slot of its probe sequence
+    std::atomic<Entry*>* findSlot(Table* pTable, const ConfigKey& key, uint hash) const;
+    std::atomic<Entry*>* idSlot(int id) const;
+    // Publishes pEntry in pSlot and in the slot of its id
+    void publish(std::atomic<Entry*>* pSlot, Entry* pEntry);
+    void grow();
+    void retire(Entry* pEntry);
+    void retire(Table* pTable);
+    void reclaim();
+
+    // Returns the reader of the calling thread after announcing the current
+    // epoch in it
+    Reader* beginLookup() const;
+    void endLookup(Reader* pReader) const;
+    Reader* threadReader() const;
+
+    std::atomic<Table*> m_pTable;
+    std::atomic<std::atomic<Entry*>*> m_idChunks[kMaxIdChunks];
+    // Only advanced by modifications
+    std::atomic<quint64> m_epoch;
+    // A list of all readers that only grows
+    mutable std::atomic<Reader*> m_pReaders;
+    mutable QThreadStorage<ReaderHandle*> m_threadReaders;
+
+    // The following members are only accessed by modifications. The retired
+    // entries and tables are stored with the epoch in which they were
+    // replaced.
+    QHash<ConfigKey, int> m_ids;
+    int m_usedSlots;
+    RetiredList<Entry> m_retiredEntries;
+    RetiredList<Table> m_retiredTables;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlRegistry);
+};
+
+#endif /* CONTROLREGISTRY_H */
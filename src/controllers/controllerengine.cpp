@@ -175,15 +175,8 @@ void ControllerEngine::gracefulShutdown() {
     m_scriptWrappedFunctionCache.clear();
 
     // Free all the ControlObjectScripts
-    QList<ConfigKey> keys = m_controlCache.keys();
-    QList<ConfigKey>::iterator it = keys.begin();
-    QList<ConfigKey>::iterator end = keys.end();
-    while (it != end) {
-        ConfigKey key = *it;
-        ControlObjectScript* coScript = m_controlCache.take(key);
-        delete coScript;
-        ++it;
-    }
+    qDeleteAll(m_controlCache);
+    m_controlCache.clear();
 
     delete m_pBaClass;
     m_pBaClass = nullptr;
@@ -532,18 +525,32 @@ void ControllerEngine::errorDialogButton(const QString& key, QMessageBox::Standa
 }
 
 ControlObjectScript* ControllerEngine::getControlObjectScript(const QString& group, const QString& name) {
-    ConfigKey key = ConfigKey(group, name);
-    ControlObjectScript* coScript = m_controlCache.value(key, nullptr);
-    if (coScript == nullptr) {
-        // create COT
-        coScript = new ControlObjectScript(key, this);
-        if (coScript->valid()) {
-            m_controlCache.insert(key, coScript);
-        } else {
-            delete coScript;
-            coScript = nullptr;
-        }
+    return getControlObjectScript(
+            ControlDoublePrivate::getControlId(ConfigKey(group, name)));
+}
+
+ControlObjectScript* ControllerEngine::getControlObjectScript(int controlId) {
+    if (controlId < 0) {
+        return nullptr;
+    }
+    if (controlId < m_controlCache.size() && m_controlCache[controlId] != nullptr) {
+        return m_controlCache[controlId];
+    }
+    QSharedPointer<ControlDoublePrivate> pControl =
+            ControlDoublePrivate::getControlById(controlId);
+    if (pControl.isNull()) {
+        return nullptr;
+    }
+    // create COT
+    ControlObjectScript* coScript = new ControlObjectScript(pControl->getKey(), this);
+    if (!coScript->valid()) {
+        delete coScript;
+        return nullptr;
     }
+    if (controlId >= m_controlCache.size()) {
+        m_controlCache.resize(controlId + 1);
+    }
+    m_controlCache[controlId] = coScript;
     return coScript;
 }
 
@@ -576,13 +583,63 @@ void ControllerEngine::setValue(QString group, QString name, double newValue) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(coScript->getKey());
-        if (pControl && !m_st.ignore(pControl, coScript->getParameterForValue(newValue))) {
-            coScript->slotSet(newValue);
-        }
+        setControlValue(coScript, newValue);
     }
 }
 
+/* -------- ------------------------------------------------------
+   Purpose: Returns the id of a Mixxx control (for scripts)
+   Input:   Control group (e.g. [Channel1]), Key name (e.g. [filterHigh])
+   Output:  The id for getValueById() and setValueById(), or -1 if the
+            control does not exist
+   -------- ------------------------------------------------------ */
+int ControllerEngine::getControlId(QString group, QString name) {
+    const int controlId = ControlDoublePrivate::getControlId(ConfigKey(group, name));
+    if (controlId < 0) {
+        qWarning() << "ControllerEngine: Unknown control" << group << name << ", returning -1";
+    }
+    return controlId;
+}
+
+/* -------- ------------------------------------------------------
+   Purpose: Returns the current value of a Mixxx control (for scripts)
+   Input:   Control id from getControlId()
+   Output:  The value
+   -------- ------------------------------------------------------ */
+double ControllerEngine::getValueById(int controlId) {
+    ControlObjectScript* coScript = getControlObjectScript(controlId);
+    if (coScript == nullptr) {
+        qWarning() << "ControllerEngine: Unknown control id" << controlId << ", returning 0.0";
+        return 0.0;
+    }
+    return coScript->get();
+}
+
+/* -------- ------------------------------------------------------
+   Purpose: Sets new value of a Mixxx control (for scripts)
+   Input:   Control id from getControlId(), new value
+   Output:  -
+   -------- ------------------------------------------------------ */
+void ControllerEngine::setValueById(int controlId, double newValue) {
+    ControlObjectScript* coScript = getControlObjectScript(controlId);
+    if (coScript == nullptr) {
+        qWarning() << "ControllerEngine: Unknown control id" << controlId << ", ignoring.";
+        return;
+    }
+    if (isnan(newValue)) {
+        qWarning() << "ControllerEngine: script setting" << coScript->getKey()
+                 << "to NotANumber, ignoring.";
+        return;
+    }
+    setControlValue(coScript, newValue);
+}
+
+void ControllerEngine::setControlValue(ControlObjectScript* coScript, double newValue) {
+    ControlObject* pControl = ControlObject::getControlById(coScript->getControlId());
+    if (pControl && !m_st.ignore(pControl, coScript->getParameterForValue(newValue))) {
+        coScript->slotSet(newValue);
+    }
+}
 
 /* -------- ------------------------------------------------------
    Purpose: Returns the normalized value of a Mixxx control (for scripts)
@@ -613,7 +670,7 @@ void ControllerEngine::setParameter(QString group, QString name, double newParam
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(coScript->getKey());
+        ControlObject* pControl = ControlObject::getControlById(coScript->getControlId());
         if (pControl && !m_st.ignore(pControl, newParameter)) {
           coScript->setParameter(newParameter);
         }
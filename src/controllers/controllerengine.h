@@ -103,6 +103,11 @@ class ControllerEngine : public QObject {
   protected:
     Q_INVOKABLE double getValue(QString group, QString name);
     Q_INVOKABLE void setValue(QString group, QString name, double newValue);
+    // Scripts that access a control very often, e.g. on every jog wheel tick,
+    // can look up its id once and use the cheaper accessors by id.
+    Q_INVOKABLE int getControlId(QString group, QString name);
+    Q_INVOKABLE double getValueById(int controlId);
+    Q_INVOKABLE void setValueById(int controlId, double newValue);
     Q_INVOKABLE double getParameter(QString group, QString name);
     Q_INVOKABLE void setParameter(QString group, QString name, double newValue);
     Q_INVOKABLE double getParameterForValue(QString group, QString name, double value);
@@ -184,6 +189,8 @@ class ControllerEngine : public QObject {
     QScriptEngine *m_pEngine;
 
     ControlObjectScript* getControlObjectScript(const QString& group, const QString& name);
+    ControlObjectScript* getControlObjectScript(int controlId);
+    void setControlValue(ControlObjectScript* coScript, double newValue);
 
     // Scratching functions & variables
     void scratchProcess(int timerId);
@@ -195,7 +202,8 @@ class ControllerEngine : public QObject {
     bool m_bPopups;
     QList<QString> m_scriptFunctionPrefixes;
     QMap<QString, QStringList> m_scriptErrors;
-    QHash<ConfigKey, ControlObjectScript*> m_controlCache;
+    // Indexed by the control id
+    QVector<ControlObjectScript*> m_controlCache;
     struct TimerInfo {
         QScriptValue callback;
         QScriptValue context;
@@ -7,6 +7,23 @@
 #include "util/statsmanager.h"
 #include "util/logging.h"
 
+namespace {
+
+// The number of controls that are shown in the control traces tab
+const int kControlTraceTopN = 50;
+
+enum ControlTraceColumn {
+    CONTROL_TRACE_COLUMN_NAME = 0,
+    CONTROL_TRACE_COLUMN_SETS,
+    CONTROL_TRACE_COLUMN_DISPATCH_TOTAL,
+    CONTROL_TRACE_COLUMN_DISPATCH_MAX,
+    CONTROL_TRACE_COLUMN_LISTENERS,
+    CONTROL_TRACE_COLUMN_THREADS,
+    NUM_CONTROL_TRACE_COLUMNS
+};
+
+} // anonymous namespace
+
 DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
                                      UserSettingsPointer pConfig)
         : QDialog(pParent),
@@ -51,6 +68,20 @@ DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
     m_statProxyModel.setSourceModel(&m_statModel);
     statsTable->setModel(&m_statProxyModel);
 
+    controlTraceTable->setColumnCount(NUM_CONTROL_TRACE_COLUMNS);
+    controlTraceTable->setHorizontalHeaderLabels(QStringList()
+            << tr("Control") << tr("Sets") << tr("Total Dispatch Time")
+            << tr("Max Dispatch Time") << tr("Max Listeners")
+            << tr("Setting Threads"));
+    controlTraceEnabled->setChecked(StatsManager::controlTracingEnabled());
+    controlTraceEnabled->setEnabled(pManager != nullptr);
+    connect(controlTraceEnabled, SIGNAL(toggled(bool)),
+            this, SLOT(slotControlTraceEnabled(bool)));
+    connect(controlTraceClear, SIGNAL(clicked()),
+            this, SLOT(slotControlTraceClear()));
+    connect(controlTraceExport, SIGNAL(clicked()),
+            this, SLOT(slotControlTraceExport()));
+
     QString logFileName = QDir(pConfig->getSettingsPath()).filePath("mixxx.log");
     m_logFile.setFileName(logFileName);
     if (!m_logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -113,9 +144,71 @@ void DlgDeveloperTools::timerEvent(QTimerEvent* pEvent) {
         if (pManager) {
             pManager->updateStats();
         }
+    } else if (toolTabWidget->currentWidget() == controlTraceTab) {
+        updateControlTraces();
+    }
+}
+
+void DlgDeveloperTools::updateControlTraces() {
+    StatsManager* pManager = StatsManager::instance();
+    if (!pManager) {
+        return;
+    }
+    const QList<ControlTrace> traces = pManager->getControlTraces(kControlTraceTopN);
+    controlTraceTable->setRowCount(traces.size());
+    for (int row = 0; row < traces.size(); ++row) {
+        const ControlTrace& trace = traces[row];
+        QStringList threads;
+        for (auto it = trace.setsByThread.constBegin();
+                it != trace.setsByThread.constEnd(); ++it) {
+            threads << QString("%1: %2").arg(it.key()).arg(it.value());
+        }
+        const QString columns[NUM_CONTROL_TRACE_COLUMNS] = {
+            trace.name(),
+            QString::number(trace.sets),
+            mixxx::Duration::fromNanos(trace.dispatchNanos).formatMillisWithUnit(),
+            mixxx::Duration::fromNanos(trace.maxDispatchNanos).formatMicrosWithUnit(),
+            QString::number(trace.maxListeners),
+            threads.join(", "),
+        };
+        for (int column = 0; column < NUM_CONTROL_TRACE_COLUMNS; ++column) {
+            QTableWidgetItem* pItem = controlTraceTable->item(row, column);
+            if (pItem == nullptr) {
+                pItem = new QTableWidgetItem();
+                controlTraceTable->setItem(row, column, pItem);
+            }
+            pItem->setText(columns[column]);
+        }
     }
 }
 
+void DlgDeveloperTools::slotControlTraceEnabled(bool enabled) {
+    StatsManager* pManager = StatsManager::instance();
+    if (pManager) {
+        pManager->setControlTracingEnabled(enabled);
+    }
+}
+
+void DlgDeveloperTools::slotControlTraceClear() {
+    StatsManager* pManager = StatsManager::instance();
+    if (pManager) {
+        pManager->clearControlTraces();
+    }
+    controlTraceTable->setRowCount(0);
+}
+
+void DlgDeveloperTools::slotControlTraceExport() {
+    StatsManager* pManager = StatsManager::instance();
+    if (!pManager) {
+        return;
+    }
+    QString timestamp = QDateTime::currentDateTime()
+            .toString("yyyy-MM-dd_hh'h'mm'm'ss's'");
+    QString reportFileName = m_pConfig->getSettingsPath() +
+            "/control_trace_" + timestamp + ".csv";
+    pManager->writeControlTraceReport(reportFileName, kControlTraceTopN);
+}
+
 void DlgDeveloperTools::slotControlSearch(const QString& search) {
     m_controlProxyModel.setFilterFixedString(search);
 }
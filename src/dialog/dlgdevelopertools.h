@@ -24,8 +24,13 @@ class DlgDeveloperTools : public QDialog, public Ui::DlgDeveloperTools {
     void slotControlSearch(const QString& search);
     void slotLogSearch();
     void slotControlDump();
+    void slotControlTraceEnabled(bool enabled);
+    void slotControlTraceClear();
+    void slotControlTraceExport();
 
   private:
+    void updateControlTraces();
+
     UserSettingsPointer m_pConfig;
     ControlModel m_controlModel;
     QSortFilterProxyModel m_controlProxyModel;
@@ -2,6 +2,7 @@
 
 #include <QtDebug>
 
+#include "effects/builtin/modulation_util.h"
 #include "util/experiment.h"
 #include "util/math.h"
 #include "util/sample.h"
@@ -24,6 +25,7 @@ EffectManifestPointer AutoPanEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Bounce the sound left and right across the stereo field"));
+    pManifest->setTailLength(0.1);
 
     // Period
     EffectManifestParameterPointer period = pManifest->addParameter();
@@ -144,12 +146,12 @@ void AutoPanEffect::processChannel(
 
     gs.frac.setRampingThreshold(kPositionRampingThreshold);
 
-    double sinusoid = 0;
+    // The time restarts on the first frame at or beyond the end of the period
+    const unsigned int cycleFrames = static_cast<unsigned int>(ceil(period));
+    const double sampleRate = bufferParameters.sampleRate();
 
-    // NOTE: Assuming engine is working in stereo.
-    for (unsigned int i = 0; i + 1 < bufferParameters.samplesPerBuffer(); i += 2) {
-
-        CSAMPLE periodFraction = CSAMPLE(gs.time) / period;
+    auto sinusoidAt = [&](unsigned int time) {
+        CSAMPLE periodFraction = CSAMPLE(time) / period;
 
         // current quarter in the trigonometric circle
         float quarter = floorf(periodFraction * 4.0f);
@@ -174,26 +176,45 @@ void AutoPanEffect::processChannel(
         // the limits will be 0.25 and 0.75. If it's 0, it will be 0.5 and 0.5
         // so the sound will be stuck at the center. If it values 1, the limits
         // will be 0 and 1 (full left and full right).
-        sinusoid = sin(M_PI * 2.0f * angleFraction) * width;
-        gs.frac.setWithRampingApplied((sinusoid + 1.0f) / 2.0f);
-
-        // apply the delay
-        gs.delay->process(&pInput[i], &pOutput[i],
-                -0.005 * math_clamp(((gs.frac * 2.0) - 1.0f), -1.0, 1.0) * bufferParameters.sampleRate());
-
-        double lawCoef = computeLawCoefficient(sinusoid);
-        pOutput[i] *= gs.frac * lawCoef;
-        pOutput[i+1] *= (1.0f - gs.frac) * lawCoef;
+        return static_cast<CSAMPLE>(sin(M_PI * 2.0f * angleFraction) * width);
+    };
 
-        gs.time++;
-        while (gs.time >= period) {
-            // Click for debug
-            //pOutput[i] = 1.0f;
-            //pOutput[i+1] = 1.0f;
+    // NOTE: Assuming engine is working in stereo.
+    const SINT frames = bufferParameters.framesPerBuffer();
+    for (SINT blockStart = 0; blockStart < frames;
+            blockStart += kModulationBlockFrames) {
+        const SINT blockFrames = math_min(frames - blockStart, kModulationBlockFrames);
+        const unsigned int time = gs.time;
+
+        CSAMPLE sinusoids[kModulationBlockFrames];
+        ModulationUtil::fillCurve(sinusoids, blockFrames, [&](SINT frame) {
+            return sinusoidAt((time + frame) % cycleFrames);
+        });
+        gs.time = (time + blockFrames) % cycleFrames;
+
+        // The delay filter needs to be processed frame by frame
+        CSAMPLE_GAIN gainsLeft[kModulationBlockFrames];
+        CSAMPLE_GAIN gainsRight[kModulationBlockFrames];
+        const SINT blockOffset = blockStart * bufferParameters.channelCount();
+        for (SINT i = 0; i < blockFrames; ++i) {
+            gs.frac.setWithRampingApplied((sinusoids[i] + 1.0f) / 2.0f);
+            const CSAMPLE_GAIN frac = gs.frac;
+            gs.delay->process(&pInput[blockOffset + i * 2], &pOutput[blockOffset + i * 2],
+                    -0.005 * math_clamp(((frac * 2.0) - 1.0f), -1.0, 1.0) * sampleRate);
+            gainsLeft[i] = frac;
+            gainsRight[i] = 1.0f - frac;
+        }
 
-            // The while loop is required in case period changes the value
-            gs.time -= period;
+        // note: LOOP VECTORIZED.
+        for (SINT i = 0; i < blockFrames; ++i) {
+            // See computeLawCoefficient()
+            const CSAMPLE_GAIN lawCoef = 1 + 1 / sqrtf(fabsf(sinusoids[i]) + 1);
+            gainsLeft[i] *= lawCoef;
+            gainsRight[i] *= lawCoef;
         }
+
+        SampleUtil::copyWithStereoGains(pOutput + blockOffset,
+                pOutput + blockOffset, gainsLeft, gainsRight, blockFrames);
     }
 }
 
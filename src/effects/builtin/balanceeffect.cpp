@@ -23,6 +23,7 @@ EffectManifestPointer BalanceEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Adjust the left/right balance and stereo width"));
+    pManifest->setTailLength(0.1);
     pManifest->setEffectRampsFromDry(true);
 
     EffectManifestParameterPointer balance = pManifest->addParameter();
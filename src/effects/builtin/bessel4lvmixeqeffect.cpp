@@ -18,6 +18,7 @@ EffectManifestPointer Bessel4LVMixEQEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "A Bessel 4th-order filter isolator with Lipshitz and Vanderkooy mix (bit perfect unity, roll-off -24 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
+    pManifest->setTailLength(0.1);
     pManifest->setIsMixingEQ(true);
     pManifest->setEffectRampsFromDry(true);
 
@@ -18,6 +18,7 @@ EffectManifestPointer Bessel8LVMixEQEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "A Bessel 8th-order filter isolator with Lipshitz and Vanderkooy mix (bit perfect unity, roll-off -48 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
+    pManifest->setTailLength(0.1);
     pManifest->setIsMixingEQ(true);
     pManifest->setEffectRampsFromDry(true);
 
@@ -62,6 +62,7 @@ EffectManifestPointer BiquadFullKillEQEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "A 3-band Equalizer that combines an Equalizer and an Isolator circuit to offer gentle slopes and full kill.") + " " +  EqualizerUtil::adjustFrequencyShelvesTip());
+    pManifest->setTailLength(0.1);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMixingEQ(true);
 
@@ -17,6 +17,7 @@ EffectManifestPointer BitCrusherEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Adds noise by the reducing the bit depth and sample rate"));
+    pManifest->setTailLength(0.0);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setMetaknobDefault(0.0);
 
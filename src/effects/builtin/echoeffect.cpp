@@ -39,6 +39,9 @@ EffectManifestPointer EchoEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
       "Stores the input signal in a temporary buffer and outputs it after a short time"));
+    // The repeats can go on for longer with a lot of feedback. They are
+    // processed as long as the output is audible.
+    pManifest->setTailLength(10.0);
     pManifest->setMetaknobDefault(db2ratio(-3.0));
 
     EffectManifestParameterPointer delay = pManifest->addParameter();
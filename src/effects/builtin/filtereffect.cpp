@@ -21,6 +21,8 @@ EffectManifestPointer FilterEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Allows only high or low frequencies to play."));
+    // The resonance makes the filters ring
+    pManifest->setTailLength(0.5);
     pManifest->setEffectRampsFromDry(true);
 
     EffectManifestParameterPointer lpf = pManifest->addParameter();
@@ -2,6 +2,7 @@
 
 #include <QtDebug>
 
+#include "effects/builtin/modulation_util.h"
 #include "util/math.h"
 
 namespace{
@@ -30,6 +31,7 @@ EffectManifestPointer FlangerEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Mixes the input with a delayed, pitch modulated copy of itself to create comb filtering"));
+    pManifest->setTailLength(1.0);
     pManifest->setMetaknobDefault(1.0);
 
     EffectManifestParameterPointer speed = pManifest->addParameter();
@@ -165,14 +167,17 @@ void FlangerEffect::processChannel(const ChannelHandle& handle,
     // independently in the loop below, so do not multiply lfoPeriodSamples by
     // the number of channels.
 
+    // The ramps of the parameters over the buffer, like RampingValue
+    const SINT frames = bufferParameters.framesPerBuffer();
+
     CSAMPLE_GAIN mix = m_pMixParameter->value();
-    RampingValue<CSAMPLE_GAIN> mixRamped(
-            pState->prev_mix, mix, bufferParameters.framesPerBuffer());
+    const CSAMPLE_GAIN mixStart = pState->prev_mix;
+    const CSAMPLE_GAIN mixStep = (mix - mixStart) / frames;
     pState->prev_mix = mix;
 
     CSAMPLE_GAIN regen = m_pRegenParameter->value();
-    RampingValue<CSAMPLE_GAIN> regenRamped(
-            pState->prev_regen, regen, bufferParameters.framesPerBuffer());
+    const CSAMPLE_GAIN regenStart = pState->prev_regen;
+    const CSAMPLE_GAIN regenStep = (regen - regenStart) / frames;
     pState->prev_regen = regen;
 
     // With and Manual is limited by amount of amplitude that remains from width
@@ -183,57 +188,80 @@ void FlangerEffect::processChannel(const ChannelHandle& handle,
     double minManual = kCenterDelayMs - (kMaxLfoWidthMs - width) / 2;
     manual = math_clamp(manual, minManual, maxManual);
 
-    RampingValue<double> widthRamped(
-            pState->prev_width, width, bufferParameters.framesPerBuffer());
+    const double widthStart = pState->prev_width;
+    const double widthStep = (width - widthStart) / frames;
     pState->prev_width = width;
 
-    RampingValue<double> manualRamped(
-            pState->prev_manual, manual, bufferParameters.framesPerBuffer());
+    const double manualStart = pState->prev_manual;
+    const double manualStep = (manual - manualStart) / frames;
     pState->prev_manual = manual;
 
+    // The LFO restarts on the first frame at or beyond the end of the period
+    const unsigned int lfoCycleFrames = static_cast<unsigned int>(ceil(lfoPeriodFrames));
+    const double framesPerMs = bufferParameters.sampleRate() / 1000.0;
+
     CSAMPLE* delayLeft = pState->delayLeft;
     CSAMPLE* delayRight = pState->delayRight;
 
-   for (unsigned int i = 0;
-          i < bufferParameters.samplesPerBuffer();
-          i += bufferParameters.channelCount()) {
-
-        CSAMPLE_GAIN mix_ramped = mixRamped.getNext();
-        CSAMPLE_GAIN regen_ramped = regenRamped.getNext();
-        double width_ramped = widthRamped.getNext();
-        double manual_ramped = manualRamped.getNext();
-
-        pState->lfoFrames++;
-        if (pState->lfoFrames >= lfoPeriodFrames) {
-            pState->lfoFrames = 0;
+    // NOTE: Assuming engine is working in stereo.
+    for (SINT blockStart = 0; blockStart < frames;
+            blockStart += kModulationBlockFrames) {
+        const SINT blockFrames = math_min(frames - blockStart, kModulationBlockFrames);
+        const unsigned int lfoFrames = pState->lfoFrames;
+
+        // The delay of each frame in the block
+        CSAMPLE delayFramesCurve[kModulationBlockFrames];
+        ModulationUtil::fillCurve(delayFramesCurve, blockFrames, [&](SINT frame) {
+            const SINT rampFrame = blockStart + frame + 1;
+            const double width_ramped = widthStart + widthStep * rampFrame;
+            const double manual_ramped = manualStart + manualStep * rampFrame;
+            const unsigned int lfoFrame = (lfoFrames + frame + 1) % lfoCycleFrames;
+            float periodFraction = static_cast<float>(lfoFrame) / lfoPeriodFrames;
+            double delayMs = manual_ramped + width_ramped / 2 * sin(M_PI * 2.0f * periodFraction);
+            return static_cast<CSAMPLE>(delayMs * framesPerMs);
+        });
+        pState->lfoFrames = (lfoFrames + blockFrames) % lfoCycleFrames;
+
+        CSAMPLE_GAIN regenCurve[kModulationBlockFrames];
+        ModulationUtil::fillRamp(regenCurve, blockFrames,
+                regenStart + regenStep * blockStart, regenStep);
+
+        // The feedback through the delay lines needs to be processed frame
+        // by frame
+        CSAMPLE delayedLeft[kModulationBlockFrames];
+        CSAMPLE delayedRight[kModulationBlockFrames];
+        const CSAMPLE* pBlockInput = pInput + blockStart * bufferParameters.channelCount();
+        for (SINT i = 0; i < blockFrames; ++i) {
+            const CSAMPLE delayFrames = delayFramesCurve[i];
+            const SINT delayFloor = static_cast<SINT>(delayFrames);
+            const SINT framePrev = (pState->delayPos - delayFloor
+                    + kBufferLenth) % kBufferLenth;
+            const SINT frameNext = (framePrev - 1 + kBufferLenth) % kBufferLenth;
+            const CSAMPLE frac = delayFrames - delayFloor;
+
+            const CSAMPLE prevLeft = delayLeft[framePrev];
+            const CSAMPLE prevRight = delayRight[framePrev];
+            delayedLeft[i] = prevLeft + frac * (delayLeft[frameNext] - prevLeft);
+            delayedRight[i] = prevRight + frac * (delayRight[frameNext] - prevRight);
+
+            delayLeft[pState->delayPos] = tanh_approx(
+                    pBlockInput[i * 2] + regenCurve[i] * delayedLeft[i]);
+            delayRight[pState->delayPos] = tanh_approx(
+                    pBlockInput[i * 2 + 1] + regenCurve[i] * delayedRight[i]);
+
+            pState->delayPos = (pState->delayPos + 1) % kBufferLenth;
         }
 
-        float periodFraction = static_cast<float>(pState->lfoFrames) / lfoPeriodFrames;
-        double delayMs = manual_ramped + width_ramped / 2 * sin(M_PI * 2.0f * periodFraction);
-        double delayFrames = delayMs * bufferParameters.sampleRate() / 1000;
-
-        SINT framePrev = (pState->delayPos - static_cast<SINT>(floor(delayFrames))
-                + kBufferLenth) % kBufferLenth;
-        SINT frameNext = (pState->delayPos - static_cast<SINT>(ceil(delayFrames))
-                + kBufferLenth) % kBufferLenth;
-        CSAMPLE prevLeft = delayLeft[framePrev];
-        CSAMPLE nextLeft = delayLeft[frameNext];
-
-        CSAMPLE prevRight = delayRight[framePrev];
-        CSAMPLE nextRight = delayRight[frameNext];
-
-        CSAMPLE frac = delayFrames - floorf(delayFrames);
-        CSAMPLE delayedSampleLeft = prevLeft + frac * (nextLeft - prevLeft);
-        CSAMPLE delayedSampleRight = prevRight + frac * (nextRight - prevRight);
-
-        delayLeft[pState->delayPos] = tanh_approx(pInput[i] + regen_ramped * delayedSampleLeft);
-        delayRight[pState->delayPos] = tanh_approx(pInput[i + 1] + regen_ramped * delayedSampleRight);
-
-        pState->delayPos = (pState->delayPos + 1) % kBufferLenth;
-
-        double gain = (1 - mix_ramped + kGainCorrection * mix_ramped);
-        pOutput[i] = (pInput[i] + mix_ramped * delayedSampleLeft) / gain;
-        pOutput[i + 1] = (pInput[i + 1] + mix_ramped * delayedSampleRight) / gain;
+        CSAMPLE* pBlockOutput = pOutput + blockStart * bufferParameters.channelCount();
+        const CSAMPLE_GAIN blockMixStart = mixStart + mixStep * blockStart;
+        const CSAMPLE_GAIN gainCorrection = static_cast<CSAMPLE_GAIN>(kGainCorrection);
+        // note: LOOP VECTORIZED. only with "int i"
+        for (int i = 0; i < blockFrames; ++i) {
+            const CSAMPLE_GAIN mix_ramped = blockMixStart + mixStep * (i + 1);
+            const CSAMPLE_GAIN gain = 1 - mix_ramped + gainCorrection * mix_ramped;
+            pBlockOutput[i * 2] = (pBlockInput[i * 2] + mix_ramped * delayedLeft[i]) / gain;
+            pBlockOutput[i * 2 + 1] = (pBlockInput[i * 2 + 1] + mix_ramped * delayedRight[i]) / gain;
+        }
     }
 
     if (enableState == EffectEnableState::Disabling) {
@@ -18,6 +18,7 @@ EffectManifestPointer GraphicEQEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "An 8-band graphic equalizer based on biquad filters"));
+    pManifest->setTailLength(0.1);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMasterEQ(true);
 
@@ -22,6 +22,7 @@ EffectManifestPointer LinkwitzRiley8EQEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "A Linkwitz-Riley 8th-order filter isolator (optimized crossover, constant phase shift, roll-off -48 dB/octave).") + " " + EqualizerUtil::adjustFrequencyShelvesTip());
+    pManifest->setTailLength(0.1);
     pManifest->setIsMixingEQ(true);
 
     EqualizerUtil::createCommonParameters(pManifest.data(), false);
@@ -46,6 +47,10 @@ LinkwitzRiley8EQEffectGroupState::LinkwitzRiley8EQEffectGroupState(
     m_high1 = new EngineFilterLinkwitzRiley8High(kStartupSamplerate, kStartupLoFreq);
     m_low2 = new EngineFilterLinkwitzRiley8Low(kStartupSamplerate, kStartupHiFreq);
     m_high2 = new EngineFilterLinkwitzRiley8High(kStartupSamplerate, kStartupHiFreq);
+    m_firstRun.setCoefs(0, *m_high2);
+    m_firstRun.setCoefs(1, *m_low2);
+    m_secondRun.setCoefs(0, *m_high1);
+    m_secondRun.setCoefs(1, *m_low1);
 }
 
 LinkwitzRiley8EQEffectGroupState::~LinkwitzRiley8EQEffectGroupState() {
@@ -64,6 +69,10 @@ void LinkwitzRiley8EQEffectGroupState::setFilters(int sampleRate, int lowFreq,
     m_high1->setFrequencyCorners(sampleRate, lowFreq);
     m_low2->setFrequencyCorners(sampleRate, highFreq);
     m_high2->setFrequencyCorners(sampleRate, highFreq);
+    m_firstRun.setCoefs(0, *m_high2);
+    m_firstRun.setCoefs(1, *m_low2);
+    m_secondRun.setCoefs(0, *m_high1);
+    m_secondRun.setCoefs(1, *m_low1);
 }
 
 LinkwitzRiley8EQEffect::LinkwitzRiley8EQEffect(EngineEffect* pEffect)
@@ -111,8 +120,10 @@ void LinkwitzRiley8EQEffect::processChannel(const ChannelHandle& handle,
         pState->setFilters(bufferParameters.sampleRate(), pState->m_loFreq, pState->m_hiFreq);
     }
 
-    pState->m_high2->process(pInput, pState->m_pHighBuf, bufferParameters.samplesPerBuffer()); // HighPass first run
-    pState->m_low2->process(pInput, pState->m_pLowBuf, bufferParameters.samplesPerBuffer()); // LowPass first run for low and bandpass
+    // HighPass first run and LowPass first run for low and bandpass
+    const CSAMPLE* const pFirstIn[] = {pInput, pInput};
+    CSAMPLE* const pFirstOut[] = {pState->m_pHighBuf, pState->m_pLowBuf};
+    pState->m_firstRun.process(pFirstIn, pFirstOut, bufferParameters.samplesPerBuffer());
 
     if (fMid != pState->old_mid || fHigh != pState->old_high) {
         SampleUtil::applyRampingGain(pState->m_pHighBuf,
@@ -128,8 +139,10 @@ void LinkwitzRiley8EQEffect::processChannel(const ChannelHandle& handle,
                                 bufferParameters.samplesPerBuffer());
     }
 
-    pState->m_high1->process(pState->m_pHighBuf, pState->m_pMidBuf, bufferParameters.samplesPerBuffer()); // HighPass + BandPass second run
-    pState->m_low1->process(pState->m_pLowBuf, pState->m_pLowBuf, bufferParameters.samplesPerBuffer()); // LowPass second run
+    // HighPass + BandPass second run and LowPass second run
+    const CSAMPLE* const pSecondIn[] = {pState->m_pHighBuf, pState->m_pLowBuf};
+    CSAMPLE* const pSecondOut[] = {pState->m_pMidBuf, pState->m_pLowBuf};
+    pState->m_secondRun.process(pSecondIn, pSecondOut, bufferParameters.samplesPerBuffer());
 
     if (fLow != pState->old_low) {
         SampleUtil::copy2WithRampingGain(pOutput,
@@ -146,10 +159,8 @@ void LinkwitzRiley8EQEffect::processChannel(const ChannelHandle& handle,
     if (enableState == EffectEnableState::Disabling) {
         // we rely on the ramping to dry in EngineEffect
         // since this EQ is not fully dry at unity
-        pState->m_low1->pauseFilter();
-        pState->m_low2->pauseFilter();
-        pState->m_high1->pauseFilter();
-        pState->m_high2->pauseFilter();
+        pState->m_firstRun.pauseFilter();
+        pState->m_secondRun.pauseFilter();
         pState->old_low = 1.0;
         pState->old_mid = 1.0;
         pState->old_high = 1.0;
@@ -8,6 +8,7 @@
 #include "effects/effectprocessor.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
+#include "engine/enginefilteriirbank.h"
 #include "engine/enginefilterlinkwitzriley8.h"
 #include "util/class.h"
 #include "util/defs.h"
@@ -21,11 +22,18 @@ class LinkwitzRiley8EQEffectGroupState : public EffectState {
 
     void setFilters(int sampleRate, int lowFreq, int highFreq);
 
+    // These only design the filters, which run in m_firstRun and
+    // m_secondRun
     EngineFilterLinkwitzRiley8Low* m_low1;
     EngineFilterLinkwitzRiley8High* m_high1;
     EngineFilterLinkwitzRiley8Low* m_low2;
     EngineFilterLinkwitzRiley8High* m_high2;
 
+    // m_high2 and m_low2 for both channels
+    EngineFilterIIRBank<8, 2> m_firstRun;
+    // m_high1 and m_low1 for both channels
+    EngineFilterIIRBank<8, 2> m_secondRun;
+
     double old_low;
     double old_mid;
     double old_high;
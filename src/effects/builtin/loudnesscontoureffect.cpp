@@ -29,6 +29,7 @@ EffectManifestPointer LoudnessContourEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Amplifies low and high frequencies at low volumes to compensate for reduced sensitivity of the human ear."));
+    pManifest->setTailLength(0.1);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setMetaknobDefault(-kMaxLoGain / 2);
 
@@ -3,6 +3,7 @@
 
 #include "effects/effectprocessor.h"
 #include "engine/enginefilterdelay.h"
+#include "engine/enginefilteriirbank.h"
 #include "util/defs.h"
 #include "util/math.h"
 #include "util/sample.h"
@@ -30,6 +31,7 @@ class LVMixEQEffectGroupState : public EffectState {
         m_pBandBuf = SampleUtil::alloc(bufferParameters.samplesPerBuffer());
         m_pHighBuf = SampleUtil::alloc(bufferParameters.samplesPerBuffer());
 
+        // Only used to design the filters which run in m_lowFilters
         m_low1 = new LPF(bufferParameters.sampleRate(), kStartupLoFreq);
         m_low2 = new LPF(bufferParameters.sampleRate(), kStartupHiFreq);
         m_delay2 = new EngineFilterDelay<kMaxDelay>();
@@ -53,6 +55,9 @@ class LVMixEQEffectGroupState : public EffectState {
         int delayLow2 = m_low2->setFrequencyCornersForIntDelay(
                 highFreq / sampleRate, kMaxDelay);
 
+        m_lowFilters.setCoefs(0, *m_low1);
+        m_lowFilters.setCoefs(1, *m_low2);
+
         m_delay2->setDelay((delayLow1 - delayLow2) * 2);
         m_delay3->setDelay(delayLow1 * 2);
         m_groupDelay = delayLow1 * 2;
@@ -87,14 +92,12 @@ class LVMixEQEffectGroupState : public EffectState {
             m_delay3->process(pInput, m_pHighBuf, numSamples);
         }
 
-        if (fMid || m_oldMid) {
-            m_delay2->process(pInput, m_pBandBuf, numSamples);
-            m_low2->process(m_pBandBuf, m_pBandBuf, numSamples);
-        }
-
-        if (fLow || m_oldLow) {
-            m_low1->process(pInput, m_pLowBuf, numSamples);
-        }
+        // Both low passes run side by side in a single pass, so there is
+        // nothing to gain from skipping one of them when its band is muted.
+        m_delay2->process(pInput, m_pBandBuf, numSamples);
+        const CSAMPLE* const pLowIn[] = {pInput, m_pBandBuf};
+        CSAMPLE* const pLowOut[] = {m_pLowBuf, m_pBandBuf};
+        m_lowFilters.process(pLowIn, pLowOut, numSamples);
 
         // Test code for comparing streams as two stereo channels
         //for (unsigned int i = 0; i < numSamples; i +=2) {
@@ -168,14 +171,10 @@ class LVMixEQEffectGroupState : public EffectState {
         // We know the exact group delay here so we can just hold off the ramping.
         m_delay3->processAndPauseFilter(pInput, m_pHighBuf, numSamples);
 
-        if (m_oldMid) {
-            m_delay2->processAndPauseFilter(pInput, m_pBandBuf, numSamples);
-            m_low2->processAndPauseFilter(m_pBandBuf, m_pBandBuf, numSamples);
-        }
-
-        if (m_oldLow) {
-            m_low1->processAndPauseFilter(pInput, m_pLowBuf, numSamples);
-        }
+        m_delay2->processAndPauseFilter(pInput, m_pBandBuf, numSamples);
+        const CSAMPLE* const pLowIn[] = {pInput, m_pBandBuf};
+        CSAMPLE* const pLowOut[] = {m_pLowBuf, m_pBandBuf};
+        m_lowFilters.processAndPauseFilter(pLowIn, pLowOut, numSamples);
 
         SampleUtil::copy3WithRampingGain(pOutput,
                 m_pLowBuf, m_oldLow, 0.0,
@@ -238,6 +237,8 @@ class LVMixEQEffectGroupState : public EffectState {
   private:
     LPF* m_low1;
     LPF* m_low2;
+    // m_low1 and m_low2 for both channels
+    EngineFilterIIRBank<LPF::kSize, 2> m_lowFilters;
     EngineFilterDelay<kMaxDelay>* m_delay2;
     EngineFilterDelay<kMaxDelay>* m_delay3;
 
@@ -0,0 +1,50 @@
+#ifndef EFFECTS_BUILTIN_MODULATION_UTIL_H
+#define EFFECTS_BUILTIN_MODULATION_UTIL_H
+
+#include "util/math.h"
+#include "util/types.h"
+
+// The effects that are driven by an LFO process a buffer in blocks of up to
+// kModulationBlockFrames frames. The modulation curves of a block are
+// precomputed into small tables on the stack first, so that the loops over
+// the samples contain no trigonometry and vectorize.
+constexpr SINT kModulationBlockFrames = 64;
+// The LFO only needs to be evaluated every kLfoStepFrames frames. The frames
+// in between are interpolated linearly, which is inaudible for LFO
+// frequencies far below the audio range.
+constexpr SINT kLfoStepFrames = 8;
+
+class ModulationUtil {
+  public:
+    // Fills pCurve with the value of lfo(frame) for all frames of a block.
+    // lfo is only called for every kLfoStepFrames-th and for the last frame.
+    template<typename T, typename Lfo>
+    static void fillCurve(T* pCurve, SINT frames, Lfo lfo) {
+        pCurve[0] = lfo(0);
+        SINT node = 0;
+        while (node < frames - 1) {
+            const SINT nextNode = math_min(node + kLfoStepFrames, frames - 1);
+            const T start = pCurve[node];
+            const T end = lfo(nextNode);
+            const T step = (end - start) / (nextNode - node);
+            // note: LOOP VECTORIZED. only with "int i"
+            for (int i = 1; i < nextNode - node; ++i) {
+                pCurve[node + i] = start + step * i;
+            }
+            pCurve[nextNode] = end;
+            node = nextNode;
+        }
+    }
+
+    // Fills pCurve with a linear ramp that starts one step after start,
+    // like RampingValue::getNext()
+    template<typename T>
+    static void fillRamp(T* pCurve, SINT frames, T start, T step) {
+        // note: LOOP VECTORIZED. only with "int i"
+        for (int i = 0; i < frames; ++i) {
+            pCurve[i] = start + step * (i + 1);
+        }
+    }
+};
+
+#endif /* EFFECTS_BUILTIN_MODULATION_UTIL_H */
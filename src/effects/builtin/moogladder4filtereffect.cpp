@@ -21,6 +21,8 @@ EffectManifestPointer MoogLadder4FilterEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
             "A 4-pole Moog ladder filter, based on Antti Houvilainen's non linear digital implementation"));
+    // The resonance makes the filters ring
+    pManifest->setTailLength(0.5);
     pManifest->setEffectRampsFromDry(true);
 
     EffectManifestParameterPointer lpf = pManifest->addParameter();
@@ -23,6 +23,8 @@ EffectManifestPointer ParametricEQEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "An gentle 2-band parametric equalizer based on biquad filters.\n"
         "It is designed as a complement to the steep mixing equalizers."));
+    // Narrow bands ring for a while
+    pManifest->setTailLength(0.5);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMasterEQ(true);
 
@@ -22,6 +22,7 @@ EffectManifestPointer PhaserEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "Mixes the input signal with a copy passed through a series of "
         "all-pass filters to create comb filtering"));
+    pManifest->setTailLength(1.0);
     pManifest->setEffectRampsFromDry(true);
 
     EffectManifestParameterPointer period = pManifest->addParameter();
@@ -167,7 +168,7 @@ void PhaserEffect::processChannel(const ChannelHandle& handle,
     }
     // freqSkip is used to calculate the phase independently for each channel,
     // so do not multiply periodSamples by the number of channels.
-    CSAMPLE freqSkip = 1.0 / periodSamples * 2.0 * M_PI;
+    const double freqSkip = 1.0 / periodSamples * 2.0 * M_PI;
 
     CSAMPLE feedback = m_pFeedbackParameter->value();
     CSAMPLE range = m_pRangeParameter->value();
@@ -178,57 +179,67 @@ void PhaserEffect::processChannel(const ChannelHandle& handle,
     CSAMPLE* oldInRight = pState->oldInRight;
     CSAMPLE* oldOutRight = pState->oldOutRight;
 
-    // Using two sets of coefficients for left and right channel
-    CSAMPLE filterCoefLeft = 0;
-    CSAMPLE filterCoefRight = 0;
-
     CSAMPLE left = 0, right = 0;
 
-    CSAMPLE_GAIN oldDepth = pState->oldDepth;
-    const CSAMPLE_GAIN depthDelta = (depth - oldDepth)
-            / bufferParameters.framesPerBuffer();
-    const CSAMPLE_GAIN depthStart = oldDepth + depthDelta;
-
+    // For stereo enabled, the channels are out of phase
     int stereoCheck = m_pStereoParameter->value();
-    int counter = 0;
-
-    for (unsigned int i = 0;
-            i < bufferParameters.samplesPerBuffer();
-            i += bufferParameters.channelCount()) {
-        left = pInput[i] + tanh(left * feedback);
-        right = pInput[i + 1] + tanh(right * feedback);
-
-        // For stereo enabled, the channels are out of phase
-        pState->leftPhase = fmodf(pState->leftPhase + freqSkip, 2.0 * M_PI);
-        pState->rightPhase = fmodf(pState->rightPhase + freqSkip + M_PI * stereoCheck, 2.0 * M_PI);
-
-        // Updating filter coefficients once every 'updateCoef' samples to avoid
-        // extra computing
-        if ((counter++) % updateCoef == 0) {
-                CSAMPLE delayLeft = 0.5 + 0.5 * sin(pState->leftPhase);
-                CSAMPLE delayRight = 0.5 + 0.5 * sin(pState->rightPhase);
-
-                // Coefficient computing based on the following:
-                // https://ccrma.stanford.edu/~jos/pasp/Classic_Virtual_Analog_Phase.html
-                CSAMPLE wLeft = range * delayLeft;
-                CSAMPLE wRight = range * delayRight;
-
-                CSAMPLE tanwLeft = tanh(wLeft / 2);
-                CSAMPLE tanwRight = tanh(wRight / 2);
-
-                filterCoefLeft = (1.0 - tanwLeft) / (1.0 + tanwLeft);
-                filterCoefRight = (1.0 - tanwRight) / (1.0 + tanwRight);
+    const double leftPhaseSkip = freqSkip;
+    const double rightPhaseSkip = freqSkip + M_PI * stereoCheck;
+
+    // The filter coefficients are only updated once every 'updateCoef'
+    // frames to avoid extra computing, so the phases are only needed for
+    // these frames.
+    const SINT frames = bufferParameters.framesPerBuffer();
+    for (SINT blockStart = 0; blockStart < frames; blockStart += updateCoef) {
+        const SINT blockFrames = math_min<SINT>(frames - blockStart, updateCoef);
+
+        const double leftPhase = fmod(
+                pState->leftPhase + leftPhaseSkip * (blockStart + 1), 2.0 * M_PI);
+        const double rightPhase = fmod(
+                pState->rightPhase + rightPhaseSkip * (blockStart + 1), 2.0 * M_PI);
+        CSAMPLE delayLeft = 0.5 + 0.5 * sin(leftPhase);
+        CSAMPLE delayRight = 0.5 + 0.5 * sin(rightPhase);
+
+        // Coefficient computing based on the following:
+        // https://ccrma.stanford.edu/~jos/pasp/Classic_Virtual_Analog_Phase.html
+        CSAMPLE wLeft = range * delayLeft;
+        CSAMPLE wRight = range * delayRight;
+
+        CSAMPLE tanwLeft = tanh(wLeft / 2);
+        CSAMPLE tanwRight = tanh(wRight / 2);
+
+        // Using two sets of coefficients for left and right channel
+        const CSAMPLE filterCoefLeft = (1.0 - tanwLeft) / (1.0 + tanwLeft);
+        const CSAMPLE filterCoefRight = (1.0 - tanwRight) / (1.0 + tanwRight);
+
+        // The feedback through the all-pass filters needs to be processed
+        // frame by frame. Only the wet signal is written to the output here,
+        // the dry signal is mixed in below.
+        const SINT blockOffset = blockStart * bufferParameters.channelCount();
+        for (SINT i = blockOffset;
+                i < blockOffset + blockFrames * bufferParameters.channelCount();
+                i += bufferParameters.channelCount()) {
+            left = pInput[i] + tanh(left * feedback);
+            right = pInput[i + 1] + tanh(right * feedback);
+
+            left = processSample(left, oldInLeft, oldOutLeft, filterCoefLeft, stages);
+            right = processSample(right, oldInRight, oldOutRight, filterCoefRight, stages);
+
+            pOutput[i] = left;
+            pOutput[i + 1] = right;
         }
+    }
 
-        left = processSample(left, oldInLeft, oldOutLeft, filterCoefLeft, stages);
-        right = processSample(right, oldInRight, oldOutRight, filterCoefRight, stages);
-
-        const CSAMPLE_GAIN depth = depthStart + depthDelta * (i / bufferParameters.channelCount());
+    pState->leftPhase = fmod(pState->leftPhase + leftPhaseSkip * frames, 2.0 * M_PI);
+    pState->rightPhase = fmod(pState->rightPhase + rightPhaseSkip * frames, 2.0 * M_PI);
 
-        // Computing output combining the original and processed sample
-        pOutput[i] = pInput[i] * (1.0 - 0.5 * depth) + left * depth * 0.5;
-        pOutput[i + 1] = pInput[i + 1] * (1.0 - 0.5 * depth) + right * depth * 0.5;
-    }
+    // Computing output combining the original and processed sample
+    const CSAMPLE_GAIN oldDepth = pState->oldDepth;
+    SampleUtil::applyRampingGain(pOutput, oldDepth * 0.5f, depth * 0.5f,
+            bufferParameters.samplesPerBuffer());
+    SampleUtil::addWithRampingGain(pOutput, pInput,
+            1.0f - 0.5f * oldDepth, 1.0f - 0.5f * depth,
+            bufferParameters.samplesPerBuffer());
 
     pState->oldDepth = depth;
 }
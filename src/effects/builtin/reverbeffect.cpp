@@ -21,6 +21,8 @@ EffectManifestPointer ReverbEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Emulates the sound of the signal bouncing off the walls of a room"));
+    // Long decays are processed as long as the output is audible
+    pManifest->setTailLength(10.0);
 
     EffectManifestParameterPointer decay = pManifest->addParameter();
     decay->setId("decay");
@@ -61,6 +61,7 @@ EffectManifestPointer ThreeBandBiquadEQEffect::getManifest() {
     pManifest->setDescription(QObject::tr(
         "A 3-band Equalizer with two biquad bell filters, a shelving high pass and kill switches.") +
         " " + EqualizerUtil::adjustFrequencyShelvesTip());
+    pManifest->setTailLength(0.1);
     pManifest->setEffectRampsFromDry(true);
     pManifest->setIsMixingEQ(true);
 
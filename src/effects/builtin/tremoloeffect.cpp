@@ -1,5 +1,8 @@
 #include "effects/builtin/tremoloeffect.h"
 
+#include "effects/builtin/modulation_util.h"
+#include "util/math.h"
+
 namespace {
 //  Used to avoid gain discontinuities when changing parameters too fast
 constexpr double kMaxGainIncrement = 0.001;
@@ -20,6 +23,7 @@ EffectManifestPointer TremoloEffect::getManifest() {
     pManifest->setVersion("1.0");
     pManifest->setDescription(QObject::tr(
         "Cycles the volume up and down"));
+    pManifest->setTailLength(0.0);
     pManifest->setMetaknobDefault(1.0);
 
     EffectManifestParameterPointer depth = pManifest->addParameter();
@@ -192,10 +196,12 @@ void TremoloEffect::processChannel(const ChannelHandle& handle,
     unsigned int phaseOffsetFrame = m_pPhaseParameter->value() * framePerPeriod;
     currentFrame = currentFrame % framePerPeriod;
 
-    for (unsigned int i = 0;
-            i < bufferParameters.samplesPerBuffer();
-            i += bufferParameters.channelCount()) {
-        unsigned int positionFrame = (currentFrame - phaseOffsetFrame);
+    //  This is where the magic happens
+    //  This function gives the gain to apply for position in [0 1]
+    //  Plot the function to get a grasp :
+    //  From a sine to a square wave depending on the smooth parameter
+    auto gainTargetAt = [&](unsigned int frame) {
+        unsigned int positionFrame = (frame - phaseOffsetFrame);
         positionFrame = positionFrame % framePerPeriod;
 
         //  Relative position (0 to 1) in the period
@@ -209,27 +215,40 @@ void TremoloEffect::processChannel(const ChannelHandle& handle,
             position = 0.5 + 0.5 * (position - width) / (1 - width);
         }
 
-        //  This is where the magic happens
-        //  This function gives the gain to apply for position in [0 1]
-        //  Plot the function to get a grasp :
-        //  From a sine to a square wave depending on the smooth parameter
-        double gainTarget = 1.0 - (depth / 2.0)
+        return 1.0 - (depth / 2.0)
                 + (atan(sin(2.0 * M_PI * position) / smooth) / (2 * atan(1 / smooth)))
                     * depth;
+    };
 
-        if (gainTarget > gain + kMaxGainIncrement) {
-            gain += kMaxGainIncrement;
-        } else if (gainTarget < gain - kMaxGainIncrement) {
-            gain -= kMaxGainIncrement;
-        } else {
-            gain = gainTarget;
-        }
+    // NOTE: Assuming engine is working in stereo.
+    CSAMPLE_GAIN gains[kModulationBlockFrames];
+    const SINT frames = bufferParameters.framesPerBuffer();
+    for (SINT blockStart = 0; blockStart < frames;
+            blockStart += kModulationBlockFrames) {
+        const SINT blockFrames = math_min(frames - blockStart, kModulationBlockFrames);
 
-        for (int channel = 0; channel < bufferParameters.channelCount(); channel++) {
-            pOutput[i+channel] = gain * pInput[i+channel];
+        double gainTargets[kModulationBlockFrames];
+        ModulationUtil::fillCurve(gainTargets, blockFrames, [&](SINT frame) {
+            return gainTargetAt(currentFrame + frame);
+        });
+
+        for (SINT i = 0; i < blockFrames; ++i) {
+            const double gainTarget = gainTargets[i];
+            if (gainTarget > gain + kMaxGainIncrement) {
+                gain += kMaxGainIncrement;
+            } else if (gainTarget < gain - kMaxGainIncrement) {
+                gain -= kMaxGainIncrement;
+            } else {
+                gain = gainTarget;
+            }
+            gains[i] = static_cast<CSAMPLE_GAIN>(gain);
         }
 
-        currentFrame++;
+        const SINT blockOffset = blockStart * bufferParameters.channelCount();
+        SampleUtil::copyWithStereoGains(pOutput + blockOffset,
+                pInput + blockOffset, gains, gains, blockFrames);
+
+        currentFrame += blockFrames;
     }
 
     // Write back channel state
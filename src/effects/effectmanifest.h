@@ -29,7 +29,8 @@ class EffectManifest final {
           m_isMasterEQ(false),
           m_effectRampsFromDry(false),
           m_bAddDryToWet(false),
-          m_metaknobDefault(0.5) {
+          m_metaknobDefault(0.5),
+          m_tailLength(-1.0) {
     }
 
     const QString& id() const {
@@ -142,6 +143,23 @@ class EffectManifest final {
         m_metaknobDefault = metaknobDefault;
     }
 
+    // How long the output of the effect can keep sounding after its input
+    // has become silent, in seconds. Once the input of a channel has been
+    // silent for longer and the output has decayed to silence as well,
+    // EngineEffect stops processing the effect for the channel until the
+    // input is audible again. The tail length is unknown by default, which
+    // keeps the effect processing all the time. That is also what effects
+    // that generate sound on their own need.
+    bool hasTailLength() const {
+        return m_tailLength >= 0;
+    }
+    double tailLength() const {
+        return m_tailLength;
+    }
+    void setTailLength(double seconds) {
+        m_tailLength = seconds;
+    }
+
     QString backendName() {
         switch (m_backendType) {
             case EffectBackendType::BuiltIn:
@@ -194,6 +212,7 @@ class EffectManifest final {
     bool m_effectRampsFromDry;
     bool m_bAddDryToWet;
     double m_metaknobDefault;
+    double m_tailLength;
 };
 
 #endif /* EFFECTMANIFEST_H */
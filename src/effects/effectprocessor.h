@@ -82,6 +82,14 @@ class EffectProcessor {
                          const mixxx::EngineParameters& bufferParameters,
                          const EffectEnableState enableState,
                          const GroupFeatureState& groupFeatures) = 0;
+
+    // Returns true if process() may be called for different input channels
+    // at the same time from different threads. This is the case if all the
+    // state that process() modifies is kept per channel like the EffectStates
+    // of EffectProcessorImpl.
+    virtual bool supportsConcurrentChannels() const {
+        return true;
+    }
 };
 
 // EffectProcessorImpl manages a separate EffectState for every routing of
@@ -142,7 +150,17 @@ class EffectProcessorImpl : public EffectProcessor {
                          const mixxx::EngineParameters& bufferParameters,
                          const EffectEnableState enableState,
                          const GroupFeatureState& groupFeatures) final {
-        EffectSpecificState* pState = m_channelStateMatrix[inputHandle][outputHandle];
+        // The channels may be processed concurrently, so the matrix must not
+        // be expanded here
+        EffectSpecificState* pState = nullptr;
+        const ChannelHandleMap<EffectSpecificState*>* pOutputsMap =
+                m_channelStateMatrix.find(inputHandle);
+        if (pOutputsMap) {
+            EffectSpecificState* const* ppState = pOutputsMap->find(outputHandle);
+            if (ppState) {
+                pState = *ppState;
+            }
+        }
         VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
             if (kEffectDebugOutput) {
                 qWarning() << "EffectProcessorImpl::process could not retrieve"
@@ -45,6 +45,15 @@ bool EffectsBackend::canInstantiateEffect(const QString& effectId) const {
     return m_registeredEffects.contains(effectId);
 }
 
+EffectInstantiatorPointer EffectsBackend::getInstantiator(
+        const QString& effectId) const {
+    if (!m_registeredEffects.contains(effectId)) {
+        qWarning() << "WARNING: Effect" << effectId << "is not registered.";
+        return EffectInstantiatorPointer();
+    }
+    return m_registeredEffects[effectId].initiator();
+}
+
 EffectPointer EffectsBackend::instantiateEffect(EffectsManager* pEffectsManager,
                                                 const QString& effectId) {
     if (!m_registeredEffects.contains(effectId)) {
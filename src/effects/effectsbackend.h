@@ -28,6 +28,9 @@ class EffectsBackend : public QObject {
     virtual const QList<QString> getEffectIds() const;
     virtual EffectManifestPointer getManifest(const QString& effectId) const;
     virtual bool canInstantiateEffect(const QString& effectId) const;
+    // Returns the instantiator of the effect's processor, which allows to
+    // create an EngineEffect without the Effect front-end, e.g. in benchmarks.
+    virtual EffectInstantiatorPointer getInstantiator(const QString& effectId) const;
     virtual EffectPointer instantiateEffect(
             EffectsManager* pEffectsManager, const QString& effectId);
 
@@ -82,6 +82,20 @@ LV2Manifest* LV2Backend::getLV2Manifest(const QString& effectId) const {
     return m_registeredEffects[effectId];
 }
 
+EffectInstantiatorPointer LV2Backend::getInstantiator(
+        const QString& effectId) const {
+    if (!canInstantiateEffect(effectId)) {
+        qWarning() << "WARNING: Effect" << effectId << "is not registered.";
+        return EffectInstantiatorPointer();
+    }
+    LV2Manifest* lv2manifest = m_registeredEffects[effectId];
+    return EffectInstantiatorPointer(
+            new LV2EffectProcessorInstantiator(
+                    lv2manifest->getPlugin(),
+                    lv2manifest->getAudioPortIndices(),
+                    lv2manifest->getControlPortIndices()));
+}
+
 EffectPointer LV2Backend::instantiateEffect(EffectsManager* pEffectsManager,
                                             const QString& effectId) {
     if (!canInstantiateEffect(effectId)) {
@@ -94,9 +108,5 @@ EffectPointer LV2Backend::instantiateEffect(EffectsManager* pEffectsManager,
         new Effect(
                 pEffectsManager,
                 lv2manifest->getEffectManifest(),
-                EffectInstantiatorPointer(
-                        new LV2EffectProcessorInstantiator(
-                                lv2manifest->getPlugin(),
-                                lv2manifest->getAudioPortIndices(),
-                                lv2manifest->getControlPortIndices()))));
+                getInstantiator(effectId)));
 }
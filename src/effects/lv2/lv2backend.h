@@ -19,6 +19,7 @@ class LV2Backend : public EffectsBackend {
     EffectManifestPointer getManifest(const QString& effectId) const;
     LV2Manifest* getLV2Manifest(const QString& effectId) const;
     bool canInstantiateEffect(const QString& effectId) const;
+    EffectInstantiatorPointer getInstantiator(const QString& effectId) const;
     EffectPointer instantiateEffect(EffectsManager* pEffectsManager,
                                     const QString& effectId);
 
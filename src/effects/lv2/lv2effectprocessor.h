@@ -52,6 +52,10 @@ class LV2EffectProcessor : public EffectProcessor {
             const mixxx::EngineParameters& bufferParameters,
             const EffectEnableState enableState,
             const GroupFeatureState& groupFeatures) override;
+    // The plugin instances of all channels share the port buffers
+    bool supportsConcurrentChannels() const override {
+        return false;
+    }
   private:
     LV2EffectGroupState* createGroupState(const mixxx::EngineParameters& bufferParameters);
 
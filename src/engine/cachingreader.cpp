@@ -21,10 +21,18 @@ mixxx::Logger kLogger("CachingReader");
 const SINT kDefaultHintFrames = 1024;
 
 // currently CachingReaderWorker::kCachingReaderChunkLength is 65536 (0x10000);
-// For 80 chunks we need 5242880 (0x500000) bytes (5 MiB) of Memory
+// For 80 chunks we need up to 5242880 (0x500000) bytes (5 MiB) of Memory,
+// which are shared with other readers of the same track
 //static
 const SINT kNumberOfCachedChunksInMemory = 80;
 
+// The memory that the chunks of a reader refer to, which is added to the
+// budget of the shared chunk cache
+SINT chunkMemoryBytes() {
+    return kNumberOfCachedChunksInMemory *
+            CachingReaderChunk::kSamples * sizeof(CSAMPLE);
+}
+
 } // anonymous namespace
 
 
@@ -34,24 +42,30 @@ CachingReader::CachingReader(QString group,
           m_chunkReadRequestFIFO(1024),
           m_readerStatusFIFO(1024),
           m_readerStatus(INVALID),
+          m_freeCachingReaderChunk(nullptr),
+          m_allocatedCachingReaderChunks(kNumberOfCachedChunksInMemory),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
-          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
+          m_worker(group, config, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
+
+    CachingReaderChunkCache::sharedInstance()->addReader(chunkMemoryBytes());
+    if (m_pConfig) {
+        const int memoryBudgetMiB = m_pConfig->getValue(
+                ConfigKey("[Master]", "decoded_chunk_cache_mb"), 0);
+        if (memoryBudgetMiB > 0) {
+            CachingReaderChunkCache::sharedInstance()->setMemoryBudget(
+                    static_cast<SINT>(memoryBudgetMiB) * 1024 * 1024);
+        }
+    }
 
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
+    m_chunks.reserve(kNumberOfCachedChunksInMemory);
+    // Initialize each chunk to hold nothing and add it to the free list.
+    // The samples are allocated by the worker and shared with other readers.
     for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
-        CachingReaderChunkForOwner* c =
-                new CachingReaderChunkForOwner(
-                        mixxx::SampleBuffer::WritableSlice(
-                                m_sampleBuffer,
-                                CachingReaderChunk::kSamples * i,
-                                CachingReaderChunk::kSamples));
+        CachingReaderChunkForOwner* c = new CachingReaderChunkForOwner();
         m_chunks.push_back(c);
-        m_freeChunks.push_back(c);
+        c->insertIntoListBefore(m_freeCachingReaderChunk);
+        m_freeCachingReaderChunk = c;
     }
 
     // Forward signals from worker
@@ -70,6 +84,8 @@ CachingReader::CachingReader(QString group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    // The worker still refers to the shared cache
+    CachingReaderChunkCache::sharedInstance()->removeReader(chunkMemoryBytes());
     qDeleteAll(m_chunks);
 }
 
@@ -77,15 +93,19 @@ void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
     DEBUG_ASSERT(pChunk != nullptr);
     DEBUG_ASSERT(pChunk->getState() != CachingReaderChunkForOwner::READ_PENDING);
 
-    const int removed = m_allocatedCachingReaderChunks.remove(pChunk->getIndex());
     // We'll tolerate not being in allocatedCachingReaderChunks,
     // because sometime you free a chunk right after you allocated it.
-    DEBUG_ASSERT(removed <= 1);
+    // A pending chunk that is returned after freeAllChunks() must not
+    // remove a new chunk with the same index.
+    if (lookupChunk(pChunk->getIndex()) == pChunk) {
+        m_allocatedCachingReaderChunks.remove(pChunk->getIndex());
+    }
 
     pChunk->removeFromList(
             &m_mruCachingReaderChunk, &m_lruCachingReaderChunk);
     pChunk->free();
-    m_freeChunks.push_back(pChunk);
+    pChunk->insertIntoListBefore(m_freeCachingReaderChunk);
+    m_freeCachingReaderChunk = pChunk;
 }
 
 void CachingReader::freeAllChunks() {
@@ -100,7 +120,8 @@ void CachingReader::freeAllChunks() {
             pChunk->removeFromList(
                     &m_mruCachingReaderChunk, &m_lruCachingReaderChunk);
             pChunk->free();
-            m_freeChunks.push_back(pChunk);
+            pChunk->insertIntoListBefore(m_freeCachingReaderChunk);
+            m_freeCachingReaderChunk = pChunk;
         }
     }
 
@@ -109,14 +130,19 @@ void CachingReader::freeAllChunks() {
 }
 
 CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
-    if (m_freeChunks.isEmpty()) {
+    CachingReaderChunkForOwner* pChunk = m_freeCachingReaderChunk;
+    if (pChunk == nullptr) {
         return nullptr;
     }
-    CachingReaderChunkForOwner* pChunk = m_freeChunks.takeFirst();
+    pChunk->removeFromList(&m_freeCachingReaderChunk, nullptr);
     pChunk->init(chunkIndex);
 
     //kLogger.debug() << "Allocating chunk" << pChunk << pChunk->getIndex();
-    m_allocatedCachingReaderChunks.insert(chunkIndex, pChunk);
+    // Never fails, because there are not more chunks than its capacity
+    const bool inserted =
+            m_allocatedCachingReaderChunks.insert(chunkIndex, pChunk);
+    DEBUG_ASSERT(inserted);
+    Q_UNUSED(inserted);
 
     return pChunk;
 }
@@ -137,7 +163,7 @@ CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkInde
 
 CachingReaderChunkForOwner* CachingReader::lookupChunk(SINT chunkIndex) {
     // Defaults to nullptr if it's not in the hash.
-    CachingReaderChunkForOwner* chunk = m_allocatedCachingReaderChunks.value(chunkIndex, nullptr);
+    CachingReaderChunkForOwner* chunk = m_allocatedCachingReaderChunks.value(chunkIndex);
 
     // Make sure the allocated number matches the indexed chunk number.
     DEBUG_ASSERT(chunk == nullptr || chunkIndex == chunk->getIndex());
@@ -181,6 +207,10 @@ void CachingReader::newTrack(TrackPointer pTrack) {
     m_worker.workReady();
 }
 
+void CachingReader::notifySeek() {
+    m_worker.notifySeek();
+}
+
 void CachingReader::process() {
     ReaderStatusUpdate status;
     while (m_readerStatusFIFO.read(&status, 1) == 1) {
@@ -440,6 +470,7 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
+    const int seekGeneration = m_worker.seekGeneration();
 
     for (const auto& hint: hintList) {
         SINT hintFrame = hint.frame;
@@ -483,7 +514,8 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 // Do not insert the allocated chunk into the MRU/LRU list,
                 // because it will be handed over to the worker immediately
                 CachingReaderChunkReadRequest request;
-                request.giveToWorker(pChunk);
+                request.giveToWorker(pChunk, hint.priority, seekGeneration,
+                        hint.priority > Hint::kPriorityImminent);
                 // kLogger.debug() << "Requesting read of chunk" << current << "into" << pChunk;
                 // kLogger.debug() << "Requesting read into " << request.chunk->data;
                 if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
@@ -498,6 +530,16 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 // This will cause the chunk to be 'freshened' in the cache. The
                 // chunk will be moved to the end of the LRU list.
                 freshenChunk(pChunk);
+            } else if (pChunk->updateReadRequest(hint.priority, seekGeneration)) {
+                // The pending chunk is needed more urgently now, e.g. after
+                // jumping to the hotcue it was requested for, or is still
+                // needed after a seek and must not be cancelled.
+                CachingReaderChunkReadRequest request;
+                request.reprioritizeInWorker(pChunk, hint.priority, seekGeneration,
+                        hint.priority > Hint::kPriorityImminent);
+                if (m_chunkReadRequestFIFO.write(&request, 1) == 1) {
+                    shouldWake = true;
+                }
             }
         }
     }
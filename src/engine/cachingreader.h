@@ -7,8 +7,6 @@
 #include <QtDebug>
 #include <QList>
 #include <QVector>
-#include <QLinkedList>
-#include <QHash>
 #include <QVarLengthArray>
 
 #include "util/types.h"
@@ -16,6 +14,7 @@
 #include "track/track.h"
 #include "engine/engineworker.h"
 #include "util/fifo.h"
+#include "util/fixedcapacityhash.h"
 #include "engine/cachingreaderworker.h"
 
 // A Hint is an indication to the CachingReader that a certain section of a
@@ -27,17 +26,31 @@ typedef struct Hint {
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
-    // used for samples that will be read imminently. Hints for samples that
-    // have the potential to be read (i.e. a cue point) should be issued with
-    // priority >10.
+    // Chunks that are not in the cache are read by the worker in the order of
+    // priority. A priority of 1 is the highest priority and should be used
+    // for samples that will be read imminently. Hints for samples that have
+    // the potential to be read (i.e. a cue point) should be issued with a
+    // lower priority, i.e. a higher number. Pending reads for hints with a
+    // lower priority than kPriorityImminent are cancelled after a seek,
+    // because they are hinted again if still needed.
     int priority;
 
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
 
+    // The play position and the slip position
+    static constexpr int kPriorityImminent = 1;
+    // The start of an enabled loop that we will jump to soon
+    static constexpr int kPriorityLoop = 2;
+    // The samples following the imminent ones in the direction of playback
+    static constexpr int kPriorityLookahead = 3;
+    // Hotcues, which are the most likely targets of a jump
+    static constexpr int kPriorityHotcue = 5;
+    // Other positions that might be jumped to, e.g. the cue point or
+    // the boundaries of a disabled loop
+    static constexpr int kPriorityCue = 10;
+
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -65,12 +78,21 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // positions, and loop points are all portions of the track that the user is
 // likely to dynamically jump to so we should keep them ready.
 //
+// The samples of the chunks are shared with the readers of other decks and
+// samplers that have loaded the same track (see CachingReaderChunkCache).
+//
 // The least recently used policy is implemented by keeping a linked list of the
 // least recently used chunks. When a chunk is "freshened" (i.e. accessed via
 // read or hinted via hintAndMaybeWake) then it is moved to the back of the
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// The index of allocated chunks and the list of free chunks are sized for
+// all chunks at construction, so neither read() nor hintAndMaybeWake()
+// allocate memory in the engine callback. A chunk is either in the free list,
+// in the LRU list or owned by the worker, so both lists share the links of
+// the chunks.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -103,6 +125,11 @@ class CachingReader : public QObject {
     // from the engine callback.
     virtual void hintAndMaybeWake(const HintVector& hintList);
 
+    // Cancels pending reads of chunks that were requested with a lower
+    // priority than Hint::kPriorityImminent before the seek. Must only be
+    // called from the engine callback.
+    virtual void notifySeek();
+
     // Request that the CachingReader load a new track. These requests are
     // processed in the work thread, so the reader must be woken up via wake()
     // for this to take effect.
@@ -155,21 +182,18 @@ class CachingReader : public QObject {
     // Keeps track of all CachingReaderChunks we've allocated.
     QVector<CachingReaderChunkForOwner*> m_chunks;
 
-    // List of free chunks. Linked list so that we have constant time insertions
-    // and deletions. Iteration is not necessary.
-    QLinkedList<CachingReaderChunkForOwner*> m_freeChunks;
+    // The linked list of free chunks. Chunks are taken from and returned to
+    // the head.
+    CachingReaderChunkForOwner* m_freeCachingReaderChunk;
 
     // Keeps track of what CachingReaderChunks we've allocated and indexes them based on what
     // chunk number they are allocated to.
-    QHash<int, CachingReaderChunkForOwner*> m_allocatedCachingReaderChunks;
+    FixedCapacityHash<CachingReaderChunkForOwner> m_allocatedCachingReaderChunks;
 
     // The linked list of recently-used chunks.
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
     CachingReaderChunkForOwner* m_lruCachingReaderChunk;
 
-    // The raw memory buffer which is divided up into chunks.
-    mixxx::SampleBuffer m_sampleBuffer;
-
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
@@ -2,6 +2,7 @@
 
 #include <QtDebug>
 
+#include "engine/cachingreaderdiskcache.h"
 #include "sources/audiosourcestereoproxy.h"
 #include "engine/engine.h"
 #include "util/math.h"
@@ -30,11 +31,8 @@ const SINT CachingReaderChunk::kFrames = 8192; // ~ 170 ms at 48 kHz
 const SINT CachingReaderChunk::kSamples =
         CachingReaderChunk::frames2samples(CachingReaderChunk::kFrames);
 
-CachingReaderChunk::CachingReaderChunk(
-        mixxx::SampleBuffer::WritableSlice sampleBuffer)
-        : m_index(kInvalidChunkIndex),
-          m_sampleBuffer(sampleBuffer) {
-    DEBUG_ASSERT(sampleBuffer.length() == kSamples);
+CachingReaderChunk::CachingReaderChunk()
+        : m_index(kInvalidChunkIndex) {
 }
 
 CachingReaderChunk::~CachingReaderChunk() {
@@ -42,7 +40,10 @@ CachingReaderChunk::~CachingReaderChunk() {
 
 void CachingReaderChunk::init(SINT index) {
     m_index = index;
-    m_bufferedSampleFrames.frameIndexRange() = mixxx::IndexRange();
+    m_bufferedSampleFrames = mixxx::ReadableSampleFrames();
+    // Never frees the samples in the engine callback, because the cache
+    // keeps them as long as they are referenced
+    m_pDecodedChunk.reset();
 }
 
 // Frame index range of this chunk for the given audio source.
@@ -61,17 +62,40 @@ mixxx::IndexRange CachingReaderChunk::frameIndexRange(
 
 mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
         const mixxx::AudioSourcePointer& pAudioSource,
-        mixxx::SampleBuffer::WritableSlice tempOutputBuffer) {
+        mixxx::SampleBuffer::WritableSlice tempOutputBuffer,
+        CachingReaderChunkCache* pCache,
+        const QString& trackKey,
+        CachingReaderDiskCacheFile* pDiskCacheFile) {
+    DEBUG_ASSERT(pCache);
     const auto sourceFrameIndexRange = frameIndexRange(pAudioSource);
-    mixxx::AudioSourceStereoProxy audioSourceProxy(
-            pAudioSource,
-            tempOutputBuffer);
-    DEBUG_ASSERT(audioSourceProxy.channelCount() == kChannels);
-    m_bufferedSampleFrames =
-            audioSourceProxy.readSampleFrames(
-                    mixxx::WritableSampleFrames(
-                            sourceFrameIndexRange,
-                            mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+    m_pDecodedChunk = pCache->lookup(trackKey, m_index);
+    if (!m_pDecodedChunk) {
+        auto pDecodedChunk = std::make_shared<CachingReaderDecodedChunk>(kSamples);
+        if (!pDiskCacheFile ||
+                !pDiskCacheFile->readChunk(
+                        m_index, sourceFrameIndexRange, pDecodedChunk.get())) {
+            mixxx::AudioSourceStereoProxy audioSourceProxy(
+                    pAudioSource,
+                    tempOutputBuffer);
+            DEBUG_ASSERT(audioSourceProxy.channelCount() == kChannels);
+            pDecodedChunk->setReadableSampleFrames(
+                    audioSourceProxy.readSampleFrames(
+                            mixxx::WritableSampleFrames(
+                                    sourceFrameIndexRange,
+                                    mixxx::SampleBuffer::WritableSlice(
+                                            pDecodedChunk->sampleBuffer()))));
+            if (pDiskCacheFile) {
+                pDiskCacheFile->writeChunk(
+                        m_index, pDecodedChunk->readableSampleFrames());
+            }
+        }
+        // Chunks with decoding errors are shared as well, because the
+        // errors are the same for every reader of the file. Every chunk
+        // has to be owned by the cache anyway, so that releasing it in
+        // the engine callback never frees the samples.
+        m_pDecodedChunk = pCache->insert(trackKey, m_index, pDecodedChunk);
+    }
+    m_bufferedSampleFrames = m_pDecodedChunk->readableSampleFrames();
     DEBUG_ASSERT(m_bufferedSampleFrames.frameIndexRange() <= sourceFrameIndexRange);
     return m_bufferedSampleFrames.frameIndexRange();
 }
@@ -114,10 +138,11 @@ mixxx::IndexRange CachingReaderChunk::readBufferedSampleFramesReverse(
     return copyableFrameIndexRange;
 }
 
-CachingReaderChunkForOwner::CachingReaderChunkForOwner(
-        mixxx::SampleBuffer::WritableSlice sampleBuffer)
-        : CachingReaderChunk(sampleBuffer),
+CachingReaderChunkForOwner::CachingReaderChunkForOwner()
+        : CachingReaderChunk(),
           m_state(FREE),
+          m_readPriority(0),
+          m_readSeekGeneration(0),
           m_pPrev(nullptr),
           m_pNext(nullptr) {
 }
@@ -1,7 +1,11 @@
 #ifndef ENGINE_CACHINGREADERCHUNK_H
 #define ENGINE_CACHINGREADERCHUNK_H
 
+#include "engine/cachingreaderchunkcache.h"
 #include "sources/audiosource.h"
+#include "util/math.h"
+
+class CachingReaderDiskCacheFile;
 
 // A Chunk is a memory-resident section of audio that has been cached.
 // Each chunk holds a fixed number kFrames of frames with samples for
@@ -52,10 +56,16 @@ public:
             const mixxx::AudioSourcePointer& pAudioSource) const;
 
     // Read sample frames from the audio source and return the
-    // range of frames that have been read.
+    // range of frames that have been read. The samples are looked up in
+    // or shared through the cache with the readers of the same track.
+    // Before decoding, the samples are looked up in the disk cache file of
+    // the track if there is one.
     mixxx::IndexRange bufferSampleFrames(
             const mixxx::AudioSourcePointer& pAudioSource,
-            mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
+            mixxx::SampleBuffer::WritableSlice tempOutputBuffer,
+            CachingReaderChunkCache* pCache,
+            const QString& trackKey,
+            CachingReaderDiskCacheFile* pDiskCacheFile);
 
     mixxx::IndexRange readBufferedSampleFrames(
             CSAMPLE* sampleBuffer,
@@ -65,8 +75,7 @@ public:
             const mixxx::IndexRange& frameIndexRange) const;
 
 protected:
-    explicit CachingReaderChunk(
-            mixxx::SampleBuffer::WritableSlice sampleBuffer);
+    CachingReaderChunk();
     virtual ~CachingReaderChunk();
 
     void init(SINT index);
@@ -78,9 +87,9 @@ private:
 
     SINT m_index;
 
-    // The worker thread will fill the sample buffer and
-    // set the corresponding frame index range.
-    mixxx::SampleBuffer::WritableSlice m_sampleBuffer;
+    // The worker thread will decode or look up the samples and set
+    // the corresponding frame index range, which refers to the samples.
+    CachingReaderDecodedChunkPointer m_pDecodedChunk;
     mixxx::ReadableSampleFrames m_bufferedSampleFrames;
 };
 
@@ -89,8 +98,7 @@ private:
 // the worker thread is in control.
 class CachingReaderChunkForOwner: public CachingReaderChunk {
 public:
-    explicit CachingReaderChunkForOwner(
-            mixxx::SampleBuffer::WritableSlice sampleBuffer);
+    CachingReaderChunkForOwner();
     ~CachingReaderChunkForOwner() override;
 
     void init(SINT index);
@@ -107,15 +115,31 @@ public:
     }
 
     // The state is controlled by the cache as the owner of each chunk!
-    void giveToWorker() {
+    void giveToWorker(int priority, int seekGeneration) {
         DEBUG_ASSERT(READY == m_state);
         m_state = READ_PENDING;
+        m_readPriority = priority;
+        m_readSeekGeneration = seekGeneration;
     }
     void takeFromWorker() {
         DEBUG_ASSERT(READ_PENDING == m_state);
         m_state = READY;
     }
 
+    // Updates the priority and seek generation of the pending read request
+    // as known by the owner. Returns true if the request needs to be updated
+    // in the worker, i.e. if the chunk is requested with a higher priority
+    // or again after a seek.
+    bool updateReadRequest(int priority, int seekGeneration) {
+        DEBUG_ASSERT(READ_PENDING == m_state);
+        if (priority >= m_readPriority && seekGeneration == m_readSeekGeneration) {
+            return false;
+        }
+        m_readPriority = math_min(priority, m_readPriority);
+        m_readSeekGeneration = seekGeneration;
+        return true;
+    }
+
     // Inserts a chunk into the double-linked list before the
     // given chunk. If the list is currently empty simply pass
     // pBefore = nullptr. Please note that if pBefore points to
@@ -133,6 +157,9 @@ public:
 private:
     State m_state;
 
+    int m_readPriority;
+    int m_readSeekGeneration;
+
     CachingReaderChunkForOwner* m_pPrev; // previous item in double-linked list
     CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
 };
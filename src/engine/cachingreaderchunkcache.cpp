@@ -0,0 +1,139 @@
+#include "engine/cachingreaderchunkcache.h"
+
+#include <QMutexLocker>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CachingReaderChunkCache");
+
+} // anonymous namespace
+
+CachingReaderChunkCache::CachingReaderChunkCache(SINT memoryBudgetBytes)
+        : m_baseMemoryBudgetBytes(memoryBudgetBytes),
+          m_readerMemoryBytes(0),
+          m_bFixedMemoryBudget(false),
+          m_memoryBudgetBytes(memoryBudgetBytes),
+          m_memoryUsageBytes(0) {
+}
+
+CachingReaderChunkCache::~CachingReaderChunkCache() {
+}
+
+// static
+std::shared_ptr<CachingReaderChunkCache> CachingReaderChunkCache::sharedInstance() {
+    static QMutex s_mutex;
+    static std::weak_ptr<CachingReaderChunkCache> s_pInstance;
+    QMutexLocker locker(&s_mutex);
+    std::shared_ptr<CachingReaderChunkCache> pInstance = s_pInstance.lock();
+    if (!pInstance) {
+        // The readers add their memory, see addReader()
+        pInstance = std::make_shared<CachingReaderChunkCache>(0);
+        s_pInstance = pInstance;
+    }
+    return pInstance;
+}
+
+// static
+QString CachingReaderChunkCache::trackKey(const QString& location,
+        qint64 fileSize, const QDateTime& fileModified) {
+    return QString("%1|%2|%3").arg(
+            location,
+            QString::number(fileSize),
+            QString::number(fileModified.toMSecsSinceEpoch()));
+}
+
+CachingReaderDecodedChunkPointer CachingReaderChunkCache::lookup(
+        const QString& trackKey, SINT chunkIndex) {
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_index.constFind(Key{trackKey, chunkIndex});
+    if (it == m_index.constEnd()) {
+        return CachingReaderDecodedChunkPointer();
+    }
+    // Move to the most recently used position
+    m_entries.splice(m_entries.end(), m_entries, it.value());
+    return it.value()->pChunk;
+}
+
+CachingReaderDecodedChunkPointer CachingReaderChunkCache::insert(
+        const QString& trackKey, SINT chunkIndex,
+        CachingReaderDecodedChunkPointer pChunk) {
+    DEBUG_ASSERT(pChunk);
+    QMutexLocker locker(&m_mutex);
+    const Key key{trackKey, chunkIndex};
+    const auto it = m_index.constFind(key);
+    if (it != m_index.constEnd()) {
+        // Decoded concurrently by another worker
+        m_entries.splice(m_entries.end(), m_entries, it.value());
+        return it.value()->pChunk;
+    }
+    m_index.insert(key, m_entries.insert(m_entries.end(), Entry{key, pChunk}));
+    m_memoryUsageBytes += pChunk->sizeInBytes();
+    evictUnreferencedEntries();
+    return pChunk;
+}
+
+void CachingReaderChunkCache::evictUnreferencedEntries() {
+    auto it = m_entries.begin();
+    while (m_memoryUsageBytes > m_memoryBudgetBytes && it != m_entries.end()) {
+        // Readers only get references from the cache while holding the lock,
+        // so an entry that is not referenced now will not be referenced
+        // before it is removed.
+        if (it->pChunk.use_count() > 1) {
+            ++it;
+            continue;
+        }
+        m_memoryUsageBytes -= it->pChunk->sizeInBytes();
+        m_index.remove(it->key);
+        it = m_entries.erase(it);
+    }
+    if (m_memoryUsageBytes > m_memoryBudgetBytes && kLogger.debugEnabled()) {
+        kLogger.debug()
+                << "Referenced chunks exceed the memory budget:"
+                << m_memoryUsageBytes << ">" << m_memoryBudgetBytes;
+    }
+}
+
+void CachingReaderChunkCache::setMemoryBudget(SINT memoryBudgetBytes) {
+    QMutexLocker locker(&m_mutex);
+    m_bFixedMemoryBudget = true;
+    m_memoryBudgetBytes = memoryBudgetBytes;
+    evictUnreferencedEntries();
+}
+
+void CachingReaderChunkCache::addReader(SINT memoryBytes) {
+    QMutexLocker locker(&m_mutex);
+    m_readerMemoryBytes += memoryBytes;
+    updateMemoryBudget();
+}
+
+void CachingReaderChunkCache::removeReader(SINT memoryBytes) {
+    QMutexLocker locker(&m_mutex);
+    m_readerMemoryBytes -= memoryBytes;
+    DEBUG_ASSERT(m_readerMemoryBytes >= 0);
+    updateMemoryBudget();
+}
+
+void CachingReaderChunkCache::updateMemoryBudget() {
+    if (m_bFixedMemoryBudget) {
+        return;
+    }
+    m_memoryBudgetBytes = m_baseMemoryBudgetBytes + m_readerMemoryBytes;
+    evictUnreferencedEntries();
+}
+
+SINT CachingReaderChunkCache::memoryBudget() const {
+    QMutexLocker locker(&m_mutex);
+    return m_memoryBudgetBytes;
+}
+
+SINT CachingReaderChunkCache::memoryUsage() const {
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsageBytes;
+}
+
+int CachingReaderChunkCache::size() const {
+    QMutexLocker locker(&m_mutex);
+    return m_index.size();
+}
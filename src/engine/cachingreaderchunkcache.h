@@ -0,0 +1,132 @@
+#ifndef ENGINE_CACHINGREADERCHUNKCACHE_H
+#define ENGINE_CACHINGREADERCHUNKCACHE_H
+
+#include <list>
+#include <memory>
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "sources/audiosource.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// The decoded sample frames of a chunk. They are written once by the worker
+// that decoded them and are immutable after being shared.
+class CachingReaderDecodedChunk {
+  public:
+    explicit CachingReaderDecodedChunk(SINT samples)
+            : m_sampleBuffer(samples) {
+    }
+
+    mixxx::SampleBuffer& sampleBuffer() {
+        return m_sampleBuffer;
+    }
+
+    // The decoded frames, which refer to sampleBuffer()
+    const mixxx::ReadableSampleFrames& readableSampleFrames() const {
+        return m_readableSampleFrames;
+    }
+    void setReadableSampleFrames(
+            const mixxx::ReadableSampleFrames& readableSampleFrames) {
+        m_readableSampleFrames = readableSampleFrames;
+    }
+
+    SINT sizeInBytes() const {
+        return m_sampleBuffer.size() * sizeof(CSAMPLE);
+    }
+
+  private:
+    mixxx::SampleBuffer m_sampleBuffer;
+    mixxx::ReadableSampleFrames m_readableSampleFrames;
+};
+
+typedef std::shared_ptr<const CachingReaderDecodedChunk> CachingReaderDecodedChunkPointer;
+
+// A process-wide cache of decoded chunks, keyed by track and chunk index,
+// that is shared by the workers of all CachingReaders. If the same track is
+// loaded into several decks or samplers its chunks are decoded only once and
+// all readers refer to the same sample data.
+//
+// Chunks are reference counted. The cache keeps a reference to every chunk
+// it holds and never drops chunks that are still referenced by a reader, so
+// releasing a chunk in the engine callback never frees memory. When the
+// memory used by all chunks exceeds the budget the least recently used
+// chunks that are not referenced by any reader are evicted.
+//
+// Thread-safe, but lookup() and insert() lock and allocate and must only be
+// called from worker threads.
+class CachingReaderChunkCache {
+  public:
+    explicit CachingReaderChunkCache(SINT memoryBudgetBytes);
+    virtual ~CachingReaderChunkCache();
+
+    // The cache is created with the first reader and destroyed with the
+    // last one.
+    static std::shared_ptr<CachingReaderChunkCache> sharedInstance();
+
+    // Identifies the decoded contents of a track file that stay valid until
+    // the file is modified.
+    static QString trackKey(const QString& location, qint64 fileSize,
+            const QDateTime& fileModified);
+
+    // Returns the chunk or nullptr if it is not cached
+    CachingReaderDecodedChunkPointer lookup(const QString& trackKey, SINT chunkIndex);
+
+    // Adds a decoded chunk and returns the cached chunk, which is a chunk
+    // that has been inserted for the same key by another worker before.
+    CachingReaderDecodedChunkPointer insert(const QString& trackKey, SINT chunkIndex,
+            CachingReaderDecodedChunkPointer pChunk);
+
+    // Replaces the budget that is derived from the readers, see addReader()
+    void setMemoryBudget(SINT memoryBudgetBytes);
+    SINT memoryBudget() const;
+
+    // Adds the memory that a reader used for its own chunks before they
+    // were shared to the budget, so all readers together never keep more
+    // decoded chunks in memory than before. Each reader must remove the
+    // same amount again when it is destroyed.
+    void addReader(SINT memoryBytes);
+    void removeReader(SINT memoryBytes);
+    // The memory used by all cached chunks, including those that are
+    // referenced and may exceed the budget.
+    SINT memoryUsage() const;
+    int size() const;
+
+  private:
+    struct Key {
+        QString trackKey;
+        SINT chunkIndex;
+
+        bool operator==(const Key& other) const {
+            return chunkIndex == other.chunkIndex && trackKey == other.trackKey;
+        }
+        friend uint qHash(const Key& key) {
+            return qHash(key.trackKey) ^ qHash(static_cast<qint64>(key.chunkIndex));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        CachingReaderDecodedChunkPointer pChunk;
+    };
+    // Ordered from the least to the most recently used entry
+    typedef std::list<Entry> EntryList;
+
+    void evictUnreferencedEntries();
+    void updateMemoryBudget();
+
+    mutable QMutex m_mutex;
+    // The budget passed to the constructor, without the readers
+    SINT m_baseMemoryBudgetBytes;
+    SINT m_readerMemoryBytes;
+    bool m_bFixedMemoryBudget;
+    SINT m_memoryBudgetBytes;
+    SINT m_memoryUsageBytes;
+    EntryList m_entries;
+    QHash<Key, EntryList::iterator> m_index;
+};
+
+#endif // ENGINE_CACHINGREADERCHUNKCACHE_H
@@ -0,0 +1,196 @@
+#include "engine/cachingreaderdecoders.h"
+
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+
+#include "engine/cachingreaderchunk.h"
+#include "sources/soundsourceproxy.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/memory.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CachingReaderDecoders");
+
+// Formats that seek without decoding from the beginning of a frame or
+// page, i.e. uncompressed formats and formats with seek tables
+const char* const kRandomAccessTrackTypes[] = {
+        "aif",
+        "aiff",
+        "flac",
+        "wav",
+        "wv",
+};
+
+// Runs the additional decoders of all readers
+QThreadPool* decoderThreadPool() {
+    static QThreadPool* s_pThreadPool = [] {
+        QThreadPool* pThreadPool = new QThreadPool();
+        pThreadPool->setMaxThreadCount(math_max(2, QThread::idealThreadCount()));
+        return pThreadPool;
+    }();
+    return s_pThreadPool;
+}
+
+} // anonymous namespace
+
+const int CachingReaderDecoders::kDefaultParallelism = 2;
+const int CachingReaderDecoders::kMaxParallelism = 8;
+
+CachingReaderDecoders::Decoder::Decoder(
+        mixxx::AudioSourcePointer pAudioSource)
+        : m_pAudioSource(std::move(pAudioSource)),
+          m_tempReadBuffer(m_pAudioSource->frames2samples(CachingReaderChunk::kFrames)),
+          m_pChunk(nullptr),
+          m_pBufferedFrameIndexRange(nullptr),
+          m_pCache(nullptr),
+          m_pTrackKey(nullptr),
+          m_pDiskCacheFile(nullptr),
+          m_pDone(nullptr) {
+    // Owned by CachingReaderDecoders and reused for every chunk
+    setAutoDelete(false);
+}
+
+mixxx::IndexRange CachingReaderDecoders::Decoder::readChunk(
+        CachingReaderChunk* pChunk,
+        CachingReaderChunkCache* pCache,
+        const QString& trackKey,
+        CachingReaderDiskCacheFile* pDiskCacheFile) {
+    return pChunk->bufferSampleFrames(
+            m_pAudioSource,
+            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer),
+            pCache,
+            trackKey,
+            pDiskCacheFile);
+}
+
+void CachingReaderDecoders::Decoder::startReadChunk(
+        CachingReaderChunk* pChunk,
+        mixxx::IndexRange* pBufferedFrameIndexRange,
+        CachingReaderChunkCache* pCache,
+        const QString& trackKey,
+        CachingReaderDiskCacheFile* pDiskCacheFile,
+        QSemaphore* pDone) {
+    m_pChunk = pChunk;
+    m_pBufferedFrameIndexRange = pBufferedFrameIndexRange;
+    m_pCache = pCache;
+    m_pTrackKey = &trackKey;
+    m_pDiskCacheFile = pDiskCacheFile;
+    m_pDone = pDone;
+    decoderThreadPool()->start(this);
+}
+
+void CachingReaderDecoders::Decoder::run() {
+    *m_pBufferedFrameIndexRange = readChunk(
+            m_pChunk, m_pCache, *m_pTrackKey, m_pDiskCacheFile);
+    m_pDone->release();
+}
+
+CachingReaderDecoders::CachingReaderDecoders() {
+}
+
+CachingReaderDecoders::~CachingReaderDecoders() {
+    // readChunks() waits for all reads, so no decoder is running
+    close();
+}
+
+// static
+bool CachingReaderDecoders::supportsParallelReads(const QString& trackType) {
+    for (const char* type: kRandomAccessTrackTypes) {
+        if (trackType.compare(QLatin1String(type), Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CachingReaderDecoders::open(
+        mixxx::AudioSourcePointer pAudioSource,
+        const TrackPointer& pTrack,
+        const mixxx::AudioSource::OpenParams& params,
+        int parallelism) {
+    close();
+    DEBUG_ASSERT(pAudioSource);
+    m_decoders.push_back(std::make_unique<Decoder>(pAudioSource));
+    QString trackType = pTrack->getType();
+    if (trackType.isEmpty()) {
+        // Not imported into the library yet
+        trackType = QFileInfo(pTrack->getLocation()).suffix();
+    }
+    if (parallelism <= 1 || !supportsParallelReads(trackType)) {
+        return;
+    }
+    parallelism = math_min(parallelism, kMaxParallelism);
+    while (static_cast<int>(m_decoders.size()) < parallelism) {
+        auto pParallelAudioSource = SoundSourceProxy(pTrack).openAudioSource(params);
+        if (!pParallelAudioSource) {
+            break;
+        }
+        // All decoders must decode the same samples
+        if (pParallelAudioSource->frameIndexRange() != pAudioSource->frameIndexRange() ||
+                pParallelAudioSource->sampleRate() != pAudioSource->sampleRate() ||
+                pParallelAudioSource->channelCount() != pAudioSource->channelCount()) {
+            kLogger.warning()
+                    << "Decoders differ, reading chunks sequentially:"
+                    << pTrack->getLocation();
+            m_decoders.resize(1);
+            break;
+        }
+        m_decoders.push_back(std::make_unique<Decoder>(pParallelAudioSource));
+    }
+    if (kLogger.debugEnabled()) {
+        kLogger.debug() << "Reading up to" << m_decoders.size()
+                << "chunks in parallel from" << pTrack->getLocation();
+    }
+}
+
+void CachingReaderDecoders::close() {
+    m_decoders.clear();
+}
+
+const mixxx::AudioSourcePointer& CachingReaderDecoders::audioSource() const {
+    DEBUG_ASSERT(!m_decoders.empty());
+    return m_decoders.front()->audioSource();
+}
+
+void CachingReaderDecoders::readChunks(
+        CachingReaderChunk* const* ppChunks,
+        mixxx::IndexRange* pBufferedFrameIndexRanges,
+        int count,
+        CachingReaderChunkCache* pCache,
+        const QString& trackKey,
+        CachingReaderDiskCacheFile* pDiskCacheFile,
+        const std::function<void()>& firstChunkRead) {
+    DEBUG_ASSERT(!m_decoders.empty());
+    // The decoders read and write the disk cache file concurrently, which
+    // is only safe for different chunks
+    for (int i = 1; i < count; ++i) {
+        for (int j = 0; j < i; ++j) {
+            DEBUG_ASSERT(ppChunks[i] != ppChunks[j]);
+        }
+    }
+    int next = 0;
+    while (next < count) {
+        const int batchSize = math_min(count - next, parallelism());
+        // The calling thread reads the first chunk of every batch and
+        // waits for the pool threads to finish the others
+        for (int i = 1; i < batchSize; ++i) {
+            m_decoders[i]->startReadChunk(
+                    ppChunks[next + i],
+                    &pBufferedFrameIndexRanges[next + i],
+                    pCache,
+                    trackKey,
+                    pDiskCacheFile,
+                    &m_readsDone);
+        }
+        pBufferedFrameIndexRanges[next] = m_decoders[0]->readChunk(
+                ppChunks[next], pCache, trackKey, pDiskCacheFile);
+        if (next == 0 && firstChunkRead) {
+            firstChunkRead();
+        }
+        m_readsDone.acquire(batchSize - 1);
+        next += batchSize;
+    }
+}
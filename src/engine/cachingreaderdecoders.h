@@ -0,0 +1,121 @@
+#ifndef ENGINE_CACHINGREADERDECODERS_H
+#define ENGINE_CACHINGREADERDECODERS_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QString>
+
+#include "sources/audiosource.h"
+#include "track/track.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+class CachingReaderChunk;
+class CachingReaderChunkCache;
+class CachingReaderDiskCacheFile;
+
+// The decoders of the track loaded by a CachingReaderWorker.
+//
+// Chunks are usually read one after another by the worker thread. For
+// formats with cheap random access additional decoder instances are opened
+// for the same file, so that a burst of requests after a seek or for a loop
+// roll is read in parallel. The additional decoders run on a thread pool
+// that is shared by the workers of all readers.
+//
+// Only accessed by the worker thread that owns it.
+class CachingReaderDecoders {
+  public:
+    static const int kDefaultParallelism;
+    static const int kMaxParallelism;
+
+    CachingReaderDecoders();
+    ~CachingReaderDecoders();
+
+    // Takes the audio source that has been opened for the track and opens
+    // up to parallelism - 1 additional decoders if the format of the track
+    // supports cheap random access.
+    void open(mixxx::AudioSourcePointer pAudioSource,
+            const TrackPointer& pTrack,
+            const mixxx::AudioSource::OpenParams& params,
+            int parallelism);
+    void close();
+
+    // The audio source passed to open()
+    const mixxx::AudioSourcePointer& audioSource() const;
+
+    // The number of chunks that are read at once
+    int parallelism() const {
+        return static_cast<int>(m_decoders.size());
+    }
+
+    // Reads the samples of count distinct chunks with up to parallelism()
+    // decoders at once and stores the range of frames that have been read
+    // for each chunk. The first chunk is read by the calling thread, which
+    // then calls firstChunkRead (if set) before it waits for the other
+    // decoders, so that the most urgent chunk is not delayed by a slower
+    // one. See CachingReaderChunk::bufferSampleFrames().
+    void readChunks(
+            CachingReaderChunk* const* ppChunks,
+            mixxx::IndexRange* pBufferedFrameIndexRanges,
+            int count,
+            CachingReaderChunkCache* pCache,
+            const QString& trackKey,
+            CachingReaderDiskCacheFile* pDiskCacheFile,
+            const std::function<void()>& firstChunkRead = std::function<void()>());
+
+    // If additional decoders are opened for the type of a track
+    static bool supportsParallelReads(const QString& trackType);
+
+  private:
+    class Decoder : public QRunnable {
+      public:
+        explicit Decoder(mixxx::AudioSourcePointer pAudioSource);
+
+        const mixxx::AudioSourcePointer& audioSource() const {
+            return m_pAudioSource;
+        }
+
+        mixxx::IndexRange readChunk(
+                CachingReaderChunk* pChunk,
+                CachingReaderChunkCache* pCache,
+                const QString& trackKey,
+                CachingReaderDiskCacheFile* pDiskCacheFile);
+
+        // Reads a chunk on a pool thread and releases pDone when finished
+        void startReadChunk(
+                CachingReaderChunk* pChunk,
+                mixxx::IndexRange* pBufferedFrameIndexRange,
+                CachingReaderChunkCache* pCache,
+                const QString& trackKey,
+                CachingReaderDiskCacheFile* pDiskCacheFile,
+                QSemaphore* pDone);
+
+        void run() override;
+
+      private:
+        const mixxx::AudioSourcePointer m_pAudioSource;
+
+        // Temporary buffer for reading samples from all channels
+        // before conversion to a stereo signal.
+        mixxx::SampleBuffer m_tempReadBuffer;
+
+        // The arguments of startReadChunk()
+        CachingReaderChunk* m_pChunk;
+        mixxx::IndexRange* m_pBufferedFrameIndexRange;
+        CachingReaderChunkCache* m_pCache;
+        const QString* m_pTrackKey;
+        CachingReaderDiskCacheFile* m_pDiskCacheFile;
+        QSemaphore* m_pDone;
+    };
+
+    // The first decoder uses the audio source passed to open()
+    std::vector<std::unique_ptr<Decoder>> m_decoders;
+
+    QSemaphore m_readsDone;
+};
+
+#endif // ENGINE_CACHINGREADERDECODERS_H
@@ -0,0 +1,318 @@
+#include "engine/cachingreaderdiskcache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#endif
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderchunkcache.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CachingReaderDiskCache");
+
+const char kMagic[8] = {'M', 'I', 'X', 'X', 'X', 'P', 'C', 'M'};
+const quint32 kByteOrder = 0x01020304;
+const quint32 kVersion = 1;
+
+// The samples start at a page boundary
+const qint64 kDataOffset = 4096;
+
+const QString kFileSuffix = ".pcm";
+
+SINT numberOfChunks(const mixxx::IndexRange& frameIndexRange) {
+    return (frameIndexRange.length() + CachingReaderChunk::kFrames - 1) /
+            CachingReaderChunk::kFrames;
+}
+
+// FNV-1a over the sample words. Never 0, which marks missing chunks.
+quint32 checksum(const CSAMPLE* pSamples, SINT numSamples) {
+    static_assert(sizeof(CSAMPLE) == sizeof(quint32),
+            "Checksum requires 32-bit samples");
+    quint32 hash = 2166136261u;
+    for (SINT i = 0; i < numSamples; ++i) {
+        quint32 word;
+        std::memcpy(&word, &pSamples[i], sizeof(word));
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash | 1;
+}
+
+// Allocates the blocks of the whole file on disk. Writing to a mapping of
+// a sparse file raises SIGBUS when the disk is full instead of failing.
+// The contents of a file that has been reserved before are kept.
+bool reserveBlocks(QFile* pFile, qint64 fileSize, bool reservedBefore) {
+#ifdef __LINUX__
+    const int result = posix_fallocate(pFile->handle(), 0, fileSize);
+    if (result == 0) {
+        return true;
+    }
+    if (result != EOPNOTSUPP && result != EINVAL) {
+        return false;
+    }
+    // Not supported by the file system
+#endif
+    if (reservedBefore) {
+        return true;
+    }
+    const QByteArray zeros(64 * 1024, '\0');
+    if (!pFile->seek(0)) {
+        return false;
+    }
+    for (qint64 pos = 0; pos < fileSize; pos += zeros.size()) {
+        const qint64 bytes = std::min<qint64>(zeros.size(), fileSize - pos);
+        if (pFile->write(zeros.constData(), bytes) != bytes) {
+            return false;
+        }
+    }
+    return pFile->flush();
+}
+
+} // anonymous namespace
+
+struct CachingReaderDiskCacheFile::Header {
+    char magic[8];
+    quint32 byteOrder;
+    quint32 version;
+    quint32 channelCount;
+    quint32 sampleRate;
+    quint32 chunkFrames;
+    quint32 reserved;
+    qint64 frameIndexStart;
+    qint64 frameIndexEnd;
+    // Rewritten on every open to update the modification time of the
+    // file that is used for evicting the least recently used files
+    qint64 lastOpenedMillis;
+
+    bool matches(const Header& other) const {
+        return std::memcmp(magic, other.magic, sizeof(magic)) == 0 &&
+                byteOrder == other.byteOrder &&
+                version == other.version &&
+                channelCount == other.channelCount &&
+                sampleRate == other.sampleRate &&
+                chunkFrames == other.chunkFrames &&
+                frameIndexStart == other.frameIndexStart &&
+                frameIndexEnd == other.frameIndexEnd;
+    }
+};
+
+CachingReaderDiskCacheFile::CachingReaderDiskCacheFile(
+        const QString& filePath,
+        const mixxx::IndexRange& frameIndexRange)
+        : m_file(filePath),
+          m_frameIndexRange(frameIndexRange),
+          m_chunkCount(numberOfChunks(frameIndexRange)),
+          m_pMapped(nullptr) {
+}
+
+CachingReaderDiskCacheFile::~CachingReaderDiskCacheFile() {
+    if (m_pMapped) {
+        m_file.unmap(m_pMapped);
+    }
+}
+
+bool CachingReaderDiskCacheFile::open(qint64 fileSize, const Header& header) {
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        kLogger.warning() << "Failed to open" << m_file.fileName();
+        return false;
+    }
+    // The file is never truncated if it has the expected size, because
+    // the worker of another reader might have mapped it already.
+    bool valid = false;
+    const bool resized = m_file.size() != fileSize;
+    if (!resized) {
+        Header existingHeader;
+        valid = m_file.read(reinterpret_cast<char*>(&existingHeader),
+                        sizeof(existingHeader)) == sizeof(existingHeader) &&
+                existingHeader.matches(header);
+    } else if (!m_file.resize(fileSize)) {
+        kLogger.warning() << "Failed to resize" << m_file.fileName()
+                << "to" << fileSize << "bytes";
+        return false;
+    }
+    // Files that already have the expected size have been reserved when
+    // they were created, which makes this cheap for them
+    if (!reserveBlocks(&m_file, fileSize, !resized)) {
+        kLogger.warning() << "Failed to reserve" << fileSize
+                << "bytes on disk for" << m_file.fileName();
+        if (resized) {
+            // Don't leave a sparse file behind for the next reader
+            m_file.remove();
+        }
+        return false;
+    }
+    if (!m_file.seek(0) ||
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+                    sizeof(header) ||
+            !m_file.flush()) {
+        kLogger.warning() << "Failed to write" << m_file.fileName();
+        return false;
+    }
+    m_pMapped = m_file.map(0, fileSize);
+    if (!m_pMapped) {
+        kLogger.warning() << "Failed to map" << m_file.fileName();
+        return false;
+    }
+    if (!valid) {
+        // Start over without any complete chunks
+        std::memset(checksums(), 0, m_chunkCount * sizeof(quint32));
+    }
+    return true;
+}
+
+SINT CachingReaderDiskCacheFile::chunkSamples(SINT chunkIndex) const {
+    const auto chunkFrameIndexRange = intersect(
+            mixxx::IndexRange::forward(
+                    m_frameIndexRange.start() + chunkIndex * CachingReaderChunk::kFrames,
+                    CachingReaderChunk::kFrames),
+            m_frameIndexRange);
+    return CachingReaderChunk::frames2samples(chunkFrameIndexRange.length());
+}
+
+quint32* CachingReaderDiskCacheFile::checksums() const {
+    return reinterpret_cast<quint32*>(m_pMapped + kDataOffset +
+            m_chunkCount * CachingReaderChunk::kSamples * sizeof(CSAMPLE));
+}
+
+CSAMPLE* CachingReaderDiskCacheFile::chunkData(SINT chunkIndex) const {
+    return reinterpret_cast<CSAMPLE*>(m_pMapped + kDataOffset) +
+            chunkIndex * CachingReaderChunk::kSamples;
+}
+
+bool CachingReaderDiskCacheFile::readChunk(SINT chunkIndex,
+        const mixxx::IndexRange& frameIndexRange,
+        CachingReaderDecodedChunk* pDecodedChunk) const {
+    if (chunkIndex < 0 || chunkIndex >= m_chunkCount) {
+        return false;
+    }
+    const SINT numSamples = chunkSamples(chunkIndex);
+    if (frameIndexRange.start() !=
+                    m_frameIndexRange.start() + chunkIndex * CachingReaderChunk::kFrames ||
+            numSamples != CachingReaderChunk::frames2samples(frameIndexRange.length())) {
+        return false;
+    }
+    const quint32 expectedChecksum = checksums()[chunkIndex];
+    if (expectedChecksum == 0) {
+        return false;
+    }
+    CSAMPLE* pSamples = pDecodedChunk->sampleBuffer().data();
+    std::memcpy(pSamples, chunkData(chunkIndex), numSamples * sizeof(CSAMPLE));
+    if (checksum(pSamples, numSamples) != expectedChecksum) {
+        // Not written completely before a crash
+        kLogger.warning() << "Corrupt chunk" << chunkIndex
+                << "in" << m_file.fileName();
+        return false;
+    }
+    pDecodedChunk->setReadableSampleFrames(mixxx::ReadableSampleFrames(
+            frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice(pSamples, numSamples)));
+    return true;
+}
+
+void CachingReaderDiskCacheFile::writeChunk(SINT chunkIndex,
+        const mixxx::ReadableSampleFrames& frames) {
+    if (chunkIndex < 0 || chunkIndex >= m_chunkCount) {
+        return;
+    }
+    const SINT numSamples = chunkSamples(chunkIndex);
+    if (frames.readableLength() != numSamples) {
+        // Incomplete chunks are not stored, because decoding errors
+        // might be temporary
+        return;
+    }
+    std::memcpy(chunkData(chunkIndex), frames.readableData(),
+            numSamples * sizeof(CSAMPLE));
+    checksums()[chunkIndex] = checksum(frames.readableData(), numSamples);
+}
+
+CachingReaderDiskCache::CachingReaderDiskCache(
+        const QString& directory, qint64 maxSizeBytes)
+        : m_directory(directory),
+          m_maxSizeBytes(maxSizeBytes) {
+}
+
+// static
+qint64 CachingReaderDiskCache::fileSize(const mixxx::IndexRange& frameIndexRange) {
+    const qint64 chunkCount = numberOfChunks(frameIndexRange);
+    return kDataOffset +
+            chunkCount * CachingReaderChunk::kSamples * sizeof(CSAMPLE) +
+            chunkCount * sizeof(quint32);
+}
+
+std::unique_ptr<CachingReaderDiskCacheFile> CachingReaderDiskCache::openFile(
+        const QString& trackKey,
+        const mixxx::IndexRange& frameIndexRange, SINT sampleRate) {
+    if (frameIndexRange.empty()) {
+        return nullptr;
+    }
+    const qint64 size = fileSize(frameIndexRange);
+    if (size > m_maxSizeBytes) {
+        return nullptr;
+    }
+
+    QDir directory(m_directory);
+    if (!directory.mkpath(".")) {
+        kLogger.warning() << "Failed to create" << m_directory;
+        return nullptr;
+    }
+    const QString filePath = directory.filePath(QString(
+            QCryptographicHash::hash(trackKey.toUtf8(),
+                    QCryptographicHash::Sha1).toHex()) + kFileSuffix);
+    evictFiles(size, filePath);
+
+    CachingReaderDiskCacheFile::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.byteOrder = kByteOrder;
+    header.version = kVersion;
+    header.channelCount = CachingReaderChunk::kChannels;
+    header.sampleRate = sampleRate;
+    header.chunkFrames = CachingReaderChunk::kFrames;
+    header.frameIndexStart = frameIndexRange.start();
+    header.frameIndexEnd = frameIndexRange.end();
+    header.lastOpenedMillis = QDateTime::currentMSecsSinceEpoch();
+
+    std::unique_ptr<CachingReaderDiskCacheFile> pFile(
+            new CachingReaderDiskCacheFile(filePath, frameIndexRange));
+    if (!pFile->open(size, header)) {
+        return nullptr;
+    }
+    return pFile;
+}
+
+void CachingReaderDiskCache::evictFiles(qint64 requiredBytes,
+        const QString& keepFilePath) {
+    // Oldest first
+    const QFileInfoList files = QDir(m_directory).entryInfoList(
+            QStringList() << ("*" + kFileSuffix),
+            QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 totalBytes = requiredBytes;
+    for (const auto& file: files) {
+        if (file.absoluteFilePath() != QFileInfo(keepFilePath).absoluteFilePath()) {
+            totalBytes += file.size();
+        }
+    }
+    for (const auto& file: files) {
+        if (totalBytes <= m_maxSizeBytes) {
+            break;
+        }
+        if (file.absoluteFilePath() == QFileInfo(keepFilePath).absoluteFilePath()) {
+            continue;
+        }
+        // Fails on some platforms if the file is still mapped by another
+        // reader, which is fine
+        if (QFile::remove(file.absoluteFilePath())) {
+            totalBytes -= file.size();
+        }
+    }
+}
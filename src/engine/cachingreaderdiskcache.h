@@ -0,0 +1,88 @@
+#ifndef ENGINE_CACHINGREADERDISKCACHE_H
+#define ENGINE_CACHINGREADERDISKCACHE_H
+
+#include <memory>
+
+#include <QFile>
+#include <QString>
+
+#include "sources/audiosource.h"
+#include "util/types.h"
+
+class CachingReaderDecodedChunk;
+
+// A decoded track in the disk cache. The file is memory mapped and holds
+// the decoded stereo samples of all chunks at their natural position,
+// followed by a checksum for each chunk that marks the chunk as complete.
+// Chunks are filled in as they are decoded.
+//
+// The parallel decoders of a worker call readChunk() and writeChunk()
+// concurrently from the threads of a shared pool, but never for the same
+// chunk index at the same time, see CachingReaderDecoders::readChunks().
+// This needs no locking, because a call only touches the samples and the
+// checksum of its own chunk and the mapping does not change after the
+// file has been opened. The workers of other decks that play the same
+// track map the same file and may race on a chunk. A reader that sees an
+// incomplete chunk fails the checksum test and decodes it again.
+class CachingReaderDiskCacheFile {
+  public:
+    ~CachingReaderDiskCacheFile();
+
+    // Copies the samples of a chunk into pDecodedChunk. Returns false if
+    // the chunk has not been written completely yet. Thread safe for
+    // distinct chunk indices.
+    bool readChunk(SINT chunkIndex, const mixxx::IndexRange& frameIndexRange,
+            CachingReaderDecodedChunk* pDecodedChunk) const;
+
+    // Stores the samples of a completely decoded chunk. Thread safe for
+    // distinct chunk indices.
+    void writeChunk(SINT chunkIndex, const mixxx::ReadableSampleFrames& frames);
+
+  private:
+    friend class CachingReaderDiskCache;
+
+    struct Header;
+
+    CachingReaderDiskCacheFile(const QString& filePath,
+            const mixxx::IndexRange& frameIndexRange);
+
+    bool open(qint64 fileSize, const Header& header);
+
+    SINT chunkSamples(SINT chunkIndex) const;
+    quint32* checksums() const;
+    CSAMPLE* chunkData(SINT chunkIndex) const;
+
+    QFile m_file;
+    const mixxx::IndexRange m_frameIndexRange;
+    const SINT m_chunkCount;
+    uchar* m_pMapped;
+};
+
+// An optional cache of decoded tracks on disk, so that compressed tracks
+// are only decoded once. Seeks into regions that are not in memory yet then
+// only need to copy the samples from the page cache or the disk.
+//
+// Tracks are stored in one file each that is named after the hash of the
+// track key of CachingReaderChunkCache, i.e. the location, size and
+// modification time of the track file. When a new file is created the
+// least recently opened files are deleted to stay below the size limit.
+class CachingReaderDiskCache {
+  public:
+    CachingReaderDiskCache(const QString& directory, qint64 maxSizeBytes);
+
+    // Opens or creates the cache file of a track. Returns nullptr if the
+    // track does not fit into the cache or the file cannot be created.
+    std::unique_ptr<CachingReaderDiskCacheFile> openFile(const QString& trackKey,
+            const mixxx::IndexRange& frameIndexRange, SINT sampleRate);
+
+    static qint64 fileSize(const mixxx::IndexRange& frameIndexRange);
+
+  private:
+    // Deletes the least recently used files until another requiredBytes fit
+    void evictFiles(qint64 requiredBytes, const QString& keepFilePath);
+
+    const QString m_directory;
+    const qint64 m_maxSizeBytes;
+};
+
+#endif // ENGINE_CACHINGREADERDISKCACHE_H
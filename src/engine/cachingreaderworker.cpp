@@ -1,4 +1,5 @@
 #include <QtDebug>
+#include <QDir>
 #include <QFileInfo>
 #include <QMutexLocker>
 
@@ -9,16 +10,22 @@
 #include "util/compatibility.h"
 #include "util/event.h"
 #include "util/logger.h"
+#include "util/math.h"
+#include "util/memory.h"
 
 
 namespace {
 
 mixxx::Logger kLogger("CachingReaderWorker");
 
+const QString kConfigGroup = "[Master]";
+const int kDefaultDiskCacheSizeMiB = 4096;
+
 } // anonymous namespace
 
 CachingReaderWorker::CachingReaderWorker(
         QString group,
+        UserSettingsPointer pConfig,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
         FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
         : m_group(group),
@@ -26,32 +33,95 @@ CachingReaderWorker::CachingReaderWorker(
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
           m_newTrackAvailable(false),
+          m_seekGeneration(0),
+          m_pConfig(pConfig),
+          m_pChunkCache(CachingReaderChunkCache::sharedInstance()),
           m_stop(0) {
+    m_pendingReadRequests.reserve(pChunkReadRequestFIFO->writeAvailable());
+    m_batchRequests.reserve(CachingReaderDecoders::kMaxParallelism);
+    m_batchChunks.reserve(CachingReaderDecoders::kMaxParallelism);
+    m_batchBufferedFrameIndexRanges.reserve(CachingReaderDecoders::kMaxParallelism);
+    if (pConfig && pConfig->getValue(
+            ConfigKey(kConfigGroup, "decoded_pcm_disk_cache"), false)) {
+        const int sizeMiB = pConfig->getValue(
+                ConfigKey(kConfigGroup, "decoded_pcm_disk_cache_mb"),
+                kDefaultDiskCacheSizeMiB);
+        m_pDiskCache = std::make_unique<CachingReaderDiskCache>(
+                QDir(pConfig->getSettingsPath()).filePath("pcmcache"),
+                static_cast<qint64>(sizeMiB) * 1024 * 1024);
+    }
 }
 
 CachingReaderWorker::~CachingReaderWorker() {
 }
 
-ReaderStatusUpdate CachingReaderWorker::processReadRequest(
-        const CachingReaderChunkReadRequest& request) {
-    CachingReaderChunk* pChunk = request.chunk;
-    DEBUG_ASSERT(pChunk);
+void CachingReaderWorker::processReadRequests(
+        const CachingReaderChunkReadRequest& firstRequest) {
+    // The following requests are taken in the order of their priority
+    m_batchRequests.clear();
+    m_batchRequests.append(firstRequest);
+    CachingReaderChunkReadRequest request;
+    while (m_batchRequests.size() < m_decoders.parallelism() &&
+            takeNextReadRequest(&request)) {
+        m_batchRequests.append(request);
+    }
 
     // Before trying to read any data we need to check if the audio source
     // is available and if any audio data that is needed by the chunk is
     // actually available.
-    const auto chunkFrameIndexRange = pChunk->frameIndexRange(m_pAudioSource);
-    if (intersect(chunkFrameIndexRange, m_readableFrameIndexRange).empty()) {
-        ReaderStatusUpdate result;
-        result.init(CHUNK_READ_INVALID, pChunk, m_readableFrameIndexRange);
-        return result;
+    m_batchChunks.clear();
+    for (const auto& batchRequest: qAsConst(m_batchRequests)) {
+        const auto chunkFrameIndexRange =
+                batchRequest.chunk->frameIndexRange(m_pAudioSource);
+        if (!intersect(chunkFrameIndexRange, m_readableFrameIndexRange).empty()) {
+            m_batchChunks.append(batchRequest.chunk);
+        }
     }
 
-    // Try to read the data required for the chunk from the audio source
-    // and adjust the max. readable frame index if decoding errors occur.
-    const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
-            m_pAudioSource,
-            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+    // Writes the status updates of the requests in their order of
+    // priority, up to the first chunk that has not been read yet
+    int requestIndex = 0;
+    int readIndex = 0;
+    auto writeStatusUpdates = [this, &requestIndex, &readIndex](int chunksRead) {
+        while (requestIndex < m_batchRequests.size()) {
+            const auto& batchRequest = m_batchRequests[requestIndex];
+            ReaderStatusUpdate update;
+            if (readIndex < m_batchChunks.size() &&
+                    m_batchChunks[readIndex] == batchRequest.chunk) {
+                if (readIndex >= chunksRead) {
+                    return;
+                }
+                update = processReadResult(batchRequest.chunk,
+                        m_batchBufferedFrameIndexRanges[readIndex]);
+                ++readIndex;
+            } else {
+                update.init(CHUNK_READ_INVALID, batchRequest.chunk, m_readableFrameIndexRange);
+            }
+            m_pReaderStatusFIFO->writeBlocking(&update, 1);
+            ++requestIndex;
+        }
+    };
+
+    // Try to read the data required for the chunks from the audio source.
+    // The chunk with the highest priority is delivered as soon as it has
+    // been read, without waiting for the other decoders.
+    m_batchBufferedFrameIndexRanges.resize(m_batchChunks.size());
+    m_decoders.readChunks(
+            m_batchChunks.constData(),
+            m_batchBufferedFrameIndexRanges.data(),
+            m_batchChunks.size(),
+            m_pChunkCache.get(),
+            m_trackKey,
+            m_pDiskCacheFile.get(),
+            [&writeStatusUpdates] { writeStatusUpdates(1); });
+    writeStatusUpdates(m_batchChunks.size());
+}
+
+ReaderStatusUpdate CachingReaderWorker::processReadResult(
+        CachingReaderChunk* pChunk,
+        const mixxx::IndexRange& bufferedFrameIndexRange) {
+    // Adjust the max. readable frame index if decoding errors occur.
+    const auto chunkFrameIndexRange = pChunk->frameIndexRange(m_pAudioSource);
     ReaderStatus status = bufferedFrameIndexRange.empty() ? CHUNK_READ_EOF : CHUNK_READ_SUCCESS;
     if (chunkFrameIndexRange != bufferedFrameIndexRange) {
         kLogger.warning()
@@ -84,6 +154,84 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     return result;
 }
 
+void CachingReaderWorker::fetchReadRequests() {
+    CachingReaderChunkReadRequest request;
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        if (!request.reprioritize) {
+            m_pendingReadRequests.append(request);
+            continue;
+        }
+        // The owner sends these only while the chunk is pending, so a
+        // request for the chunk that is still pending must precede it in
+        // the FIFO. Otherwise the chunk has already been read.
+        for (auto& pending: m_pendingReadRequests) {
+            if (pending.chunk == request.chunk) {
+                pending.priority = math_min(pending.priority, request.priority);
+                pending.seekGeneration = request.seekGeneration;
+                pending.cancelAfterSeek =
+                        pending.cancelAfterSeek && request.cancelAfterSeek;
+                break;
+            }
+        }
+    }
+}
+
+bool CachingReaderWorker::takeNextReadRequest(
+        CachingReaderChunkReadRequest* pRequest) {
+    fetchReadRequests();
+
+    // Requests are read in the order of their priority. Among requests with
+    // the same priority the ones issued after the most recent seek come
+    // first and otherwise the requests are read in the order of arrival.
+    const int seekGeneration = this->seekGeneration();
+    int next = -1;
+    int i = 0;
+    while (i < m_pendingReadRequests.size()) {
+        const CachingReaderChunkReadRequest& pending = m_pendingReadRequests[i];
+        if (pending.cancelAfterSeek && pending.seekGeneration != seekGeneration) {
+            cancelReadRequest(pending);
+            m_pendingReadRequests.remove(i);
+            continue;
+        }
+        if (next < 0) {
+            next = i;
+        } else {
+            const CachingReaderChunkReadRequest& best = m_pendingReadRequests[next];
+            if (pending.priority < best.priority ||
+                    (pending.priority == best.priority &&
+                            pending.seekGeneration == seekGeneration &&
+                            best.seekGeneration != seekGeneration)) {
+                next = i;
+            }
+        }
+        ++i;
+    }
+    if (next < 0) {
+        return false;
+    }
+    *pRequest = m_pendingReadRequests[next];
+    m_pendingReadRequests.remove(next);
+    return true;
+}
+
+void CachingReaderWorker::cancelReadRequest(
+        const CachingReaderChunkReadRequest& request) {
+    if (kLogger.traceEnabled()) {
+        kLogger.trace() << "Cancelling read request for" << request.chunk->getIndex();
+    }
+    ReaderStatusUpdate status;
+    status.init(CHUNK_READ_INVALID, request.chunk, m_readableFrameIndexRange);
+    m_pReaderStatusFIFO->writeBlocking(&status, 1);
+}
+
+void CachingReaderWorker::cancelAllReadRequests() {
+    fetchReadRequests();
+    for (const auto& pending: qAsConst(m_pendingReadRequests)) {
+        cancelReadRequest(pending);
+    }
+    m_pendingReadRequests.clear();
+}
+
 // WARNING: Always called from a different thread (GUI)
 void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     QMutexLocker locker(&m_newTrackMutex);
@@ -108,13 +256,12 @@ void CachingReaderWorker::run() {
                 m_newTrackAvailable = false;
             } // implicitly unlocks the mutex
             loadTrack(pLoadTrack);
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
-            const ReaderStatusUpdate update(processReadRequest(request));
-            m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (takeNextReadRequest(&request)) {
+            // Read the requested chunks and send the results
+            processReadRequests(request);
         } else {
             Event::end(m_tag);
-            m_semaRun.acquire();
+            waitForWork();
             Event::start(m_tag);
         }
     }
@@ -138,7 +285,10 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     if (!pTrack) {
         // Unload track
+        m_decoders.close();
         m_pAudioSource.reset(); // Close open file handles
+        m_trackKey.clear();
+        m_pDiskCacheFile.reset();
         m_readableFrameIndexRange = mixxx::IndexRange();
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
         return;
@@ -161,6 +311,8 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     mixxx::AudioSource::OpenParams config;
     config.setChannelCount(CachingReaderChunk::kChannels);
+    m_pDiskCacheFile.reset();
+    m_decoders.close();
     m_pAudioSource = openAudioSourceForReading(pTrack, config);
     if (!m_pAudioSource) {
         m_readableFrameIndexRange = mixxx::IndexRange();
@@ -173,11 +325,19 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         return;
     }
 
-    const SINT tempReadBufferSize = m_pAudioSource->frames2samples(CachingReaderChunk::kFrames);
-    if (m_tempReadBuffer.size() != tempReadBufferSize) {
-        mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
+    m_trackKey = CachingReaderChunkCache::trackKey(
+            filename, pTrack->getFileSize(), pTrack->getFileModifiedTime());
+    if (m_pDiskCache) {
+        m_pDiskCacheFile = m_pDiskCache->openFile(m_trackKey,
+                m_pAudioSource->frameIndexRange(), m_pAudioSource->sampleRate());
     }
 
+    // Changes of the preference take effect when the next track is loaded
+    const int parallelism = m_pConfig ? m_pConfig->getValue(
+            ConfigKey(kConfigGroup, "parallel_chunk_decoders"),
+            CachingReaderDecoders::kDefaultParallelism) : 1;
+    m_decoders.open(m_pAudioSource, pTrack, config, parallelism);
+
     // Initially assume that the complete content offered by audio source
     // is available for reading. Later if read errors occur this value will
     // be decreased to avoid repeated reading of corrupt audio data.
@@ -189,13 +349,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     m_pReaderStatusFIFO->writeBlocking(&status, 1);
 
     // Clear the chunks to read list.
-    CachingReaderChunkReadRequest request;
-    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-        kLogger.debug() << "Cancelling read request for " << request.chunk->getIndex();
-        status.status = CHUNK_READ_INVALID;
-        status.chunk = request.chunk;
-        m_pReaderStatusFIFO->writeBlocking(&status, 1);
-    }
+    cancelAllReadRequests();
 
     // Emit that the track is loaded.
     const SINT sampleCount =
@@ -6,22 +6,53 @@
 #include <QSemaphore>
 #include <QThread>
 #include <QString>
+#include <QVector>
 
 #include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderdecoders.h"
+#include "engine/cachingreaderdiskcache.h"
+#include "preferences/usersettings.h"
 #include "track/track.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
+#include "util/compatibility.h"
 #include "util/fifo.h"
 
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // The Hint::priority of the hint that requested the chunk
+    int priority;
+    // The seek generation of the worker when the chunk was requested
+    int seekGeneration;
+    // If the request is cancelled when the seek generation changes
+    bool cancelAfterSeek;
+    // Does not pass the chunk to the worker but updates priority,
+    // seekGeneration and cancelAfterSeek of a pending request for the
+    // chunk. Ignored if the chunk has already been read.
+    bool reprioritize;
+
+    void giveToWorker(CachingReaderChunkForOwner* chunkForOwner,
+            int priorityArg, int seekGenerationArg, bool cancelAfterSeekArg) {
+        DEBUG_ASSERT(chunkForOwner);
+        chunk = chunkForOwner;
+        priority = priorityArg;
+        seekGeneration = seekGenerationArg;
+        cancelAfterSeek = cancelAfterSeekArg;
+        reprioritize = false;
+        chunkForOwner->giveToWorker(priority, seekGeneration);
+    }
 
-    void giveToWorker(CachingReaderChunkForOwner* chunkForOwner) {
+    void reprioritizeInWorker(CachingReaderChunkForOwner* chunkForOwner,
+            int priorityArg, int seekGenerationArg, bool cancelAfterSeekArg) {
         DEBUG_ASSERT(chunkForOwner);
+        DEBUG_ASSERT(chunkForOwner->getState() == CachingReaderChunkForOwner::READ_PENDING);
         chunk = chunkForOwner;
-        chunkForOwner->giveToWorker();
+        priority = priorityArg;
+        seekGeneration = seekGenerationArg;
+        cancelAfterSeek = cancelAfterSeekArg;
+        reprioritize = true;
     }
 } CachingReaderChunkReadRequest;
 
@@ -64,6 +95,7 @@ class CachingReaderWorker : public EngineWorker {
   public:
     // Construct a CachingReader with the given group.
     CachingReaderWorker(QString group,
+            UserSettingsPointer pConfig,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
     virtual ~CachingReaderWorker();
@@ -71,6 +103,16 @@ class CachingReaderWorker : public EngineWorker {
     // Request to load a new track. wake() must be called afterwards.
     virtual void newTrack(TrackPointer pTrack);
 
+    // The seek generation is incremented by the engine on every seek.
+    // Pending requests from a previous generation that may be cancelled are
+    // returned as CHUNK_READ_INVALID without reading them.
+    int seekGeneration() const {
+        return load_atomic(m_seekGeneration);
+    }
+    void notifySeek() {
+        m_seekGeneration.fetchAndAddRelease(1);
+    }
+
     // Run upkeep operations like loading tracks and reading from file. Run by a
     // thread pool via the EngineWorkerScheduler.
     virtual void run();
@@ -101,15 +143,56 @@ class CachingReaderWorker : public EngineWorker {
     // Internal method to load a track. Emits trackLoaded when finished.
     void loadTrack(const TrackPointer& pTrack);
 
-    ReaderStatusUpdate processReadRequest(
-            const CachingReaderChunkReadRequest& request);
+    // Reads the chunk of the request together with as many of the
+    // following requests as there are decoders and sends the results
+    void processReadRequests(
+            const CachingReaderChunkReadRequest& firstRequest);
+
+    // Adjusts the readable frames if the chunk could not be read completely
+    ReaderStatusUpdate processReadResult(
+            CachingReaderChunk* pChunk,
+            const mixxx::IndexRange& bufferedFrameIndexRange);
+
+    // Moves all requests from the FIFO to the pending requests
+    void fetchReadRequests();
+
+    // Fetches new requests, cancels the stale ones and takes the one that
+    // should be read next. Returns false if there are no pending requests.
+    bool takeNextReadRequest(CachingReaderChunkReadRequest* pRequest);
+
+    // Returns all pending requests as CHUNK_READ_INVALID
+    void cancelAllReadRequests();
+    void cancelReadRequest(const CachingReaderChunkReadRequest& request);
+
+    // Requests that have been taken from the FIFO but not been read yet.
+    // Only accessed by the worker thread.
+    QVector<CachingReaderChunkReadRequest> m_pendingReadRequests;
+
+    QAtomicInt m_seekGeneration;
+
+    // The requests that are read at once by processReadRequests(),
+    // only reused to avoid allocations
+    QVector<CachingReaderChunkReadRequest> m_batchRequests;
+    QVector<CachingReaderChunk*> m_batchChunks;
+    QVector<mixxx::IndexRange> m_batchBufferedFrameIndexRanges;
+
+    UserSettingsPointer m_pConfig;
 
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
-    // Temporary buffer for reading samples from all channels
-    // before conversion to a stereo signal.
-    mixxx::SampleBuffer m_tempReadBuffer;
+    // Reads chunks with m_pAudioSource and the additional decoders
+    // that have been opened for the track loaded
+    CachingReaderDecoders m_decoders;
+
+    // Decoded chunks shared with the workers of other readers and the
+    // key of the track loaded in the cache
+    std::shared_ptr<CachingReaderChunkCache> m_pChunkCache;
+    QString m_trackKey;
+
+    // The optional disk cache and the cache file of the track loaded
+    std::unique_ptr<CachingReaderDiskCache> m_pDiskCache;
+    std::unique_ptr<CachingReaderDiskCacheFile> m_pDiskCacheFile;
 
     // The maximum readable frame index of the AudioSource. Might
     // be adjusted when decoding errors occur to prevent reading
@@ -0,0 +1,219 @@
+#include "engine/callbacklatencystats.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include "control/controlobject.h"
+#include "control/controlpushbutton.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CallbackLatencyStats");
+
+const char* kGroup = "[AudioCallback]";
+
+const int kPublishIntervalMillis = 500;
+
+} // anonymous namespace
+
+CallbackLatencyStats::CallbackLatencyStats(UserSettingsPointer pConfig,
+                                           QObject* pParent)
+        : QObject(pParent),
+          m_pConfig(pConfig),
+          m_resetRequested(false) {
+    for (int i = 0; i < kNumStages; ++i) {
+        m_deadlineMisses[i].store(0, std::memory_order_relaxed);
+        const QString name = stageName(static_cast<Stage>(i));
+        StageControls& controls = m_stageControls[i];
+        controls.pP50 = std::make_unique<ControlObject>(
+                ConfigKey(kGroup, name + "_p50"));
+        controls.pP99 = std::make_unique<ControlObject>(
+                ConfigKey(kGroup, name + "_p99"));
+        controls.pMax = std::make_unique<ControlObject>(
+                ConfigKey(kGroup, name + "_max"));
+        controls.pDeadlineMisses = std::make_unique<ControlObject>(
+                ConfigKey(kGroup, name + "_deadline_misses"));
+        controls.pP50->setReadOnly();
+        controls.pP99->setReadOnly();
+        controls.pMax->setReadOnly();
+        controls.pDeadlineMisses->setReadOnly();
+    }
+    m_pCallbackCount = std::make_unique<ControlObject>(
+            ConfigKey(kGroup, "callback_count"));
+    m_pCallbackCount->setReadOnly();
+
+    m_pReset = std::make_unique<ControlPushButton>(ConfigKey(kGroup, "reset"));
+    connect(m_pReset.get(), SIGNAL(valueChanged(double)),
+            this, SLOT(slotReset(double)));
+    m_pDump = std::make_unique<ControlPushButton>(ConfigKey(kGroup, "dump"));
+    connect(m_pDump.get(), SIGNAL(valueChanged(double)),
+            this, SLOT(slotDump(double)));
+
+    connect(&m_publishTimer, SIGNAL(timeout()),
+            this, SLOT(slotPublish()));
+    m_publishTimer.start(kPublishIntervalMillis);
+}
+
+CallbackLatencyStats::~CallbackLatencyStats() {
+}
+
+// static
+QString CallbackLatencyStats::stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Channels:
+        return "channels";
+    case Stage::Effects:
+        return "effects";
+    case Stage::Mixing:
+        return "mixing";
+    case Stage::Sidechain:
+        return "sidechain";
+    case Stage::SoundIo:
+        return "sound_io";
+    case Stage::Callback:
+        return "callback";
+    }
+    return QString();
+}
+
+void CallbackLatencyStats::beginCallback() {
+    if (m_resetRequested.exchange(false)) {
+        for (int i = 0; i < kNumStages; ++i) {
+            m_histograms[i].reset();
+            m_deadlineMisses[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    for (int i = 0; i < kNumStages; ++i) {
+        m_stageTimes[i] = mixxx::Duration::empty();
+    }
+    m_callbackTimer.start();
+}
+
+void CallbackLatencyStats::endCallback(mixxx::Duration deadline) {
+    const mixxx::Duration callbackTime = m_callbackTimer.elapsed();
+    m_stageTimes[static_cast<int>(Stage::Callback)] = callbackTime;
+
+    // Mixing is not timed on its own but is what the other stages leave
+    mixxx::Duration mixingTime = callbackTime;
+    for (int i = 0; i < kNumStages; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        if (stage != Stage::Mixing && stage != Stage::Callback) {
+            mixingTime -= m_stageTimes[i];
+        }
+    }
+    m_stageTimes[static_cast<int>(Stage::Mixing)] =
+            mixingTime > mixxx::Duration::empty() ?
+            mixingTime : mixxx::Duration::empty();
+
+    for (int i = 0; i < kNumStages; ++i) {
+        m_histograms[i].record(m_stageTimes[i]);
+    }
+
+    if (callbackTime > deadline) {
+        std::atomic<quint32>& misses =
+                m_deadlineMisses[static_cast<int>(Stage::Callback)];
+        misses.store(misses.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        blameDeadlineMiss();
+    }
+}
+
+void CallbackLatencyStats::blameDeadlineMiss() {
+    // Misses are rare, so the cost of estimating the medians here does not
+    // matter.
+    int blamedStage = -1;
+    mixxx::Duration maxExcess;
+    for (int i = 0; i < kNumStages; ++i) {
+        if (static_cast<Stage>(i) == Stage::Callback) {
+            continue;
+        }
+        const mixxx::Duration median = m_histograms[i].percentile(50);
+        const mixxx::Duration excess = m_stageTimes[i] - median;
+        if (blamedStage < 0 || excess > maxExcess) {
+            blamedStage = i;
+            maxExcess = excess;
+        }
+    }
+    std::atomic<quint32>& misses = m_deadlineMisses[blamedStage];
+    misses.store(misses.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+}
+
+void CallbackLatencyStats::requestReset() {
+    m_resetRequested.store(true);
+}
+
+void CallbackLatencyStats::slotPublish() {
+    for (int i = 0; i < kNumStages; ++i) {
+        const LatencyHistogram& histogram = m_histograms[i];
+        StageControls& controls = m_stageControls[i];
+        controls.pP50->forceSet(histogram.percentile(50).toDoubleMillis());
+        controls.pP99->forceSet(histogram.percentile(99).toDoubleMillis());
+        controls.pMax->forceSet(histogram.max().toDoubleMillis());
+        controls.pDeadlineMisses->forceSet(
+                m_deadlineMisses[i].load(std::memory_order_relaxed));
+    }
+    m_pCallbackCount->forceSet(
+            m_histograms[static_cast<int>(Stage::Callback)].count());
+}
+
+void CallbackLatencyStats::slotReset(double value) {
+    if (value > 0) {
+        requestReset();
+    }
+}
+
+void CallbackLatencyStats::slotDump(double value) {
+    if (value <= 0) {
+        return;
+    }
+    const QString fileName = QString("callback_latency_%1.txt").arg(
+            QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    const QString filePath =
+            QDir(m_pConfig->getSettingsPath()).filePath(fileName);
+    if (dumpToFile(filePath)) {
+        kLogger.info() << "Wrote callback latency statistics to" << filePath;
+    }
+}
+
+bool CallbackLatencyStats::dumpToFile(const QString& filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        kLogger.warning() << "Failed to open" << filePath << "for writing";
+        return false;
+    }
+    QTextStream out(&file);
+    out << "# Audio callback latency in milliseconds\n";
+    out << "stage\tcount\tp50\tp90\tp99\tp99.9\tmax\tdeadline_misses\n";
+    for (int i = 0; i < kNumStages; ++i) {
+        const LatencyHistogram& histogram = m_histograms[i];
+        out << stageName(static_cast<Stage>(i))
+            << '\t' << histogram.count()
+            << '\t' << histogram.percentile(50).toDoubleMillis()
+            << '\t' << histogram.percentile(90).toDoubleMillis()
+            << '\t' << histogram.percentile(99).toDoubleMillis()
+            << '\t' << histogram.percentile(99.9).toDoubleMillis()
+            << '\t' << histogram.max().toDoubleMillis()
+            << '\t' << m_deadlineMisses[i].load(std::memory_order_relaxed)
+            << '\n';
+    }
+    out << "\n# Histograms: number of durations per bucket, by the end of the\n"
+           "# bucket in microseconds\n";
+    out << "stage\tupper_bound_us\tcount\n";
+    for (int i = 0; i < kNumStages; ++i) {
+        const LatencyHistogram& histogram = m_histograms[i];
+        for (int bucket = 0; bucket < LatencyHistogram::kNumBuckets; ++bucket) {
+            const quint32 count = histogram.bucketCount(bucket);
+            if (count == 0) {
+                continue;
+            }
+            out << stageName(static_cast<Stage>(i))
+                << '\t' << LatencyHistogram::bucketUpperBoundMicros(bucket)
+                << '\t' << count << '\n';
+        }
+    }
+    return true;
+}
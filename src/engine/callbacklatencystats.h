@@ -0,0 +1,140 @@
+#ifndef CALLBACKLATENCYSTATS_H
+#define CALLBACKLATENCYSTATS_H
+
+#include <atomic>
+#include <memory>
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "preferences/usersettings.h"
+#include "util/duration.h"
+#include "util/latencyhistogram.h"
+#include "util/performancetimer.h"
+
+class ControlObject;
+class ControlPushButton;
+
+// Records how long each stage of the audio callback takes, unlike
+// ScopedTimer also outside of developer mode and without locking or
+// allocating in the callback. The clock reference sound device brackets each
+// callback with beginCallback() and endCallback(), the stages in between are
+// timed with ScopedStage.
+//
+// The distribution of every stage is published as read-only controls in the
+// [AudioCallback] group twice a second, all durations in milliseconds:
+//   <stage>_p50, <stage>_p99, <stage>_max   Percentiles and the maximum
+//   <stage>_deadline_misses                  See below
+//   callback_count                           Number of recorded callbacks
+// with the stages callback (all of it), channels, effects, mixing,
+// sidechain and sound_io. "reset" clears all statistics and "dump" writes
+// them to a file in the settings directory.
+//
+// A callback misses its deadline when it takes longer than the audio buffer.
+// callback_deadline_misses counts all of these and each miss is also blamed
+// on the stage that exceeded its median by the most in that callback, so an
+// xrun can be traced back to the stage that caused it.
+class CallbackLatencyStats : public QObject {
+    Q_OBJECT
+  public:
+    enum class Stage {
+        // The deck, sampler, microphone and auxiliary channels including their
+        // pre-fader effects
+        Channels,
+        // Post-fader effects of the channels, buses and the master
+        Effects,
+        // Everything else done by the engine: mixing, gains, delays, meters
+        Mixing,
+        // Passing the record/broadcast mix to the sidechain
+        Sidechain,
+        // Exchanging buffers with the sound devices
+        SoundIo,
+        // The whole callback
+        Callback,
+    };
+    static const int kNumStages = static_cast<int>(Stage::Callback) + 1;
+
+    // Times a stage of the current callback in the callback thread. The time
+    // is added up if a stage is entered several times. pStats may be null.
+    class ScopedStage {
+      public:
+        ScopedStage(CallbackLatencyStats* pStats, Stage stage)
+                : m_pStats(pStats),
+                  m_stage(stage) {
+            if (m_pStats) {
+                m_timer.start();
+            }
+        }
+        ~ScopedStage() {
+            if (m_pStats) {
+                m_pStats->addStageTime(m_stage, m_timer.elapsed());
+            }
+        }
+
+      private:
+        CallbackLatencyStats* m_pStats;
+        const Stage m_stage;
+        PerformanceTimer m_timer;
+    };
+
+    CallbackLatencyStats(UserSettingsPointer pConfig, QObject* pParent = nullptr);
+    ~CallbackLatencyStats() override;
+
+    // Callback thread only
+    void beginCallback();
+    void addStageTime(Stage stage, mixxx::Duration duration) {
+        m_stageTimes[static_cast<int>(stage)] += duration;
+    }
+    // deadline is the duration of the audio buffer
+    void endCallback(mixxx::Duration deadline);
+
+    // Any thread
+    const LatencyHistogram& histogram(Stage stage) const {
+        return m_histograms[static_cast<int>(stage)];
+    }
+    quint32 deadlineMisses(Stage stage) const {
+        return m_deadlineMisses[static_cast<int>(stage)].load(
+                std::memory_order_relaxed);
+    }
+    // The statistics are cleared at the start of the next callback
+    void requestReset();
+    bool dumpToFile(const QString& filePath) const;
+
+    static QString stageName(Stage stage);
+
+  public slots:
+    void slotPublish();
+
+  private slots:
+    void slotReset(double value);
+    void slotDump(double value);
+
+  private:
+    struct StageControls {
+        std::unique_ptr<ControlObject> pP50;
+        std::unique_ptr<ControlObject> pP99;
+        std::unique_ptr<ControlObject> pMax;
+        std::unique_ptr<ControlObject> pDeadlineMisses;
+    };
+
+    void blameDeadlineMiss();
+
+    UserSettingsPointer m_pConfig;
+
+    // Callback thread
+    PerformanceTimer m_callbackTimer;
+    mixxx::Duration m_stageTimes[kNumStages];
+
+    LatencyHistogram m_histograms[kNumStages];
+    std::atomic<quint32> m_deadlineMisses[kNumStages];
+    std::atomic<bool> m_resetRequested;
+
+    StageControls m_stageControls[kNumStages];
+    std::unique_ptr<ControlObject> m_pCallbackCount;
+    std::unique_ptr<ControlPushButton> m_pReset;
+    std::unique_ptr<ControlPushButton> m_pDump;
+    QTimer m_publishTimer;
+};
+
+#endif // CALLBACKLATENCYSTATS_H
@@ -183,6 +183,23 @@ class ChannelHandleMap {
         return m_data[iHandle];
     }
 
+    // Returns a pointer to the value for handle or a null pointer if the map
+    // has not been expanded to handle yet. Unlike operator[], it never
+    // modifies the map, so different threads may call it concurrently.
+    T* find(const ChannelHandle& handle) {
+        if (!handle.valid() || handle.handle() >= m_data.size()) {
+            return nullptr;
+        }
+        return &m_data[handle.handle()];
+    }
+
+    const T* find(const ChannelHandle& handle) const {
+        if (!handle.valid() || handle.handle() >= m_data.size()) {
+            return nullptr;
+        }
+        return &m_data[handle.handle()];
+    }
+
     void clear() {
         m_data.clear();
     }
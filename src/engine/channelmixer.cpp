@@ -0,0 +1,222 @@
+#include "engine/channelmixer.h"
+
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/samplekernels.h"
+#include "util/timer.h"
+
+namespace {
+
+using mixxx::RampingGainSource;
+using mixxx::SampleKernels;
+
+// The channels are mixed in blocks of this many stereo frames. A block of the
+// output and the blocks of all channels that are mixed into it in one pass
+// take (1 + SampleKernels::kMaxMixSources) * 2 KiB and stay in the L1 data
+// cache until the block is done.
+const SINT kMixBlockFrames = 256;
+
+typedef QVarLengthArray<RampingGainSource, kPreallocatedChannels> MixSources;
+
+// The same gain ramp as SampleUtil::applyRampingGain()
+RampingGainSource makeMixSource(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN oldGain, CSAMPLE_GAIN newGain,
+        unsigned int iBufferSize) {
+    RampingGainSource source;
+    source.pBuffer = pBuffer;
+    const CSAMPLE_GAIN gainDelta = (newGain - oldGain)
+            / CSAMPLE_GAIN(iBufferSize / 2);
+    if (gainDelta) {
+        source.startGain = oldGain + gainDelta;
+        source.gainDelta = gainDelta;
+    } else {
+        source.startGain = oldGain;
+        source.gainDelta = CSAMPLE_GAIN_ZERO;
+    }
+    return source;
+}
+
+RampingGainSource makeUnityMixSource(CSAMPLE* pBuffer) {
+    RampingGainSource source;
+    source.pBuffer = pBuffer;
+    source.startGain = CSAMPLE_GAIN_ONE;
+    source.gainDelta = CSAMPLE_GAIN_ZERO;
+    return source;
+}
+
+// Replaces pOutput with the faded sum of all sources. Up to
+// SampleKernels::kMaxMixSources sources are mixed in a single pass over
+// each block with a kernel that is specialized for their number. Larger
+// mixes are split into groups that are accumulated one after another. The
+// sources are added up in order either way, so the grouping does not
+// change the result.
+void mixSources(CSAMPLE* pOutput, const MixSources& sources,
+        unsigned int iBufferSize, bool applyGainToSources) {
+    const int numSources = sources.size();
+    if (numSources == 0) {
+        SampleUtil::clear(pOutput, iBufferSize);
+        return;
+    }
+    const SampleKernels& kernels = SampleKernels::active();
+    const SampleKernels::MixWithRampingGainsFunction* mixFunctions =
+            applyGainToSources ?
+            kernels.applyAndMixWithRampingGains :
+            kernels.mixWithRampingGains;
+    const int maxGroupSize = SampleKernels::kMaxMixSources;
+    const SINT numFrames = iBufferSize / 2;
+    for (SINT firstFrame = 0; firstFrame < numFrames;
+            firstFrame += kMixBlockFrames) {
+        const SINT endFrame = math_min(firstFrame + kMixBlockFrames, numFrames);
+        for (int firstSource = 0; firstSource < numSources;
+                firstSource += maxGroupSize) {
+            const int groupSize = math_min(maxGroupSize,
+                    numSources - firstSource);
+            mixFunctions[groupSize - 1](pOutput, firstSource > 0,
+                    sources.constData() + firstSource,
+                    firstFrame, endFrame);
+        }
+    }
+}
+
+struct ChannelGains {
+    CSAMPLE_GAIN oldGain;
+    CSAMPLE_GAIN newGain;
+};
+
+ChannelGains updateChannelGains(
+        const EngineMaster::GainCalculator& gainCalculator,
+        EngineMaster::ChannelInfo* pChannelInfo,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache) {
+    EngineMaster::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
+    ChannelGains gains;
+    gains.oldGain = gainCache.m_gain;
+    if (gainCache.m_fadeout) {
+        gains.newGain = 0;
+        gainCache.m_fadeout = false;
+    } else {
+        gains.newGain = gainCalculator.getGain(pChannelInfo);
+    }
+    gainCache.m_gain = gains.newGain;
+    return gains;
+}
+
+} // anonymous namespace
+
+// static
+void ChannelMixer::applyEffectsAndMixChannels(const EngineMaster::GainCalculator& gainCalculator,
+                                              QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+                                              QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+                                              CSAMPLE* pOutput,
+                                              const ChannelHandle& outputHandle,
+                                              unsigned int iBufferSize,
+                                              unsigned int iSampleRate,
+                                              EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. Mix the channels without post-fader effects into pOutput in a single
+    //    pass, applying their gain ramps on the fly
+    // 3. Pass each remaining channel's calculated gain and input buffer to
+    //    pEngineEffectsManager, which then:
+    //     A) Copies the channel input buffer to a temporary buffer
+    //     B) Applies gain to the temporary buffer
+    //     C) Processes effects on the temporary buffer
+    //     D) Mixes the temporary buffer into pOutput
+    // The original channel input buffers are not modified.
+    ScopedTimer t("EngineMaster::applyEffectsAndMixChannels_%1active",
+            activeChannels->size());
+    MixSources sources;
+    QVarLengthArray<int, kPreallocatedChannels> effectedChannels;
+    QVarLengthArray<ChannelGains, kPreallocatedChannels> effectedChannelGains;
+    for (int i = 0; i < activeChannels->size(); ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        const ChannelGains gains = updateChannelGains(
+                gainCalculator, pChannelInfo, channelGainCache);
+        if (pEngineEffectsManager->isProcessingPostFader(
+                pChannelInfo->m_handle, outputHandle)) {
+            effectedChannels.append(i);
+            effectedChannelGains.append(gains);
+        } else {
+            // No effect touches the buffer, so this only keeps the state of
+            // the effect chains for this channel up to date.
+            pEngineEffectsManager->processPostFaderInPlace(
+                    pChannelInfo->m_handle, outputHandle,
+                    pChannelInfo->m_pBuffer, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features);
+            sources.append(makeMixSource(pChannelInfo->m_pBuffer,
+                    gains.oldGain, gains.newGain, iBufferSize));
+        }
+    }
+
+    mixSources(pOutput, sources, iBufferSize, false);
+
+    for (int i = 0; i < effectedChannels.size(); ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo =
+                activeChannels->at(effectedChannels[i]);
+        const ChannelGains& gains = effectedChannelGains[i];
+        pEngineEffectsManager->processPostFaderAndMix(
+                pChannelInfo->m_handle, outputHandle,
+                pChannelInfo->m_pBuffer, pOutput,
+                iBufferSize, iSampleRate, pChannelInfo->m_features,
+                gains.oldGain, gains.newGain);
+    }
+}
+
+// static
+void ChannelMixer::applyEffectsInPlaceAndMixChannels(const EngineMaster::GainCalculator& gainCalculator,
+                                                     QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+                                                     QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+                                                     CSAMPLE* pOutput,
+                                                     const ChannelHandle& outputHandle,
+                                                     unsigned int iBufferSize,
+                                                     unsigned int iSampleRate,
+                                                     EngineEffectsManager* pEngineEffectsManager,
+                                                     EngineThreadPool* pThreadPool) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. Pass the calculated gain and input buffer of each channel with
+    //    post-fader effects to pEngineEffectsManager, which then, possibly
+    //    for several channels at once on pThreadPool:
+    //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
+    //    B) Applies effects to the buffer, modifying the original input buffer
+    // 3. Mix the channel buffers together to make pOutput, overwriting the pOutput
+    //    buffer from the last engine callback. The gain of the channels without
+    //    effects is applied to their buffers in the same pass.
+    ScopedTimer t("EngineMaster::applyEffectsInPlaceAndMixChannels_%1active",
+            activeChannels->size());
+    MixSources sources;
+    QVarLengthArray<EngineEffectsManager::PostFaderChannel, kPreallocatedChannels>
+            effectedChannels;
+    for (int i = 0; i < activeChannels->size(); ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        const ChannelGains gains = updateChannelGains(
+                gainCalculator, pChannelInfo, channelGainCache);
+        CSAMPLE* pBuffer = pChannelInfo->m_pBuffer;
+        if (pEngineEffectsManager->isProcessingPostFader(
+                pChannelInfo->m_handle, outputHandle)) {
+            // Processed below, before the buffer is mixed
+            EngineEffectsManager::PostFaderChannel channel;
+            channel.inputHandle = pChannelInfo->m_handle;
+            channel.pInOut = pBuffer;
+            channel.pGroupFeatures = &pChannelInfo->m_features;
+            channel.oldGain = gains.oldGain;
+            channel.newGain = gains.newGain;
+            effectedChannels.append(channel);
+            sources.append(makeUnityMixSource(pBuffer));
+        } else {
+            // No effect touches the buffer, so this only keeps the state of
+            // the effect chains for this channel up to date.
+            pEngineEffectsManager->processPostFaderInPlace(
+                    pChannelInfo->m_handle, outputHandle,
+                    pBuffer, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features);
+            sources.append(makeMixSource(pBuffer,
+                    gains.oldGain, gains.newGain, iBufferSize));
+        }
+    }
+
+    pEngineEffectsManager->processPostFaderInPlaceConcurrently(pThreadPool,
+            outputHandle, effectedChannels.constData(), effectedChannels.size(),
+            iBufferSize, iSampleRate);
+
+    mixSources(pOutput, sources, iBufferSize, true);
+}
@@ -21,6 +21,8 @@ class ChannelMixer {
         unsigned int iSampleRate,
         EngineEffectsManager* pEngineEffectsManager);
     // This does modify the input channel buffers, then mixes them to make the output buffer.
+    // If pThreadPool is not null, the effects of different channels may be
+    // processed concurrently on it.
     static void applyEffectsInPlaceAndMixChannels(
         const EngineMaster::GainCalculator& gainCalculator,
         QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
@@ -28,7 +30,8 @@ class ChannelMixer {
         CSAMPLE* pOutput, const ChannelHandle& outputHandle,
         unsigned int iBufferSize,
         unsigned int iSampleRate,
-        EngineEffectsManager* pEngineEffectsManager);
+        EngineEffectsManager* pEngineEffectsManager,
+        EngineThreadPool* pThreadPool = nullptr);
 };
 
 #endif /* CHANNELMIXER_H */
@@ -0,0 +1,238 @@
+#include "engine/controlsnapshot.h"
+
+#ifndef __WINDOWS__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "engine/mixxx_control_snapshot.h"
+#endif
+
+#include <QStringList>
+
+#include "control/control.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ControlSnapshot");
+
+const char* kConfigGroup = "[ControlSnapshot]";
+
+// Decks that are added after the engine has been created are looked up
+// again at this interval until all controls exist
+const int kResolveIntervalMillis = 1000;
+
+const int kDefaultDecks = 4;
+
+} // anonymous namespace
+
+// static
+bool ControlSnapshot::isEnabled(UserSettingsPointer pConfig) {
+    return pConfig->getValue(ConfigKey(kConfigGroup, "enabled"), false);
+}
+
+// static
+QList<ConfigKey> ControlSnapshot::defaultControls() {
+    QList<ConfigKey> keys;
+    for (int i = 1; i <= kDefaultDecks; ++i) {
+        const QString group = QString("[Channel%1]").arg(i);
+        keys.append(ConfigKey(group, "playposition"));
+        keys.append(ConfigKey(group, "bpm"));
+        keys.append(ConfigKey(group, "beat_distance"));
+        keys.append(ConfigKey(group, "VuMeter"));
+    }
+    keys.append(ConfigKey("[Master]", "VuMeterL"));
+    keys.append(ConfigKey("[Master]", "VuMeterR"));
+    return keys;
+}
+
+ControlSnapshot::ControlSnapshot(UserSettingsPointer pConfig, QObject* pParent)
+        : QObject(pParent),
+          m_pSnapshot(nullptr),
+          m_fd(-1),
+          m_sequence(0) {
+#ifndef __WINDOWS__
+    m_name = pConfig->getValue(ConfigKey(kConfigGroup, "name"),
+            MIXXX_CONTROL_SNAPSHOT_NAME);
+    const QString controls = pConfig->getValueString(
+            ConfigKey(kConfigGroup, "controls"));
+    if (controls.trimmed().isEmpty()) {
+        m_keys = defaultControls();
+    } else {
+        for (const QString& control : controls.split(';', QString::SkipEmptyParts)) {
+            const ConfigKey key = ConfigKey::parseCommaSeparated(control.trimmed());
+            if (!control.contains(',') || key.group.isEmpty() || key.item.isEmpty() ||
+                    key.group.toUtf8().size() >= MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH ||
+                    key.item.toUtf8().size() >= MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH) {
+                kLogger.warning() << "Ignoring invalid control" << control;
+                continue;
+            }
+            if (m_keys.size() == MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS) {
+                kLogger.warning() << "Only the first"
+                                  << MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS
+                                  << "controls are published";
+                break;
+            }
+            m_keys.append(key);
+        }
+    }
+
+    m_controls.resize(m_keys.size());
+    m_pEngineControls.reset(new std::atomic<ControlDoublePrivate*>[m_keys.size()]());
+    if (!open()) {
+        return;
+    }
+
+    slotResolveControls();
+    connect(&m_resolveTimer, SIGNAL(timeout()),
+            this, SLOT(slotResolveControls()));
+    m_resolveTimer.start(kResolveIntervalMillis);
+#else
+    Q_UNUSED(pConfig);
+    kLogger.warning() << "The control snapshot is not supported on Windows";
+#endif
+}
+
+ControlSnapshot::~ControlSnapshot() {
+    close();
+}
+
+bool ControlSnapshot::open() {
+#ifndef __WINDOWS__
+    const QByteArray name = m_name.toLocal8Bit();
+    // An existing object is never reused, because it might belong to
+    // another user or have other permissions, which only apply when an
+    // object is created. Unlinking it leaves the object of a crashed
+    // instance or of another running instance to its current readers.
+    // If it cannot be unlinked, e.g. because it belongs to another user,
+    // creating ours fails.
+    if (shm_unlink(name.constData()) == 0) {
+        kLogger.info() << "Replaced the existing shared memory object" << m_name;
+    }
+    // Only the user who runs Mixxx can read it
+    m_fd = shm_open(name.constData(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (m_fd < 0) {
+        kLogger.warning() << "Could not create the shared memory object"
+                          << m_name << ":" << strerror(errno);
+        return false;
+    }
+    if (ftruncate(m_fd, sizeof(mixxx_control_snapshot)) != 0) {
+        kLogger.warning() << "Could not resize the shared memory object"
+                          << m_name << ":" << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        shm_unlink(name.constData());
+        return false;
+    }
+    void* pMemory = mmap(nullptr, sizeof(mixxx_control_snapshot),
+            PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (pMemory == MAP_FAILED) {
+        kLogger.warning() << "Could not map the shared memory object"
+                          << m_name << ":" << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        shm_unlink(name.constData());
+        return false;
+    }
+
+    // The object is new and therefore zeroed
+    mixxx_control_snapshot* pSnapshot = static_cast<mixxx_control_snapshot*>(pMemory);
+    pSnapshot->version = MIXXX_CONTROL_SNAPSHOT_VERSION;
+    pSnapshot->control_count = m_keys.size();
+    for (int i = 0; i < m_keys.size(); ++i) {
+        // The lengths have been checked when parsing the configuration, so
+        // the strings stay terminated by the zeroed memory
+        const QByteArray group = m_keys[i].group.toUtf8();
+        const QByteArray item = m_keys[i].item.toUtf8();
+        memcpy(pSnapshot->keys[i].group, group.constData(), group.size());
+        memcpy(pSnapshot->keys[i].item, item.constData(), item.size());
+    }
+    __atomic_store_n(&pSnapshot->magic, MIXXX_CONTROL_SNAPSHOT_MAGIC,
+            __ATOMIC_RELEASE);
+    m_pSnapshot = pSnapshot;
+    kLogger.info() << "Publishing" << m_keys.size()
+                   << "controls in the shared memory object" << m_name;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ControlSnapshot::close() {
+#ifndef __WINDOWS__
+    if (m_pSnapshot == nullptr) {
+        return;
+    }
+    // Tell the readers that they have to open the snapshot again
+    __atomic_store_n(&m_pSnapshot->magic, 0, __ATOMIC_RELEASE);
+    munmap(m_pSnapshot, sizeof(mixxx_control_snapshot));
+    m_pSnapshot = nullptr;
+    // Another instance may have replaced our object in the meantime
+    const QByteArray name = m_name.toLocal8Bit();
+    const int fd = shm_open(name.constData(), O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat ours;
+        struct stat current;
+        if (fstat(m_fd, &ours) == 0 && fstat(fd, &current) == 0 &&
+                ours.st_dev == current.st_dev && ours.st_ino == current.st_ino) {
+            shm_unlink(name.constData());
+        }
+        ::close(fd);
+    }
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+void ControlSnapshot::slotResolveControls() {
+    bool complete = true;
+    for (int i = 0; i < m_keys.size(); ++i) {
+        if (m_controls[i]) {
+            continue;
+        }
+        m_controls[i] = ControlDoublePrivate::getControl(m_keys[i], false);
+        if (m_controls[i]) {
+            m_pEngineControls[i].store(m_controls[i].data());
+        } else {
+            complete = false;
+        }
+    }
+    if (complete) {
+        m_resolveTimer.stop();
+    }
+}
+
+void ControlSnapshot::publish() {
+#ifndef __WINDOWS__
+    if (m_pSnapshot == nullptr) {
+        return;
+    }
+    // Read everything before the sequence becomes odd, so that readers
+    // retry as briefly as possible
+    double values[MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS];
+    const int count = m_keys.size();
+    for (int i = 0; i < count; ++i) {
+        ControlDoublePrivate* pControl = m_pEngineControls[i].load();
+        values[i] = pControl ? pControl->get() : 0.0;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t timeNanos = static_cast<uint64_t>(now.tv_sec) * 1000000000ull
+            + now.tv_nsec;
+
+    // The sequence lock of the writer: odd while the values change
+    __atomic_store_n(&m_pSnapshot->sequence, m_sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (int i = 0; i < count; ++i) {
+        __atomic_store(&m_pSnapshot->values[i], &values[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&m_pSnapshot->time_ns, timeNanos, __ATOMIC_RELAXED);
+    m_sequence += 2;
+    __atomic_store_n(&m_pSnapshot->sequence, m_sequence, __ATOMIC_RELEASE);
+#endif
+}
@@ -0,0 +1,87 @@
+#ifndef CONTROLSNAPSHOT_H
+#define CONTROLSNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include "preferences/usersettings.h"
+#include "util/class.h"
+
+class ControlDoublePrivate;
+// See engine/mixxx_control_snapshot.h, which needs GCC or Clang
+struct mixxx_control_snapshot;
+
+// Publishes the values of a configurable set of controls in a POSIX shared
+// memory object after every audio callback. Local tools like lighting
+// controllers or visualizers can map it and read the state of the decks
+// without a controller mapping or a script. The layout and a reader are
+// defined in the C header engine/mixxx_control_snapshot.h. The values are
+// protected by a sequence lock, so the engine never waits for a reader.
+//
+// Configured in the [ControlSnapshot] group of mixxx.cfg:
+//   enabled    1 to publish the snapshot, off by default
+//   name       The name of the shared memory object, by default
+//              MIXXX_CONTROL_SNAPSHOT_NAME
+//   controls   group,item pairs separated by ';'. By default the play
+//              position, BPM, beat distance and VU meter of the first four
+//              decks and the VU meters of the master.
+//
+// Not available on Windows.
+class ControlSnapshot : public QObject {
+    Q_OBJECT
+  public:
+    static bool isEnabled(UserSettingsPointer pConfig);
+
+    ControlSnapshot(UserSettingsPointer pConfig, QObject* pParent = nullptr);
+    ~ControlSnapshot() override;
+
+    // Returns whether the shared memory object has been created
+    bool isOpen() const {
+        return m_pSnapshot != nullptr;
+    }
+
+    const QString& name() const {
+        return m_name;
+    }
+
+    const QList<ConfigKey>& keys() const {
+        return m_keys;
+    }
+
+    // Engine thread only. Copies the current values into the snapshot.
+    void publish();
+
+  public slots:
+    // Looks up the controls that did not exist yet, e.g. the controls of
+    // decks that are added after the engine has been created
+    void slotResolveControls();
+
+  private:
+    static QList<ConfigKey> defaultControls();
+    bool open();
+    void close();
+
+    QString m_name;
+    QList<ConfigKey> m_keys;
+    mixxx_control_snapshot* m_pSnapshot;
+    int m_fd;
+
+    // Keep the controls alive while the engine reads them
+    QVector<QSharedPointer<ControlDoublePrivate> > m_controls;
+    std::unique_ptr<std::atomic<ControlDoublePrivate*>[]> m_pEngineControls;
+    QTimer m_resolveTimer;
+
+    // Engine thread
+    quint64 m_sequence;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlSnapshot);
+};
+
+#endif // CONTROLSNAPSHOT_H
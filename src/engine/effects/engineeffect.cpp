@@ -4,6 +4,14 @@
 #include "util/defs.h"
 #include "util/sample.h"
 
+namespace {
+
+// -90 dBFS. Below the noise floor of any audio interface, but far above the
+// denormal range that decaying feedback loops end up in.
+const CSAMPLE kSilenceThreshold = 3.1623e-5f;
+
+} // anonymous namespace
+
 EngineEffect::EngineEffect(EffectManifestPointer pManifest,
                            const QSet<ChannelHandleAndGroup>& activeInputChannels,
                            EffectsManager* pEffectsManager,
@@ -23,11 +31,14 @@ EngineEffect::EngineEffect(EffectManifestPointer pManifest,
     for (const ChannelHandleAndGroup& inputChannel :
             pEffectsManager->registeredInputChannels()) {
         ChannelHandleMap<EffectEnableState> outputChannelMap;
+        ChannelHandleMap<SilenceState> outputSilenceMap;
         for (const ChannelHandleAndGroup& outputChannel :
                 pEffectsManager->registeredOutputChannels()) {
             outputChannelMap.insert(outputChannel.handle(), EffectEnableState::Disabled);
+            outputSilenceMap.insert(outputChannel.handle(), SilenceState());
         }
         m_effectEnableStateForChannelMatrix.insert(inputChannel.handle(), outputChannelMap);
+        m_silenceStateForChannelMatrix.insert(inputChannel.handle(), outputSilenceMap);
     }
 
     // Creating the processor must come last.
@@ -66,6 +77,21 @@ void EngineEffect::loadStatesForInputChannel(const ChannelHandle* inputChannel,
         qDebug() << "EngineEffect::loadStatesForInputChannel" << this
                  << "loading states for input" << *inputChannel;
     }
+    // The input channel may have been registered after this effect was
+    // created. Add its entries here on the engine thread, because process()
+    // never adds them while it may be called for different input channels
+    // concurrently.
+    auto& outputChannelMap = m_effectEnableStateForChannelMatrix[*inputChannel];
+    auto& outputSilenceMap = m_silenceStateForChannelMatrix[*inputChannel];
+    for (const ChannelHandleAndGroup& outputChannel :
+            m_pEffectsManager->registeredOutputChannels()) {
+        if (!outputChannelMap.find(outputChannel.handle())) {
+            outputChannelMap.insert(outputChannel.handle(), EffectEnableState::Disabled);
+        }
+        if (!outputSilenceMap.find(outputChannel.handle())) {
+            outputSilenceMap.insert(outputChannel.handle(), SilenceState());
+        }
+    }
     m_pProcessor->loadStatesForInputChannel(inputChannel, pStatesMap);
 }
 
@@ -159,8 +185,19 @@ bool EngineEffect::process(const ChannelHandle& inputHandle,
     // enabling/disabling signal. For example, the Echo effect clears its
     // internal buffer for the channel when it gets the intermediate disabling signal.
 
-    EffectEnableState effectiveEffectEnableState =
-        m_effectEnableStateForChannelMatrix[inputHandle][outputHandle];
+    auto* pEnableStates = m_effectEnableStateForChannelMatrix.find(inputHandle);
+    EffectEnableState* pEffectOnChannelState =
+            pEnableStates ? pEnableStates->find(outputHandle) : nullptr;
+    auto* pSilenceStates = m_silenceStateForChannelMatrix.find(inputHandle);
+    SilenceState* pSilenceState =
+            pSilenceStates ? pSilenceStates->find(outputHandle) : nullptr;
+    VERIFY_OR_DEBUG_ASSERT(pEffectOnChannelState && pSilenceState) {
+        // The chain only processes input channels it has been enabled for,
+        // see loadStatesForInputChannel()
+        return false;
+    }
+
+    EffectEnableState effectiveEffectEnableState = *pEffectOnChannelState;
 
     // If the EngineEffect is fully disabled, do not let
     // intermediate enabling/disabing signals from the chain override
@@ -186,9 +223,29 @@ bool EngineEffect::process(const ChannelHandle& inputHandle,
         }
     }
 
+    // Skip processing once the input has been silent for longer than the tail
+    // of the effect and the output has decayed. Intermediate states are
+    // always processed.
+    SilenceState& silenceState = *pSilenceState;
+    bool inputSilent = false;
+    if (m_pManifest->hasTailLength() &&
+            effectiveEffectEnableState == EffectEnableState::Enabled) {
+        inputSilent = SampleUtil::isSilent(pInput, numSamples, kSilenceThreshold);
+        if (!inputSilent) {
+            silenceState = SilenceState();
+        } else if (!silenceState.bypassed) {
+            silenceState.silentFrames += numSamples / mixxx::kEngineChannelCount;
+        }
+    } else {
+        silenceState = SilenceState();
+    }
+
     bool processingOccured = false;
 
-    if (effectiveEffectEnableState != EffectEnableState::Disabled) {
+    // While bypassed, the chain passes on the silent input instead of the
+    // output of this effect.
+    if (effectiveEffectEnableState != EffectEnableState::Disabled &&
+            !silenceState.bypassed) {
         //TODO: refactor rest of audio engine to use mixxx::AudioParameters
         const mixxx::EngineParameters bufferParameters(
               mixxx::AudioSignal::SampleRate(sampleRate),
@@ -218,11 +275,18 @@ bool EngineEffect::process(const ChannelHandle& inputHandle,
                         numSamples);
             }
         }
+
+        if (inputSilent &&
+                silenceState.silentFrames >= m_pManifest->tailLength() * sampleRate &&
+                SampleUtil::isSilent(pOutput, numSamples, kSilenceThreshold)) {
+            // Nothing audible is left of the tail
+            silenceState.bypassed = true;
+        }
     }
 
     // Now that the EffectProcessor has been sent the intermediate enabling/disabling
     // signal, set the channel state to fully enabled/disabled for the next engine callback.
-    EffectEnableState& effectOnChannelState = m_effectEnableStateForChannelMatrix[inputHandle][outputHandle];
+    EffectEnableState& effectOnChannelState = *pEffectOnChannelState;
     if (effectOnChannelState == EffectEnableState::Disabling) {
         effectOnChannelState = EffectEnableState::Disabled;
     } else if (effectOnChannelState == EffectEnableState::Enabling) {
@@ -54,7 +54,25 @@ class EngineEffect : public EffectsRequestHandler {
         return m_pManifest;
     }
 
+    // See EffectProcessor::supportsConcurrentChannels()
+    bool supportsConcurrentChannels() const {
+        return m_pProcessor->supportsConcurrentChannels();
+    }
+
   private:
+    // Whether the effect is processed for a channel while its input is
+    // silent, see EffectManifest::tailLength()
+    struct SilenceState {
+        SilenceState()
+                : silentFrames(0),
+                  bypassed(false) {
+        }
+        // The number of frames since the input has become silent
+        SINT silentFrames;
+        // True once the tail has decayed, until the input is audible again
+        bool bypassed;
+    };
+
     QString debugString() const {
         return QString("EngineEffect(%1)").arg(m_pManifest->name());
     }
@@ -62,6 +80,7 @@ class EngineEffect : public EffectsRequestHandler {
     EffectManifestPointer m_pManifest;
     EffectProcessor* m_pProcessor;
     ChannelHandleMap<ChannelHandleMap<EffectEnableState>> m_effectEnableStateForChannelMatrix;
+    ChannelHandleMap<ChannelHandleMap<SilenceState>> m_silenceStateForChannelMatrix;
     bool m_effectRampsFromDry;
     // Must not be modified after construction.
     QVector<EngineEffectParameter*> m_parameters;
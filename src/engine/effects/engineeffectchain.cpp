@@ -4,15 +4,20 @@
 #include "util/defs.h"
 #include "util/sample.h"
 
+EngineEffectChainBuffers::EngineEffectChainBuffers()
+        : buffer1(MAX_BUFFER_LEN),
+          buffer2(MAX_BUFFER_LEN) {
+}
+
 EngineEffectChain::EngineEffectChain(const QString& id,
                                      const QSet<ChannelHandleAndGroup>& registeredInputChannels,
                                      const QSet<ChannelHandleAndGroup>& registeredOutputChannels)
         : m_id(id),
+          m_registeredOutputChannels(registeredOutputChannels),
           m_enableState(EffectEnableState::Enabled),
           m_mixMode(EffectChainMixMode::DrySlashWet),
           m_dMix(0),
-          m_buffer1(MAX_BUFFER_LEN),
-          m_buffer2(MAX_BUFFER_LEN) {
+          m_bProcessed(false) {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 
@@ -150,7 +155,17 @@ bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
     if (kEffectDebugOutput) {
         qDebug() << "EngineEffectChain::enableForInputChannel" << this << inputHandle;
     }
+    // The input channel may have been registered after this chain was
+    // created. Add its entries here on the engine thread, before process()
+    // looks them up for it.
     auto& outputMap = m_chainStatusForChannelMatrix[*inputHandle];
+    for (const ChannelHandleAndGroup& outputChannel : m_registeredOutputChannels) {
+        if (!outputMap.find(outputChannel.handle())) {
+            ChannelStatus status;
+            status.oldMixKnob = m_dMix;
+            outputMap.insert(outputChannel.handle(), status);
+        }
+    }
     for (auto&& outputChannelStatus : outputMap) {
         VERIFY_OR_DEBUG_ASSERT(outputChannelStatus.enableState !=
                 EffectEnableState::Enabled) {
@@ -180,8 +195,12 @@ bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
 }
 
 bool EngineEffectChain::disableForInputChannel(const ChannelHandle* inputHandle) {
-    auto& outputMap = m_chainStatusForChannelMatrix[*inputHandle];
-    for (auto&& outputChannelStatus : outputMap) {
+    auto* pOutputMap = m_chainStatusForChannelMatrix.find(*inputHandle);
+    if (!pOutputMap) {
+        // Never enabled
+        return true;
+    }
+    for (auto&& outputChannelStatus : *pOutputMap) {
         if (outputChannelStatus.enableState != EffectEnableState::Disabled) {
             outputChannelStatus.enableState = EffectEnableState::Disabling;
         }
@@ -207,10 +226,13 @@ void EngineEffectChain::deleteStatesForInputChannel(const ChannelHandle* inputCh
     // a ChannelHandle key, but it actually backed by a QVarLengthArray, not a
     // QMap. So it is okay that m_chainStatusForChannelMatrix may be
     // accessed concurrently in the audio engine thread in process(),
-    // enableForInputChannel(), or disableForInputChannel().
-    auto& outputMap = m_chainStatusForChannelMatrix[*inputChannel];
-    for (auto&& outputChannelStatus : outputMap) {
-        outputChannelStatus.enableState = EffectEnableState::Disabled;
+    // enableForInputChannel(), or disableForInputChannel(). This thread must
+    // not expand it, though.
+    auto* pOutputMap = m_chainStatusForChannelMatrix.find(*inputChannel);
+    if (pOutputMap) {
+        for (auto&& outputChannelStatus : *pOutputMap) {
+            outputChannelStatus.enableState = EffectEnableState::Disabled;
+        }
     }
     for (EngineEffect* pEffect : m_effects) {
         if (pEffect != nullptr) {
@@ -219,11 +241,23 @@ void EngineEffectChain::deleteStatesForInputChannel(const ChannelHandle* inputCh
     }
 }
 
-EngineEffectChain::ChannelStatus& EngineEffectChain::getChannelStatus(
+EngineEffectChain::ChannelStatus* EngineEffectChain::findChannelStatus(
         const ChannelHandle& inputHandle,
         const ChannelHandle& outputHandle) {
-    ChannelStatus& status = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
-    return status;
+    auto* pOutputMap = m_chainStatusForChannelMatrix.find(inputHandle);
+    if (!pOutputMap) {
+        return nullptr;
+    }
+    return pOutputMap->find(outputHandle);
+}
+
+bool EngineEffectChain::isProcessingChannel(const ChannelHandle& inputHandle,
+                                            const ChannelHandle& outputHandle) {
+    // Mirrors the effective enable state computed in process()
+    const ChannelStatus* pChannelStatus = findChannelStatus(inputHandle, outputHandle);
+    return pChannelStatus &&
+            pChannelStatus->enableState != EffectEnableState::Disabled &&
+            m_enableState != EffectEnableState::Disabled;
 }
 
 bool EngineEffectChain::process(const ChannelHandle& inputHandle,
@@ -231,7 +265,10 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
                                 CSAMPLE* pIn, CSAMPLE* pOut,
                                 const unsigned int numSamples,
                                 const unsigned int sampleRate,
-                                const GroupFeatureState& groupFeatures) {
+                                const GroupFeatureState& groupFeatures,
+                                EngineEffectChainBuffers* pBuffers) {
+    m_bProcessed.store(true, std::memory_order_relaxed);
+
     // Compute the effective enable state from the channel input routing switch and
     // the chain's enable state. When either of these are turned on/off, send the
     // effects the intermediate enabling/disabling signal.
@@ -240,7 +277,12 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     // appropriately, for example the Echo effect clears its internal buffer for the channel
     // when it gets the intermediate disabling signal.
 
-    ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    ChannelStatus* pChannelStatus = findChannelStatus(inputHandle, outputHandle);
+    if (!pChannelStatus) {
+        // The chain has never been enabled for the input channel
+        return false;
+    }
+    ChannelStatus& channelStatus = *pChannelStatus;
     EffectEnableState effectiveChainEnableState = channelStatus.enableState;
 
     // If the channel is fully disabled, do not let intermediate
@@ -268,10 +310,10 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         for (EngineEffect* pEffect: m_effects) {
             if (pEffect != nullptr) {
                 // Select an unused intermediate buffer for the next output
-                if (pIntermediateInput == m_buffer1.data()) {
-                    pIntermediateOutput = m_buffer2.data();
+                if (pIntermediateInput == pBuffers->buffer1.data()) {
+                    pIntermediateOutput = pBuffers->buffer2.data();
                 } else {
-                    pIntermediateOutput = m_buffer1.data();
+                    pIntermediateOutput = pBuffers->buffer1.data();
                 }
 
                 if (pEffect->process(inputHandle, outputHandle,
@@ -332,9 +374,11 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
     channelStatus.oldMixKnob = currentMixKnob;
 
     // If the EffectProcessors have been sent a signal for the intermediate
-    // enabling/disabling state, set the channel state or chain state
-    // to the fully enabled/disabled state for the next engine callback.
-
+    // enabling/disabling state, set the channel state to the fully
+    // enabled/disabled state for the next engine callback. The state of the
+    // whole chain is shared by all channels and completed in
+    // onCallbackStart() instead, so that every channel gets the signal
+    // regardless of the order in which the channels are processed.
     EffectEnableState& chainOnChannelEnableState = channelStatus.enableState;
     if (chainOnChannelEnableState == EffectEnableState::Disabling) {
         chainOnChannelEnableState = EffectEnableState::Disabled;
@@ -342,11 +386,17 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         chainOnChannelEnableState = EffectEnableState::Enabled;
     }
 
+    return processingOccured;
+}
+
+void EngineEffectChain::onCallbackStart() {
+    if (!m_bProcessed.exchange(false, std::memory_order_relaxed)) {
+        // Keep an intermediate state until the effects have seen it
+        return;
+    }
     if (m_enableState == EffectEnableState::Disabling) {
         m_enableState = EffectEnableState::Disabled;
     } else if (m_enableState == EffectEnableState::Enabling) {
         m_enableState = EffectEnableState::Enabled;
     }
-
-    return processingOccured;
 }
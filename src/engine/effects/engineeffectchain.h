@@ -5,6 +5,8 @@
 #include <QList>
 #include <QLinkedList>
 
+#include <atomic>
+
 #include "util/class.h"
 #include "util/types.h"
 #include "util/samplebuffer.h"
@@ -16,6 +18,18 @@
 
 class EngineEffect;
 
+// The intermediate buffers that EngineEffectChain::process() alternates
+// between while it runs the effects of a chain in series. The chains of
+// different channels can only be processed concurrently with separate
+// buffers, so they are owned by the EngineEffectsManager, which hands out
+// one set to every thread that processes effects.
+struct EngineEffectChainBuffers {
+    EngineEffectChainBuffers();
+
+    mixxx::SampleBuffer buffer1;
+    mixxx::SampleBuffer buffer2;
+};
+
 class EngineEffectChain : public EffectsRequestHandler {
   public:
     EngineEffectChain(const QString& id,
@@ -27,12 +41,21 @@ class EngineEffectChain : public EffectsRequestHandler {
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // May be called concurrently for different input channels, each with
+    // its own pBuffers, if all effects of the chain support it.
     bool process(const ChannelHandle& inputHandle,
                  const ChannelHandle& outputHandle,
                  CSAMPLE* pIn, CSAMPLE* pOut,
                  const unsigned int numSamples,
                  const unsigned int sampleRate,
-                 const GroupFeatureState& groupFeatures);
+                 const GroupFeatureState& groupFeatures,
+                 EngineEffectChainBuffers* pBuffers);
+
+    // Called at the start of every engine callback before any requests are
+    // handled. Completes an intermediate enabling/disabling state of the
+    // whole chain once process() has passed it to the effects of every
+    // channel in the previous callback.
+    void onCallbackStart();
 
     const QString& id() const {
         return m_id;
@@ -40,6 +63,12 @@ class EngineEffectChain : public EffectsRequestHandler {
 
     bool enabledForChannel(const ChannelHandle& handle) const;
 
+    // Returns true if process() would run the effects of this chain for the
+    // given routing. Otherwise process() leaves the buffers untouched and
+    // only updates the chain's bookkeeping.
+    bool isProcessingChannel(const ChannelHandle& inputHandle,
+                             const ChannelHandle& outputHandle);
+
     void deleteStatesForInputChannel(const ChannelHandle* channel);
 
   private:
@@ -63,18 +92,22 @@ class EngineEffectChain : public EffectsRequestHandler {
             EffectStatesMapArray* statesForEffectsInChain);
     bool disableForInputChannel(const ChannelHandle* inputHandle);
 
-    // Gets or creates a ChannelStatus entry in m_channelStatus for the provided
-    // handle.
-    ChannelStatus& getChannelStatus(const ChannelHandle& inputHandle,
-                                    const ChannelHandle& outputHandle);
+    // Returns the ChannelStatus for the routing or a null pointer if the
+    // chain has never been enabled for the input channel. Never modifies
+    // m_chainStatusForChannelMatrix, because process() may be called for
+    // different input channels concurrently. The entries for an input channel
+    // are created by enableForInputChannel() instead.
+    ChannelStatus* findChannelStatus(const ChannelHandle& inputHandle,
+                                     const ChannelHandle& outputHandle);
 
     QString m_id;
+    const QSet<ChannelHandleAndGroup> m_registeredOutputChannels;
     EffectEnableState m_enableState;
     EffectChainMixMode m_mixMode;
     CSAMPLE m_dMix;
     QList<EngineEffect*> m_effects;
-    mixxx::SampleBuffer m_buffer1;
-    mixxx::SampleBuffer m_buffer2;
+    // Set by process() and reset by onCallbackStart()
+    std::atomic<bool> m_bProcessed;
     ChannelHandleMap<ChannelHandleMap<ChannelStatus>> m_chainStatusForChannelMatrix;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
@@ -9,6 +9,7 @@
 #include "util/samplebuffer.h"
 
 class EngineEffectChain;
+struct EngineEffectChainBuffers;
 
 //TODO(Be): Remove this superfluous class.
 class EngineEffectRack : public EffectsRequestHandler {
@@ -25,7 +26,11 @@ class EngineEffectRack : public EffectsRequestHandler {
                  CSAMPLE* pIn, CSAMPLE* pOut,
                  const unsigned int numSamples,
                  const unsigned int sampleRate,
-                 const GroupFeatureState& groupFeatures);
+                 const GroupFeatureState& groupFeatures,
+                 EngineEffectChainBuffers* pChainBuffers);
+
+    bool isProcessingChannel(const ChannelHandle& inputHandle,
+                             const ChannelHandle& outputHandle);
 
     int number() const {
         return m_iRackNumber;
@@ -42,6 +47,8 @@ class EngineEffectRack : public EffectsRequestHandler {
     int m_iRackNumber;
     QList<EngineEffectChain*> m_chains;
 
+    // Only used if the input and output buffers of process() differ, which
+    // is never the case for concurrently processed channels
     mixxx::SampleBuffer m_buffer1;
     mixxx::SampleBuffer m_buffer2;
 
@@ -10,16 +10,28 @@
 EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
         : m_pResponsePipe(pResponsePipe),
           m_buffer1(MAX_BUFFER_LEN),
-          m_buffer2(MAX_BUFFER_LEN) {
+          m_buffer2(MAX_BUFFER_LEN),
+          m_bConcurrentChannelsSupported(true),
+          m_postFaderTask(this),
+          m_pCallbackLatencyStats(nullptr) {
     // Try to prevent memory allocation.
     m_chains.reserve(256);
     m_effects.reserve(256);
+    for (std::atomic<bool>& inUse : m_chainBuffersInUse) {
+        inUse.store(false);
+    }
 }
 
 EngineEffectsManager::~EngineEffectsManager() {
 }
 
 void EngineEffectsManager::onCallbackStart() {
+    // Before any request changes the enable state of a chain again
+    for (EngineEffectChain* pChain : m_chains) {
+        pChain->onCallbackStart();
+    }
+
+    bool effectsChanged = false;
     EffectsRequest* request = NULL;
     while (m_pResponsePipe->readMessages(&request, 1) > 0) {
         EffectsResponse response(*request);
@@ -79,8 +91,10 @@ void EngineEffectsManager::onCallbackStart() {
                     // requests about it.
                     if (request->type == EffectsRequest::ADD_EFFECT_TO_CHAIN) {
                         m_effects.append(request->AddEffectToChain.pEffect);
+                        effectsChanged = true;
                     } else if (request->type == EffectsRequest::REMOVE_EFFECT_FROM_CHAIN) {
                         m_effects.removeAll(request->RemoveEffectFromChain.pEffect);
+                        effectsChanged = true;
                     }
                 } else {
                     // If we got here, the message was not handled for
@@ -117,6 +131,16 @@ void EngineEffectsManager::onCallbackStart() {
             m_pResponsePipe->writeMessages(&response, 1);
         }
     }
+
+    if (effectsChanged) {
+        m_bConcurrentChannelsSupported = true;
+        for (EngineEffect* pEffect : m_effects) {
+            if (!pEffect->supportsConcurrentChannels()) {
+                m_bConcurrentChannelsSupported = false;
+                break;
+            }
+        }
+    }
 }
 
 void EngineEffectsManager::processPreFaderInPlace(const ChannelHandle& inputHandle,
@@ -145,6 +169,8 @@ void EngineEffectsManager::processPostFaderInPlace(
     const GroupFeatureState& groupFeatures,
     const CSAMPLE_GAIN oldGain,
     const CSAMPLE_GAIN newGain) {
+    CallbackLatencyStats::ScopedStage stage(m_pCallbackLatencyStats,
+            CallbackLatencyStats::Stage::Effects);
     processInner(SignalProcessingStage::Postfader,
                  inputHandle, outputHandle,
                  pInOut, pInOut,
@@ -161,6 +187,8 @@ void EngineEffectsManager::processPostFaderAndMix(
     const GroupFeatureState& groupFeatures,
     const CSAMPLE_GAIN oldGain,
     const CSAMPLE_GAIN newGain) {
+    CallbackLatencyStats::ScopedStage stage(m_pCallbackLatencyStats,
+            CallbackLatencyStats::Stage::Effects);
     processInner(SignalProcessingStage::Postfader,
                  inputHandle, outputHandle,
                  pIn, pOut,
@@ -168,6 +196,50 @@ void EngineEffectsManager::processPostFaderAndMix(
                  oldGain, newGain);
 }
 
+void EngineEffectsManager::processPostFaderInPlaceConcurrently(
+    EngineThreadPool* pThreadPool,
+    const ChannelHandle& outputHandle,
+    const PostFaderChannel* pChannels,
+    int numChannels,
+    const unsigned int numSamples,
+    const unsigned int sampleRate) {
+    // Recorded on the engine thread for all channels together
+    CallbackLatencyStats::ScopedStage stage(m_pCallbackLatencyStats,
+            CallbackLatencyStats::Stage::Effects);
+    if (pThreadPool && m_bConcurrentChannelsSupported && numChannels > 1) {
+        // The effects keep their state per channel and every thread gets
+        // its own chain buffers from processInner(). The state that the
+        // chains share among the channels is only modified by
+        // onCallbackStart().
+        m_postFaderTask.prepare(outputHandle, pChannels,
+                numSamples, sampleRate);
+        pThreadPool->run(&m_postFaderTask, numChannels);
+    } else {
+        for (int i = 0; i < numChannels; ++i) {
+            const PostFaderChannel& channel = pChannels[i];
+            processInner(SignalProcessingStage::Postfader,
+                    channel.inputHandle, outputHandle,
+                    channel.pInOut, channel.pInOut,
+                    numSamples, sampleRate, *channel.pGroupFeatures,
+                    channel.oldGain, channel.newGain);
+        }
+    }
+}
+
+bool EngineEffectsManager::isProcessingPostFader(
+    const ChannelHandle& inputHandle,
+    const ChannelHandle& outputHandle) const {
+    const QList<EngineEffectRack*>& racks =
+            m_racksByStage.value(SignalProcessingStage::Postfader);
+    for (EngineEffectRack* pRack : racks) {
+        if (pRack != nullptr &&
+                pRack->isProcessingChannel(inputHandle, outputHandle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void EngineEffectsManager::processInner(
     const SignalProcessingStage stage,
     const ChannelHandle& inputHandle,
@@ -180,6 +252,14 @@ void EngineEffectsManager::processInner(
     const CSAMPLE_GAIN newGain) {
 
     const QList<EngineEffectRack*>& racks = m_racksByStage.value(stage);
+    EngineEffectChainBuffers* pChainBuffers = acquireChainBuffers();
+    // There is a set for every thread that may get here at the same time,
+    // see kNumChainBuffers. Should more threads ever do so, the ones that
+    // are left without a set take turns with the fallback set.
+    VERIFY_OR_DEBUG_ASSERT(pChainBuffers) {
+        m_fallbackChainBuffersMutex.lock();
+        pChainBuffers = &m_fallbackChainBuffers;
+    }
     if (pIn == pOut) {
         // Gain and effects are applied to the buffer in place,
         // modifying the original input buffer
@@ -188,7 +268,8 @@ void EngineEffectsManager::processInner(
             if (pRack != nullptr) {
                 pRack->process(inputHandle, outputHandle,
                                pIn, pIn,
-                               numSamples, sampleRate, groupFeatures);
+                               numSamples, sampleRate, groupFeatures,
+                               pChainBuffers);
             }
         }
     } else {
@@ -221,7 +302,8 @@ void EngineEffectsManager::processInner(
 
                 if (pRack->process(inputHandle, outputHandle,
                                    pIntermediateInput, pIntermediateOutput,
-                                   numSamples, sampleRate, groupFeatures)) {
+                                   numSamples, sampleRate, groupFeatures,
+                                   pChainBuffers)) {
                     // Output of this rack becomes the input of the next rack.
                     pIntermediateInput = pIntermediateOutput;
                 }
@@ -231,6 +313,27 @@ void EngineEffectsManager::processInner(
         // intermediate input of the next rack if there was one.
         SampleUtil::add(pOut, pIntermediateInput, numSamples);
     }
+    releaseChainBuffers(pChainBuffers);
+}
+
+EngineEffectChainBuffers* EngineEffectsManager::acquireChainBuffers() {
+    for (int i = 0; i < kNumChainBuffers; ++i) {
+        bool inUse = false;
+        if (m_chainBuffersInUse[i].compare_exchange_strong(inUse, true,
+                std::memory_order_acquire)) {
+            return &m_chainBuffers[i];
+        }
+    }
+    return nullptr;
+}
+
+void EngineEffectsManager::releaseChainBuffers(EngineEffectChainBuffers* pBuffers) {
+    if (pBuffers == &m_fallbackChainBuffers) {
+        m_fallbackChainBuffersMutex.unlock();
+        return;
+    }
+    const int i = static_cast<int>(pBuffers - m_chainBuffers);
+    m_chainBuffersInUse[i].store(false, std::memory_order_release);
 }
 
 bool EngineEffectsManager::addEffectRack(EngineEffectRack* pRack,
@@ -1,17 +1,22 @@
 #ifndef ENGINEEFFECTSMANAGER_H
 #define ENGINEEFFECTSMANAGER_H
 
+#include <QMutex>
 #include <QScopedPointer>
 
+#include <atomic>
+
 #include "util/samplebuffer.h"
 #include "util/types.h"
 #include "util/fifo.h"
+#include "engine/effects/engineeffectchain.h"
 #include "engine/effects/message.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/channelhandle.h"
+#include "engine/callbacklatencystats.h"
+#include "engine/enginethreadpool.h"
 
 class EngineEffectRack;
-class EngineEffectChain;
 class EngineEffect;
 
 class EngineEffectsManager : public EffectsRequestHandler {
@@ -21,6 +26,20 @@ class EngineEffectsManager : public EffectsRequestHandler {
 
     void onCallbackStart();
 
+    // False while an effect is loaded whose processor does not support being
+    // called for different channels at the same time, see
+    // EffectProcessor::supportsConcurrentChannels(). Channels, and with them
+    // their pre-fader effects, must then be processed one after another.
+    bool supportsConcurrentChannels() const {
+        return m_bConcurrentChannelsSupported;
+    }
+
+    // The time spent in post-fader effects is recorded as the effects stage
+    // of the callback. pStats may be null.
+    void setCallbackLatencyStats(CallbackLatencyStats* pStats) {
+        m_pCallbackLatencyStats = pStats;
+    }
+
     // Take a buffer of numSamples samples of audio from a channel, provided as
     // pInput, and apply each EffectChain enabled for this channel to it,
     // putting the resulting output in pOutput. If pInput is equal to pOutput,
@@ -45,6 +64,8 @@ class EngineEffectsManager : public EffectsRequestHandler {
         const CSAMPLE_GAIN oldGain = CSAMPLE_GAIN_ONE,
         const CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE);
 
+    // Unlike the other process methods, this must not be called concurrently
+    // for different channels.
     void processPostFaderAndMix(
         const ChannelHandle& inputHandle,
         const ChannelHandle& outputHandle,
@@ -55,15 +76,85 @@ class EngineEffectsManager : public EffectsRequestHandler {
         const CSAMPLE_GAIN oldGain = CSAMPLE_GAIN_ONE,
         const CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE);
 
+    // A channel for processPostFaderInPlaceConcurrently()
+    struct PostFaderChannel {
+        ChannelHandle inputHandle;
+        CSAMPLE* pInOut;
+        const GroupFeatureState* pGroupFeatures;
+        CSAMPLE_GAIN oldGain;
+        CSAMPLE_GAIN newGain;
+    };
+
+    // Does the same as processPostFaderInPlace() for numChannels channels and
+    // returns once all of them are done. The channels are processed
+    // concurrently on pThreadPool unless it is null or an effect that is
+    // loaded does not support it, see
+    // EffectProcessor::supportsConcurrentChannels().
+    void processPostFaderInPlaceConcurrently(
+        EngineThreadPool* pThreadPool,
+        const ChannelHandle& outputHandle,
+        const PostFaderChannel* pChannels,
+        int numChannels,
+        const unsigned int numSamples,
+        const unsigned int sampleRate);
+
+    // Returns true if any post-fader effect chain processes the audio of the
+    // given channel. If not, processPostFaderInPlace() and
+    // processPostFaderAndMix() reduce to applying the gain ramp, which allows
+    // ChannelMixer to fold the gain into its mixing loop.
+    bool isProcessingPostFader(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) const;
+
     bool processEffectsRequest(
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
   private:
+    // Processes the post-fader effects of the channels passed to
+    // processPostFaderInPlaceConcurrently() on the engine thread pool
+    class PostFaderTask : public EngineThreadPool::Task {
+      public:
+        explicit PostFaderTask(EngineEffectsManager* pManager)
+                : m_pManager(pManager),
+                  m_pChannels(nullptr),
+                  m_numSamples(0),
+                  m_sampleRate(0) {
+        }
+        void prepare(const ChannelHandle& outputHandle,
+                const PostFaderChannel* pChannels,
+                unsigned int numSamples,
+                unsigned int sampleRate) {
+            m_outputHandle = outputHandle;
+            m_pChannels = pChannels;
+            m_numSamples = numSamples;
+            m_sampleRate = sampleRate;
+        }
+        void run(int index) override {
+            const PostFaderChannel& channel = m_pChannels[index];
+            m_pManager->processInner(SignalProcessingStage::Postfader,
+                    channel.inputHandle, m_outputHandle,
+                    channel.pInOut, channel.pInOut,
+                    m_numSamples, m_sampleRate, *channel.pGroupFeatures,
+                    channel.oldGain, channel.newGain);
+        }
+      private:
+        EngineEffectsManager* const m_pManager;
+        ChannelHandle m_outputHandle;
+        const PostFaderChannel* m_pChannels;
+        unsigned int m_numSamples;
+        unsigned int m_sampleRate;
+    };
+
     QString debugString() const {
         return QString("EngineEffectsManager");
     }
 
+    // Claims a set of chain buffers that no other thread uses until it is
+    // released again. Returns a null pointer if all sets are in use.
+    EngineEffectChainBuffers* acquireChainBuffers();
+    void releaseChainBuffers(EngineEffectChainBuffers* pBuffers);
+
     bool addEffectRack(EngineEffectRack* pRack, SignalProcessingStage stage);
     bool removeEffectRack(EngineEffectRack* pRack, SignalProcessingStage stage);
 
@@ -88,8 +179,26 @@ class EngineEffectsManager : public EffectsRequestHandler {
     QList<EngineEffectChain*> m_chains;
     QList<EngineEffect*> m_effects;
 
+    // Only used by processPostFaderAndMix()
     mixxx::SampleBuffer m_buffer1;
     mixxx::SampleBuffer m_buffer2;
+
+    // One set of chain buffers for every thread that may process effects at
+    // the same time: the engine thread and the helper threads of its
+    // EngineThreadPool. Pre-fader effects are processed concurrently with
+    // the channels, post-fader effects by processPostFaderInPlaceConcurrently().
+    static const int kNumChainBuffers = kMaxEngineHelperThreads + 1;
+    EngineEffectChainBuffers m_chainBuffers[kNumChainBuffers];
+    std::atomic<bool> m_chainBuffersInUse[kNumChainBuffers];
+    // Only used if more threads process effects at once than expected
+    EngineEffectChainBuffers m_fallbackChainBuffers;
+    QMutex m_fallbackChainBuffersMutex;
+
+    // False if any effect does not support concurrent processing
+    bool m_bConcurrentChannelsSupported;
+    PostFaderTask m_postFaderTask;
+
+    CallbackLatencyStats* m_pCallbackLatencyStats;
 };
 
 
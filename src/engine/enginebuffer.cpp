@@ -12,8 +12,10 @@
 #include "engine/bpmcontrol.h"
 #include "engine/clockcontrol.h"
 #include "engine/cuecontrol.h"
+#include "engine/enginebufferscalecubic.h"
 #include "engine/enginebufferscalelinear.h"
 #include "engine/enginebufferscalerubberband.h"
+#include "engine/enginebufferscalerubberbandpipelined.h"
 #include "engine/enginebufferscalest.h"
 #include "engine/enginechannel.h"
 #include "engine/enginecontrol.h"
@@ -176,6 +178,10 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
     m_pKeylock = new ControlPushButton(ConfigKey(m_group, "keylock"), true);
     m_pKeylock->setButtonMode(ControlPushButton::TOGGLE);
 
+    // Selects the interpolation that is used without keylock
+    m_pVinylScaler = new ControlPushButton(ConfigKey(m_group, "vinyl_scaler"), true);
+    m_pVinylScaler->setButtonMode(ControlPushButton::TOGGLE);
+
     m_pEject = new ControlPushButton(ConfigKey(m_group, "eject"));
     connect(m_pEject, SIGNAL(valueChanged(double)),
             this, SLOT(slotEjectTrack(double)),
@@ -239,17 +245,30 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
 
     // Construct scaling objects
     m_pScaleLinear = new EngineBufferScaleLinear(m_pReadAheadManager);
+    m_pScaleCubic = new EngineBufferScaleCubic(m_pReadAheadManager);
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
+    m_pScaleRBPipelined = new EngineBufferScaleRubberBandPipelined(
+            m_pReadAheadManager);
     if (m_pKeylockEngine->get() == SOUNDTOUCH) {
         m_pScaleKeylock = m_pScaleST;
+    } else if (m_pKeylockEngine->get() == RUBBERBAND_PIPELINED) {
+        m_pScaleKeylock = m_pScaleRBPipelined;
     } else {
         m_pScaleKeylock = m_pScaleRB;
     }
-    m_pScaleVinyl = m_pScaleLinear;
+    m_pScaleRBPipelined->setSelected(m_pScaleKeylock == m_pScaleRBPipelined);
+    if (m_pVinylScaler->get() == VINYL_SCALER_CUBIC) {
+        m_pScaleVinyl = m_pScaleCubic;
+    } else {
+        m_pScaleVinyl = m_pScaleLinear;
+    }
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
     m_bScalerChanged = true;
+    connect(m_pVinylScaler, SIGNAL(valueChanged(double)),
+            this, SLOT(slotVinylScalerChanged(double)),
+            Qt::DirectConnection);
 
     m_pPassthroughEnabled = new ControlProxy(group, "passthrough", this);
     m_pPassthroughEnabled->connectValueChanged(SLOT(slotPassthroughChanged(double)),
@@ -299,10 +318,13 @@ EngineBuffer::~EngineBuffer() {
     delete m_pTrackSampleRate;
 
     delete m_pScaleLinear;
+    delete m_pScaleCubic;
     delete m_pScaleST;
     delete m_pScaleRB;
+    delete m_pScaleRBPipelined;
 
     delete m_pKeylock;
+    delete m_pVinylScaler;
     delete m_pEject;
 
     SampleUtil::free(m_pCrossfadeBuffer);
@@ -440,6 +462,9 @@ void EngineBuffer::setNewPlaypos(double newpos, bool adjustingPhase) {
 
     m_filepos_play = newpos;
 
+    // Pending reads of chunks around cue points are outdated by the seek
+    m_pReader->notifySeek();
+
     if (m_rate_old != 0.0) {
         // Before seeking, read extra buffer for crossfading
         // this also sets m_pReadAheadManager to newpos
@@ -696,9 +721,25 @@ void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
     KeylockEngine engine = static_cast<KeylockEngine>(iEngine);
     if (engine == SOUNDTOUCH) {
         m_pScaleKeylock = m_pScaleST;
+    } else if (engine == RUBBERBAND_PIPELINED) {
+        m_pScaleKeylock = m_pScaleRBPipelined;
     } else {
         m_pScaleKeylock = m_pScaleRB;
     }
+    m_pScaleRBPipelined->setSelected(m_pScaleKeylock == m_pScaleRBPipelined);
+}
+
+void EngineBuffer::slotVinylScalerChanged(double dIndex) {
+    if (m_bScalerOverride) {
+        return;
+    }
+    // The new scaler is picked up by enableIndependentPitchTempoScaling()
+    // in the next callback.
+    if (static_cast<int>(dIndex) == VINYL_SCALER_CUBIC) {
+        m_pScaleVinyl = m_pScaleCubic;
+    } else {
+        m_pScaleVinyl = m_pScaleLinear;
+    }
 }
 
 void EngineBuffer::processTrackLocked(
@@ -728,7 +769,6 @@ void EngineBuffer::processTrackLocked(
 
     // Update the slipped position and seek if it was disabled.
     processSlip(iBufferSize);
-    processSyncRequests();
 
     // Note: This may effects the m_filepos_play, play, scaler and crossfade buffer
     processSeek(paused);
@@ -866,7 +906,7 @@ void EngineBuffer::processTrackLocked(
         // This is used for scratching, but not for reverse
         // For the other, crossfade forward and backward samples
         if ((m_speed_old * speed < 0) &&  // Direction has changed!
-                (m_pScale != m_pScaleVinyl || // only m_pScaleLinear supports going though 0
+                (m_pScale != m_pScaleVinyl || // only the vinyl scalers support going though 0
                        m_reverse_old != is_reverse)) { // no pitch change when reversing
             //XXX: Trying to force RAMAN to read from correct
             //     playpos when rate changes direction - Albert
@@ -1020,8 +1060,10 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // We do this even if rubberband is not active.
     if (sample_rate != m_iSampleRate) {
         m_pScaleLinear->setSampleRate(sample_rate);
+        m_pScaleCubic->setSampleRate(sample_rate);
         m_pScaleST->setSampleRate(sample_rate);
         m_pScaleRB->setSampleRate(sample_rate);
+        m_pScaleRBPipelined->setSampleRate(sample_rate);
         m_iSampleRate = sample_rate;
     }
 
@@ -1093,6 +1135,10 @@ void EngineBuffer::processSlip(int iBufferSize) {
     }
 }
 
+SyncMode EngineBuffer::getSyncMode() const {
+    return m_pSyncControl->getSyncMode();
+}
+
 void EngineBuffer::processSyncRequests() {
     SyncRequestQueued enable_request =
             static_cast<SyncRequestQueued>(
@@ -1252,7 +1298,7 @@ void EngineBuffer::hintReader(const double dRate) {
     if (m_bSlipEnabledProcessing) {
         Hint hint;
         hint.frame = SampleUtil::floorPlayPosToFrame(m_dSlipPosition);
-        hint.priority = 1;
+        hint.priority = Hint::kPriorityImminent;
         if (m_dSlipRate >= 0) {
             hint.frameCount = Hint::kFrameCountForward;
         } else {
@@ -1288,6 +1334,7 @@ void EngineBuffer::addControl(EngineControl* pControl) {
 
 void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
+    m_pScaleRBPipelined->bindWorker(pWorkerScheduler);
 }
 
 bool EngineBuffer::isTrackLoaded() {
@@ -1338,6 +1385,7 @@ void EngineBuffer::setScalerForTest(EngineBufferScale* pScaleVinyl,
                                     EngineBufferScale* pScaleKeylock) {
     m_pScaleVinyl = pScaleVinyl;
     m_pScaleKeylock = pScaleKeylock;
+    m_pScaleRBPipelined->setSelected(m_pScaleKeylock == m_pScaleRBPipelined);
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
     m_bScalerChanged = true;
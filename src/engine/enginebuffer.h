@@ -56,9 +56,11 @@ class ControlBeat;
 class ControlTTRotary;
 class ControlPotmeter;
 class EngineBufferScale;
+class EngineBufferScaleCubic;
 class EngineBufferScaleLinear;
 class EngineBufferScaleST;
 class EngineBufferScaleRubberBand;
+class EngineBufferScaleRubberBandPipelined;
 class EngineSync;
 class EngineWorkerScheduler;
 class VisualPlayPosition;
@@ -110,9 +112,16 @@ class EngineBuffer : public EngineObject {
     enum KeylockEngine {
         SOUNDTOUCH,
         RUBBERBAND,
+        RUBBERBAND_PIPELINED,
         KEYLOCK_ENGINE_COUNT,
     };
 
+    // The values of the vinyl_scaler control
+    enum VinylScaler {
+        VINYL_SCALER_LINEAR,
+        VINYL_SCALER_CUBIC,
+    };
+
     EngineBuffer(QString _group, UserSettingsPointer pConfig,
                  EngineChannel* pChannel, EngineMaster* pMixingEngine);
     virtual ~EngineBuffer();
@@ -138,7 +147,12 @@ class EngineBuffer : public EngineObject {
     // The process methods all run in the audio callback.
     void process(CSAMPLE* pOut, const int iBufferSize);
     void processSlip(int iBufferSize);
+    // Applies the queued sync requests. They change the sync state of other
+    // decks, so EngineMaster calls this for all decks on the callback thread
+    // before any of them is processed.
+    void processSyncRequests();
     void postProcess(const int iBufferSize);
+    SyncMode getSyncMode() const;
 
     QString getGroup();
     bool isTrackLoaded();
@@ -165,6 +179,8 @@ class EngineBuffer : public EngineObject {
             return tr("Soundtouch (faster)");
         case RUBBERBAND:
             return tr("Rubberband (better)");
+        case RUBBERBAND_PIPELINED:
+            return tr("Rubberband pipelined (best, adds latency)");
         default:
             return tr("Unknown (bad value)");
         }
@@ -186,6 +202,7 @@ class EngineBuffer : public EngineObject {
     void slotControlSeekAbs(double);
     void slotControlSeekExact(double);
     void slotKeylockEngineChanged(double);
+    void slotVinylScalerChanged(double);
 
     void slotEjectTrack(double);
 
@@ -229,7 +246,6 @@ class EngineBuffer : public EngineObject {
     // Reset buffer playpos and set file playpos.
     void setNewPlaypos(double playpos, bool adjustingPhase);
 
-    void processSyncRequests();
     void processSeek(bool paused);
 
     bool updateIndicatorsAndModifyPlay(bool newPlay);
@@ -342,6 +358,7 @@ class EngineBuffer : public EngineObject {
     ControlProxy* m_pSampleRate;
     ControlProxy* m_pKeylockEngine;
     ControlPushButton* m_pKeylock;
+    ControlPushButton* m_pVinylScaler;
 
     // This ControlProxys is created as parent to this and deleted by
     // the Qt object tree. This helps that they are deleted by the creating
@@ -365,16 +382,19 @@ class EngineBuffer : public EngineObject {
     FRIEND_TEST(EngineBufferTest, ResetPitchAdjustUsesLinear);
     FRIEND_TEST(EngineBufferTest, VinylScalerRampZero);
     FRIEND_TEST(EngineBufferTest, ReadFadeOut);
-    EngineBufferScale* m_pScaleVinyl;
-    // The keylock engine is configurable, so it could flip flop between
-    // ScaleST and ScaleRB during a single callback.
+    FRIEND_TEST(EngineBufferE2ETest, CubicVinylScalerTest);
+    // The vinyl scaler and the keylock engine are configurable, so they
+    // could flip flop during a single callback.
+    EngineBufferScale* volatile m_pScaleVinyl;
     EngineBufferScale* volatile m_pScaleKeylock;
 
-    // Object used for vinyl-style interpolation scaling of the audio
+    // Objects used for vinyl-style interpolation scaling of the audio
     EngineBufferScaleLinear* m_pScaleLinear;
+    EngineBufferScaleCubic* m_pScaleCubic;
     // Objects used for pitch-indep time stretch (key lock) scaling of the audio
     EngineBufferScaleST* m_pScaleST;
     EngineBufferScaleRubberBand* m_pScaleRB;
+    EngineBufferScaleRubberBandPipelined* m_pScaleRBPipelined;
 
     // Indicates whether the scaler has changed since the last process()
     bool m_bScalerChanged;
@@ -0,0 +1,266 @@
+#include "engine/enginebufferscalecubic.h"
+
+#include <cstring>
+
+#include "engine/readaheadmanager.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// Large enough for a segment at MAX_SEEK_SPEED
+const SINT kBufferFrames = 8192;
+
+// The interpolation needs one frame before and two frames after the frame
+// at the floor of the position
+inline SINT requiredFrames(double position) {
+    return static_cast<SINT>(position) + 3;
+}
+
+// The offset of the position of an output frame from the position of the
+// first one if the rate starts at rate and changes by rateDelta with every
+// frame. The same as adding up the rates frame by frame like
+// EngineBufferScaleLinear, but without a dependency between the frames.
+inline double positionOffset(SINT frame, double rate, double rateDelta) {
+    return frame * rate + rateDelta * 0.5 * frame * (frame - 1);
+}
+
+} // anonymous namespace
+
+EngineBufferScaleCubic::EngineBufferScaleCubic(ReadAheadManager* pReadAheadManager)
+        : m_pReadAheadManager(pReadAheadManager),
+          m_pBuffer(SampleUtil::alloc(kBufferFrames * 2)),
+          m_bufferFrames(0),
+          m_paddingFrames(0),
+          m_dPosition(0.0),
+          m_bClear(false),
+          m_dRate(1.0),
+          m_dOldRate(1.0) {
+    clear();
+}
+
+EngineBufferScaleCubic::~EngineBufferScaleCubic() {
+    SampleUtil::free(m_pBuffer);
+}
+
+void EngineBufferScaleCubic::setScaleParameters(double base_rate,
+                                                double* pTempoRatio,
+                                                double* pPitchRatio) {
+    Q_UNUSED(pPitchRatio);
+
+    m_dOldRate = m_dRate;
+    m_dRate = base_rate * *pTempoRatio;
+}
+
+void EngineBufferScaleCubic::clear() {
+    m_bClear = true;
+    // Start with a silent frame before the first frame that is read
+    SampleUtil::clear(m_pBuffer, getAudioSignal().frames2samples(1));
+    m_bufferFrames = 1;
+    m_paddingFrames = 1;
+    m_dPosition = 1.0;
+}
+
+double EngineBufferScaleCubic::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (iOutputBufferSize == 0) {
+        return 0.0;
+    }
+
+    if (m_bClear) {
+        m_dOldRate = m_dRate;  // If cleared, don't interpolate rate.
+        m_bClear = false;
+    }
+    const double rateOld = m_dOldRate;
+    const double rateNew = m_dRate;
+    // We only need to ramp up the rate changes once
+    m_dOldRate = m_dRate;
+
+    const SINT frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    SINT framesRead = 0;
+    if (rateOld * rateNew < 0) {
+        // Direction has changed! Slow down to zero in the first half of
+        // the buffer and speed up in the other direction in the second half.
+        const SINT firstHalfFrames = frames / 2;
+        framesRead += scaleFrames(pOutputBuffer, firstHalfFrames,
+                fabs(rateOld), 0.0, rateOld);
+        framesRead += reverseBuffer(rateNew);
+        framesRead += scaleFrames(
+                pOutputBuffer + getAudioSignal().frames2samples(firstHalfFrames),
+                frames - firstHalfFrames,
+                0.0, fabs(rateNew), rateNew);
+    } else {
+        framesRead += scaleFrames(pOutputBuffer, frames,
+                fabs(rateOld), fabs(rateNew),
+                rateNew == 0 ? rateOld : rateNew);
+    }
+    return framesRead;
+}
+
+SINT EngineBufferScaleCubic::scaleFrames(CSAMPLE* pOutput, SINT frames,
+        double rateOld, double rateNew, double readRate) {
+    // Smooth any changes in the playback rate over the buffer like
+    // EngineBufferScaleLinear
+    const double rateDelta = (rateNew - rateOld) / frames;
+    // Limit the segments at high rates to the frames that fit into the buffer
+    const double maxRate = math_max(rateOld, rateNew);
+    const SINT maxSegmentFrames = maxRate > 1.0 ?
+            math_clamp<SINT>(static_cast<SINT>((kBufferFrames - 5) / maxRate),
+                    1, kSegmentFrames) :
+            kSegmentFrames;
+
+    SINT framesRead = 0;
+    SINT framesDone = 0;
+    while (framesDone < frames) {
+        compactBuffer();
+        const double rate = rateOld + framesDone * rateDelta;
+        SINT segmentFrames = math_min(frames - framesDone, maxSegmentFrames);
+        const SINT missingFrames = requiredFrames(m_dPosition +
+                positionOffset(segmentFrames - 1, rate, rateDelta)) - m_bufferFrames;
+        if (missingFrames > 0) {
+            framesRead += readFrames(missingFrames, readRate);
+        }
+        // Shorten the segment if reading has failed, e.g. at the end of the
+        // track
+        while (segmentFrames > 0 &&
+                requiredFrames(m_dPosition +
+                        positionOffset(segmentFrames - 1, rate, rateDelta)) >
+                        m_bufferFrames) {
+            --segmentFrames;
+        }
+        if (segmentFrames == 0) {
+            break;
+        }
+        interpolate(pOutput + getAudioSignal().frames2samples(framesDone),
+                segmentFrames, rate, rateDelta);
+        m_dPosition += positionOffset(segmentFrames, rate, rateDelta);
+        framesDone += segmentFrames;
+    }
+
+    SampleUtil::clear(pOutput + getAudioSignal().frames2samples(framesDone),
+            getAudioSignal().frames2samples(frames - framesDone));
+    return framesRead;
+}
+
+void EngineBufferScaleCubic::interpolate(CSAMPLE* pOutput, SINT frames,
+        double rate, double rateDelta) {
+    const SINT firstIndex = static_cast<SINT>(m_dPosition);
+    if (rateDelta == 0 && rate == 1.0 && m_dPosition == firstIndex) {
+        // Special case -- no scaling needed!
+        SampleUtil::copy(pOutput,
+                m_pBuffer + getAudioSignal().frames2samples(firstIndex),
+                getAudioSignal().frames2samples(frames));
+        return;
+    }
+
+    // Only collects the samples, the arithmetic is done in the SIMD
+    // kernel below.
+    for (SINT i = 0; i < frames; ++i) {
+        const double position = m_dPosition + positionOffset(i, rate, rateDelta);
+        const SINT index = static_cast<SINT>(position);
+        const CSAMPLE fraction = static_cast<CSAMPLE>(position - index);
+        const CSAMPLE* pFrames = m_pBuffer +
+                getAudioSignal().frames2samples(index - 1);
+        const SINT sample = getAudioSignal().frames2samples(i);
+        m_taps[0][sample] = pFrames[0];
+        m_taps[0][sample + 1] = pFrames[1];
+        m_taps[1][sample] = pFrames[2];
+        m_taps[1][sample + 1] = pFrames[3];
+        m_taps[2][sample] = pFrames[4];
+        m_taps[2][sample + 1] = pFrames[5];
+        m_taps[3][sample] = pFrames[6];
+        m_taps[3][sample + 1] = pFrames[7];
+        m_fraction[sample] = fraction;
+        m_fraction[sample + 1] = fraction;
+    }
+    SampleUtil::interpolateHermite(pOutput,
+            m_taps[0], m_taps[1], m_taps[2], m_taps[3], m_fraction,
+            getAudioSignal().frames2samples(frames));
+}
+
+SINT EngineBufferScaleCubic::readFrames(SINT frames, double readRate) {
+    frames = math_min(frames, kBufferFrames - m_bufferFrames);
+    SINT framesRead = 0;
+    // Protection against infinite read loops when (for example) we are
+    // reading from a broken file.
+    int readFailedCount = 0;
+    while (framesRead < frames) {
+        const SINT samplesRead = m_pReadAheadManager->getNextSamples(
+                readRate,
+                m_pBuffer + getAudioSignal().frames2samples(m_bufferFrames + framesRead),
+                getAudioSignal().frames2samples(frames - framesRead));
+        if (samplesRead == 0) {
+            if (++readFailedCount > 1) {
+                break;
+            }
+            continue;
+        }
+        framesRead += getAudioSignal().samples2frames(samplesRead);
+    }
+    m_bufferFrames += framesRead;
+    return framesRead;
+}
+
+void EngineBufferScaleCubic::compactBuffer() {
+    // Keep the frame before the current position
+    const SINT dropFrames = math_min(
+            static_cast<SINT>(m_dPosition) - 1, m_bufferFrames);
+    if (dropFrames <= 0) {
+        return;
+    }
+    std::memmove(m_pBuffer,
+            m_pBuffer + getAudioSignal().frames2samples(dropFrames),
+            getAudioSignal().frames2samples(m_bufferFrames - dropFrames) *
+                    sizeof(CSAMPLE));
+    m_bufferFrames -= dropFrames;
+    m_paddingFrames = math_max<SINT>(m_paddingFrames - dropFrames, 0);
+    m_dPosition -= dropFrames;
+}
+
+SINT EngineBufferScaleCubic::reverseBuffer(double readRate) {
+    // Reading the buffered frames again in the new direction moves the
+    // ReadAheadManager back to the first buffered frame. The samples are
+    // not needed and end up in m_taps, which is overwritten anyway.
+    const SINT bufferedFrames = m_bufferFrames - m_paddingFrames;
+    SINT framesRead = 0;
+    int readFailedCount = 0;
+    while (framesRead < bufferedFrames) {
+        const SINT samplesRead = m_pReadAheadManager->getNextSamples(
+                readRate, m_taps[0],
+                getAudioSignal().frames2samples(
+                        math_min(bufferedFrames - framesRead, kSegmentFrames)));
+        if (samplesRead == 0) {
+            if (++readFailedCount > 1) {
+                break;
+            }
+            continue;
+        }
+        framesRead += getAudioSignal().samples2frames(samplesRead);
+    }
+
+    // The frames from the ReadAheadManager in the new direction. The
+    // padding frames would end up after the position and are dropped.
+    std::memmove(m_pBuffer,
+            m_pBuffer + getAudioSignal().frames2samples(m_paddingFrames),
+            getAudioSignal().frames2samples(bufferedFrames) * sizeof(CSAMPLE));
+    SampleUtil::reverse(m_pBuffer, getAudioSignal().frames2samples(bufferedFrames));
+    m_dPosition = m_bufferFrames - 1 - m_dPosition;
+    m_bufferFrames = bufferedFrames;
+    m_paddingFrames = 0;
+    if (m_dPosition < 1.0) {
+        prependSilence(static_cast<SINT>(ceil(1.0 - m_dPosition)));
+    }
+    return framesRead;
+}
+
+void EngineBufferScaleCubic::prependSilence(SINT frames) {
+    frames = math_min(frames, kBufferFrames - m_bufferFrames);
+    std::memmove(m_pBuffer + getAudioSignal().frames2samples(frames),
+            m_pBuffer,
+            getAudioSignal().frames2samples(m_bufferFrames) * sizeof(CSAMPLE));
+    SampleUtil::clear(m_pBuffer, getAudioSignal().frames2samples(frames));
+    m_bufferFrames += frames;
+    m_paddingFrames += frames;
+    m_dPosition += frames;
+}
@@ -0,0 +1,77 @@
+#ifndef ENGINEBUFFERSCALECUBIC_H
+#define ENGINEBUFFERSCALECUBIC_H
+
+#include "engine/enginebufferscale.h"
+
+class ReadAheadManager;
+
+// Vinyl-style scaling like EngineBufferScaleLinear, but with 4-point cubic
+// Hermite interpolation, which aliases much less when playing far from the
+// original rate. The output is rendered in short segments: the positions and
+// the neighboring samples of all frames of a segment are collected first,
+// so that the interpolation itself runs in the SIMD kernels of SampleUtil
+// and costs little more than linear interpolation.
+class EngineBufferScaleCubic : public EngineBufferScale {
+  public:
+    explicit EngineBufferScaleCubic(
+            ReadAheadManager* pReadAheadManager);
+    ~EngineBufferScaleCubic() override;
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+    void clear() override;
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+  private:
+    // The maximum number of frames that are interpolated at once
+    static const SINT kSegmentFrames = 256;
+
+    // Scales the given number of output frames while the absolute rate
+    // ramps from rateOld to rateNew. readRate is the signed rate that is
+    // passed to the ReadAheadManager. Returns the number of frames read.
+    SINT scaleFrames(CSAMPLE* pOutput, SINT frames,
+            double rateOld, double rateNew, double readRate);
+    // Interpolates frames output frames starting at m_dPosition. All
+    // frames must already be buffered.
+    void interpolate(CSAMPLE* pOutput, SINT frames,
+            double rate, double rateDelta);
+    // Appends up to the given number of frames from the ReadAheadManager
+    // to m_pBuffer. Returns the number of frames read.
+    SINT readFrames(SINT frames, double readRate);
+    // Drops the buffered frames that are no longer needed for interpolation
+    void compactBuffer();
+    // Turns the buffered frames around after the playback direction has
+    // changed and moves the ReadAheadManager back to the first buffered
+    // frame. Returns the number of frames read.
+    SINT reverseBuffer(double readRate);
+    // Inserts silent frames in front of the buffered frames
+    void prependSilence(SINT frames);
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    // The unscaled frames around the current position, in the direction of
+    // playback. Interpolation needs the frame before the current position.
+    CSAMPLE* m_pBuffer;
+    SINT m_bufferFrames;
+    // The silent frames at the start of m_pBuffer that have not been read
+    // from the ReadAheadManager
+    SINT m_paddingFrames;
+    // The position of the next output frame in m_pBuffer
+    double m_dPosition;
+
+    bool m_bClear;
+    double m_dRate;
+    double m_dOldRate;
+
+    // The interleaved neighbors of each output sample and its position
+    // between the second and the third neighbor, see interpolate()
+    CSAMPLE m_taps[4][2 * kSegmentFrames];
+    CSAMPLE m_fraction[2 * kSegmentFrames];
+};
+
+#endif
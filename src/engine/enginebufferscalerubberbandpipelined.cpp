@@ -0,0 +1,479 @@
+#include "engine/enginebufferscalerubberbandpipelined.h"
+
+#include <rubberband/RubberBandStretcher.h>
+
+#include <cstring>
+
+#include "engine/readaheadmanager.h"
+#include "util/assert.h"
+#include "util/counter.h"
+#include "util/defs.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+using RubberBand::RubberBandStretcher;
+
+namespace {
+
+const mixxx::Logger kLogger("EngineBufferScaleRubberBandPipelined");
+
+// About 190 ms of input and 370 ms of output at 44.1 kHz
+const int kInputBlocks = 32;
+const int kOutputBlocks = 64;
+// Leaves room for the latency of RubberBand in the output FIFO
+const int kMaxBlocksAhead = kOutputBlocks - 16;
+
+// The worker has time to spare, so we can afford the options that sound
+// best. Processing both channels together keeps the stereo image.
+const RubberBandStretcher::Options kStretcherOptions =
+        RubberBandStretcher::OptionProcessRealTime |
+        RubberBandStretcher::OptionPitchHighQuality |
+        RubberBandStretcher::OptionChannelsTogether;
+
+}  // anonymous namespace
+
+// static
+const int EngineBufferScaleRubberBandPipelined::kBuffersAhead = 2;
+
+RubberBandPipelineWorker::RubberBandPipelineWorker(
+        FIFO<RubberBandPipelineBlock>* pInputFifo,
+        FIFO<RubberBandPipelineBlock>* pOutputFifo,
+        const std::atomic<int>* pGeneration)
+        : m_pInputFifo(pInputFifo),
+          m_pOutputFifo(pOutputFifo),
+          m_pGeneration(pGeneration),
+          m_stop(false),
+          m_bActive(false),
+          m_bThreadRunning(false),
+          m_sampleRate(0),
+          m_generation(-1),
+          m_bFlushPending(false) {
+    m_channelBuffers[0] = SampleUtil::alloc(RubberBandPipelineBlock::kFrames);
+    m_channelBuffers[1] = SampleUtil::alloc(RubberBandPipelineBlock::kFrames);
+    std::memset(&m_inputBlock, 0, sizeof(m_inputBlock));
+    std::memset(&m_outputBlock, 0, sizeof(m_outputBlock));
+    m_outputBlock.generation = m_generation;
+}
+
+RubberBandPipelineWorker::~RubberBandPipelineWorker() {
+    SampleUtil::free(m_channelBuffers[0]);
+    SampleUtil::free(m_channelBuffers[1]);
+}
+
+void RubberBandPipelineWorker::run() {
+    unsigned static id = 0; //the id of this thread, for debugging purposes
+    QThread::currentThread()->setObjectName(
+            QString("RubberBandPipelineWorker %1").arg(++id));
+
+    while (!m_stop.load()) {
+        while (processNextBlock()) {
+        }
+        {
+            QMutexLocker locker(&m_activeMutex);
+            if (!m_bActive) {
+                m_bThreadRunning = false;
+                break;
+            }
+        }
+        waitForWork();
+    }
+    markFinished();
+}
+
+void RubberBandPipelineWorker::setActive(bool active) {
+    QMutexLocker locker(&m_activeMutex);
+    m_bActive = active;
+    if (active && !m_bThreadRunning) {
+        // A previous thread has already decided to stop and is about to
+        // return from run(), so this does not wait long
+        wait();
+        m_stop = false;
+        m_bThreadRunning = true;
+        markStarting();
+        start(QThread::HighPriority);
+    } else if (!active && m_bThreadRunning) {
+        // Lets the scheduler wake the thread after the next callback,
+        // when the engine is done with the scaler
+        workReady();
+    }
+}
+
+bool RubberBandPipelineWorker::isActiveThreadRunning() {
+    QMutexLocker locker(&m_activeMutex);
+    return m_bThreadRunning;
+}
+
+void RubberBandPipelineWorker::quitWait() {
+    {
+        QMutexLocker locker(&m_activeMutex);
+        m_bActive = false;
+        m_bThreadRunning = false;
+    }
+    m_stop = true;
+    m_semaRun.release();
+    wait();
+}
+
+void RubberBandPipelineWorker::initStretcher(SINT sampleRate) {
+    // Created lazily on the worker thread, because most decks and
+    // samplers never use the pipeline
+    m_pStretcher = std::make_unique<RubberBandStretcher>(
+            sampleRate, 2, kStretcherOptions);
+    m_pStretcher->setMaxProcessSize(RubberBandPipelineBlock::kFrames);
+    // Preallocate buffers that are large enough for fast playback, see
+    // EngineBufferScaleRubberBand::initRubberBand()
+    m_pStretcher->setTimeRatio(2.0);
+    m_pStretcher->setTimeRatio(1.0);
+    m_sampleRate = sampleRate;
+    resetInputSegments();
+}
+
+double RubberBandPipelineWorker::takeInputFrames(SINT outputFrames) {
+    double inputFrames = 0;
+    double remainingOutputFrames = outputFrames;
+    while (remainingOutputFrames > 0 && !m_inputSegments.empty()) {
+        InputSegment& segment = m_inputSegments.front();
+        if (segment.outputFrames <= remainingOutputFrames) {
+            inputFrames += segment.inputFrames;
+            remainingOutputFrames -= segment.outputFrames;
+            m_inputSegments.pop_front();
+        } else {
+            const double partialInputFrames = segment.inputFrames *
+                    remainingOutputFrames / segment.outputFrames;
+            inputFrames += partialInputFrames;
+            segment.inputFrames -= partialInputFrames;
+            segment.outputFrames -= remainingOutputFrames;
+            remainingOutputFrames = 0;
+        }
+    }
+    // The frames that RubberBand outputs beyond the stretched input, e.g.
+    // its latency, don't consume any input
+    return inputFrames;
+}
+
+void RubberBandPipelineWorker::resetInputSegments() {
+    m_inputSegments.clear();
+}
+
+bool RubberBandPipelineWorker::retrieveOutput() {
+    while (true) {
+        if (m_outputBlock.frames == RubberBandPipelineBlock::kFrames) {
+            if (m_pOutputFifo->write(&m_outputBlock, 1) != 1) {
+                return false;
+            }
+            m_outputBlock.frames = 0;
+            m_outputBlock.inputFrames = 0;
+        }
+        if (!m_pStretcher) {
+            return true;
+        }
+        // Negative after the last samples have been retrieved
+        const int available = m_pStretcher->available();
+        if (available <= 0) {
+            break;
+        }
+        const SINT frames = math_min<SINT>(available,
+                RubberBandPipelineBlock::kFrames - m_outputBlock.frames);
+        const SINT received = m_pStretcher->retrieve(
+                (float* const*)m_channelBuffers, frames);
+        SampleUtil::interleaveBuffer(
+                m_outputBlock.samples + 2 * m_outputBlock.frames,
+                m_channelBuffers[0], m_channelBuffers[1], received);
+        m_outputBlock.frames += received;
+        m_outputBlock.inputFrames += takeInputFrames(received);
+    }
+    if (m_bFlushPending) {
+        // RubberBand does not output exactly the input multiplied by the
+        // time ratio. The input that is left is added to the last block, so
+        // that the engine consumes all frames that it has read.
+        for (const auto& segment : m_inputSegments) {
+            m_outputBlock.inputFrames += segment.inputFrames;
+        }
+        resetInputSegments();
+        // Also send the incomplete block with the last samples
+        if (m_outputBlock.frames > 0 || m_outputBlock.inputFrames > 0) {
+            if (m_pOutputFifo->write(&m_outputBlock, 1) != 1) {
+                return false;
+            }
+            m_outputBlock.frames = 0;
+            m_outputBlock.inputFrames = 0;
+        }
+        m_pStretcher->reset();
+        m_bFlushPending = false;
+    }
+    return true;
+}
+
+bool RubberBandPipelineWorker::processNextBlock() {
+    if (!retrieveOutput()) {
+        // Continue after the engine has consumed some output
+        return false;
+    }
+    if (m_pInputFifo->read(&m_inputBlock, 1) != 1) {
+        return false;
+    }
+    if (m_inputBlock.generation != m_pGeneration->load()) {
+        // Read before the last seek
+        return true;
+    }
+
+    if (!m_pStretcher || m_inputBlock.sampleRate != m_sampleRate) {
+        initStretcher(m_inputBlock.sampleRate);
+    } else if (m_inputBlock.generation != m_generation) {
+        m_pStretcher->reset();
+        resetInputSegments();
+    }
+    m_generation = m_inputBlock.generation;
+    if (m_outputBlock.generation != m_generation) {
+        m_outputBlock.generation = m_generation;
+        m_outputBlock.sampleRate = m_sampleRate;
+        m_outputBlock.frames = 0;
+        m_outputBlock.inputFrames = 0;
+        m_bFlushPending = false;
+    }
+
+    // RubberBand checks itself whether the parameters have changed
+    if (m_inputBlock.pitchScale > 0) {
+        m_pStretcher->setPitchScale(m_inputBlock.pitchScale);
+    }
+    if (m_inputBlock.timeRatio > 0) {
+        m_pStretcher->setTimeRatio(m_inputBlock.timeRatio);
+    }
+    if (m_pStretcher->getInputIncrement() == 0) {
+        // See EngineBufferScaleRubberBand::setScaleParameters(). The
+        // adjusted ratio is accounted for in the input frames of the output
+        // blocks.
+        kLogger.warning() << "inputIncrement is 0. Taking evasive action.";
+        double timeRatioInverse = 1.0 / m_inputBlock.timeRatio;
+        while (m_pStretcher->getInputIncrement() == 0) {
+            timeRatioInverse += 0.001;
+            m_pStretcher->setTimeRatio(1.0 / timeRatioInverse);
+        }
+    }
+
+    SampleUtil::deinterleaveBuffer(m_channelBuffers[0], m_channelBuffers[1],
+            m_inputBlock.samples, m_inputBlock.frames);
+    m_pStretcher->process((const float* const*)m_channelBuffers, m_inputBlock.frames,
+            m_inputBlock.flush);
+    if (m_inputBlock.frames > 0) {
+        // The ratio that is actually used, including the evasive action
+        // above
+        InputSegment segment;
+        segment.inputFrames = m_inputBlock.frames;
+        segment.outputFrames = m_inputBlock.frames * m_pStretcher->getTimeRatio();
+        m_inputSegments.push_back(segment);
+    }
+    m_bFlushPending = m_inputBlock.flush;
+    return true;
+}
+
+EngineBufferScaleRubberBandPipelined::EngineBufferScaleRubberBandPipelined(
+        ReadAheadManager* pReadAheadManager)
+        : m_pReadAheadManager(pReadAheadManager),
+          m_inputFifo(kInputBlocks),
+          m_outputFifo(kOutputBlocks),
+          m_generation(0),
+          m_worker(&m_inputFifo, &m_outputFifo, &m_generation),
+          m_bWorkerBound(false),
+          m_bSelected(false),
+          m_outputBlockOffset(0),
+          m_timeRatio(1.0),
+          m_pitchScale(1.0),
+          m_bBackwards(false),
+          m_bLastReadFailed(false),
+          m_bFlushed(false) {
+    std::memset(&m_inputBlock, 0, sizeof(m_inputBlock));
+    std::memset(&m_outputBlock, 0, sizeof(m_outputBlock));
+}
+
+EngineBufferScaleRubberBandPipelined::~EngineBufferScaleRubberBandPipelined() {
+    m_worker.quitWait();
+}
+
+void EngineBufferScaleRubberBandPipelined::bindWorker(
+        EngineWorkerScheduler* pWorkerScheduler) {
+    m_worker.setScheduler(pWorkerScheduler);
+    m_bWorkerBound = true;
+    updateWorker();
+}
+
+void EngineBufferScaleRubberBandPipelined::setSelected(bool selected) {
+    m_bSelected = selected;
+    updateWorker();
+}
+
+void EngineBufferScaleRubberBandPipelined::updateWorker() {
+    // The engine may still use the scaler until the next callback. Input
+    // that piles up in the FIFOs after the worker has stopped is dropped by
+    // the clear() when the scaler is selected again.
+    m_worker.setActive(m_bWorkerBound.load() && m_bSelected.load());
+}
+
+void EngineBufferScaleRubberBandPipelined::setScaleParameters(double base_rate,
+                                                              double* pTempoRatio,
+                                                              double* pPitchRatio) {
+    // Negative speed means we are going backwards. pitch does not affect
+    // the playback direction.
+    m_bBackwards = *pTempoRatio < 0;
+
+    // Same limit as in EngineBufferScaleRubberBand::setScaleParameters()
+    const double kMinSeekSpeed = 1.0 / 128.0;
+    double speed_abs = fabs(*pTempoRatio);
+    if (speed_abs < kMinSeekSpeed) {
+        // Let the caller know we ignored their speed.
+        speed_abs = *pTempoRatio = 0;
+    }
+
+    // Applied by the worker to the following input blocks
+    m_pitchScale = fabs(base_rate * *pPitchRatio);
+    const double timeRatioInverse = base_rate * speed_abs;
+    if (timeRatioInverse > 0) {
+        m_timeRatio = 1.0 / timeRatioInverse;
+    }
+
+    // Used by other methods so we need to keep them up to date.
+    m_dBaseRate = base_rate;
+    m_dTempoRatio = speed_abs;
+    m_dPitchRatio = *pPitchRatio;
+}
+
+void EngineBufferScaleRubberBandPipelined::setSampleRate(SINT iSampleRate) {
+    EngineBufferScale::setSampleRate(iSampleRate);
+    // The worker recreates RubberBand with the next input block
+    clear();
+}
+
+void EngineBufferScaleRubberBandPipelined::clear() {
+    // The stale blocks in both FIFOs are dropped when they are read
+    ++m_generation;
+    m_outputBlock.frames = 0;
+    m_outputBlockOffset = 0;
+    m_bLastReadFailed = false;
+    m_bFlushed = false;
+}
+
+SINT EngineBufferScaleRubberBandPipelined::queuedOutputFrames() const {
+    return m_outputFifo.readAvailable() * RubberBandPipelineBlock::kFrames +
+            m_outputBlock.frames - m_outputBlockOffset;
+}
+
+void EngineBufferScaleRubberBandPipelined::feedInput(SINT targetFrames) {
+    // Unscaled frames per stretched frame
+    const double inputRatio = m_dBaseRate * m_dTempoRatio;
+    // The frames inside RubberBand are not accounted for, which only
+    // adds its latency once.
+    const double framesAhead = queuedOutputFrames() +
+            m_inputFifo.readAvailable() * RubberBandPipelineBlock::kFrames /
+                    inputRatio;
+    const double missingInputFrames = (targetFrames - framesAhead) * inputRatio;
+    if (missingInputFrames <= 0) {
+        return;
+    }
+    const int blocks = math_min(
+            static_cast<int>(ceil(missingInputFrames / RubberBandPipelineBlock::kFrames)),
+            m_inputFifo.writeAvailable());
+
+    m_inputBlock.generation = m_generation.load();
+    m_inputBlock.sampleRate = getAudioSignal().sampleRate();
+    m_inputBlock.timeRatio = m_timeRatio;
+    m_inputBlock.pitchScale = m_pitchScale;
+    for (int i = 0; i < blocks; ++i) {
+        const SINT samples = m_pReadAheadManager->getNextSamples(
+                // The value doesn't matter here. All that matters is we
+                // are going forward or backward.
+                (m_bBackwards ? -1.0 : 1.0) * inputRatio,
+                m_inputBlock.samples,
+                getAudioSignal().frames2samples(RubberBandPipelineBlock::kFrames));
+        m_inputBlock.frames = getAudioSignal().samples2frames(samples);
+        if (m_inputBlock.frames > 0) {
+            m_bLastReadFailed = false;
+            m_bFlushed = false;
+            m_inputBlock.flush = false;
+            m_inputFifo.write(&m_inputBlock, 1);
+            continue;
+        }
+        if (m_bLastReadFailed && !m_bFlushed) {
+            // If we are at EOF this serves to get the last samples out of
+            // RubberBand.
+            m_inputBlock.flush = true;
+            m_inputFifo.write(&m_inputBlock, 1);
+            m_bFlushed = true;
+        }
+        m_bLastReadFailed = true;
+        break;
+    }
+}
+
+SINT EngineBufferScaleRubberBandPipelined::consumeOutput(
+        CSAMPLE* pBuffer, SINT frames, double* pInputFrames) {
+    const int generation = m_generation.load();
+    SINT consumedFrames = 0;
+    while (consumedFrames < frames) {
+        if (m_outputBlockOffset >= m_outputBlock.frames) {
+            if (m_outputFifo.read(&m_outputBlock, 1) != 1) {
+                m_outputBlock.frames = 0;
+                m_outputBlockOffset = 0;
+                break;
+            }
+            m_outputBlockOffset = 0;
+            if (m_outputBlock.generation != generation) {
+                // Stretched before the last seek
+                m_outputBlock.frames = 0;
+                continue;
+            }
+            if (m_outputBlock.frames == 0) {
+                // The rest of the input after a flush
+                *pInputFrames += m_outputBlock.inputFrames;
+                continue;
+            }
+        }
+        const SINT blockFrames = math_min(frames - consumedFrames,
+                m_outputBlock.frames - m_outputBlockOffset);
+        // Computed from the offsets, so that the input frames of a block
+        // add up exactly when it is consumed in several parts
+        *pInputFrames += m_outputBlock.inputFrames *
+                        (m_outputBlockOffset + blockFrames) / m_outputBlock.frames -
+                m_outputBlock.inputFrames * m_outputBlockOffset / m_outputBlock.frames;
+        SampleUtil::copy(pBuffer + getAudioSignal().frames2samples(consumedFrames),
+                m_outputBlock.samples + getAudioSignal().frames2samples(m_outputBlockOffset),
+                getAudioSignal().frames2samples(blockFrames));
+        m_outputBlockOffset += blockFrames;
+        consumedFrames += blockFrames;
+    }
+    return consumedFrames;
+}
+
+double EngineBufferScaleRubberBandPipelined::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (m_dBaseRate == 0.0 || m_dTempoRatio == 0.0) {
+        SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        // No actual samples/frames have been read from the
+        // unscaled input buffer!
+        return 0.0;
+    }
+
+    const SINT frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    double inputFrames = 0;
+    const SINT receivedFrames = consumeOutput(pOutputBuffer, frames, &inputFrames);
+    if (receivedFrames < frames) {
+        SampleUtil::clear(
+                pOutputBuffer + getAudioSignal().frames2samples(receivedFrames),
+                getAudioSignal().frames2samples(frames - receivedFrames));
+        Counter counter("EngineBufferScaleRubberBandPipelined::scaleBuffer underflow");
+        counter.increment();
+    }
+
+    feedInput(math_min(kBuffersAhead * frames,
+            kMaxBlocksAhead * RubberBandPipelineBlock::kFrames));
+    VERIFY_OR_DEBUG_ASSERT(m_bWorkerBound) {
+        return 0.0;
+    }
+    // The worker runs after the callback
+    m_worker.workReady();
+
+    // Only the input of the stretched frames that have been output counts as
+    // consumed, see the class comment.
+    return inputFrames;
+}
@@ -0,0 +1,198 @@
+#ifndef ENGINE_ENGINEBUFFERSCALERUBBERBANDPIPELINED_H
+#define ENGINE_ENGINEBUFFERSCALERUBBERBANDPIPELINED_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#include <QMutex>
+
+#include "engine/enginebufferscale.h"
+#include "engine/engineworker.h"
+#include "util/fifo.h"
+
+namespace RubberBand {
+class RubberBandStretcher;
+}  // namespace RubberBand
+
+class EngineWorkerScheduler;
+class ReadAheadManager;
+
+// Interleaved stereo samples that are passed between the engine and the
+// worker of EngineBufferScaleRubberBandPipelined together with everything
+// the worker needs to know to stretch them.
+struct RubberBandPipelineBlock {
+    static const SINT kFrames = 256;
+
+    // Incremented with every clear() of the scaler. Blocks of older
+    // generations are dropped.
+    int generation;
+    SINT sampleRate;
+    // Only used for input blocks
+    double timeRatio;
+    double pitchScale;
+    // Set at the end of the track to get the last samples out of RubberBand
+    bool flush;
+    SINT frames;
+    // Only used for output blocks. The number of unscaled input frames that
+    // the stretched frames have been produced from, at the time ratio of
+    // their input blocks. May be set for a block without frames, which
+    // carries the rest of the input after a flush.
+    double inputFrames;
+    CSAMPLE samples[kFrames * 2];
+};
+
+// Stretches the input blocks of one deck with RubberBand and writes the
+// results to the output FIFO. Scheduled by the EngineWorkerScheduler after
+// each callback.
+class RubberBandPipelineWorker : public EngineWorker {
+    Q_OBJECT
+  public:
+    RubberBandPipelineWorker(FIFO<RubberBandPipelineBlock>* pInputFifo,
+            FIFO<RubberBandPipelineBlock>* pOutputFifo,
+            const std::atomic<int>* pGeneration);
+    ~RubberBandPipelineWorker() override;
+
+    void run() override;
+
+    // Starts the thread with a high priority if it is not running. When
+    // deactivated, the thread finishes the blocks it has been given and
+    // stops by itself the next time the scheduler wakes it, so the caller
+    // never waits for it. Must not be called from the callback.
+    void setActive(bool active);
+    // True from setActive(true) until the thread has decided to stop
+    bool isActiveThreadRunning();
+    // Stops the thread and waits until it has finished
+    void quitWait();
+
+  private:
+    // Returns false if there is nothing more to do until the next wake-up
+    bool processNextBlock();
+    // Moves the stretched frames into the output FIFO. Returns false if the
+    // output FIFO is full.
+    bool retrieveOutput();
+    void initStretcher(SINT sampleRate);
+    // Returns the number of input frames that outputFrames stretched frames
+    // have been produced from and removes them from m_inputSegments
+    double takeInputFrames(SINT outputFrames);
+    void resetInputSegments();
+
+    FIFO<RubberBandPipelineBlock>* m_pInputFifo;
+    FIFO<RubberBandPipelineBlock>* m_pOutputFifo;
+    const std::atomic<int>* m_pGeneration;
+    std::atomic<bool> m_stop;
+
+    // Guards m_bActive and m_bThreadRunning against the worker thread
+    // deciding to stop while setActive() restarts it
+    QMutex m_activeMutex;
+    bool m_bActive;
+    bool m_bThreadRunning;
+
+    std::unique_ptr<RubberBand::RubberBandStretcher> m_pStretcher;
+    SINT m_sampleRate;
+    int m_generation;
+    bool m_bFlushPending;
+    CSAMPLE* m_channelBuffers[2];
+    RubberBandPipelineBlock m_inputBlock;
+    RubberBandPipelineBlock m_outputBlock;
+
+    // The input blocks inside RubberBand whose stretched frames have not
+    // been retrieved yet, oldest first
+    struct InputSegment {
+        double inputFrames;
+        // inputFrames multiplied by the time ratio they are stretched with
+        double outputFrames;
+    };
+    std::deque<InputSegment> m_inputSegments;
+};
+
+// Uses librubberband to scale audio like EngineBufferScaleRubberBand, but
+// runs RubberBand on a worker thread in its high quality mode. The engine
+// reads the unscaled samples from the ReadAheadManager ahead of time and
+// consumes the stretched samples that the worker has produced after the
+// previous callbacks, so the audio is delayed by up to kBuffersAhead
+// buffers plus the latency of RubberBand.
+//
+// The returned number of consumed frames refers to the stretched samples
+// that are output, not to the samples that have been read ahead. Each
+// output block carries the number of input frames it has been stretched
+// from, so rate changes while the audio is in the pipeline are accounted
+// for with the ratio the audio has actually been stretched with. The play
+// position that EngineBuffer takes from the read ahead log therefore lags
+// behind by the latency of the pipeline and matches the audible position,
+// which is also used for sync.
+//
+// Not thread safe. All methods except bindWorker() and setSelected() must
+// be called from the engine thread.
+class EngineBufferScaleRubberBandPipelined : public EngineBufferScale {
+    Q_OBJECT
+  public:
+    // The number of buffers that are stretched in advance
+    static const int kBuffersAhead;
+
+    explicit EngineBufferScaleRubberBandPipelined(
+            ReadAheadManager* pReadAheadManager);
+    ~EngineBufferScaleRubberBandPipelined() override;
+
+    // The worker thread only runs while the scaler is both bound and
+    // selected, so the decks and samplers that use another keylock engine
+    // don't keep a high priority thread around. Neither may be called from
+    // the callback.
+    void bindWorker(EngineWorkerScheduler* pWorkerScheduler);
+    // Called when the scaler is selected as keylock engine or replaced by
+    // another one, possibly while the engine is inside scaleBuffer(). The
+    // worker of a deselected scaler stops after the next callback.
+    void setSelected(bool selected);
+    bool isWorkerRunning() {
+        return m_worker.isActiveThreadRunning();
+    }
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+    void setSampleRate(SINT iSampleRate) override;
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+
+    // Drops all audio in the pipeline
+    void clear() override;
+
+  private:
+    // Reads input blocks until enough frames are in the pipeline to
+    // produce targetFrames stretched frames
+    void feedInput(SINT targetFrames);
+    // Copies up to frames stretched frames into pBuffer and returns the
+    // number of frames copied. Adds the number of input frames they have
+    // been stretched from to *pInputFrames.
+    SINT consumeOutput(CSAMPLE* pBuffer, SINT frames, double* pInputFrames);
+    SINT queuedOutputFrames() const;
+    // Starts or stops the worker thread, see bindWorker()
+    void updateWorker();
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    FIFO<RubberBandPipelineBlock> m_inputFifo;
+    FIFO<RubberBandPipelineBlock> m_outputFifo;
+    std::atomic<int> m_generation;
+    RubberBandPipelineWorker m_worker;
+    std::atomic<bool> m_bWorkerBound;
+    std::atomic<bool> m_bSelected;
+
+    RubberBandPipelineBlock m_inputBlock;
+    // The output block that is currently consumed
+    RubberBandPipelineBlock m_outputBlock;
+    SINT m_outputBlockOffset;
+
+    double m_timeRatio;
+    double m_pitchScale;
+    // Holds the playback direction
+    bool m_bBackwards;
+    bool m_bLastReadFailed;
+    bool m_bFlushed;
+};
+
+#endif // ENGINE_ENGINEBUFFERSCALERUBBERBANDPIPELINED_H
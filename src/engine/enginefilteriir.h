@@ -37,6 +37,8 @@ class EngineFilterIIRBase : public EngineObjectConstIn {
 template<unsigned int SIZE, enum IIRPass PASS>
 class EngineFilterIIR : public EngineFilterIIRBase {
   public:
+    static const unsigned int kSize = SIZE;
+
     EngineFilterIIR()
             : m_doRamping(false),
               m_doStart(false),
@@ -193,6 +195,12 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         m_doStart = false;
     }
 
+    // The gain followed by the SIZE coefficients of the filter, as returned
+    // by fid_design_coef(). Used to run the filter in EngineFilterIIRBank.
+    const double* getCoefs() const {
+        return m_coef;
+    }
+
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput,
                          const int iBufferSize) {
         if (!m_doRamping) {
@@ -0,0 +1,432 @@
+#ifndef ENGINEFILTERIIRBANK_H
+#define ENGINEFILTERIIRBANK_H
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "engine/enginefilteriir.h"
+#include "util/math.h"
+#include "util/types.h"
+
+// The vectors of lanes that EngineFilterIIRBank works on. Every vector
+// holds kWidth / 2 stereo frames, the left and right sample of each frame
+// being neighbouring lanes. With SSE2 a vector holds one frame in double
+// and two frames in single precision, otherwise it is a plain pair of
+// scalars.
+template<typename SAMPLE>
+struct EngineFilterIIRBankLanes {
+    static const int kWidth = 2;
+    struct Vec {
+        SAMPLE l;
+        SAMPLE r;
+    };
+    static inline Vec load(const SAMPLE* p) {
+        Vec v = {p[0], p[1]};
+        return v;
+    }
+    static inline void store(SAMPLE* p, Vec v) {
+        p[0] = v.l;
+        p[1] = v.r;
+    }
+    static inline Vec add(Vec a, Vec b) {
+        Vec v = {a.l + b.l, a.r + b.r};
+        return v;
+    }
+    static inline Vec sub(Vec a, Vec b) {
+        Vec v = {a.l - b.l, a.r - b.r};
+        return v;
+    }
+    static inline Vec mul(Vec a, Vec b) {
+        Vec v = {a.l * b.l, a.r * b.r};
+        return v;
+    }
+    // Loads the stereo frames of kWidth / 2 filters, p1 is only used for
+    // vectors of more than one frame.
+    static inline Vec loadFrames(const CSAMPLE* p0, const CSAMPLE* p1) {
+        Q_UNUSED(p1);
+        Vec v = {p0[0], p0[1]};
+        return v;
+    }
+    static inline void storeFrames(CSAMPLE* p0, CSAMPLE* p1, Vec v) {
+        Q_UNUSED(p1);
+        p0[0] = static_cast<CSAMPLE>(v.l);
+        p0[1] = static_cast<CSAMPLE>(v.r);
+    }
+};
+
+#ifdef __SSE2__
+template<>
+struct EngineFilterIIRBankLanes<double> {
+    static const int kWidth = 2;
+    typedef __m128d Vec;
+    static inline Vec load(const double* p) {
+        return _mm_loadu_pd(p);
+    }
+    static inline void store(double* p, Vec v) {
+        _mm_storeu_pd(p, v);
+    }
+    static inline Vec add(Vec a, Vec b) {
+        return _mm_add_pd(a, b);
+    }
+    static inline Vec sub(Vec a, Vec b) {
+        return _mm_sub_pd(a, b);
+    }
+    static inline Vec mul(Vec a, Vec b) {
+        return _mm_mul_pd(a, b);
+    }
+    static inline Vec loadFrames(const CSAMPLE* p0, const CSAMPLE* p1) {
+        Q_UNUSED(p1);
+        return _mm_cvtps_pd(_mm_castpd_ps(
+                _mm_load_sd(reinterpret_cast<const double*>(p0))));
+    }
+    static inline void storeFrames(CSAMPLE* p0, CSAMPLE* p1, Vec v) {
+        Q_UNUSED(p1);
+        _mm_storel_pi(reinterpret_cast<__m64*>(p0), _mm_cvtpd_ps(v));
+    }
+};
+
+template<>
+struct EngineFilterIIRBankLanes<float> {
+    static const int kWidth = 4;
+    typedef __m128 Vec;
+    static inline Vec load(const float* p) {
+        return _mm_loadu_ps(p);
+    }
+    static inline void store(float* p, Vec v) {
+        _mm_storeu_ps(p, v);
+    }
+    static inline Vec add(Vec a, Vec b) {
+        return _mm_add_ps(a, b);
+    }
+    static inline Vec sub(Vec a, Vec b) {
+        return _mm_sub_ps(a, b);
+    }
+    static inline Vec mul(Vec a, Vec b) {
+        return _mm_mul_ps(a, b);
+    }
+    static inline Vec loadFrames(const CSAMPLE* p0, const CSAMPLE* p1) {
+        const Vec v = _mm_loadl_pi(_mm_setzero_ps(),
+                reinterpret_cast<const __m64*>(p0));
+        return _mm_loadh_pi(v, reinterpret_cast<const __m64*>(p1));
+    }
+    static inline void storeFrames(CSAMPLE* p0, CSAMPLE* p1, Vec v) {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p0), v);
+        _mm_storeh_pi(reinterpret_cast<__m64*>(p1), v);
+    }
+};
+#endif
+
+// Runs FILTERS stereo low or high pass filters of the same order side by
+// side. They may have different coefficients and each filter has its own
+// input and output buffer. This is the same as processing FILTERS
+// EngineFilterIIR objects one after another, but the left and right channel
+// of every filter are lanes of SIMD vectors in a structure-of-arrays layout.
+// So a whole EQ is processed in a single pass over the buffers and the
+// independent filters hide the latency of each other's feedback loops.
+//
+// SIZE and the coefficients are the same as for EngineFilterIIR<SIZE, PASS>
+// with PASS IIR_LP or IIR_HP, which is used to design them. With SAMPLE
+// float the filters run in single precision, which doubles the number of
+// lanes per vector. This is only accurate enough for corners well above
+// 100 Hz, where the poles are not too close to the unit circle.
+template<unsigned int SIZE, int FILTERS, typename SAMPLE = double>
+class EngineFilterIIRBank {
+    typedef EngineFilterIIRBankLanes<SAMPLE> Lanes;
+    typedef typename Lanes::Vec Vec;
+
+  public:
+    EngineFilterIIRBank() {
+        memset(&m_coefs, 0, sizeof(m_coefs));
+        memset(&m_oldCoefs, 0, sizeof(m_oldCoefs));
+        memset(&m_oldState, 0, sizeof(m_oldState));
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            m_doStart[filter] = false;
+        }
+        pauseFilter();
+    }
+
+    // Takes the coefficients of a designed filter for the given filter of
+    // the bank. Like EngineFilterIIR::setCoefs(), the output of the old
+    // coefficients is cross faded to the new ones during the next process()
+    // call.
+    template<enum IIRPass PASS>
+    void setCoefs(int filter, const EngineFilterIIR<SIZE, PASS>& design) {
+        static_assert(PASS == IIR_LP || PASS == IIR_HP,
+                "Only low and high pass filters are supported");
+        const double* coef = design.getCoefs();
+        const SAMPLE feedForward = PASS == IIR_LP ? 2 : -2;
+        for (int lane = filter * 2; lane < endLane(filter); ++lane) {
+            m_oldCoefs.gain[lane] = m_coefs.gain[lane];
+            m_coefs.gain[lane] = static_cast<SAMPLE>(coef[0]);
+            for (unsigned int s = 0; s < kSections; ++s) {
+                m_oldCoefs.a2[s][lane] = m_coefs.a2[s][lane];
+                m_oldCoefs.a1[s][lane] = m_coefs.a1[s][lane];
+                m_oldCoefs.b1[s][lane] = m_coefs.b1[s][lane];
+                m_coefs.a2[s][lane] = static_cast<SAMPLE>(coef[s * 2 + 1]);
+                m_coefs.a1[s][lane] = static_cast<SAMPLE>(coef[s * 2 + 2]);
+                m_coefs.b1[s][lane] = feedForward;
+
+                m_oldState.z2[s][lane] = m_state.z2[s][lane];
+                m_oldState.z1[s][lane] = m_state.z1[s][lane];
+                m_state.z2[s][lane] = 0;
+                m_state.z1[s][lane] = 0;
+            }
+        }
+        m_doRamping[filter] = true;
+    }
+
+    // Starts all filters from silence with the next process() call
+    void pauseFilter() {
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            if (!m_doStart[filter]) {
+                for (int lane = filter * 2; lane < endLane(filter); ++lane) {
+                    for (unsigned int s = 0; s < kSections; ++s) {
+                        m_state.z2[s][lane] = 0;
+                        m_state.z1[s][lane] = 0;
+                    }
+                }
+                m_doRamping[filter] = true;
+                m_doStart[filter] = true;
+            }
+        }
+    }
+
+    void assumeSettled() {
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            m_doRamping[filter] = false;
+            m_doStart[filter] = false;
+        }
+    }
+
+    // Filters pIn[filter] into pOutput[filter] for every filter. Both are
+    // interleaved stereo buffers, which may be the same.
+    void process(const CSAMPLE* const pIn[FILTERS],
+            CSAMPLE* const pOutput[FILTERS], const int iBufferSize) {
+        bool doRamping = false;
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            doRamping = doRamping || m_doRamping[filter];
+        }
+
+        // Working on local vectors allows the compiler to keep everything
+        // in registers instead of reloading it for every frame.
+        VecCoefs coefs;
+        VecState state;
+        loadCoefs(m_coefs, &coefs);
+        loadState(m_state, &state);
+
+        if (!doRamping) {
+            for (int i = 0; i < iBufferSize; i += 2) {
+                Vec frame[kVectors];
+                loadFrames(frame, pIn, i);
+                processFrame(coefs, &state, frame);
+                storeFrames(pOutput, frame, i);
+            }
+            storeState(state, &m_state);
+            return;
+        }
+
+        // The same cross fade as in EngineFilterIIR::process(), applied
+        // only to the lanes of the filters that are ramping. The others
+        // have a constant weight of 1 for the new output.
+        VecCoefs oldCoefs;
+        VecState oldState;
+        loadCoefs(m_oldCoefs, &oldCoefs);
+        loadState(m_oldState, &oldState);
+
+        const SAMPLE crossInc = 4 / static_cast<SAMPLE>(iBufferSize);
+        SAMPLE oldGainLanes[kPaddedLanes];
+        SAMPLE crossMixLanes[kPaddedLanes];
+        SAMPLE crossIncLanes[kPaddedLanes];
+        SAMPLE oneLanes[kPaddedLanes];
+        for (int lane = 0; lane < kPaddedLanes; ++lane) {
+            const int filter = math_min(lane / 2, FILTERS - 1);
+            // The old filter is not valid after a pause, fade in from
+            // silence in this case.
+            oldGainLanes[lane] = m_doStart[filter] ? 0 : 1;
+            crossMixLanes[lane] = m_doRamping[filter] ? 0 : 1;
+            crossIncLanes[lane] = m_doRamping[filter] ? crossInc : 0;
+            oneLanes[lane] = 1;
+        }
+        Vec oldGain[kVectors];
+        Vec crossMix[kVectors];
+        Vec crossMixInc[kVectors];
+        Vec one[kVectors];
+        for (int v = 0; v < kVectors; ++v) {
+            oldGain[v] = Lanes::load(lanes(oldGainLanes, v));
+            crossMix[v] = Lanes::load(lanes(crossMixLanes, v));
+            crossMixInc[v] = Lanes::load(lanes(crossIncLanes, v));
+            one[v] = Lanes::load(lanes(oneLanes, v));
+        }
+
+        for (int i = 0; i < iBufferSize; i += 2) {
+            Vec frame[kVectors];
+            Vec oldFrame[kVectors];
+            loadFrames(frame, pIn, i);
+            for (int v = 0; v < kVectors; ++v) {
+                oldFrame[v] = frame[v];
+            }
+            processFrame(oldCoefs, &oldState, oldFrame);
+            processFrame(coefs, &state, frame);
+            for (int v = 0; v < kVectors; ++v) {
+                const Vec old = Lanes::mul(oldFrame[v], oldGain[v]);
+                frame[v] = Lanes::add(Lanes::mul(frame[v], crossMix[v]),
+                        Lanes::mul(old, Lanes::sub(one[v], crossMix[v])));
+            }
+            if (i >= iBufferSize / 2) {
+                for (int v = 0; v < kVectors; ++v) {
+                    crossMix[v] = Lanes::add(crossMix[v], crossMixInc[v]);
+                }
+            }
+            storeFrames(pOutput, frame, i);
+        }
+        storeState(state, &m_state);
+        storeState(oldState, &m_oldState);
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            m_doRamping[filter] = false;
+            m_doStart[filter] = false;
+        }
+    }
+
+    // Can be used instead of a final process() call before a pause, fades
+    // the output of all filters to silence.
+    void processAndPauseFilter(const CSAMPLE* const pIn[FILTERS],
+            CSAMPLE* const pOutput[FILTERS], const int iBufferSize) {
+        process(pIn, pOutput, iBufferSize);
+        for (int filter = 0; filter < FILTERS; ++filter) {
+            SampleUtil::applyRampingGain(pOutput[filter], 1.0, 0.0, iBufferSize);
+        }
+        pauseFilter();
+    }
+
+  private:
+    static const unsigned int kSections = SIZE / 2;
+    static_assert(SIZE % 2 == 0, "The filters must consist of biquad sections");
+    static const int kFramesPerVector = Lanes::kWidth / 2;
+    static const int kVectors =
+            (FILTERS + kFramesPerVector - 1) / kFramesPerVector;
+    // If FILTERS does not fill the last vector, its unused lanes run a copy
+    // of the last filter.
+    static const int kPaddedLanes = kVectors * Lanes::kWidth;
+
+    // The coefficients of a cascade of direct form II biquad sections with
+    // the feed forward coefficients 1, b1, 1, see processSample() in
+    // enginefilteriir.h for IIR_LP and IIR_HP.
+    struct Coefs {
+        SAMPLE gain[kPaddedLanes];
+        SAMPLE a2[kSections][kPaddedLanes];
+        SAMPLE a1[kSections][kPaddedLanes];
+        SAMPLE b1[kSections][kPaddedLanes];
+    };
+    struct State {
+        SAMPLE z2[kSections][kPaddedLanes];
+        SAMPLE z1[kSections][kPaddedLanes];
+    };
+    struct VecCoefs {
+        Vec gain[kVectors];
+        Vec a2[kSections][kVectors];
+        Vec a1[kSections][kVectors];
+        Vec b1[kSections][kVectors];
+    };
+    struct VecState {
+        Vec z2[kSections][kVectors];
+        Vec z1[kSections][kVectors];
+    };
+
+    static int endLane(int filter) {
+        return filter == FILTERS - 1 ? kPaddedLanes : filter * 2 + 2;
+    }
+
+    static inline const SAMPLE* lanes(const SAMPLE* values, int v) {
+        return values + v * Lanes::kWidth;
+    }
+
+    static void loadCoefs(const Coefs& coefs, VecCoefs* pVecCoefs) {
+        for (int v = 0; v < kVectors; ++v) {
+            pVecCoefs->gain[v] = Lanes::load(lanes(coefs.gain, v));
+            for (unsigned int s = 0; s < kSections; ++s) {
+                pVecCoefs->a2[s][v] = Lanes::load(lanes(coefs.a2[s], v));
+                pVecCoefs->a1[s][v] = Lanes::load(lanes(coefs.a1[s], v));
+                pVecCoefs->b1[s][v] = Lanes::load(lanes(coefs.b1[s], v));
+            }
+        }
+    }
+
+    static void loadState(const State& state, VecState* pVecState) {
+        for (int v = 0; v < kVectors; ++v) {
+            for (unsigned int s = 0; s < kSections; ++s) {
+                pVecState->z2[s][v] = Lanes::load(lanes(state.z2[s], v));
+                pVecState->z1[s][v] = Lanes::load(lanes(state.z1[s], v));
+            }
+        }
+    }
+
+    static void storeState(const VecState& vecState, State* pState) {
+        for (int v = 0; v < kVectors; ++v) {
+            for (unsigned int s = 0; s < kSections; ++s) {
+                Lanes::store(pState->z2[s] + v * Lanes::kWidth,
+                        vecState.z2[s][v]);
+                Lanes::store(pState->z1[s] + v * Lanes::kWidth,
+                        vecState.z1[s][v]);
+            }
+        }
+    }
+
+    static inline int filterOfFrame(int v, int frame) {
+        return math_min(v * kFramesPerVector + frame, FILTERS - 1);
+    }
+
+    static inline void loadFrames(Vec* frame,
+            const CSAMPLE* const pIn[FILTERS], int i) {
+        for (int v = 0; v < kVectors; ++v) {
+            frame[v] = Lanes::loadFrames(pIn[filterOfFrame(v, 0)] + i,
+                    pIn[filterOfFrame(v, kFramesPerVector - 1)] + i);
+        }
+    }
+
+    static inline void storeFrames(CSAMPLE* const pOutput[FILTERS],
+            const Vec* frame, int i) {
+        // The copy of the last filter in a padded vector computes the same
+        // samples, so it does not matter which one is stored last.
+        for (int v = 0; v < kVectors; ++v) {
+            Lanes::storeFrames(pOutput[filterOfFrame(v, 0)] + i,
+                    pOutput[filterOfFrame(v, kFramesPerVector - 1)] + i,
+                    frame[v]);
+        }
+    }
+
+    static inline void processFrame(const VecCoefs& coefs, VecState* pState,
+            Vec* frame) {
+        for (int v = 0; v < kVectors; ++v) {
+            frame[v] = Lanes::mul(frame[v], coefs.gain[v]);
+        }
+        for (unsigned int s = 0; s < kSections; ++s) {
+            for (int v = 0; v < kVectors; ++v) {
+                const Vec z2 = pState->z2[s][v];
+                const Vec z1 = pState->z1[s][v];
+                const Vec iir = Lanes::sub(frame[v],
+                        Lanes::add(Lanes::mul(coefs.a2[s][v], z2),
+                                Lanes::mul(coefs.a1[s][v], z1)));
+                frame[v] = Lanes::add(
+                        Lanes::add(z2, Lanes::mul(coefs.b1[s][v], z1)), iir);
+                pState->z2[s][v] = z1;
+                pState->z1[s][v] = iir;
+            }
+        }
+    }
+
+    Coefs m_coefs;
+    // Old coefficients and state needed for ramping
+    Coefs m_oldCoefs;
+    State m_state;
+    State m_oldState;
+
+    // Flag set to true if ramping needs to be done
+    bool m_doRamping[FILTERS];
+    // Flag set to true if old filter is invalid
+    bool m_doStart[FILTERS];
+};
+
+#endif // ENGINEFILTERIIRBANK_H
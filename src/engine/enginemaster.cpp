@@ -10,7 +10,9 @@
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
+#include "engine/callbacklatencystats.h"
 #include "engine/channelmixer.h"
+#include "engine/controlsnapshot.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginebuffer.h"
@@ -36,6 +38,7 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
                            bool bEnableSidechain)
         : m_pChannelHandleFactory(pChannelHandleFactory),
           m_pEngineEffectsManager(pEffectsManager ? pEffectsManager->getEngineEffectsManager() : NULL),
+          m_channelProcessingTask(this),
           m_masterGainOld(0.0),
           m_boothGainOld(0.0),
           m_headphoneMasterGainOld(0.0),
@@ -65,6 +68,20 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     m_bExternalRecordBroadcastInputConnected = false;
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
+    m_pThreadPool = new EngineThreadPool(
+            EngineThreadPool::defaultHelperThreadCount());
+    m_pCallbackLatencyStats = new CallbackLatencyStats(pConfig);
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->setCallbackLatencyStats(m_pCallbackLatencyStats);
+    }
+    m_pControlSnapshot = nullptr;
+    if (ControlSnapshot::isEnabled(pConfig)) {
+        m_pControlSnapshot = new ControlSnapshot(pConfig);
+        if (!m_pControlSnapshot->isOpen()) {
+            delete m_pControlSnapshot;
+            m_pControlSnapshot = nullptr;
+        }
+    }
 
     // Master sample rate
     m_pMasterSampleRate = new ControlObject(ConfigKey(group, "samplerate"), true, true);
@@ -175,6 +192,12 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     m_pKeylockEngine->set(pConfig->getValueString(
             ConfigKey(group, "keylock_engine")).toDouble());
 
+    // Parallel channel processing is opt-in. Channels are still processed
+    // serially if the machine has only a single core.
+    m_pParallelProcessing = new ControlObject(
+            ConfigKey(group, "parallel_processing"),
+            true, false, true);  // persist = true
+
     // TODO: Make this read only and make EngineMaster decide whether
     // processing the master mix is necessary.
     m_pMasterEnabled = new ControlObject(ConfigKey(group, "enabled"),
@@ -194,6 +217,7 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
 EngineMaster::~EngineMaster() {
     qDebug() << "in ~EngineMaster()";
     delete m_pKeylockEngine;
+    delete m_pParallelProcessing;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -239,6 +263,12 @@ EngineMaster::~EngineMaster() {
     }
 
     delete m_pWorkerScheduler;
+    delete m_pThreadPool;
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->setCallbackLatencyStats(nullptr);
+    }
+    delete m_pCallbackLatencyStats;
+    delete m_pControlSnapshot;
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -250,6 +280,13 @@ EngineMaster::~EngineMaster() {
     }
 }
 
+void EngineMaster::waitForBackgroundProcessing() {
+    m_pWorkerScheduler->waitForIdleWorkers();
+    if (m_pEngineSideChain) {
+        m_pEngineSideChain->waitForFreeSpace();
+    }
+}
+
 const CSAMPLE* EngineMaster::getMasterBuffer() const {
     return m_pMaster;
 }
@@ -275,6 +312,17 @@ void EngineMaster::processChannels(int iBufferSize) {
     m_activeChannels.clear();
 
     ScopedTimer timer("EngineMaster::processChannels");
+    // Sync requests change the master and the sync state of other decks, so
+    // they are handled here on the callback thread before any channel is
+    // processed. This also makes a newly requested master the first channel
+    // processed below.
+    for (int i = 0; i < m_channels.size(); ++i) {
+        EngineChannel* pChannel = m_channels[i]->m_pChannel;
+        EngineBuffer* pBuffer = pChannel ? pChannel->getEngineBuffer() : nullptr;
+        if (pBuffer) {
+            pBuffer->processSyncRequests();
+        }
+    }
     EngineChannel* pMasterChannel = m_pMasterSync->getMaster();
     // Reserve the first place for the master channel which
     // should be processed first
@@ -345,20 +393,40 @@ void EngineMaster::processChannels(int iBufferSize) {
         }
     }
 
-    // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
+    // Now that the list is built and ordered, do the processing. The sync
+    // master is always processed first on the callback thread because the
+    // other channels follow the state it publishes.
+    int firstFollowingChannel = activeChannelsStartIndex;
+    if (activeChannelsStartIndex == 0) {
+        processChannel(m_activeChannels[0], iBufferSize);
+        firstFollowingChannel = 1;
+    }
+    // Decks that take part in sync report their BPM and beat distance to
+    // EngineSync while they are processed, which changes the state of the
+    // other synced decks. They stay on the callback thread. All other
+    // channels only touch their own state and are processed concurrently.
+    // EngineThreadPool::run() returns after all of them are done, before
+    // any of the buffers are mixed.
+    // The pre-fader effects are processed together with the channels.
+    m_parallelChannels.clear();
+    const bool parallel = m_pParallelProcessing->toBool() &&
+            (!m_pEngineEffectsManager ||
+                    m_pEngineEffectsManager->supportsConcurrentChannels());
+    for (int i = firstFollowingChannel; i < m_activeChannels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+        EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+        if (parallel && (!pBuffer || pBuffer->getSyncMode() == SYNC_NONE)) {
+            m_parallelChannels.append(pChannelInfo);
+        } else {
+            processChannel(pChannelInfo, iBufferSize);
         }
     }
+    if (m_parallelChannels.size() > 1) {
+        m_channelProcessingTask.prepare(iBufferSize);
+        m_pThreadPool->run(&m_channelProcessingTask, m_parallelChannels.size());
+    } else if (m_parallelChannels.size() == 1) {
+        processChannel(m_parallelChannels[0], iBufferSize);
+    }
 
     // After all the engines have been processed, trigger post-processing
     // which ensures that all channels are updating certain values at the
@@ -370,6 +438,18 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMaster::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -395,7 +475,11 @@ void EngineMaster::process(const int iBufferSize) {
     // Update internal master sync rate.
     m_pMasterSync->onCallbackStart(m_iSampleRate, m_iBufferSize);
     // Prepare each channel for output
-    processChannels(m_iBufferSize);
+    {
+        CallbackLatencyStats::ScopedStage stage(m_pCallbackLatencyStats,
+                CallbackLatencyStats::Stage::Channels);
+        processChannels(m_iBufferSize);
+    }
     // Do internal master sync post-processing
     m_pMasterSync->onCallbackEnd(m_iSampleRate, m_iBufferSize);
 
@@ -446,13 +530,19 @@ void EngineMaster::process(const int iBufferSize) {
         }
     }
 
+    // The post-fader effects of the channels in each of the following mixes
+    // are processed concurrently like the channels themselves.
+    EngineThreadPool* pEffectsThreadPool =
+            m_pParallelProcessing->toBool() ? m_pThreadPool : nullptr;
+
     // Mix all the talkover enabled channels together.
     // Effects processing is done in place to avoid unnecessary buffer copying.
     ChannelMixer::applyEffectsInPlaceAndMixChannels(
         m_talkoverGain, &m_activeTalkoverChannels,
         &m_channelTalkoverGainCache,
         m_pTalkover, m_masterHandle.handle(),
-        m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager);
+        m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager,
+        pEffectsThreadPool);
 
     // Process effects on all microphones mixed together
     // We have no metadata for mixed effect buses, so use an empty GroupFeatureState.
@@ -491,7 +581,8 @@ void EngineMaster::process(const int iBufferSize) {
             &m_activeBusChannels[o],
             &m_channelMasterGainCache, // no [o] because the old gain follows an orientation switch
             m_pOutputBusBuffers[o], m_masterHandle.handle(),
-            m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager);
+            m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager,
+            pEffectsThreadPool);
     }
 
     // Process crossfader orientation bus channel effects
@@ -666,6 +757,8 @@ void EngineMaster::process(const int iBufferSize) {
         // so skip sending a buffer to m_pSidechain here.
         if (!m_bExternalRecordBroadcastInputConnected
             && m_pEngineSideChain != nullptr) {
+            CallbackLatencyStats::ScopedStage stage(m_pCallbackLatencyStats,
+                    CallbackLatencyStats::Stage::Sidechain);
             m_pEngineSideChain->writeSamples(m_pSidechainMix, iFrames);
         }
 
@@ -723,6 +816,10 @@ void EngineMaster::process(const int iBufferSize) {
         m_pBoothDelay->process(m_pBooth, m_iBufferSize);
     }
 
+    if (m_pControlSnapshot) {
+        m_pControlSnapshot->publish();
+    }
+
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
     m_pWorkerScheduler->runWorkers();
@@ -791,6 +888,7 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     // callback. QVarLengthArray does nothing if reserve is called with a size
     // smaller than its pre-allocation.
     m_activeChannels.reserve(m_channels.size());
+    m_parallelChannels.reserve(m_channels.size());
     m_activeBusChannels[EngineChannel::LEFT].reserve(m_channels.size());
     m_activeBusChannels[EngineChannel::CENTER].reserve(m_channels.size());
     m_activeBusChannels[EngineChannel::RIGHT].reserve(m_channels.size());
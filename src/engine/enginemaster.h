@@ -27,10 +27,13 @@
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
 #include "engine/channelhandle.h"
+#include "engine/enginethreadpool.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
 #include "recording/recordingmanager.h"
 
+class CallbackLatencyStats;
+class ControlSnapshot;
 class EngineWorkerScheduler;
 class EngineBuffer;
 class EngineChannel;
@@ -86,6 +89,11 @@ class EngineMaster : public QObject, public AudioSource {
 
     void process(const int iBufferSize);
 
+    // Blocks until the engine workers and the sidechain have caught up with
+    // the callbacks so far. Only for offline rendering, which runs process()
+    // back to back instead of racing them in realtime.
+    void waitForBackgroundProcessing();
+
     // Add an EngineChannel to the mixing engine. This is not thread safe --
     // only call it before the engine has started mixing.
     void addChannel(EngineChannel* pChannel);
@@ -123,6 +131,10 @@ class EngineMaster : public QObject, public AudioSource {
         return m_pEngineSideChain;
     }
 
+    CallbackLatencyStats* getCallbackLatencyStats() const {
+        return m_pCallbackLatencyStats;
+    }
+
     struct ChannelInfo {
         ChannelInfo(int index)
                 : m_pChannel(NULL),
@@ -271,6 +283,31 @@ class EngineMaster : public QObject, public AudioSource {
     // respective output.
     void processChannels(int iBufferSize);
 
+    // Runs EngineChannel::process for a single active channel and collects
+    // its features for effects processing. May be called concurrently for
+    // different channels from the threads of m_pThreadPool.
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
+
+    // Processes the channels in m_parallelChannels on the engine thread pool.
+    class ChannelProcessingTask : public EngineThreadPool::Task {
+      public:
+        explicit ChannelProcessingTask(EngineMaster* pMaster)
+                : m_pMaster(pMaster),
+                  m_iBufferSize(0) {
+        }
+        void prepare(int iBufferSize) {
+            m_iBufferSize = iBufferSize;
+        }
+        void run(int index) override {
+            m_pMaster->processChannel(
+                    m_pMaster->m_parallelChannels[index],
+                    m_iBufferSize);
+        }
+      private:
+        EngineMaster* const m_pMaster;
+        int m_iBufferSize;
+    };
+
     ChannelHandleFactory* m_pChannelHandleFactory;
     void applyMasterEffects();
     void processHeadphones(const double masterMixGainInHeadphones);
@@ -288,6 +325,8 @@ class EngineMaster : public QObject, public AudioSource {
 
     // Pre-allocated buffers for performing channel mixing in the callback.
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeChannels;
+    // The active channels that are not synced, processed on m_pThreadPool
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_parallelChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeBusChannels[3];
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeHeadphoneChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeTalkoverChannels;
@@ -304,6 +343,11 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pSidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    EngineThreadPool* m_pThreadPool;
+    CallbackLatencyStats* m_pCallbackLatencyStats;
+    // NULL unless enabled in the configuration
+    ControlSnapshot* m_pControlSnapshot;
+    ChannelProcessingTask m_channelProcessingTask;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -334,6 +378,9 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    // If enabled, independent channels are processed concurrently on
+    // m_pThreadPool instead of one after another in the callback thread.
+    ControlObject* m_pParallelProcessing;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
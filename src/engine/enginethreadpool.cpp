@@ -0,0 +1,166 @@
+#include "engine/enginethreadpool.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QtDebug>
+
+#include "util/assert.h"
+#include "util/denormalsarezero.h"
+#include "util/math.h"
+
+namespace {
+
+// Number of times a helper polls for new work before going to sleep. At
+// typical callback rates this keeps helpers awake between the channel
+// processing batches of a single callback without burning a core when the
+// engine is idle.
+const int kHelperSpinCount = 2000;
+
+inline void cpuRelax() {
+#ifdef __SSE__
+    _mm_pause();
+#endif
+}
+
+} // anonymous namespace
+
+class EngineThreadPool::HelperThread : public QThread {
+  public:
+    HelperThread(EngineThreadPool* pPool, int index)
+            : m_pPool(pPool),
+              m_index(index),
+              m_bQuit(false) {
+    }
+
+    // Wakes the helper to take part in the current job. Called once per job
+    // by EngineThreadPool::run().
+    void wake() {
+        m_semaRun.release();
+    }
+
+    void quit() {
+        m_bQuit.store(true);
+        m_semaRun.release();
+    }
+
+  protected:
+    void run() override {
+        setObjectName(QString("EngineHelper %1").arg(m_index));
+#ifdef __SSE__
+        // Helpers process audio on behalf of the callback thread, so they
+        // need the same floating point environment to avoid denormals.
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+        while (true) {
+            waitForWork();
+            if (m_bQuit.load()) {
+                break;
+            }
+            m_pPool->processTasks();
+            m_pPool->helperFinished();
+        }
+    }
+
+  private:
+    void waitForWork() {
+        for (int i = 0; i < kHelperSpinCount; ++i) {
+            if (m_semaRun.tryAcquire()) {
+                return;
+            }
+            cpuRelax();
+        }
+        m_semaRun.acquire();
+    }
+
+    EngineThreadPool* const m_pPool;
+    const int m_index;
+    QSemaphore m_semaRun;
+    std::atomic<bool> m_bQuit;
+};
+
+EngineThreadPool::EngineThreadPool(int numHelperThreads)
+        : m_pTask(nullptr),
+          m_taskCount(0),
+          m_nextIndex(0),
+          m_activeHelpers(0) {
+    numHelperThreads = math_clamp(numHelperThreads, 0, kMaxEngineHelperThreads);
+    m_helpers.reserve(numHelperThreads);
+    for (int i = 0; i < numHelperThreads; ++i) {
+        HelperThread* pHelper = new HelperThread(this, i);
+        pHelper->start(QThread::TimeCriticalPriority);
+        m_helpers.push_back(pHelper);
+    }
+    qDebug() << "EngineThreadPool started with" << numHelperThreads
+             << "helper threads";
+}
+
+EngineThreadPool::~EngineThreadPool() {
+    for (HelperThread* pHelper : m_helpers) {
+        pHelper->quit();
+    }
+    for (HelperThread* pHelper : m_helpers) {
+        pHelper->wait();
+        delete pHelper;
+    }
+}
+
+// static
+int EngineThreadPool::defaultHelperThreadCount() {
+    return math_clamp(QThread::idealThreadCount() - 1, 0,
+                      kMaxEngineHelperThreads);
+}
+
+void EngineThreadPool::run(Task* pTask, int count) {
+    VERIFY_OR_DEBUG_ASSERT(pTask != nullptr) {
+        return;
+    }
+    if (count <= 0) {
+        return;
+    }
+
+    // The calling thread takes one share of the work, so there is no point
+    // in waking more helpers than there are remaining tasks.
+    const int numHelpers = math_min(helperThreadCount(), count - 1);
+    if (numHelpers == 0) {
+        for (int i = 0; i < count; ++i) {
+            pTask->run(i);
+        }
+        return;
+    }
+
+    // No helper is active at this point, so the job can be published without
+    // further synchronization. Waking the helpers through their semaphores
+    // makes these writes visible to them.
+    m_pTask = pTask;
+    m_taskCount = count;
+    m_nextIndex.store(0, std::memory_order_relaxed);
+    m_activeHelpers.store(numHelpers, std::memory_order_release);
+    for (int i = 0; i < numHelpers; ++i) {
+        m_helpers[i]->wake();
+    }
+
+    processTasks();
+
+    // Join: every helper that was woken for this job has to check out before
+    // we return, both because it may still be running a task and because it
+    // must not pick up m_pTask of the next job.
+    while (m_activeHelpers.load(std::memory_order_acquire) > 0) {
+        cpuRelax();
+    }
+    m_pTask = nullptr;
+}
+
+void EngineThreadPool::processTasks() {
+    while (true) {
+        const int index = m_nextIndex.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= m_taskCount) {
+            return;
+        }
+        m_pTask->run(index);
+    }
+}
+
+void EngineThreadPool::helperFinished() {
+    m_activeHelpers.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,69 @@
+#ifndef ENGINETHREADPOOL_H
+#define ENGINETHREADPOOL_H
+
+#include <atomic>
+#include <vector>
+
+#include "util/class.h"
+
+// The maximum number of helper threads an EngineThreadPool will spawn. The
+// callback thread always takes part in the work as well.
+const int kMaxEngineHelperThreads = 7;
+
+// EngineThreadPool runs independent pieces of work from the audio callback
+// concurrently on a set of pre-spawned, time-critical helper threads and
+// blocks until all of them are finished (fork/join).
+//
+// Unlike the EngineWorkerScheduler, which runs non-realtime work after the
+// callback has completed, EngineThreadPool is meant to be used *inside* the
+// callback. run() is realtime safe: it does not allocate memory, and helper
+// threads spin for a short while before falling back to sleeping on a
+// semaphore so back-to-back jobs are handed off without a context switch.
+//
+// run() must only be called from a single thread (the engine thread) at a
+// time.
+class EngineThreadPool {
+  public:
+    // A Task is run once for every index in [0, count) passed to run().
+    // Different indices may be processed concurrently on different threads.
+    class Task {
+      public:
+        virtual ~Task() {}
+        virtual void run(int index) = 0;
+    };
+
+    explicit EngineThreadPool(int numHelperThreads);
+    virtual ~EngineThreadPool();
+
+    int helperThreadCount() const {
+        return static_cast<int>(m_helpers.size());
+    }
+
+    // Runs pTask->run(i) for every i in [0, count) and returns once all of
+    // them have completed. The calling thread takes part in the processing.
+    void run(Task* pTask, int count);
+
+    // Returns a sensible number of helper threads for this machine: one less
+    // than the number of cores, capped at kMaxEngineHelperThreads.
+    static int defaultHelperThreadCount();
+
+  private:
+    class HelperThread;
+
+    // Claims and runs task indices until none are left.
+    void processTasks();
+    void helperFinished();
+
+    std::vector<HelperThread*> m_helpers;
+
+    // The current job. Only written by run() while no helper is active.
+    Task* m_pTask;
+    int m_taskCount;
+
+    std::atomic<int> m_nextIndex;
+    std::atomic<int> m_activeHelpers;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineThreadPool);
+};
+
+#endif /* ENGINETHREADPOOL_H */
@@ -5,7 +5,9 @@
 #include "engine/engineworkerscheduler.h"
 
 EngineWorker::EngineWorker()
-    : m_pScheduler(nullptr) {
+    : m_pScheduler(nullptr),
+      m_idle(true),
+      m_finished(false) {
     m_notReady.test_and_set();
 }
 
@@ -31,6 +33,47 @@ void EngineWorker::workReady() {
 
 void EngineWorker::wakeIfReady() {
     if (!m_notReady.test_and_set()) {
+        QMutexLocker locker(&m_idleMutex);
+        if (m_finished) {
+            return;
+        }
+        m_idle = false;
         m_semaRun.release();
     }
 }
+
+void EngineWorker::waitUntilIdle() {
+    if (!isRunning()) {
+        // A worker that has not been started or has been stopped again
+        // never becomes idle
+        return;
+    }
+    wakeIfReady();
+    QMutexLocker locker(&m_idleMutex);
+    while (!m_idle) {
+        m_idleCondition.wait(&m_idleMutex);
+    }
+}
+
+void EngineWorker::waitForWork() {
+    {
+        QMutexLocker locker(&m_idleMutex);
+        if (m_semaRun.available() == 0) {
+            m_idle = true;
+            m_idleCondition.wakeAll();
+        }
+    }
+    m_semaRun.acquire();
+}
+
+void EngineWorker::markStarting() {
+    QMutexLocker locker(&m_idleMutex);
+    m_finished = false;
+}
+
+void EngineWorker::markFinished() {
+    QMutexLocker locker(&m_idleMutex);
+    m_finished = true;
+    m_idle = true;
+    m_idleCondition.wakeAll();
+}
@@ -5,9 +5,11 @@
 #define ENGINEWORKER_H
 
 #include <atomic>
+#include <QMutex>
 #include <QObject>
 #include <QSemaphore>
 #include <QThread>
+#include <QWaitCondition>
 
 // EngineWorker is an interface for running background processing work when the
 // audio callback is not active. While the audio callback is active, an
@@ -28,12 +30,38 @@ class EngineWorker : public QThread {
     void workReady();
     void wakeIfReady();
 
+    // Wakes the worker if it has work and blocks until it is done with it.
+    // Returns immediately if the thread is not running.
+    // Only for offline rendering, where the engine does not race the workers
+    // but waits for them after every callback. Never call this from the
+    // audio callback.
+    void waitUntilIdle();
+
   protected:
+    // Puts the worker thread to sleep until the next wakeIfReady() that
+    // finds new work.
+    void waitForWork();
+
+    // For workers whose run() returns by itself instead of when the
+    // worker is asked to quit: markStarting() must be called before the
+    // thread is (re)started and markFinished() right before run() returns,
+    // so waitUntilIdle() does not wait for a thread that is gone.
+    void markStarting();
+    void markFinished();
+
     QSemaphore m_semaRun;
 
   private:
     EngineWorkerScheduler* m_pScheduler;
     std::atomic_flag m_notReady;
+
+    // Guards m_idle and m_finished. The semaphore is only released with
+    // this mutex held, so a pending wake-up is never mistaken for an idle
+    // worker.
+    QMutex m_idleMutex;
+    QWaitCondition m_idleCondition;
+    bool m_idle;
+    bool m_finished;
 };
 
 #endif /* ENGINEWORKER_H */
@@ -31,14 +31,26 @@ void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
 
 void EngineWorkerScheduler::runWorkers() {
     // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
+    // scheduler. workerReady may also be called concurrently from the helper
+    // threads of the engine, so the flag is taken atomically and a worker
+    // that becomes ready meanwhile is woken up by the next callback.
+    if (m_bWakeScheduler.exchange(false)) {
         m_waitCondition.wakeAll();
     }
 }
 
+void EngineWorkerScheduler::waitForIdleWorkers() {
+    std::vector<EngineWorker*> workers;
+    {
+        QMutexLocker locker(&m_mutex);
+        workers = m_workers;
+    }
+    // Waiting without holding m_mutex keeps the scheduler thread running
+    for (const auto& pWorker: workers) {
+        pWorker->waitUntilIdle();
+    }
+}
+
 void EngineWorkerScheduler::run() {
     while (!m_bQuit) {
         Event::start("EngineWorkerScheduler");
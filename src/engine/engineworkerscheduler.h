@@ -1,6 +1,8 @@
 #ifndef ENGINEWORKERSCHEDULER_H
 #define ENGINEWORKERSCHEDULER_H
 
+#include <atomic>
+
 #include <QMutex>
 #include <QThreadPool>
 #include <QWaitCondition>
@@ -22,14 +24,18 @@ class EngineWorkerScheduler : public QThread {
     void addWorker(EngineWorker* pWorker);
     void runWorkers();
     void workerReady();
+    // Blocks until all workers are done with the work they have been woken
+    // up for. See EngineWorker::waitUntilIdle().
+    void waitForIdleWorkers();
 
   protected:
     void run();
 
   private:
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run. Set by the callback thread and by the helper
+    // threads that process channels, cleared by the callback thread.
+    std::atomic<bool> m_bWakeScheduler;
 
     std::vector<EngineWorker*> m_workers;
 
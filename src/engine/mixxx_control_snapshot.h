@@ -0,0 +1,120 @@
+/*
+ * Layout of the shared memory snapshot of control values that Mixxx
+ * publishes for local tools, e.g. lighting or visualizers. Plain C99, so it
+ * can be copied into any project. Only GCC and Clang are supported, because
+ * the reader uses their __atomic builtins.
+ *
+ * Mixxx creates the POSIX shared memory object MIXXX_CONTROL_SNAPSHOT_NAME
+ * (or the name configured as [ControlSnapshot],name) when
+ * [ControlSnapshot],enabled is set to 1 in mixxx.cfg. It overwrites the
+ * values after every audio callback. The published controls are configured
+ * as [ControlSnapshot],controls, a list like
+ *   [Channel1],playposition;[Channel1],bpm;[Master],VuMeterL
+ *
+ * A reader maps the object read-only and copies the values with
+ * mixxx_control_snapshot_read():
+ *
+ *   int fd = shm_open(MIXXX_CONTROL_SNAPSHOT_NAME, O_RDONLY, 0);
+ *   const mixxx_control_snapshot* s = mmap(NULL,
+ *           sizeof(mixxx_control_snapshot), PROT_READ, MAP_SHARED, fd, 0);
+ *   int bpm = mixxx_control_snapshot_find(s, "[Channel1]", "bpm");
+ *   double values[MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS];
+ *   uint64_t time_ns;
+ *   if (mixxx_control_snapshot_read(s, values, &time_ns) && bpm >= 0) {
+ *       printf("%f\n", values[bpm]);
+ *   }
+ *
+ * When Mixxx exits it clears magic and unlinks the object. A reader that
+ * outlives Mixxx should map the object again when
+ * mixxx_control_snapshot_valid() fails.
+ */
+
+#ifndef MIXXX_CONTROL_SNAPSHOT_H
+#define MIXXX_CONTROL_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define MIXXX_CONTROL_SNAPSHOT_NAME "/mixxx-controls"
+/* "MXCS" */
+#define MIXXX_CONTROL_SNAPSHOT_MAGIC 0x4d584353u
+#define MIXXX_CONTROL_SNAPSHOT_VERSION 1u
+#define MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS 256
+#define MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH 64
+
+typedef struct {
+    /* NUL terminated, e.g. "[Channel1]" and "playposition" */
+    char group[MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH];
+    char item[MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH];
+} mixxx_control_snapshot_key;
+
+typedef struct mixxx_control_snapshot {
+    /* Set last, after the keys, when Mixxx has initialized the snapshot */
+    uint32_t magic;
+    uint32_t version;
+    /* The number of published controls, fixed while Mixxx is running */
+    uint32_t control_count;
+    uint32_t reserved;
+    /* Odd while Mixxx writes the values. Incremented by 2 per update. */
+    uint64_t sequence;
+    /* CLOCK_MONOTONIC time of the last update in nanoseconds */
+    uint64_t time_ns;
+    mixxx_control_snapshot_key keys[MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS];
+    /* 0 for controls that do not exist (yet) */
+    double values[MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS];
+} mixxx_control_snapshot;
+
+/* Returns whether the snapshot has been initialized by a compatible Mixxx */
+static inline int mixxx_control_snapshot_valid(const mixxx_control_snapshot* s) {
+    return __atomic_load_n(&s->magic, __ATOMIC_ACQUIRE) ==
+                    MIXXX_CONTROL_SNAPSHOT_MAGIC &&
+            s->version == MIXXX_CONTROL_SNAPSHOT_VERSION;
+}
+
+/* Returns the index of a control in values or -1 if it is not published */
+static inline int mixxx_control_snapshot_find(const mixxx_control_snapshot* s,
+        const char* group, const char* item) {
+    uint32_t i;
+    if (!mixxx_control_snapshot_valid(s)) {
+        return -1;
+    }
+    for (i = 0; i < s->control_count; ++i) {
+        if (strncmp(s->keys[i].group, group, MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH) == 0 &&
+                strncmp(s->keys[i].item, item, MIXXX_CONTROL_SNAPSHOT_KEY_LENGTH) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* Copies the control_count values of one update into values and its time
+ * into time_ns (may be NULL). Retries while Mixxx is writing, which takes
+ * well below a microsecond. Returns 0 if the snapshot is not valid. */
+static inline int mixxx_control_snapshot_read(const mixxx_control_snapshot* s,
+        double* values, uint64_t* time_ns) {
+    uint64_t begin;
+    uint64_t end;
+    uint64_t time;
+    uint32_t i;
+    if (!mixxx_control_snapshot_valid(s)) {
+        return 0;
+    }
+    do {
+        begin = __atomic_load_n(&s->sequence, __ATOMIC_ACQUIRE);
+        if (begin & 1) {
+            continue;
+        }
+        for (i = 0; i < s->control_count; ++i) {
+            __atomic_load(&s->values[i], &values[i], __ATOMIC_RELAXED);
+        }
+        time = __atomic_load_n(&s->time_ns, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&s->sequence, __ATOMIC_RELAXED);
+    } while ((begin & 1) || begin != end);
+    if (time_ns) {
+        *time_ns = time;
+    }
+    return 1;
+}
+
+#endif /* MIXXX_CONTROL_SNAPSHOT_H */
@@ -12,13 +12,25 @@
 
 static const int kNumChannels = 2;
 
+// SoundTouch can read up to 2 chunks ahead. Always keep 2 chunks ahead in
+// cache when playing at the native rate.
+static const SINT kMinImminentFrameCount = 2 * CachingReaderChunk::kFrames;
+// Limits the frames hinted with the highest priority at high rates
+static const SINT kMaxImminentFrameCount = 8 * CachingReaderChunk::kFrames;
+// The number of callbacks at the current demand of the scaler for which
+// the samples should be available
+static const int kImminentCallbackCount = 16;
+// Scratching a paused deck may go in either direction
+static const SINT kPausedFrameCount = CachingReaderChunk::kFrames;
+
 ReadAheadManager::ReadAheadManager()
         : m_pLoopingControl(NULL),
           m_pRateControl(NULL),
           m_currentPosition(0),
           m_pReader(NULL),
           m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
-          m_cacheMissHappened(false) {
+          m_cacheMissHappened(false),
+          m_samplesReadSinceHint(0) {
     // For testing only: ReadAheadManagerMock
 }
 
@@ -29,7 +41,8 @@ ReadAheadManager::ReadAheadManager(CachingReader* pReader,
           m_currentPosition(0),
           m_pReader(pReader),
           m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
-          m_cacheMissHappened(false) {
+          m_cacheMissHappened(false),
+          m_samplesReadSinceHint(0) {
     DEBUG_ASSERT(m_pLoopingControl != NULL);
     DEBUG_ASSERT(m_pReader != NULL);
 }
@@ -88,6 +101,7 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
 
     const auto readResult = m_pReader->read(
             start_sample, samples_from_reader, in_reverse, pOutput);
+    m_samplesReadSinceHint += samples_from_reader;
     if (readResult == CachingReader::ReadResult::UNAVAILABLE) {
         // Cache miss - no samples written
         SampleUtil::clear(pOutput, samples_from_reader);
@@ -185,11 +199,35 @@ void ReadAheadManager::notifySeek(double seekPosition) {
 
 void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     bool in_reverse = dRate < 0;
+
+    // The frames that the scaler has consumed during the last callback,
+    // including the additional input that e.g. RubberBand requests
+    const SINT demandFrameCount = m_samplesReadSinceHint / kNumChannels;
+    m_samplesReadSinceHint = 0;
+
     Hint current_position;
+    // top priority, we need to read this data immediately
+    current_position.priority = Hint::kPriorityImminent;
+
+    if (dRate == 0 && demandFrameCount == 0) {
+        // Paused
+        current_position.frame =
+                static_cast<SINT>(floor(m_currentPosition / kNumChannels)) -
+                kPausedFrameCount / 2;
+        current_position.frameCount = kPausedFrameCount;
+        if (current_position.frame + current_position.frameCount >= 0) {
+            pHintList->append(current_position);
+        }
+        return;
+    }
 
-    // SoundTouch can read up to 2 chunks ahead. Always keep 2 chunks ahead in
-    // cache.
-    SINT frameCountToCache = 2 * CachingReaderChunk::kFrames;
+    // Scale the window with the rate and the demand of the scaler
+    const SINT frameCountToCache = math_clamp(
+            math_max(
+                    static_cast<SINT>(kMinImminentFrameCount * fabs(dRate)),
+                    kImminentCallbackCount * demandFrameCount),
+            kMinImminentFrameCount,
+            kMaxImminentFrameCount);
     current_position.frameCount = frameCountToCache;
 
     // this called after the precious chunk was consumed
@@ -209,10 +247,21 @@ void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     {
     	return;
     }
-
-    // top priority, we need to read this data immediately
-    current_position.priority = 1;
     pHintList->append(current_position);
+
+    // The same number of frames beyond, which are read when nothing
+    // imminent is pending and cancelled after a seek
+    Hint lookahead;
+    lookahead.priority = Hint::kPriorityLookahead;
+    lookahead.frameCount = frameCountToCache;
+    if (in_reverse) {
+        lookahead.frame = current_position.frame - frameCountToCache;
+    } else {
+        lookahead.frame = current_position.frame + frameCountToCache;
+    }
+    if (lookahead.frame + lookahead.frameCount >= 0) {
+        pHintList->append(lookahead);
+    }
 }
 
 // Not thread-save, call from engine thread only
@@ -53,7 +53,11 @@ class ReadAheadManager {
     virtual void notifySeek(double seekPosition);
 
     // hintReader allows the ReadAheadManager to provide hints to the reader to
-    // indicate that the given portion of a song is about to be read.
+    // indicate that the given portion of a song is about to be read. The
+    // hinted window grows with the rate and with the number of samples that
+    // the scaler has requested since the last call, i.e. it follows where
+    // playback will be in the next callbacks. When paused only the samples
+    // around the play position are hinted.
     virtual void hintReader(double dRate, HintVector* hintList);
 
     virtual double getFilePlaypositionFromLog(double currentFilePlayposition,
@@ -126,6 +130,8 @@ class ReadAheadManager {
     CachingReader* m_pReader;
     CSAMPLE* m_pCrossFadeBuffer;
     bool m_cacheMissHappened;
+    // The samples read by getNextSamples() since the last hintReader()
+    SINT m_samplesReadSinceHint;
 };
 
 #endif // READAHEADMANGER_H
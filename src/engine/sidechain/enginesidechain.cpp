@@ -40,7 +40,8 @@ EngineSideChain::EngineSideChain(UserSettingsPointer pConfig)
         : m_pConfig(pConfig),
           m_bStopThread(false),
           m_sampleFifo(SIDECHAIN_BUFFER_SIZE),
-          m_pWorkBuffer(SampleUtil::alloc(SIDECHAIN_BUFFER_SIZE)) {
+          m_pWorkBuffer(SampleUtil::alloc(SIDECHAIN_BUFFER_SIZE)),
+          m_bWaitingForFreeSpace(false) {
     // We use HighPriority to prevent starvation by lower-priority processes (Qt
     // main thread, analysis, etc.). This used to be LowPriority but that is not
     // a suitable choice since we do semi-realtime tasks
@@ -103,6 +104,19 @@ void EngineSideChain::writeSamples(const CSAMPLE* pBuffer, int iFrames) {
     }
 }
 
+void EngineSideChain::waitForFreeSpace() {
+    QMutexLocker locker(&m_waitLock);
+    m_bWaitingForFreeSpace = true;
+    while (m_sampleFifo.writeAvailable() < SIDECHAIN_BUFFER_SIZE / 2) {
+        // writeSamples() only wakes the sidechain thread once the FIFO is
+        // almost full. The sidechain thread signals m_waitForFreeSpace with
+        // m_waitLock held, so the signal cannot get lost.
+        m_waitForSamples.wakeAll();
+        m_waitForFreeSpace.wait(&m_waitLock);
+    }
+    m_bWaitingForFreeSpace = false;
+}
+
 void EngineSideChain::run() {
     // the id of this thread, for debugging purposes //XXX copypasta (should
     // factor this out somehow), -kousu 2/2009
@@ -115,7 +129,11 @@ void EngineSideChain::run() {
         m_waitLock.lock();
 
         Event::end("EngineSideChain");
-        m_waitForSamples.wait(&m_waitLock);
+        // waitForFreeSpace() may have tried to wake this thread before it
+        // was waiting. Do not sleep then.
+        if (!m_bWaitingForFreeSpace || m_sampleFifo.readAvailable() == 0) {
+            m_waitForSamples.wait(&m_waitLock);
+        }
         m_waitLock.unlock();
         Event::start("EngineSideChain");
 
@@ -123,6 +141,11 @@ void EngineSideChain::run() {
         while ((samples_read = m_sampleFifo.read(m_pWorkBuffer,
                                                  SIDECHAIN_BUFFER_SIZE))) {
             Trace process("EngineSideChain::process");
+            {
+                // For waitForFreeSpace()
+                QMutexLocker locker(&m_waitLock);
+                m_waitForFreeSpace.wakeAll();
+            }
             MMutexLocker locker(&m_workerLock);
             foreach (SideChainWorker* pWorker, m_workers) {
                 pWorker->process(m_pWorkBuffer, samples_read);
@@ -40,6 +40,11 @@ class EngineSideChain : public QThread, public AudioDestination {
     // the engine callback).
     void writeSamples(const CSAMPLE* pBuffer, int iFrames);
 
+    // Blocks until the sidechain thread has freed at least half of the
+    // sample FIFO. Only for offline rendering, where the engine runs faster
+    // than realtime and would overrun the FIFO otherwise.
+    void waitForFreeSpace();
+
     // Thin wrapper around writeSamples that is used by SoundManager when receiving
     // from a sound card input instead of the engine
     void receiveBuffer(AudioInput input,
@@ -59,10 +64,14 @@ class EngineSideChain : public QThread, public AudioDestination {
     FIFO<CSAMPLE> m_sampleFifo;
     CSAMPLE* m_pWorkBuffer;
 
-    // Provides thread safety around the wait condition below.
+    // Provides thread safety around the wait conditions below.
     QMutex m_waitLock;
     // Allows sleeping until we have samples to process.
     QWaitCondition m_waitForSamples;
+    // Signaled by the sidechain thread whenever it has read from the FIFO.
+    QWaitCondition m_waitForFreeSpace;
+    // Set while waitForFreeSpace() waits for the sidechain thread.
+    bool m_bWaitingForFreeSpace;
 
     // Sidechain workers registered with EngineSideChain.
     MMutex m_workerLock;
@@ -1,3 +1,4 @@
+#include <QCryptographicHash>
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QSqlError>
@@ -17,11 +18,15 @@ const QString AnalysisDao::s_analysisTableName = "track_analysis";
 // CPU time so I think we should stick with the default. rryan 4/3/2012
 const int kCompressionLevel = -1;
 
+const QString kSeekIndexDirectory = "seekindex";
+
 AnalysisDao::AnalysisDao(UserSettingsPointer pConfig)
         : m_pConfig(pConfig) {
     QDir storagePath = getAnalysisStoragePath();
     if (!QDir().mkpath(storagePath.absolutePath())) {
         qDebug() << "WARNING: Could not create analysis storage path. Mixxx will be unable to store analyses.";
+    } else if (!storagePath.mkpath(kSeekIndexDirectory)) {
+        qDebug() << "WARNING: Could not create seek index storage path.";
     }
 }
 
@@ -251,6 +256,25 @@ QDir AnalysisDao::getAnalysisStoragePath() const {
     return dir.absolutePath().append("/");
 }
 
+QString AnalysisDao::getSeekIndexFilePath(const QString& key) const {
+    QDir dir(getAnalysisStoragePath().absoluteFilePath(kSeekIndexDirectory));
+    return dir.absoluteFilePath(QString(QCryptographicHash::hash(
+            key.toUtf8(), QCryptographicHash::Sha1).toHex()));
+}
+
+QByteArray AnalysisDao::loadSeekIndex(const QString& key) const {
+    return loadDataFromFile(getSeekIndexFilePath(key));
+}
+
+bool AnalysisDao::saveSeekIndex(const QString& key, const QByteArray& data) const {
+    const QString dataPath = getSeekIndexFilePath(key);
+    if (!saveDataToFile(dataPath, data)) {
+        qDebug() << "WARNING: Couldn't save seek index to file" << dataPath;
+        return false;
+    }
+    return true;
+}
+
 QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
     QFile file(filename);
     if (!file.exists()) {
@@ -7,6 +7,7 @@
 
 #include "preferences/usersettings.h"
 #include "library/dao/dao.h"
+#include "sources/seekindexstore.h"
 #include "track/trackid.h"
 #include "waveform/waveform.h"
 
@@ -62,8 +63,16 @@ class AnalysisDao : public DAO {
             ConstWaveformPointer pWaveform,
             ConstWaveformPointer pWaveSummary);
 
+    // The seek indices of sound sources are stored in files next to the
+    // analyses, but keyed by the location of the track file instead of a
+    // track id. They are accessed without a database connection from any
+    // thread, see mixxx::SeekIndexStore.
+    QByteArray loadSeekIndex(const QString& key) const;
+    bool saveSeekIndex(const QString& key, const QByteArray& data) const;
+
   private:
     QDir getAnalysisStoragePath() const;
+    QString getSeekIndexFilePath(const QString& key) const;
     QByteArray loadDataFromFile(const QString& fileName) const;
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
     bool deleteFile(const QString& filename) const;
@@ -73,4 +82,23 @@ class AnalysisDao : public DAO {
     QSqlDatabase m_db;
 };
 
+// Provides the seek index storage of the AnalysisDao to all SoundSources
+class AnalysisDaoSeekIndexStore : public mixxx::SeekIndexStore {
+  public:
+    explicit AnalysisDaoSeekIndexStore(UserSettingsPointer pConfig)
+            : m_analysisDao(pConfig) {
+    }
+
+    QByteArray loadSeekIndex(const QString& key) const override {
+        return m_analysisDao.loadSeekIndex(key);
+    }
+
+    bool saveSeekIndex(const QString& key, const QByteArray& data) override {
+        return m_analysisDao.saveSeekIndex(key, data);
+    }
+
+  private:
+    const AnalysisDao m_analysisDao;
+};
+
 #endif // ANALYSISDAO_H
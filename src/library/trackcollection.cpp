@@ -21,12 +21,15 @@ TrackCollection::TrackCollection(
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
                      m_analysisDao, m_libraryHashDao, pConfig) {
+    mixxx::SeekIndexStore::setInstance(
+            std::make_shared<AnalysisDaoSeekIndexStore>(pConfig));
 }
 
 TrackCollection::~TrackCollection() {
     if (kLogger.debugEnabled()) {
         kLogger.debug() << "~TrackCollection()";
     }
+    mixxx::SeekIndexStore::setInstance(nullptr);
     // The database should have been detached earlier
     DEBUG_ASSERT(!m_database.isOpen());
 }
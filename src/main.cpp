@@ -25,11 +25,13 @@
 
 #include "mixxx.h"
 #include "mixxxapplication.h"
+#include "offlinerenderer.h"
 #include "sources/soundsourceproxy.h"
 #include "errordialoghandler.h"
 #include "util/cmdlineargs.h"
 #include "util/console.h"
 #include "util/logging.h"
+#include "util/sample.h"
 #include "util/version.h"
 
 #ifdef Q_OS_LINUX
@@ -55,6 +57,11 @@ int runMixxx(MixxxApplication* app, const CmdlineArgs& args) {
     return result;
 }
 
+int runOfflineRender(const CmdlineArgs& args) {
+    OfflineRenderer renderer(args);
+    return renderer.render();
+}
+
 } // anonymous namespace
 
 int main(int argc, char * argv[]) {
@@ -88,6 +95,14 @@ int main(int argc, char * argv[]) {
         return 0;
     }
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    // Rendering does not open any windows, so it must not require a display
+    // on servers without one.
+    if (args.getRenderEnabled() && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#endif
+
     // If you change this here, you also need to change it in
     // ErrorDialogHandler::errorDialog(). TODO(XXX): Remove this hack.
     QThread::currentThread()->setObjectName("Main");
@@ -102,6 +117,8 @@ int main(int argc, char * argv[]) {
                                args.getLogFlushLevel(),
                                args.getDebugAssertBreak());
 
+    SampleUtil::initialize();
+
     MixxxApplication app(argc, argv);
 
     // Support utf-8 for all translation strings. Not supported in Qt 5.
@@ -133,7 +150,12 @@ int main(int argc, char * argv[]) {
     // When the last window is closed, terminate the Qt event loop.
     QObject::connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
 
-    int result = runMixxx(&app, args);
+    int result;
+    if (args.getRenderEnabled()) {
+        result = runOfflineRender(args);
+    } else {
+        result = runMixxx(&app, args);
+    }
 
     qDebug() << "Mixxx shutdown complete with code" << result;
 
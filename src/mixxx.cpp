@@ -158,8 +158,8 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
 
     Version::logBuildDetails();
 
-    // Only record stats in developer mode.
-    if (m_cmdLineArgs.getDeveloper()) {
+    // Only record stats in developer mode or when tracing controls.
+    if (m_cmdLineArgs.getDeveloper() || m_cmdLineArgs.getControlTraceEnabled()) {
         StatsManager::createInstance();
     }
 
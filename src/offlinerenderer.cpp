@@ -0,0 +1,362 @@
+#include "offlinerenderer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sndfile.h>
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QStringList>
+
+#include "control/controlobject.h"
+#include "effects/builtin/builtinbackend.h"
+#include "effects/effectsmanager.h"
+#ifdef __LILV__
+#include "effects/lv2/lv2backend.h"
+#endif
+#include "engine/channelhandle.h"
+#include "engine/enginemaster.h"
+#include "mixer/basetrackplayer.h"
+#include "mixer/playerinfo.h"
+#include "mixer/playermanager.h"
+#include "preferences/settingsmanager.h"
+#include "recording/recordingmanager.h"
+#include "soundio/sounddeviceoffline.h"
+#include "soundio/soundmanager.h"
+#include "soundio/soundmanagerconfig.h"
+#include "soundio/soundmanagerutil.h"
+#include "sources/soundsourceproxy.h"
+#include "util/cmdlineargs.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/sandbox.h"
+#include "waveform/guitick.h"
+
+namespace {
+
+const mixxx::Logger kLogger("OfflineRenderer");
+
+const QRegExp kWhitespace("\\s+");
+
+SINT framesForSeconds(double seconds, double sampleRate) {
+    return static_cast<SINT>(seconds * sampleRate);
+}
+
+} // anonymous namespace
+
+// Same as in MixxxMainWindow
+const int OfflineRenderer::kMicrophoneCount = 4;
+const int OfflineRenderer::kAuxiliaryCount = 4;
+
+OfflineRenderer::OfflineRenderer(const CmdlineArgs& args)
+        : m_cmdLineArgs(args),
+          m_pSettingsManager(nullptr),
+          m_pChannelHandleFactory(nullptr),
+          m_pEffectsManager(nullptr),
+          m_pEngine(nullptr),
+          m_pSoundManager(nullptr),
+          m_pRecordingManager(nullptr),
+          m_pGuiTick(nullptr),
+          m_pPlayerManager(nullptr),
+          m_pSoundDevice(nullptr) {
+    // The engine is set up in the same order as in
+    // MixxxMainWindow::initialize(), leaving out everything that is only
+    // needed for the GUI, the library and controllers.
+    m_pSettingsManager = new SettingsManager(nullptr, args.getSettingsPath());
+    UserSettingsPointer pConfig = m_pSettingsManager->settings();
+
+    Sandbox::initialize(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
+
+    m_pChannelHandleFactory = new ChannelHandleFactory();
+    m_pEffectsManager = new EffectsManager(nullptr, pConfig,
+            m_pChannelHandleFactory);
+    m_pEngine = new EngineMaster(pConfig, "[Master]", m_pEffectsManager,
+                                 m_pChannelHandleFactory, true);
+
+    m_pEffectsManager->addEffectsBackend(
+            new BuiltInBackend(m_pEffectsManager));
+#ifdef __LILV__
+    m_pEffectsManager->addEffectsBackend(new LV2Backend(m_pEffectsManager));
+#endif
+    m_pEffectsManager->setup();
+
+    m_pSoundManager = new SoundManager(pConfig, m_pEngine);
+    m_pEngine->registerNonEngineChannelSoundIO(m_pSoundManager);
+
+    m_pRecordingManager = new RecordingManager(pConfig, m_pEngine);
+
+    // Needs to be created before CueControl (decks).
+    m_pGuiTick = new GuiTick();
+
+    m_pPlayerManager = new PlayerManager(pConfig, m_pSoundManager,
+                                         m_pEffectsManager, m_pEngine);
+    for (int i = 0; i < kMicrophoneCount; ++i) {
+        m_pPlayerManager->addMicrophone();
+    }
+    for (int i = 0; i < kAuxiliaryCount; ++i) {
+        m_pPlayerManager->addAuxiliary();
+    }
+    m_pPlayerManager->addConfiguredDecks();
+    m_pPlayerManager->addSampler();
+    m_pPlayerManager->addSampler();
+    m_pPlayerManager->addSampler();
+    m_pPlayerManager->addSampler();
+    m_pPlayerManager->addPreviewDeck();
+
+    m_pEffectsManager->loadEffectChains();
+
+    // Render with the sample rate and the buffer size of the sound hardware
+    // configuration, so the engine behaves like it does when playing live.
+    // Only the master output is connected.
+    const SoundManagerConfig soundConfig = m_pSoundManager->getConfig();
+    m_pSoundDevice = new SoundDeviceOffline(pConfig, m_pSoundManager);
+    m_pSoundDevice->setSampleRate(soundConfig.getSampleRate());
+    m_pSoundDevice->setFramesPerBuffer(soundConfig.getFramesPerBuffer());
+    const AudioOutput masterOutput(AudioOutput::MASTER, 0, 2);
+    m_pSoundDevice->addOutput(AudioOutputBuffer(masterOutput,
+            m_pEngine->buffer(masterOutput)));
+    m_pEngine->onOutputConnected(masterOutput);
+    m_pSoundDevice->open(true, 0);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    // Same order as in MixxxMainWindow::finalize()
+    delete m_pSoundDevice;
+    delete m_pSoundManager;
+    delete m_pPlayerManager;
+    delete m_pRecordingManager;
+    delete m_pEngine;
+    delete m_pEffectsManager;
+    delete m_pChannelHandleFactory;
+    PlayerInfo::destroy();
+    delete m_pGuiTick;
+    Sandbox::shutdown();
+    delete m_pSettingsManager;
+}
+
+// static
+bool OfflineRenderer::parseScript(const QString& script,
+        QList<RenderEvent>* pEvents,
+        QString* pErrorMessage) {
+    QList<RenderEvent> events;
+    bool hasStop = false;
+    const QStringList lines = script.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines[i].trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList tokens = line.split(kWhitespace);
+        RenderEvent event;
+        bool ok = false;
+        event.seconds = tokens[0].toDouble(&ok);
+        if (!ok || event.seconds < 0) {
+            *pErrorMessage = QString("Line %1: Invalid time \"%2\"")
+                    .arg(i + 1).arg(tokens[0]);
+            return false;
+        }
+        const QString eventName = tokens.value(1);
+        if (eventName == "set" && tokens.size() == 5) {
+            event.type = RenderEvent::Type::Set;
+            event.group = tokens[2];
+            event.item = tokens[3];
+            event.value = tokens[4].toDouble(&ok);
+            if (!ok) {
+                *pErrorMessage = QString("Line %1: Invalid value \"%2\"")
+                        .arg(i + 1).arg(tokens[4]);
+                return false;
+            }
+        } else if (eventName == "load" && tokens.size() >= 4) {
+            event.type = RenderEvent::Type::Load;
+            event.group = tokens[2];
+            // The location may contain whitespace
+            event.location = line.section(kWhitespace, 3);
+        } else if (eventName == "stop" && tokens.size() == 2) {
+            event.type = RenderEvent::Type::Stop;
+            hasStop = true;
+        } else {
+            *pErrorMessage = QString("Line %1: Invalid event \"%2\"")
+                    .arg(i + 1).arg(line);
+            return false;
+        }
+        events.append(event);
+    }
+    if (!hasStop) {
+        *pErrorMessage = QString("The script has no stop event");
+        return false;
+    }
+    std::stable_sort(events.begin(), events.end(),
+            [](const RenderEvent& a, const RenderEvent& b) {
+                return a.seconds < b.seconds;
+            });
+    *pEvents = events;
+    return true;
+}
+
+int OfflineRenderer::render() {
+    const QString& scriptPath = m_cmdLineArgs.getRenderScriptPath();
+    QFile scriptFile(scriptPath);
+    if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        kLogger.critical() << "Failed to open render script" << scriptPath;
+        return 1;
+    }
+    QList<RenderEvent> events;
+    QString errorMessage;
+    if (!parseScript(QString::fromUtf8(scriptFile.readAll()), &events,
+            &errorMessage)) {
+        kLogger.critical() << scriptPath << errorMessage;
+        return 1;
+    }
+
+    const SoundManagerConfig soundConfig = m_pSoundManager->getConfig();
+    const double sampleRate = soundConfig.getSampleRate();
+    const SINT framesPerBuffer = soundConfig.getFramesPerBuffer();
+    const int numChannels = m_pSoundDevice->getNumOutputChannels();
+
+    SINT stopFrame = 0;
+    for (const RenderEvent& event: events) {
+        if (event.type == RenderEvent::Type::Stop) {
+            stopFrame = framesForSeconds(event.seconds, sampleRate);
+            break;
+        }
+    }
+
+    // Without an output file the render only measures the throughput
+    SNDFILE* pSndfile = nullptr;
+    const QString& outputPath = m_cmdLineArgs.getRenderOutputPath();
+    if (!outputPath.isEmpty()) {
+        SF_INFO sfInfo;
+        memset(&sfInfo, 0, sizeof(sfInfo));
+        sfInfo.samplerate = static_cast<int>(sampleRate);
+        sfInfo.channels = numChannels;
+        // Float samples keep the headroom of the engine above 0 dBFS
+        sfInfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+        pSndfile = sf_open(outputPath.toLocal8Bit().constData(), SFM_WRITE,
+                &sfInfo);
+        if (!pSndfile) {
+            kLogger.critical() << "Failed to open" << outputPath
+                               << "for writing:" << sf_strerror(nullptr);
+            return 1;
+        }
+    }
+
+    kLogger.info() << "Rendering" << scriptPath << "with" << framesPerBuffer
+                   << "frames per buffer at" << sampleRate << "Hz";
+
+    int result = 0;
+    int nextEvent = 0;
+    SINT renderedFrames = 0;
+    PerformanceTimer timer;
+    timer.start();
+    while (renderedFrames < stopFrame) {
+        // Events take effect at the start of the first callback that
+        // begins at or after their time.
+        while (nextEvent < events.size() &&
+                framesForSeconds(events[nextEvent].seconds, sampleRate)
+                        <= renderedFrames) {
+            if (!applyEvent(events[nextEvent], &errorMessage)) {
+                kLogger.critical() << errorMessage;
+                result = 1;
+                break;
+            }
+            ++nextEvent;
+        }
+        if (result != 0) {
+            break;
+        }
+
+        const CSAMPLE* pOutput = m_pSoundDevice->process();
+        const SINT frames = math_min(framesPerBuffer,
+                stopFrame - renderedFrames);
+        if (pSndfile && sf_writef_float(pSndfile, pOutput, frames) != frames) {
+            kLogger.critical() << "Failed to write to" << outputPath << ":"
+                               << sf_strerror(pSndfile);
+            result = 1;
+            break;
+        }
+        renderedFrames += frames;
+
+        // Instead of racing the reader threads and the sidechain like the
+        // realtime devices do, wait until they have caught up, so nothing is
+        // dropped no matter how fast the engine runs. Then deliver the queued
+        // signals that the main thread would have received in the meantime.
+        m_pEngine->waitForBackgroundProcessing();
+        QCoreApplication::processEvents();
+    }
+    const mixxx::Duration elapsed = timer.elapsed();
+
+    if (pSndfile) {
+        sf_close(pSndfile);
+    }
+    if (result != 0) {
+        return result;
+    }
+
+    const double renderedSeconds = renderedFrames / sampleRate;
+    const double elapsedSeconds = elapsed.toDoubleSeconds();
+    fprintf(stdout, "Rendered %.3f s of audio in %.3f s (%.1fx realtime)\n",
+            renderedSeconds, elapsedSeconds,
+            elapsedSeconds > 0 ? renderedSeconds / elapsedSeconds : 0.0);
+    return 0;
+}
+
+bool OfflineRenderer::applyEvent(const RenderEvent& event,
+        QString* pErrorMessage) {
+    switch (event.type) {
+    case RenderEvent::Type::Set: {
+        ControlObject* pControl = ControlObject::getControl(
+                ConfigKey(event.group, event.item), false);
+        if (!pControl) {
+            *pErrorMessage = QString("Unknown control %1, %2")
+                    .arg(event.group, event.item);
+            return false;
+        }
+        pControl->set(event.value);
+        return true;
+    }
+    case RenderEvent::Type::Load:
+        return loadTrack(event, pErrorMessage);
+    case RenderEvent::Type::Stop:
+        return true;
+    }
+    return true;
+}
+
+bool OfflineRenderer::loadTrack(const RenderEvent& event,
+        QString* pErrorMessage) {
+    BaseTrackPlayer* pPlayer = m_pPlayerManager->getPlayer(event.group);
+    if (!pPlayer) {
+        *pErrorMessage = QString("Unknown player %1").arg(event.group);
+        return false;
+    }
+    const QFileInfo fileInfo(event.location);
+    if (!fileInfo.exists()) {
+        *pErrorMessage = QString("File not found: %1").arg(event.location);
+        return false;
+    }
+    TrackPointer pTrack = SoundSourceProxy::importTemporaryTrack(fileInfo);
+    if (!pTrack) {
+        *pErrorMessage = QString("Failed to import %1").arg(event.location);
+        return false;
+    }
+
+    pPlayer->slotLoadTrack(pTrack, false);
+    // The track is opened by the reader thread of the deck. Wait for it and
+    // deliver the queued notifications of the player, so the track is ready
+    // when the next callback starts.
+    m_pEngine->waitForBackgroundProcessing();
+    QCoreApplication::processEvents();
+    if (pPlayer->getLoadedTrack() != pTrack) {
+        *pErrorMessage = QString("Failed to load %1 into %2")
+                .arg(event.location, event.group);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include <QList>
+#include <QString>
+
+#include "preferences/usersettings.h"
+#include "util/types.h"
+
+class ChannelHandleFactory;
+class CmdlineArgs;
+class EffectsManager;
+class EngineMaster;
+class GuiTick;
+class PlayerManager;
+class RecordingManager;
+class SettingsManager;
+class SoundDeviceOffline;
+class SoundManager;
+
+// A single action of a render script, see OfflineRenderer::parseScript().
+struct RenderEvent {
+    enum class Type {
+        Set,
+        Load,
+        Stop,
+    };
+
+    RenderEvent()
+            : type(Type::Stop),
+              seconds(0.0),
+              value(0.0) {
+    }
+
+    Type type;
+    double seconds;
+    // Set and Load
+    QString group;
+    // Set
+    QString item;
+    double value;
+    // Load
+    QString location;
+};
+
+// Runs the complete engine without a GUI and without sound hardware:
+// decks, sync, effects and the recording sidechain are set up like in
+// MixxxMainWindow, but a SoundDeviceOffline drives the engine callbacks back
+// to back from a scripted control timeline. The master output is written to
+// a file and the achieved throughput is reported, so this is both a way to
+// pre-render mixes on machines without audio hardware and a benchmark of the
+// whole engine.
+class OfflineRenderer {
+  public:
+    explicit OfflineRenderer(const CmdlineArgs& args);
+    ~OfflineRenderer();
+
+    // Renders the script given on the command line and returns the exit
+    // code for main().
+    int render();
+
+    // Parses a render script with one event per line:
+    //
+    //   # seconds  event
+    //   0          load [Channel1] /music/first track.mp3
+    //   0          set [Channel1] play 1
+    //   92.5       set [Master] crossfader 0.25
+    //   300        stop
+    //
+    // "load" takes the rest of the line as the location of the track, "set"
+    // sets a control like a controller would and "stop" ends the render.
+    // Empty lines and lines starting with '#' are ignored. The events are
+    // returned in the order of their time, events with the same time in the
+    // order of the script. Returns false and sets pErrorMessage if the script
+    // is malformed or has no "stop" event.
+    static bool parseScript(const QString& script,
+            QList<RenderEvent>* pEvents,
+            QString* pErrorMessage);
+
+  private:
+    bool applyEvent(const RenderEvent& event, QString* pErrorMessage);
+    bool loadTrack(const RenderEvent& event, QString* pErrorMessage);
+
+    const CmdlineArgs& m_cmdLineArgs;
+
+    SettingsManager* m_pSettingsManager;
+    ChannelHandleFactory* m_pChannelHandleFactory;
+    EffectsManager* m_pEffectsManager;
+    EngineMaster* m_pEngine;
+    SoundManager* m_pSoundManager;
+    RecordingManager* m_pRecordingManager;
+    GuiTick* m_pGuiTick;
+    PlayerManager* m_pPlayerManager;
+    SoundDeviceOffline* m_pSoundDevice;
+
+    static const int kMicrophoneCount;
+    static const int kAuxiliaryCount;
+};
+
+#endif // OFFLINERENDERER_H
@@ -17,6 +17,7 @@
 #include <QMessageBox>
 #include "preferences/dialog/dlgprefsound.h"
 #include "preferences/dialog/dlgprefsounditem.h"
+#include "engine/cachingreaderdecoders.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginemaster.h"
 #include "mixer/playermanager.h"
@@ -136,6 +137,8 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
             this, SLOT(settingChanged()));
     connect(keylockComboBox, SIGNAL(currentIndexChanged(int)),
             this, SLOT(settingChanged()));
+    connect(parallelDecodersSpinBox, SIGNAL(valueChanged(int)),
+            this, SLOT(settingChanged()));
 
     connect(queryButton, SIGNAL(clicked()),
             this, SLOT(queryClicked()));
@@ -229,6 +232,8 @@ void DlgPrefSound::slotApply() {
         m_pKeylockEngine->set(keylockComboBox->currentIndex());
         m_pConfig->set(ConfigKey("[Master]", "keylock_engine"),
                        ConfigValue(keylockComboBox->currentIndex()));
+        m_pConfig->set(ConfigKey("[Master]", "parallel_chunk_decoders"),
+                       ConfigValue(parallelDecodersSpinBox->value()));
 
         err = m_pSoundManager->setConfig(m_config);
     }
@@ -417,6 +422,10 @@ void DlgPrefSound::loadSettings(const SoundManagerConfig &config) {
             ConfigKey("[Master]", "keylock_engine"), 1);
     keylockComboBox->setCurrentIndex(keylock_engine);
 
+    parallelDecodersSpinBox->setValue(m_pConfig->getValue(
+            ConfigKey("[Master]", "parallel_chunk_decoders"),
+            CachingReaderDecoders::kDefaultParallelism));
+
     m_loading = false;
     // DlgPrefSoundItem has it's own inhibit flag 
     emit(loadPaths(m_config));
@@ -596,6 +605,8 @@ void DlgPrefSound::slotResetToDefaults() {
     keylockComboBox->setCurrentIndex(EngineBuffer::RUBBERBAND);
     m_pKeylockEngine->set(EngineBuffer::RUBBERBAND);
 
+    parallelDecodersSpinBox->setValue(CachingReaderDecoders::kDefaultParallelism);
+
     masterMixComboBox->setCurrentIndex(1);
     m_pMasterEnabled->set(1.0);
 
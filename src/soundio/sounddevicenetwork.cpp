@@ -8,6 +8,7 @@
 #include "control/controlproxy.h"
 #include "control/controlobject.h"
 #include "util/denormalsarezero.h"
+#include "engine/callbacklatencystats.h"
 #include "engine/sidechain/enginenetworkstream.h"
 #include "float.h"
 #include "soundio/sounddevice.h"
@@ -449,7 +450,15 @@ void SoundDeviceNetwork::callbackProcessClkRef() {
 #endif
     }
 
-    m_pSoundManager->readProcess();
+    CallbackLatencyStats* pLatencyStats =
+            m_pSoundManager->getCallbackLatencyStats();
+    pLatencyStats->beginCallback();
+
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        m_pSoundManager->readProcess();
+    }
 
     {
         ScopedTimer t("SoundDevicePortAudio::callbackProcess prepare %1",
@@ -457,7 +466,13 @@ void SoundDeviceNetwork::callbackProcessClkRef() {
         m_pSoundManager->onDeviceOutputCallback(m_framesPerBuffer);
     }
 
-    m_pSoundManager->writeProcess();
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        m_pSoundManager->writeProcess();
+    }
+
+    pLatencyStats->endCallback(m_audioBufferTime);
 
     m_pSoundManager->processUnderflowHappened();
 
@@ -0,0 +1,119 @@
+#include "soundio/sounddeviceoffline.h"
+
+#include <QtDebug>
+
+#include "control/controlobject.h"
+#include "engine/callbacklatencystats.h"
+#include "soundio/soundmanager.h"
+#include "util/denormalsarezero.h"
+#include "util/logger.h"
+#include "util/sample.h"
+#include "util/trace.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SoundDeviceOffline");
+
+} // anonymous namespace
+
+SoundDeviceOffline::SoundDeviceOffline(UserSettingsPointer config,
+                                       SoundManager* sm)
+        : SoundDevice(config, sm),
+          m_pOutputBuffer(nullptr),
+          m_denormals(false) {
+    // Setting parent class members:
+    m_hostAPI = "Offline";
+    m_dSampleRate = 44100.0;
+    m_strInternalName = kOfflineDeviceInternalName;
+    m_strDisplayName = QObject::tr("Offline render");
+    m_iNumInputChannels = 0;
+    m_iNumOutputChannels = 2;
+}
+
+SoundDeviceOffline::~SoundDeviceOffline() {
+    close();
+}
+
+SoundDeviceError SoundDeviceOffline::open(bool isClkRefDevice, int syncBuffers) {
+    Q_UNUSED(syncBuffers);
+    kLogger.debug() << "open:" << getInternalName();
+
+    if (m_dSampleRate <= 0) {
+        m_dSampleRate = 44100.0;
+    }
+
+    SampleUtil::free(m_pOutputBuffer);
+    m_pOutputBuffer = SampleUtil::alloc(
+            m_framesPerBuffer * m_iNumOutputChannels);
+    SampleUtil::clear(m_pOutputBuffer, m_framesPerBuffer * m_iNumOutputChannels);
+
+    if (isClkRefDevice) {
+        // There is no device latency, but the engine and the waveforms
+        // derive their timing from these ControlObjects.
+        const double bufferMillis = m_framesPerBuffer * 1000.0 / m_dSampleRate;
+        ControlObject::set(ConfigKey("[Master]", "latency"), bufferMillis);
+        ControlObject::set(ConfigKey("[Master]", "samplerate"), m_dSampleRate);
+        ControlObject::set(ConfigKey("[Master]", "audio_buffer_size"),
+                bufferMillis);
+    }
+    return SOUNDDEVICE_ERROR_OK;
+}
+
+bool SoundDeviceOffline::isOpen() const {
+    return m_pOutputBuffer != nullptr;
+}
+
+SoundDeviceError SoundDeviceOffline::close() {
+    SampleUtil::free(m_pOutputBuffer);
+    m_pOutputBuffer = nullptr;
+    return SOUNDDEVICE_ERROR_OK;
+}
+
+QString SoundDeviceOffline::getError() const {
+    return QString();
+}
+
+void SoundDeviceOffline::readProcess() {
+    // No inputs
+}
+
+void SoundDeviceOffline::writeProcess() {
+    if (!m_pOutputBuffer) {
+        return;
+    }
+    composeOutputBuffer(m_pOutputBuffer, m_framesPerBuffer, 0,
+            m_iNumOutputChannels);
+}
+
+const CSAMPLE* SoundDeviceOffline::process() {
+    Trace trace("SoundDeviceOffline::process %1", getInternalName());
+
+    if (!m_denormals) {
+        m_denormals = true;
+        // Same as in the callbacks of the realtime devices. The flags are
+        // per thread and this runs in the thread of the caller.
+#ifdef __SSE__
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+    }
+
+    // Misses of the deadline mean that rendering is slower than realtime
+    CallbackLatencyStats* pLatencyStats =
+            m_pSoundManager->getCallbackLatencyStats();
+    pLatencyStats->beginCallback();
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        readProcess();
+    }
+    m_pSoundManager->onDeviceOutputCallback(m_framesPerBuffer);
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        writeProcess();
+    }
+    pLatencyStats->endCallback(mixxx::Duration::fromSeconds(
+            m_framesPerBuffer / m_dSampleRate));
+    return m_pOutputBuffer;
+}
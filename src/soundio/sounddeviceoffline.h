@@ -0,0 +1,42 @@
+#ifndef SOUNDDEVICEOFFLINE_H
+#define SOUNDDEVICEOFFLINE_H
+
+#include <QString>
+
+#include "soundio/sounddevice.h"
+#include "util/types.h"
+
+class SoundManager;
+
+const QString kOfflineDeviceInternalName = "Offline render";
+
+// A stereo sound device without any hardware or clock behind it. Every call
+// of process() runs a single engine callback and returns the composed output,
+// so the engine runs as fast as the caller drives it. This is used to render
+// a mix to a file faster than realtime.
+class SoundDeviceOffline : public SoundDevice {
+  public:
+    SoundDeviceOffline(UserSettingsPointer config, SoundManager* sm);
+    ~SoundDeviceOffline() override;
+
+    SoundDeviceError open(bool isClkRefDevice, int syncBuffers) override;
+    bool isOpen() const override;
+    SoundDeviceError close() override;
+    void readProcess() override;
+    void writeProcess() override;
+    QString getError() const override;
+    unsigned int getDefaultSampleRate() const override {
+        return 44100;
+    }
+
+    // Runs one engine callback in the calling thread and returns the
+    // interleaved output of m_framesPerBuffer frames. The buffer is valid
+    // until the next call.
+    const CSAMPLE* process();
+
+  private:
+    CSAMPLE* m_pOutputBuffer;
+    bool m_denormals;
+};
+
+#endif // SOUNDDEVICEOFFLINE_H
@@ -29,6 +29,7 @@
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "engine/callbacklatencystats.h"
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
@@ -916,6 +917,10 @@ int SoundDevicePortAudio::callbackProcessClkRef(
 #endif
 #endif
 
+    CallbackLatencyStats* pLatencyStats =
+            m_pSoundManager->getCallbackLatencyStats();
+    pLatencyStats->beginCallback();
+
     if (statusFlags & (paOutputUnderflow | paInputOverflow)) {
         m_pSoundManager->underflowHappened(6);
     }
@@ -927,14 +932,18 @@ int SoundDevicePortAudio::callbackProcessClkRef(
     //      m_pSoundManager->requestBuffer() is called below.)
 
     // Send audio from the soundcard's input off to the SoundManager...
-    if (in) {
-        ScopedTimer t("SoundDevicePortAudio::callbackProcess input %1",
-                getInternalName());
-        composeInputBuffer(in, framesPerBuffer, 0, m_inputParams.channelCount);
-        m_pSoundManager->pushInputBuffers(m_audioInputs, m_framesPerBuffer);
-    }
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        if (in) {
+            ScopedTimer t("SoundDevicePortAudio::callbackProcess input %1",
+                    getInternalName());
+            composeInputBuffer(in, framesPerBuffer, 0, m_inputParams.channelCount);
+            m_pSoundManager->pushInputBuffers(m_audioInputs, m_framesPerBuffer);
+        }
 
-    m_pSoundManager->readProcess();
+        m_pSoundManager->readProcess();
+    }
 
     {
         ScopedTimer t("SoundDevicePortAudio::callbackProcess prepare %1",
@@ -942,22 +951,29 @@ int SoundDevicePortAudio::callbackProcessClkRef(
         m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
     }
 
-    if (out) {
-        ScopedTimer t("SoundDevicePortAudio::callbackProcess output %1",
-                getInternalName());
+    {
+        CallbackLatencyStats::ScopedStage stage(pLatencyStats,
+                CallbackLatencyStats::Stage::SoundIo);
+        if (out) {
+            ScopedTimer t("SoundDevicePortAudio::callbackProcess output %1",
+                    getInternalName());
+
+            if (m_outputParams.channelCount <= 0) {
+                qWarning()
+                        << "SoundDevicePortAudio::callbackProcess m_outputParams channel count is zero or less:"
+                        << m_outputParams.channelCount;
+                // Bail out.
+                return paContinue;
+            }
 
-        if (m_outputParams.channelCount <= 0) {
-            qWarning()
-                    << "SoundDevicePortAudio::callbackProcess m_outputParams channel count is zero or less:"
-                    << m_outputParams.channelCount;
-            // Bail out.
-            return paContinue;
+            composeOutputBuffer(out, framesPerBuffer, 0, m_outputParams.channelCount);
         }
 
-        composeOutputBuffer(out, framesPerBuffer, 0, m_outputParams.channelCount);
+        m_pSoundManager->writeProcess();
     }
 
-    m_pSoundManager->writeProcess();
+    pLatencyStats->endCallback(mixxx::Duration::fromSeconds(
+            framesPerBuffer / m_dSampleRate));
 
     updateAudioLatencyUsage(framesPerBuffer);
 
@@ -583,6 +583,10 @@ void SoundManager::onDeviceOutputCallback(const SINT iFramesPerBuffer) {
     m_pMaster->process(iFramesPerBuffer * 2);
 }
 
+CallbackLatencyStats* SoundManager::getCallbackLatencyStats() const {
+    return m_pMaster->getCallbackLatencyStats();
+}
+
 void SoundManager::pushInputBuffers(const QList<AudioInputBuffer>& inputs,
                                     const SINT iFramesPerBuffer) {
    for (QList<AudioInputBuffer>::ConstIterator i = inputs.begin(),
@@ -33,6 +33,7 @@
 #include "util/cmdlineargs.h"
 
 
+class CallbackLatencyStats;
 class EngineMaster;
 class AudioOutput;
 class AudioInput;
@@ -116,6 +117,9 @@ class SoundManager : public QObject {
         return m_pNetworkStream;
     }
 
+    // Used by the clock reference device to time its callbacks
+    CallbackLatencyStats* getCallbackLatencyStats() const;
+
     void underflowHappened(int code) {
         m_underflowHappened = 1;
         // Disable the engine warnings by default, because printing a warning is a
@@ -0,0 +1,27 @@
+#include "sources/seekindexstore.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace mixxx {
+
+namespace {
+
+QMutex s_instanceMutex;
+std::shared_ptr<SeekIndexStore> s_pInstance;
+
+} // anonymous namespace
+
+// static
+std::shared_ptr<SeekIndexStore> SeekIndexStore::instance() {
+    QMutexLocker locker(&s_instanceMutex);
+    return s_pInstance;
+}
+
+// static
+void SeekIndexStore::setInstance(std::shared_ptr<SeekIndexStore> pInstance) {
+    QMutexLocker locker(&s_instanceMutex);
+    s_pInstance = std::move(pInstance);
+}
+
+} // namespace mixxx
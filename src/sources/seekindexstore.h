@@ -0,0 +1,37 @@
+#ifndef MIXXX_SEEKINDEXSTORE_H
+#define MIXXX_SEEKINDEXSTORE_H
+
+#include <memory>
+
+#include <QByteArray>
+#include <QString>
+
+namespace mixxx {
+
+// Persists the indices that some SoundSources build by scanning the whole
+// file when opening it, e.g. the seek frames of MP3 files. The next time the
+// file is opened the stored index is reused instead of scanning it again.
+//
+// The store knows nothing about the contents of an index. SoundSources are
+// responsible for validating a loaded index against the file and must fall
+// back to scanning the file if it is stale.
+//
+// Implementations must be thread-safe, because SoundSources are opened
+// concurrently by the reader threads of all decks and by the analyzers.
+class SeekIndexStore {
+  public:
+    virtual ~SeekIndexStore() = default;
+
+    // Returns an empty array if no index has been stored for the key
+    virtual QByteArray loadSeekIndex(const QString& key) const = 0;
+
+    virtual bool saveSeekIndex(const QString& key, const QByteArray& data) = 0;
+
+    // The store used by all SoundSources, nullptr if none has been set
+    static std::shared_ptr<SeekIndexStore> instance();
+    static void setInstance(std::shared_ptr<SeekIndexStore> pInstance);
+};
+
+} // namespace mixxx
+
+#endif // MIXXX_SEEKINDEXSTORE_H
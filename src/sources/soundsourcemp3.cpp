@@ -1,11 +1,16 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
+#include "sources/seekindexstore.h"
 
 #include "util/math.h"
 #include "util/logger.h"
 
 #include <id3tag.h>
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+
 namespace mixxx {
 
 namespace {
@@ -86,6 +91,19 @@ const SINT kMaxMp3FramesPerSecond = 39; // fixed: 1 MP3 frame = 26 ms -> ~ 1000
 const SINT kSeekFrameListCapacity = kMinutesPerFile
         * kSecondsPerMinute * kMaxMp3FramesPerSecond;
 
+const quint32 kSeekIndexMagic = 0x4D503353; // "MP3S"
+const quint32 kSeekIndexVersion = 1;
+
+// The number of seek frames that are checked for a frame sync word
+// when restoring a stored seek index. Checking all of them would read
+// the whole file just like scanning it.
+const SINT kSeekIndexSyncCheckCount = 16;
+
+inline bool isFrameSync(const unsigned char* pInputData) {
+    // 11 set bits
+    return (pInputData[0] == 0xFF) && ((pInputData[1] & 0xE0) == 0xE0);
+}
+
 inline QString formatHeaderFlags(int headerFlags) {
     return QString("0x%1").arg(headerFlags, 4, 16, QLatin1Char('0'));
 }
@@ -221,6 +239,43 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     DEBUG_ASSERT(m_seekFrameList.empty());
     m_avgSeekFrameCount = 0;
     m_curFrameIndex = 0;
+
+    // Reuse the seek index that has been stored when the file has
+    // been opened before instead of decoding all frame headers again.
+    // The index is keyed by the location and validated against the
+    // size and modification time of the file.
+    const QFileInfo fileInfo(m_file);
+    const QString seekIndexKey = fileInfo.canonicalFilePath();
+    const qint64 fileModifiedMillis = fileInfo.lastModified().toMSecsSinceEpoch();
+    const auto pSeekIndexStore = SeekIndexStore::instance();
+    if (!pSeekIndexStore ||
+            !restoreSeekIndex(
+                    pSeekIndexStore->loadSeekIndex(seekIndexKey),
+                    fileModifiedMillis)) {
+        const OpenResult scanResult = scanSeekFrames();
+        if (scanResult != OpenResult::Succeeded) {
+            return scanResult;
+        }
+        if (pSeekIndexStore) {
+            pSeekIndexStore->saveSeekIndex(
+                    seekIndexKey,
+                    serializeSeekIndex(fileModifiedMillis));
+        }
+    }
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
+    return OpenResult::Succeeded;
+}
+
+SoundSource::OpenResult SoundSourceMp3::scanSeekFrames() {
     int headerPerSampleRate[kSampleRateCount];
     for (int i = 0; i < kSampleRateCount; ++i) {
         headerPerSampleRate[i] = 0;
@@ -380,16 +435,148 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     addSeekFrame(m_curFrameIndex, 0);
     DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
 
-    // Restart decoding at the beginning of the audio stream
-    restartDecoding(m_seekFrameList.front());
+    return OpenResult::Succeeded;
+}
 
-    if (m_curFrameIndex != frameIndexMin()) {
-        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
-        // Abort
-        return OpenResult::Failed;
+QByteArray SoundSourceMp3::serializeSeekIndex(qint64 fileModifiedMillis) const {
+    // The list is terminated by an entry without input data
+    DEBUG_ASSERT(m_seekFrameList.size() > 1);
+    const SINT seekFrameCount = m_seekFrameList.size() - 1;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << kSeekIndexMagic
+            << kSeekIndexVersion
+            << quint64(m_fileSize)
+            << qint64(fileModifiedMillis)
+            << quint32(sampleRate())
+            << quint32(channelCount())
+            << quint32(bitrate())
+            << quint64(frameLength())
+            << quint32(seekFrameCount);
+    // Deltas of consecutive seek frames compress well, because most
+    // MP3 frames have the same length
+    SINT prevFrameIndex = 0;
+    quint64 prevOffset = 0;
+    for (SINT i = 0; i < seekFrameCount; ++i) {
+        const auto& seekFrame = m_seekFrameList[i];
+        const quint64 offset = seekFrame.pInputData - m_pFileData;
+        stream << quint32(seekFrame.frameIndex - prevFrameIndex)
+                << quint64(offset - prevOffset);
+        prevFrameIndex = seekFrame.frameIndex;
+        prevOffset = offset;
     }
+    return qCompress(data);
+}
 
-    return OpenResult::Succeeded;
+bool SoundSourceMp3::restoreSeekIndex(
+        const QByteArray& data, qint64 fileModifiedMillis) {
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    if (data.isEmpty()) {
+        return false;
+    }
+    const QByteArray uncompressedData = qUncompress(data);
+    QDataStream stream(uncompressedData);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint64 fileSize = 0;
+    qint64 modifiedMillis = 0;
+    quint32 sampleRateValue = 0;
+    quint32 channelCountValue = 0;
+    quint32 bitrateValue = 0;
+    quint64 frameCount = 0;
+    quint32 seekFrameCount = 0;
+    stream >> magic
+            >> version
+            >> fileSize
+            >> modifiedMillis
+            >> sampleRateValue
+            >> channelCountValue
+            >> bitrateValue
+            >> frameCount
+            >> seekFrameCount;
+    if ((stream.status() != QDataStream::Ok) ||
+            (magic != kSeekIndexMagic) ||
+            (version != kSeekIndexVersion)) {
+        kLogger.warning() << "Ignoring invalid seek index of"
+                << m_file.fileName();
+        return false;
+    }
+    if ((fileSize != m_fileSize) || (modifiedMillis != fileModifiedMillis)) {
+        kLogger.debug() << "Ignoring stale seek index of"
+                << m_file.fileName();
+        return false;
+    }
+    const SampleRate restoredSampleRate(sampleRateValue);
+    const ChannelCount restoredChannelCount(channelCountValue);
+    if (!restoredSampleRate.valid() ||
+            !restoredChannelCount.valid() ||
+            (restoredChannelCount > kChannelCountMax) ||
+            (seekFrameCount == 0) ||
+            (seekFrameCount > m_fileSize) ||
+            (frameCount == 0)) {
+        kLogger.warning() << "Ignoring invalid seek index of"
+                << m_file.fileName();
+        return false;
+    }
+
+    SeekFrameList seekFrameList;
+    seekFrameList.reserve(seekFrameCount + 1);
+    quint64 frameIndex = 0;
+    quint64 offset = 0;
+    for (quint32 i = 0; i < seekFrameCount; ++i) {
+        quint32 frameIndexDelta = 0;
+        quint64 offsetDelta = 0;
+        stream >> frameIndexDelta >> offsetDelta;
+        frameIndex += frameIndexDelta;
+        offset += offsetDelta;
+        if ((stream.status() != QDataStream::Ok) ||
+                ((i > 0) && ((frameIndexDelta == 0) || (offsetDelta == 0))) ||
+                (frameIndex >= frameCount) ||
+                (offset + 1 >= m_fileSize)) {
+            kLogger.warning() << "Ignoring corrupt seek index of"
+                    << m_file.fileName();
+            return false;
+        }
+        SeekFrameType seekFrame;
+        seekFrame.frameIndex = frameIndex;
+        seekFrame.pInputData = m_pFileData + offset;
+        seekFrameList.push_back(seekFrame);
+    }
+    if (seekFrameList.front().frameIndex != 0) {
+        kLogger.warning() << "Ignoring corrupt seek index of"
+                << m_file.fileName();
+        return false;
+    }
+
+    // Spot check that the stored offsets still point to frame headers
+    const SINT syncCheckStride = math_max(
+            SINT(1), SINT(seekFrameList.size()) / kSeekIndexSyncCheckCount);
+    for (SINT i = 0; i < SINT(seekFrameList.size()); i += syncCheckStride) {
+        if (!isFrameSync(seekFrameList[i].pInputData)) {
+            kLogger.warning() << "Ignoring mismatching seek index of"
+                    << m_file.fileName();
+            return false;
+        }
+    }
+    if (!isFrameSync(seekFrameList.back().pInputData)) {
+        kLogger.warning() << "Ignoring mismatching seek index of"
+                << m_file.fileName();
+        return false;
+    }
+
+    m_seekFrameList = std::move(seekFrameList);
+    setSampleRate(restoredSampleRate);
+    setChannelCount(restoredChannelCount);
+    initFrameIndexRangeOnce(IndexRange::forward(0, frameCount));
+    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
+    if (Bitrate(bitrateValue).valid()) {
+        initBitrateOnce(bitrateValue);
+    }
+    m_curFrameIndex = frameCount;
+    addSeekFrame(m_curFrameIndex, 0);
+    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
+    return true;
 }
 
 void SoundSourceMp3::close() {
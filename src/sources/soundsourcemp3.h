@@ -33,6 +33,16 @@ class SoundSourceMp3 final : public SoundSource {
             OpenMode mode,
             const OpenParams& params) override;
 
+    // Builds m_seekFrameList by decoding all frame headers and
+    // initializes the audio properties of the file
+    OpenResult scanSeekFrames();
+
+    // The seek frames and audio properties are persisted in the
+    // SeekIndexStore to skip the scan when the file is opened again.
+    // Restoring fails if the stored index does not match the file.
+    QByteArray serializeSeekIndex(qint64 fileModifiedMillis) const;
+    bool restoreSeekIndex(const QByteArray& data, qint64 fileModifiedMillis);
+
     QFile m_file;
     quint64 m_fileSize;
     unsigned char* m_pFileData;
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+
+#include "engine/cachingreaderchunkcache.h"
+
+namespace {
+
+const SINT kChunkSamples = 1024;
+const SINT kChunkBytes = kChunkSamples * sizeof(CSAMPLE);
+
+CachingReaderDecodedChunkPointer newChunk() {
+    return std::make_shared<CachingReaderDecodedChunk>(kChunkSamples);
+}
+
+class CachingReaderChunkCacheTest : public testing::Test {
+  protected:
+    CachingReaderChunkCacheTest()
+            : m_trackKey(CachingReaderChunkCache::trackKey(
+                      "/music/track.mp3", 1234, QDateTime::fromMSecsSinceEpoch(5678))) {
+    }
+
+    const QString m_trackKey;
+};
+
+TEST_F(CachingReaderChunkCacheTest, SharesChunks) {
+    CachingReaderChunkCache cache(16 * kChunkBytes);
+    EXPECT_EQ(nullptr, cache.lookup(m_trackKey, 0).get());
+
+    CachingReaderDecodedChunkPointer pChunk = newChunk();
+    EXPECT_EQ(pChunk, cache.insert(m_trackKey, 0, pChunk));
+    EXPECT_EQ(pChunk, cache.lookup(m_trackKey, 0));
+    EXPECT_EQ(nullptr, cache.lookup(m_trackKey, 1).get());
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(kChunkBytes, cache.memoryUsage());
+
+    // A chunk that has been decoded concurrently is replaced by the cached one
+    EXPECT_EQ(pChunk, cache.insert(m_trackKey, 0, newChunk()));
+    EXPECT_EQ(1, cache.size());
+
+    // The same file after it has been modified
+    const QString modifiedTrackKey = CachingReaderChunkCache::trackKey(
+            "/music/track.mp3", 1234, QDateTime::fromMSecsSinceEpoch(5679));
+    EXPECT_EQ(nullptr, cache.lookup(modifiedTrackKey, 0).get());
+}
+
+TEST_F(CachingReaderChunkCacheTest, EvictsLeastRecentlyUsedUnreferencedChunks) {
+    CachingReaderChunkCache cache(3 * kChunkBytes);
+    CachingReaderDecodedChunkPointer pReferenced = cache.insert(m_trackKey, 0, newChunk());
+    cache.insert(m_trackKey, 1, newChunk());
+    cache.insert(m_trackKey, 2, newChunk());
+    // Chunk 1 becomes more recently used than chunk 2
+    EXPECT_NE(nullptr, cache.lookup(m_trackKey, 1).get());
+
+    // Chunk 0 is the least recently used one, but still referenced
+    cache.insert(m_trackKey, 3, newChunk());
+    EXPECT_EQ(3, cache.size());
+    EXPECT_NE(nullptr, cache.lookup(m_trackKey, 0).get());
+    EXPECT_NE(nullptr, cache.lookup(m_trackKey, 1).get());
+    EXPECT_EQ(nullptr, cache.lookup(m_trackKey, 2).get());
+    EXPECT_NE(nullptr, cache.lookup(m_trackKey, 3).get());
+
+    // Referenced chunks are kept even if they exceed the budget
+    cache.setMemoryBudget(0);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(kChunkBytes, cache.memoryUsage());
+    EXPECT_EQ(pReferenced, cache.lookup(m_trackKey, 0));
+
+    // The inserted chunk is referenced by the inserting worker
+    pReferenced.reset();
+    cache.insert(m_trackKey, 4, newChunk());
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(nullptr, cache.lookup(m_trackKey, 0).get());
+
+    cache.setMemoryBudget(0);
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.memoryUsage());
+}
+
+TEST_F(CachingReaderChunkCacheTest, BudgetGrowsWithReaders) {
+    CachingReaderChunkCache cache(0);
+    cache.addReader(2 * kChunkBytes);
+    cache.addReader(kChunkBytes);
+    EXPECT_EQ(3 * kChunkBytes, cache.memoryBudget());
+    cache.insert(m_trackKey, 0, newChunk());
+    cache.insert(m_trackKey, 1, newChunk());
+    cache.insert(m_trackKey, 2, newChunk());
+    EXPECT_EQ(3, cache.size());
+
+    // The chunks of a removed reader are evicted
+    cache.removeReader(2 * kChunkBytes);
+    EXPECT_EQ(kChunkBytes, cache.memoryBudget());
+    EXPECT_EQ(1, cache.size());
+    EXPECT_NE(nullptr, cache.lookup(m_trackKey, 2).get());
+
+    // A configured budget replaces the one of the readers
+    cache.setMemoryBudget(4 * kChunkBytes);
+    cache.addReader(kChunkBytes);
+    EXPECT_EQ(4 * kChunkBytes, cache.memoryBudget());
+}
+
+}  // namespace
@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+#include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderchunkcache.h"
+#include "engine/cachingreaderdecoders.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+// A burst of hints after a seek requests the chunks around the new
+// play position
+const int kChunksPerSeek = 8;
+
+class CachingReaderDecodersTest : public MixxxTest {
+  protected:
+    static TrackPointer openTrack(const QString& fileName,
+            CachingReaderDecoders* pDecoders, int parallelism) {
+        TrackPointer pTrack = Track::newTemporary(kTestDir.absoluteFilePath(fileName));
+        mixxx::AudioSource::OpenParams params;
+        params.setChannelCount(CachingReaderChunk::kChannels);
+        auto pAudioSource = SoundSourceProxy(pTrack).openAudioSource(params);
+        EXPECT_FALSE(!pAudioSource);
+        if (pAudioSource) {
+            pDecoders->open(pAudioSource, pTrack, params, parallelism);
+        }
+        return pTrack;
+    }
+};
+
+TEST_F(CachingReaderDecodersTest, ParallelReadsOnlyForRandomAccessFormats) {
+    EXPECT_TRUE(CachingReaderDecoders::supportsParallelReads("flac"));
+    EXPECT_TRUE(CachingReaderDecoders::supportsParallelReads("WAV"));
+    EXPECT_FALSE(CachingReaderDecoders::supportsParallelReads("mp3"));
+    EXPECT_FALSE(CachingReaderDecoders::supportsParallelReads("ogg"));
+}
+
+TEST_F(CachingReaderDecodersTest, ParallelReadsMatchSequentialReads) {
+    CachingReaderDecoders sequentialDecoders;
+    openTrack("cover-test.flac", &sequentialDecoders, 1);
+    ASSERT_EQ(1, sequentialDecoders.parallelism());
+    CachingReaderDecoders parallelDecoders;
+    openTrack("cover-test.flac", &parallelDecoders, 4);
+    ASSERT_EQ(4, parallelDecoders.parallelism());
+
+    // Separate caches to decode every chunk twice
+    CachingReaderChunkCache sequentialCache(64 * 1024 * 1024);
+    CachingReaderChunkCache parallelCache(64 * 1024 * 1024);
+    const QString trackKey = "cover-test.flac";
+
+    std::vector<CachingReaderChunkForOwner> sequentialChunks(kChunksPerSeek + 1);
+    std::vector<CachingReaderChunkForOwner> parallelChunks(kChunksPerSeek + 1);
+    std::vector<CachingReaderChunk*> ppSequentialChunks;
+    std::vector<CachingReaderChunk*> ppParallelChunks;
+    for (int i = 0; i <= kChunksPerSeek; ++i) {
+        // Out of order to read chunks that do not follow each other
+        const SINT index = (i * 5) % (kChunksPerSeek + 1);
+        sequentialChunks[i].init(index);
+        parallelChunks[i].init(index);
+        ppSequentialChunks.push_back(&sequentialChunks[i]);
+        ppParallelChunks.push_back(&parallelChunks[i]);
+    }
+    std::vector<mixxx::IndexRange> sequentialRanges(kChunksPerSeek + 1);
+    std::vector<mixxx::IndexRange> parallelRanges(kChunksPerSeek + 1);
+    sequentialDecoders.readChunks(ppSequentialChunks.data(),
+            sequentialRanges.data(), kChunksPerSeek + 1,
+            &sequentialCache, trackKey, nullptr);
+    parallelDecoders.readChunks(ppParallelChunks.data(),
+            parallelRanges.data(), kChunksPerSeek + 1,
+            &parallelCache, trackKey, nullptr);
+
+    mixxx::SampleBuffer expected(CachingReaderChunk::kSamples);
+    mixxx::SampleBuffer actual(CachingReaderChunk::kSamples);
+    for (int i = 0; i <= kChunksPerSeek; ++i) {
+        EXPECT_FALSE(sequentialRanges[i].empty());
+        EXPECT_EQ(sequentialRanges[i], parallelRanges[i]);
+        sequentialChunks[i].readBufferedSampleFrames(expected.data(), sequentialRanges[i]);
+        parallelChunks[i].readBufferedSampleFrames(actual.data(), parallelRanges[i]);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                sequentialRanges[i].length());
+        for (SINT j = 0; j < sampleCount; ++j) {
+            EXPECT_EQ(expected.data()[j], actual.data()[j]);
+        }
+    }
+}
+
+TEST_F(CachingReaderDecodersTest, FirstChunkReadCallback) {
+    CachingReaderDecoders decoders;
+    openTrack("cover-test.flac", &decoders, 4);
+    CachingReaderChunkCache cache(64 * 1024 * 1024);
+
+    std::vector<CachingReaderChunkForOwner> chunks(kChunksPerSeek);
+    std::vector<CachingReaderChunk*> ppChunks;
+    for (int i = 0; i < kChunksPerSeek; ++i) {
+        chunks[i].init(i);
+        ppChunks.push_back(&chunks[i]);
+    }
+    std::vector<mixxx::IndexRange> ranges(kChunksPerSeek);
+    int calls = 0;
+    decoders.readChunks(ppChunks.data(), ranges.data(), kChunksPerSeek,
+            &cache, "cover-test.flac", nullptr,
+            [&calls, &ranges] {
+                // Only called once, when the first chunk is complete
+                ++calls;
+                EXPECT_FALSE(ranges[0].empty());
+            });
+    EXPECT_EQ(1, calls);
+    for (const auto& range: ranges) {
+        EXPECT_FALSE(range.empty());
+    }
+}
+
+// The time until all chunks around a new play position have been read
+// with state.range_x() decoders, without any of them being cached.
+void benchmarkColdSeekFill(benchmark::State& state, const QString& fileName) {
+    CachingReaderDecoders decoders;
+    TrackPointer pTrack = Track::newTemporary(kTestDir.absoluteFilePath(fileName));
+    mixxx::AudioSource::OpenParams params;
+    params.setChannelCount(CachingReaderChunk::kChannels);
+    auto pAudioSource = SoundSourceProxy(pTrack).openAudioSource(params);
+    if (!pAudioSource) {
+        state.SetLabel("unsupported file type");
+        while (state.KeepRunning()) {
+        }
+        return;
+    }
+    decoders.open(pAudioSource, pTrack, params, state.range_x());
+    const SINT chunkCount = CachingReaderChunk::indexForFrame(
+            pAudioSource->frameIndexMax() - 1) + 1;
+
+    std::vector<CachingReaderChunkForOwner> chunks(kChunksPerSeek);
+    std::vector<CachingReaderChunk*> ppChunks;
+    for (auto& chunk: chunks) {
+        ppChunks.push_back(&chunk);
+    }
+    std::vector<mixxx::IndexRange> bufferedFrameIndexRanges(kChunksPerSeek);
+    SINT seekChunk = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        CachingReaderChunkCache cache(64 * 1024 * 1024);
+        for (int i = 0; i < kChunksPerSeek; ++i) {
+            chunks[i].init((seekChunk + i) % chunkCount);
+        }
+        seekChunk = (seekChunk + 3 * kChunksPerSeek) % chunkCount;
+        state.ResumeTiming();
+
+        decoders.readChunks(ppChunks.data(), bufferedFrameIndexRanges.data(),
+                kChunksPerSeek, &cache, fileName, nullptr);
+
+        state.PauseTiming();
+        // Release the decoded chunks before the cache
+        for (auto& chunk: chunks) {
+            chunk.free();
+        }
+        state.ResumeTiming();
+    }
+}
+
+static void BM_ColdSeekFillFlac(benchmark::State& state) {
+    benchmarkColdSeekFill(state, "cover-test.flac");
+}
+BENCHMARK(BM_ColdSeekFillFlac)->Arg(1)->Arg(2)->Arg(4);
+
+static void BM_ColdSeekFillWav(benchmark::State& state) {
+    benchmarkColdSeekFill(state, "cover-test.wav");
+}
+BENCHMARK(BM_ColdSeekFillWav)->Arg(1)->Arg(2)->Arg(4);
+
+}  // namespace
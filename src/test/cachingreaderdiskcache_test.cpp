@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+
+#include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderdiskcache.h"
+
+namespace {
+
+const SINT kSampleRate = 44100;
+// Two and a half chunks
+const mixxx::IndexRange kFrameIndexRange = mixxx::IndexRange::forward(
+        0, 2 * CachingReaderChunk::kFrames + CachingReaderChunk::kFrames / 2);
+
+class CachingReaderDiskCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        QDir tempPath(QDir::tempPath());
+        const QString subdir = QString("CachingReaderDiskCacheTest-%1").arg(
+                QDateTime::currentMSecsSinceEpoch());
+        ASSERT_TRUE(tempPath.mkpath(subdir));
+        m_cacheDir = QDir(tempPath.filePath(subdir));
+    }
+
+    void TearDown() override {
+        ASSERT_TRUE(m_cacheDir.removeRecursively());
+    }
+
+    // Writes a chunk with samples that depend on the chunk index
+    void writeChunk(CachingReaderDiskCacheFile* pFile, SINT chunkIndex) {
+        const auto frameIndexRange = chunkFrameIndexRange(chunkIndex);
+        CachingReaderDecodedChunk decodedChunk(CachingReaderChunk::kSamples);
+        const SINT numSamples = CachingReaderChunk::frames2samples(frameIndexRange.length());
+        for (SINT i = 0; i < numSamples; ++i) {
+            decodedChunk.sampleBuffer().data()[i] = chunkIndex + i * 0.001f;
+        }
+        pFile->writeChunk(chunkIndex, mixxx::ReadableSampleFrames(
+                frameIndexRange,
+                mixxx::SampleBuffer::ReadableSlice(
+                        decodedChunk.sampleBuffer().data(), numSamples)));
+    }
+
+    bool readChunk(CachingReaderDiskCacheFile* pFile, SINT chunkIndex) {
+        const auto frameIndexRange = chunkFrameIndexRange(chunkIndex);
+        CachingReaderDecodedChunk decodedChunk(CachingReaderChunk::kSamples);
+        if (!pFile->readChunk(chunkIndex, frameIndexRange, &decodedChunk)) {
+            return false;
+        }
+        const auto& frames = decodedChunk.readableSampleFrames();
+        EXPECT_EQ(frameIndexRange, frames.frameIndexRange());
+        for (SINT i = 0; i < frames.readableLength(); ++i) {
+            EXPECT_EQ(chunkIndex + i * 0.001f, frames.readableData()[i]);
+        }
+        return true;
+    }
+
+    static mixxx::IndexRange chunkFrameIndexRange(SINT chunkIndex) {
+        return intersect(
+                mixxx::IndexRange::forward(
+                        chunkIndex * CachingReaderChunk::kFrames,
+                        CachingReaderChunk::kFrames),
+                kFrameIndexRange);
+    }
+
+    QDir m_cacheDir;
+};
+
+TEST_F(CachingReaderDiskCacheTest, WriteAndReadChunks) {
+    CachingReaderDiskCache cache(m_cacheDir.absolutePath(), 1024 * 1024 * 1024);
+    {
+        auto pFile = cache.openFile("track", kFrameIndexRange, kSampleRate);
+        ASSERT_TRUE(pFile != nullptr);
+        EXPECT_FALSE(readChunk(pFile.get(), 0));
+        writeChunk(pFile.get(), 0);
+        // The last chunk is shorter
+        writeChunk(pFile.get(), 2);
+        EXPECT_TRUE(readChunk(pFile.get(), 0));
+        EXPECT_FALSE(readChunk(pFile.get(), 1));
+        EXPECT_TRUE(readChunk(pFile.get(), 2));
+        EXPECT_FALSE(readChunk(pFile.get(), 3));
+    }
+
+    // The chunks are still there after reopening the file
+    {
+        auto pFile = cache.openFile("track", kFrameIndexRange, kSampleRate);
+        ASSERT_TRUE(pFile != nullptr);
+        EXPECT_TRUE(readChunk(pFile.get(), 0));
+        EXPECT_FALSE(readChunk(pFile.get(), 1));
+        EXPECT_TRUE(readChunk(pFile.get(), 2));
+    }
+
+    // A different decoding of the same track starts over
+    {
+        auto pFile = cache.openFile("track", kFrameIndexRange, 48000);
+        ASSERT_TRUE(pFile != nullptr);
+        EXPECT_FALSE(readChunk(pFile.get(), 0));
+    }
+}
+
+TEST_F(CachingReaderDiskCacheTest, EvictsLeastRecentlyOpenedFiles) {
+    const qint64 fileSize = CachingReaderDiskCache::fileSize(kFrameIndexRange);
+    CachingReaderDiskCache cache(m_cacheDir.absolutePath(), 2 * fileSize);
+    EXPECT_TRUE(cache.openFile("first", kFrameIndexRange, kSampleRate) != nullptr);
+    EXPECT_TRUE(cache.openFile("second", kFrameIndexRange, kSampleRate) != nullptr);
+    EXPECT_EQ(2, m_cacheDir.entryList(QDir::Files).size());
+    EXPECT_TRUE(cache.openFile("third", kFrameIndexRange, kSampleRate) != nullptr);
+    EXPECT_EQ(2, m_cacheDir.entryList(QDir::Files).size());
+
+    // Too large
+    const auto longFrameIndexRange = mixxx::IndexRange::forward(
+            0, 3 * kFrameIndexRange.length());
+    EXPECT_TRUE(cache.openFile("long", longFrameIndexRange, kSampleRate) == nullptr);
+}
+
+}  // namespace
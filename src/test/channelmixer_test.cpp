@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QVarLengthArray>
+#include <QVector>
+
+#include "engine/channelhandle.h"
+#include "engine/channelmixer.h"
+#include "engine/effects/engineeffectsmanager.h"
+#include "engine/enginethreadpool.h"
+#include "util/sample.h"
+
+namespace {
+
+const unsigned int kBufferSize = 1024;
+const unsigned int kSampleRate = 44100;
+
+class ChannelGainCalculator : public EngineMaster::GainCalculator {
+  public:
+    double getGain(EngineMaster::ChannelInfo* pChannelInfo) const override {
+        // A different gain for every channel, including unity gain
+        return 1.0 - 0.125 * (pChannelInfo->m_index % 5);
+    }
+};
+
+// Mixes a number of channels without any effect racks, so that all gains
+// are folded into the mixing loop.
+class ChannelMixerFixture {
+  public:
+    explicit ChannelMixerFixture(int numChannels)
+            : m_effectsManager(nullptr),
+              m_pOutput(SampleUtil::alloc(kBufferSize)),
+              m_outputHandle(m_handleFactory.getOrCreateHandle("[Master]")) {
+        for (int i = 0; i < numChannels; ++i) {
+            EngineMaster::ChannelInfo* pChannelInfo =
+                    new EngineMaster::ChannelInfo(i);
+            pChannelInfo->m_handle = m_handleFactory.getOrCreateHandle(
+                    QString("[Channel%1]").arg(i + 1));
+            pChannelInfo->m_pBuffer = SampleUtil::alloc(kBufferSize);
+            m_channels.append(pChannelInfo);
+            EngineMaster::GainCache gainCache;
+            gainCache.m_gain = 0.5;
+            gainCache.m_fadeout = false;
+            m_gainCache.append(gainCache);
+        }
+        fillChannelBuffers();
+    }
+
+    ~ChannelMixerFixture() {
+        for (EngineMaster::ChannelInfo* pChannelInfo : m_channels) {
+            SampleUtil::free(pChannelInfo->m_pBuffer);
+            delete pChannelInfo;
+        }
+        SampleUtil::free(m_pOutput);
+    }
+
+    void fillChannelBuffers() {
+        for (int c = 0; c < m_channels.size(); ++c) {
+            CSAMPLE* pBuffer = m_channels[c]->m_pBuffer;
+            for (unsigned int i = 0; i < kBufferSize; ++i) {
+                // Deterministic values in [-1.5, 1.5] with both signs
+                pBuffer[i] = static_cast<CSAMPLE>(
+                        ((i + 1) * (c + 37)) % 301) / 100 - 1.5f;
+            }
+        }
+    }
+
+    void mix(bool inPlace, EngineThreadPool* pThreadPool = nullptr) {
+        if (inPlace) {
+            ChannelMixer::applyEffectsInPlaceAndMixChannels(
+                    m_gainCalculator, &m_channels, &m_gainCache,
+                    m_pOutput, m_outputHandle, kBufferSize, kSampleRate,
+                    &m_effectsManager, pThreadPool);
+        } else {
+            ChannelMixer::applyEffectsAndMixChannels(
+                    m_gainCalculator, &m_channels, &m_gainCache,
+                    m_pOutput, m_outputHandle, kBufferSize, kSampleRate,
+                    &m_effectsManager);
+        }
+    }
+
+    ChannelHandleFactory m_handleFactory;
+    ChannelGainCalculator m_gainCalculator;
+    EngineEffectsManager m_effectsManager;
+    QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels> m_channels;
+    QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels> m_gainCache;
+    CSAMPLE* m_pOutput;
+    ChannelHandle m_outputHandle;
+};
+
+class ChannelMixerTest : public testing::TestWithParam<int> {
+  protected:
+    // Mixes the channels the way the unrolled mixing code did: ramp the
+    // gain of each channel with SampleUtil and add them up in order.
+    void verifyMix(bool inPlace, EngineThreadPool* pThreadPool = nullptr) {
+        ChannelMixerFixture fixture(GetParam());
+        // Fade out one channel to zero gain
+        if (GetParam() > 1) {
+            fixture.m_gainCache[1].m_fadeout = true;
+        }
+
+        QVector<QVector<CSAMPLE>> expectedChannels;
+        QVector<CSAMPLE> expectedOutput(kBufferSize, CSAMPLE_ZERO);
+        for (int c = 0; c < fixture.m_channels.size(); ++c) {
+            EngineMaster::ChannelInfo* pChannelInfo = fixture.m_channels[c];
+            QVector<CSAMPLE> channel(kBufferSize);
+            SampleUtil::copy(channel.data(), pChannelInfo->m_pBuffer, kBufferSize);
+            const CSAMPLE_GAIN oldGain = fixture.m_gainCache[c].m_gain;
+            const CSAMPLE_GAIN newGain = fixture.m_gainCache[c].m_fadeout ?
+                    0 : fixture.m_gainCalculator.getGain(pChannelInfo);
+            SampleUtil::applyRampingGain(channel.data(), oldGain, newGain,
+                    kBufferSize);
+            SampleUtil::add(expectedOutput.data(), channel.data(), kBufferSize);
+            expectedChannels.append(channel);
+        }
+        QVector<QVector<CSAMPLE>> originalChannels;
+        for (EngineMaster::ChannelInfo* pChannelInfo : fixture.m_channels) {
+            originalChannels.append(QVector<CSAMPLE>(kBufferSize));
+            SampleUtil::copy(originalChannels.last().data(),
+                    pChannelInfo->m_pBuffer, kBufferSize);
+        }
+        SampleUtil::fill(fixture.m_pOutput, 42.0f, kBufferSize);
+
+        fixture.mix(inPlace, pThreadPool);
+
+        for (unsigned int i = 0; i < kBufferSize; ++i) {
+            EXPECT_FLOAT_EQ(expectedOutput[i], fixture.m_pOutput[i]) << i;
+        }
+        for (int c = 0; c < fixture.m_channels.size(); ++c) {
+            const QVector<CSAMPLE>& expectedChannel = inPlace ?
+                    expectedChannels[c] : originalChannels[c];
+            for (unsigned int i = 0; i < kBufferSize; ++i) {
+                EXPECT_FLOAT_EQ(expectedChannel[i],
+                        fixture.m_channels[c]->m_pBuffer[i]) << c << " " << i;
+            }
+            const CSAMPLE_GAIN expectedGain = (c == 1) ?
+                    0 : fixture.m_gainCalculator.getGain(fixture.m_channels[c]);
+            EXPECT_FLOAT_EQ(expectedGain, fixture.m_gainCache[c].m_gain);
+            EXPECT_FALSE(fixture.m_gainCache[c].m_fadeout);
+        }
+    }
+};
+
+TEST_P(ChannelMixerTest, ApplyEffectsAndMixChannels) {
+    verifyMix(false);
+}
+
+TEST_P(ChannelMixerTest, ApplyEffectsInPlaceAndMixChannels) {
+    verifyMix(true);
+}
+
+TEST_P(ChannelMixerTest, ApplyEffectsInPlaceAndMixChannelsWithThreadPool) {
+    // Without any effects the result must not depend on the thread pool
+    EngineThreadPool threadPool(3);
+    verifyMix(true, &threadPool);
+}
+
+// Covers the empty mix, every specialized group size and mixes that are
+// split into several groups.
+INSTANTIATE_TEST_CASE_P(ChannelCounts, ChannelMixerTest,
+        testing::Values(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 17, 33));
+
+static void BM_ChannelMixer_ApplyEffectsAndMixChannels(benchmark::State& state) {
+    ChannelMixerFixture fixture(state.range_x());
+    while (state.KeepRunning()) {
+        fixture.mix(false);
+    }
+}
+BENCHMARK(BM_ChannelMixer_ApplyEffectsAndMixChannels)
+        ->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Arg(32);
+
+static void BM_ChannelMixer_ApplyEffectsInPlaceAndMixChannels(benchmark::State& state) {
+    ChannelMixerFixture fixture(state.range_x());
+    while (state.KeepRunning()) {
+        // Avoid fading the channels to silence over the iterations
+        state.PauseTiming();
+        fixture.fillChannelBuffers();
+        state.ResumeTiming();
+        fixture.mix(true);
+    }
+}
+BENCHMARK(BM_ChannelMixer_ApplyEffectsInPlaceAndMixChannels)
+        ->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Arg(32);
+
+}  // namespace
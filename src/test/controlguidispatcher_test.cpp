@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <QSignalSpy>
+
+#include "control/controlguidispatcher.h"
+#include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "test/mixxxtest.h"
+#include "util/memory.h"
+
+namespace {
+
+class ControlGuiDispatcherTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pControl = std::make_unique<ControlObject>(ConfigKey("[Test]", "control"));
+        m_pReceiver = std::make_unique<ControlObject>(ConfigKey("[Test]", "receiver"));
+        m_pReceiverProxy = std::make_unique<ControlProxy>(ConfigKey("[Test]", "receiver"));
+    }
+
+    // Returns a proxy of the control that sets the receiver control on every
+    // change
+    std::unique_ptr<ControlProxy> connectProxy() {
+        auto pProxy = std::make_unique<ControlProxy>(ConfigKey("[Test]", "control"));
+        EXPECT_TRUE(pProxy->connectValueChangedCoalesced(
+                m_pReceiverProxy.get(), SLOT(slotSet(double))));
+        return pProxy;
+    }
+
+    std::unique_ptr<ControlObject> m_pControl;
+    std::unique_ptr<ControlObject> m_pReceiver;
+    std::unique_ptr<ControlProxy> m_pReceiverProxy;
+};
+
+TEST_F(ControlGuiDispatcherTest, DeliversEveryChangeWithoutDispatcher) {
+    auto pProxy = connectProxy();
+    QSignalSpy spy(pProxy.get(), SIGNAL(valueChanged(double)));
+    m_pControl->set(1.0);
+    m_pControl->set(2.0);
+    EXPECT_EQ(2, spy.count());
+    EXPECT_DOUBLE_EQ(2.0, m_pReceiver->get());
+}
+
+TEST_F(ControlGuiDispatcherTest, CoalescesChanges) {
+    ControlGuiDispatcher dispatcher;
+    auto pProxy = connectProxy();
+    QSignalSpy spy(pProxy.get(), SIGNAL(valueChanged(double)));
+    m_pControl->set(1.0);
+    m_pControl->set(2.0);
+    m_pControl->set(3.0);
+    EXPECT_EQ(0, spy.count());
+
+    dispatcher.process();
+    ASSERT_EQ(1, spy.count());
+    EXPECT_DOUBLE_EQ(3.0, spy.at(0).at(0).toDouble());
+    EXPECT_DOUBLE_EQ(3.0, m_pReceiver->get());
+
+    // Nothing has changed since
+    dispatcher.process();
+    EXPECT_EQ(1, spy.count());
+}
+
+TEST_F(ControlGuiDispatcherTest, DoesNotNotifySetter) {
+    ControlGuiDispatcher dispatcher;
+    auto pSetter = connectProxy();
+    auto pOther = connectProxy();
+    QSignalSpy setterSpy(pSetter.get(), SIGNAL(valueChanged(double)));
+    QSignalSpy otherSpy(pOther.get(), SIGNAL(valueChanged(double)));
+    pSetter->set(5.0);
+    dispatcher.process();
+    EXPECT_EQ(0, setterSpy.count());
+    EXPECT_EQ(1, otherSpy.count());
+}
+
+TEST_F(ControlGuiDispatcherTest, Unsubscribe) {
+    ControlGuiDispatcher dispatcher;
+    auto pProxy = connectProxy();
+    m_pControl->set(1.0);
+    pProxy.reset();
+    dispatcher.process();
+    EXPECT_DOUBLE_EQ(0.0, m_pReceiver->get());
+
+    // Subscribing again only delivers the later changes
+    pProxy = connectProxy();
+    QSignalSpy spy(pProxy.get(), SIGNAL(valueChanged(double)));
+    dispatcher.process();
+    EXPECT_EQ(0, spy.count());
+    m_pControl->set(2.0);
+    dispatcher.process();
+    EXPECT_EQ(1, spy.count());
+}
+
+TEST_F(ControlGuiDispatcherTest, DeletedControl) {
+    auto pDispatcher = std::make_unique<ControlGuiDispatcher>();
+    auto pProxy = connectProxy();
+    // The proxy keeps the control alive
+    m_pControl.reset();
+    pProxy->set(1.0);
+    pDispatcher->process();
+    // The proxy outlives the dispatcher
+    pDispatcher.reset();
+    pProxy.reset();
+}
+
+}  // namespace
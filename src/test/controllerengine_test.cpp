@@ -71,6 +71,36 @@ TEST_F(ControllerEngineTest, getSetValue) {
     EXPECT_DOUBLE_EQ(1.0, co->get());
 }
 
+TEST_F(ControllerEngineTest, getControlId) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    EXPECT_EQ(ControlDoublePrivate::getControlId(ConfigKey("[Test]", "co")),
+              cEngine->getControlId("[Test]", "co"));
+    EXPECT_EQ(-1, cEngine->getControlId("[Nothing]", "nothing"));
+}
+
+TEST_F(ControllerEngineTest, getSetValueById) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    co->set(1.0);
+    EXPECT_TRUE(execute("function() {"
+                        "  var id = engine.getControlId('[Test]', 'co');"
+                        "  engine.setValueById(id, engine.getValueById(id) + 1); }"));
+    EXPECT_DOUBLE_EQ(2.0, co->get());
+}
+
+TEST_F(ControllerEngineTest, setValueById_IgnoresNaN) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    co->set(10.0);
+    EXPECT_TRUE(execute("function() {"
+                        "  engine.setValueById(engine.getControlId('[Test]', 'co'), NaN); }"));
+    EXPECT_DOUBLE_EQ(10.0, co->get());
+}
+
+TEST_F(ControllerEngineTest, getSetValueById_InvalidControl) {
+    EXPECT_TRUE(execute("function() { engine.setValueById(-1, 1.0); }"));
+    EXPECT_DOUBLE_EQ(0.0, cEngine->getValueById(-1));
+    EXPECT_DOUBLE_EQ(0.0, cEngine->getValueById(1 << 30));
+}
+
 TEST_F(ControllerEngineTest, setParameter) {
     auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
                                                 -10.0, 10.0);
@@ -1,7 +1,14 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 #include <QtDebug>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "control/controlregistry.h"
 #include "util/memory.h"
 #include "test/mixxxtest.h"
 
@@ -84,4 +91,201 @@ TEST_F(ControlObjectTest, Persistence_ValidValue) {
     EXPECT_DOUBLE_EQ(5.0, co.get());
 }
 
+TEST_F(ControlObjectTest, RecreateDeletedControl) {
+    ConfigKey ck("[Test]", "recreated");
+    auto co = std::make_unique<ControlObject>(ck);
+    co.reset();
+    EXPECT_EQ(ControlObject::getControl(ck, false), (ControlObject*)nullptr);
+
+    co = std::make_unique<ControlObject>(ck);
+    EXPECT_EQ(ControlObject::getControl(ck), co.get());
+
+    QList<QSharedPointer<ControlDoublePrivate> > controls;
+    ControlDoublePrivate::getControls(&controls);
+    int count = 0;
+    for (const auto& pControl : controls) {
+        if (pControl->getKey() == ck) {
+            ++count;
+        }
+    }
+    EXPECT_EQ(1, count);
+}
+
+TEST_F(ControlObjectTest, ControlIds) {
+    ConfigKey key1("[Test]", "id1");
+    ConfigKey key2("[Test]", "id2");
+    EXPECT_EQ(kInvalidControlId, ControlDoublePrivate::getControlId(key1));
+
+    auto control1 = std::make_unique<ControlObject>(key1);
+    auto control2 = std::make_unique<ControlObject>(key2);
+    const int id1 = ControlDoublePrivate::getControlId(key1);
+    const int id2 = ControlDoublePrivate::getControlId(key2);
+    EXPECT_NE(kInvalidControlId, id1);
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(control1.get(), ControlObject::getControlById(id1));
+    EXPECT_EQ(control2.get(), ControlObject::getControlById(id2));
+
+    ControlProxy proxy;
+    proxy.initializeById(id2);
+    EXPECT_TRUE(proxy.valid());
+    EXPECT_EQ(key2, proxy.getKey());
+    EXPECT_EQ(id2, proxy.getControlId());
+
+    // The id of a key survives its control
+    control1.reset();
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControlById(id1));
+    EXPECT_EQ(id1, ControlDoublePrivate::getControlId(key1));
+    control1 = std::make_unique<ControlObject>(key1);
+    EXPECT_EQ(control1.get(), ControlObject::getControlById(id1));
+
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControlById(kInvalidControlId));
+}
+
+TEST_F(ControlObjectTest, ManyControls) {
+    // More controls than fit into the initial registry
+    std::vector<std::unique_ptr<ControlObject> > controls;
+    for (int i = 0; i < 10000; ++i) {
+        controls.push_back(std::make_unique<ControlObject>(
+                ConfigKey("[Test]", QString("control%1").arg(i))));
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        controls[i].reset();
+    }
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(controls[i].get(), ControlObject::getControl(
+                ConfigKey("[Test]", QString("control%1").arg(i)), false));
+    }
+}
+
+TEST_F(ControlObjectTest, LookupWhileCreatingControls) {
+    ConfigKey ck("[Test]", "stable");
+    auto co = std::make_unique<ControlObject>(ck);
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&ck, &co, &stop, &failures]() {
+            while (!stop.load()) {
+                if (ControlObject::getControl(ck) != co.get()) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    // Creating and deleting controls replaces the entries and grows the
+    // registry while the readers look up the stable control
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::unique_ptr<ControlObject> > controls;
+        for (int i = 0; i < 5000; ++i) {
+            controls.push_back(std::make_unique<ControlObject>(
+                    ConfigKey("[Test]", QString("temporary%1").arg(i))));
+        }
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST_F(ControlObjectTest, RegistryReclaimsDuringLookups) {
+    ControlRegistry registry;
+    const ConfigKey stable("[Test]", "stable");
+    registry.insert(stable, QSharedPointer<ControlDoublePrivate>());
+    const int stableId = registry.lookupId(stable);
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&registry, &stable, stableId, &stop, &failures]() {
+            while (!stop.load()) {
+                if (registry.lookupId(stable) != stableId) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    // Every insert replaces an entry while the lookups keep overlapping.
+    // The replaced entries must not pile up until the lookups stop.
+    const int kReplacements = 10000;
+    const ConfigKey temporary("[Test]", "temporary");
+    for (int i = 0; i < kReplacements; ++i) {
+        registry.insert(temporary, QSharedPointer<ControlDoublePrivate>());
+    }
+    EXPECT_LT(registry.retiredCountForTest(), kReplacements / 2);
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, failures.load());
+}
+
+// The controls of the benchmarks are created and deleted by their first
+// thread
+std::vector<ConfigKey>* s_pBenchmarkKeys = nullptr;
+std::vector<std::unique_ptr<ControlObject> >* s_pBenchmarkControls = nullptr;
+
+void createBenchmarkControls(int count) {
+    s_pBenchmarkKeys = new std::vector<ConfigKey>();
+    s_pBenchmarkControls = new std::vector<std::unique_ptr<ControlObject> >();
+    for (int i = 0; i < count; ++i) {
+        s_pBenchmarkKeys->push_back(ConfigKey(
+                QString("[Channel%1]").arg(i % 8 + 1), QString("control%1").arg(i)));
+        s_pBenchmarkControls->push_back(
+                std::make_unique<ControlObject>(s_pBenchmarkKeys->back()));
+    }
+}
+
+void deleteBenchmarkControls() {
+    delete s_pBenchmarkControls;
+    s_pBenchmarkControls = nullptr;
+    delete s_pBenchmarkKeys;
+    s_pBenchmarkKeys = nullptr;
 }
+
+// Looks up controls from several threads like controller scripts, skins and
+// the engine do
+static void BM_ControlDoublePrivate_GetControl(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        createBenchmarkControls(state.range_x());
+    }
+    // KeepRunning() waits for all threads before the timer starts
+    size_t index = state.thread_index;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ControlDoublePrivate::getControl(
+                (*s_pBenchmarkKeys)[index % s_pBenchmarkKeys->size()]));
+        index += 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index == 0) {
+        deleteBenchmarkControls();
+    }
+}
+BENCHMARK(BM_ControlDoublePrivate_GetControl)
+        ->Arg(4096)->ThreadRange(1, 16);
+
+// Like above, but the first thread keeps creating and deleting controls
+static void BM_ControlDoublePrivate_GetControlWhileCreating(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        createBenchmarkControls(state.range_x());
+    }
+    const ConfigKey temporaryKey("[Test]", "temporary");
+    size_t index = state.thread_index;
+    while (state.KeepRunning()) {
+        if (state.thread_index == 0) {
+            ControlObject temporary(temporaryKey);
+        } else {
+            benchmark::DoNotOptimize(ControlDoublePrivate::getControl(
+                    (*s_pBenchmarkKeys)[index % s_pBenchmarkKeys->size()]));
+            index += 7;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index == 0) {
+        deleteBenchmarkControls();
+    }
+}
+BENCHMARK(BM_ControlDoublePrivate_GetControlWhileCreating)
+        ->Arg(4096)->ThreadRange(2, 16);
+
+}  // namespace
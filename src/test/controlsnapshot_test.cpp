@@ -0,0 +1,157 @@
+#ifndef __WINDOWS__
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QCoreApplication>
+
+#include "control/controlobject.h"
+#include "engine/controlsnapshot.h"
+#include "engine/mixxx_control_snapshot.h"
+#include "test/mixxxtest.h"
+#include "util/memory.h"
+
+namespace {
+
+class ControlSnapshotTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_name = QString("/mixxx-controls-test-%1")
+                .arg(QCoreApplication::applicationPid());
+        config()->setValue(ConfigKey("[ControlSnapshot]", "enabled"), true);
+        config()->setValue(ConfigKey("[ControlSnapshot]", "name"), m_name);
+        config()->setValue(ConfigKey("[ControlSnapshot]", "controls"),
+                QString("[Test],a; [Test],b;invalid;[Test],missing"));
+        m_pControlA = std::make_unique<ControlObject>(ConfigKey("[Test]", "a"));
+        m_pControlB = std::make_unique<ControlObject>(ConfigKey("[Test]", "b"));
+    }
+
+    // Maps the snapshot like an external reader
+    const mixxx_control_snapshot* map() {
+        int fd = shm_open(m_name.toLocal8Bit().constData(), O_RDONLY, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* pMemory = mmap(nullptr, sizeof(mixxx_control_snapshot),
+                PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (pMemory == MAP_FAILED) {
+            return nullptr;
+        }
+        return static_cast<const mixxx_control_snapshot*>(pMemory);
+    }
+
+    void unmap(const mixxx_control_snapshot* pSnapshot) {
+        munmap(const_cast<mixxx_control_snapshot*>(pSnapshot),
+                sizeof(mixxx_control_snapshot));
+    }
+
+    QString m_name;
+    std::unique_ptr<ControlObject> m_pControlA;
+    std::unique_ptr<ControlObject> m_pControlB;
+};
+
+TEST_F(ControlSnapshotTest, Disabled) {
+    EXPECT_TRUE(ControlSnapshot::isEnabled(config()));
+    config()->setValue(ConfigKey("[ControlSnapshot]", "enabled"), false);
+    EXPECT_FALSE(ControlSnapshot::isEnabled(config()));
+}
+
+TEST_F(ControlSnapshotTest, PublishesValues) {
+    auto pWriter = std::make_unique<ControlSnapshot>(config());
+    ASSERT_TRUE(pWriter->isOpen());
+    EXPECT_EQ(3, pWriter->keys().size());
+
+    const mixxx_control_snapshot* pSnapshot = map();
+    ASSERT_NE((const mixxx_control_snapshot*)nullptr, pSnapshot);
+    EXPECT_TRUE(mixxx_control_snapshot_valid(pSnapshot));
+    EXPECT_EQ(3u, pSnapshot->control_count);
+    int a = mixxx_control_snapshot_find(pSnapshot, "[Test]", "a");
+    int b = mixxx_control_snapshot_find(pSnapshot, "[Test]", "b");
+    int missing = mixxx_control_snapshot_find(pSnapshot, "[Test]", "missing");
+    EXPECT_EQ(0, a);
+    EXPECT_EQ(1, b);
+    EXPECT_EQ(2, missing);
+    EXPECT_EQ(-1, mixxx_control_snapshot_find(pSnapshot, "[Test]", "c"));
+
+    m_pControlA->set(0.25);
+    m_pControlB->set(128.0);
+    pWriter->publish();
+
+    double values[MIXXX_CONTROL_SNAPSHOT_MAX_CONTROLS];
+    uint64_t firstTime = 0;
+    ASSERT_TRUE(mixxx_control_snapshot_read(pSnapshot, values, &firstTime));
+    EXPECT_DOUBLE_EQ(0.25, values[a]);
+    EXPECT_DOUBLE_EQ(128.0, values[b]);
+    EXPECT_DOUBLE_EQ(0.0, values[missing]);
+    EXPECT_EQ(2u, pSnapshot->sequence);
+
+    // Controls created later are published once they are resolved
+    ControlObject controlMissing(ConfigKey("[Test]", "missing"));
+    controlMissing.set(-1.0);
+    m_pControlA->set(0.5);
+    pWriter->slotResolveControls();
+    pWriter->publish();
+
+    uint64_t secondTime = 0;
+    ASSERT_TRUE(mixxx_control_snapshot_read(pSnapshot, values, &secondTime));
+    EXPECT_DOUBLE_EQ(0.5, values[a]);
+    EXPECT_DOUBLE_EQ(-1.0, values[missing]);
+    EXPECT_LE(firstTime, secondTime);
+    EXPECT_EQ(4u, pSnapshot->sequence);
+
+    // Readers notice that the snapshot is gone
+    pWriter.reset();
+    EXPECT_FALSE(mixxx_control_snapshot_valid(pSnapshot));
+    EXPECT_FALSE(mixxx_control_snapshot_read(pSnapshot, values, nullptr));
+    unmap(pSnapshot);
+    EXPECT_EQ((const mixxx_control_snapshot*)nullptr, map());
+}
+
+TEST_F(ControlSnapshotTest, ReplacesExistingObject) {
+    // Left behind with other permissions, e.g. by another program
+    const QByteArray name = m_name.toLocal8Bit();
+    const int fd = shm_open(name.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_LE(0, fd);
+    ASSERT_EQ(0, ftruncate(fd, sizeof(mixxx_control_snapshot)));
+
+    auto pWriter = std::make_unique<ControlSnapshot>(config());
+    ASSERT_TRUE(pWriter->isOpen());
+    const int newFd = shm_open(name.constData(), O_RDONLY, 0);
+    ASSERT_LE(0, newFd);
+    struct stat oldStat;
+    struct stat newStat;
+    ASSERT_EQ(0, fstat(fd, &oldStat));
+    ASSERT_EQ(0, fstat(newFd, &newStat));
+    ::close(newFd);
+    // A new object that only we can access, the old one is untouched
+    EXPECT_NE(oldStat.st_ino, newStat.st_ino);
+    EXPECT_EQ(static_cast<mode_t>(S_IRUSR | S_IWUSR), newStat.st_mode & 0777);
+    EXPECT_EQ(geteuid(), newStat.st_uid);
+    const mixxx_control_snapshot* pOld = static_cast<const mixxx_control_snapshot*>(
+            mmap(nullptr, sizeof(mixxx_control_snapshot), PROT_READ, MAP_SHARED, fd, 0));
+    ASSERT_NE(MAP_FAILED, static_cast<const void*>(pOld));
+    EXPECT_FALSE(mixxx_control_snapshot_valid(pOld));
+    unmap(pOld);
+    ::close(fd);
+
+    // An instance that has been replaced by another one keeps the object
+    // of the other instance
+    auto pOtherWriter = std::make_unique<ControlSnapshot>(config());
+    ASSERT_TRUE(pOtherWriter->isOpen());
+    pWriter.reset();
+    const mixxx_control_snapshot* pSnapshot = map();
+    ASSERT_NE((const mixxx_control_snapshot*)nullptr, pSnapshot);
+    EXPECT_TRUE(mixxx_control_snapshot_valid(pSnapshot));
+    unmap(pSnapshot);
+    pOtherWriter.reset();
+    EXPECT_EQ((const mixxx_control_snapshot*)nullptr, map());
+}
+
+}  // namespace
+
+#endif // __WINDOWS__
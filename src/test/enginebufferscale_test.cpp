@@ -0,0 +1,232 @@
+// Benchmarks of all EngineBufferScale implementations. Run them with
+//   mixxx-test --benchmark --benchmark_filter=BM_EngineBufferScale
+// Besides the average time per call, the label of each benchmark reports
+// the time per output frame and the worst case time of a single call, which
+// decides whether a scaler fits into the callback of a given latency.
+
+#include <benchmark/benchmark.h>
+
+#include <QString>
+#include <QtDebug>
+
+#include "engine/enginebufferscalecubic.h"
+#include "engine/enginebufferscalelinear.h"
+#include "engine/enginebufferscalerubberband.h"
+#include "engine/enginebufferscalerubberbandpipelined.h"
+#include "engine/enginebufferscalest.h"
+#include "engine/engineworkerscheduler.h"
+#include "engine/readaheadmanager.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+const SINT kSampleRate = 44100;
+
+// Reads an endless sine in both directions like the ReadAheadManager reads
+// a track
+class ReadAheadManagerFake : public ReadAheadManager {
+  public:
+    ReadAheadManagerFake()
+            : ReadAheadManager(),
+              m_frame(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            if (dRate < 0) {
+                --m_frame;
+            }
+            buffer[i] = buffer[i + 1] = static_cast<CSAMPLE>(
+                    0.5 * sin(2 * M_PI * 440.0 * m_frame / kSampleRate));
+            if (dRate >= 0) {
+                ++m_frame;
+            }
+        }
+        return requested_samples;
+    }
+
+  private:
+    SINT m_frame;
+};
+
+// Scales buffers of a fixed size with one scaler and records the time of
+// each call
+template<typename Scaler>
+class ScalerBenchmark {
+  public:
+    ScalerBenchmark(benchmark::State& state, SINT bufferFrames)
+            : m_state(state),
+              m_scaler(&m_readAheadManager),
+              m_bufferFrames(bufferFrames),
+              m_pBuffer(SampleUtil::alloc(bufferFrames * 2)),
+              m_calls(0),
+              m_totalNanos(0),
+              m_maxNanos(0) {
+        bindWorker(&m_scaler);
+        m_scaler.setSampleRate(kSampleRate);
+        setScaleParameters(1.0, 1.0);
+    }
+
+    ~ScalerBenchmark() {
+        SampleUtil::free(m_pBuffer);
+    }
+
+    void setScaleParameters(double tempoRatio, double pitchRatio) {
+        m_scaler.setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    void process() {
+        m_timer.restart();
+        m_scaler.scaleBuffer(m_pBuffer, m_bufferFrames * 2);
+        const qint64 nanos = m_timer.elapsed().toIntegerNanos();
+        ++m_calls;
+        m_totalNanos += nanos;
+        m_maxNanos = math_max(m_maxNanos, nanos);
+        runWorkers(&m_scaler);
+    }
+
+    // Must be called after the benchmark loop
+    void report() {
+        m_state.SetItemsProcessed(m_state.iterations() * m_bufferFrames);
+        if (m_calls > 0) {
+            m_state.SetLabel(QString("%1 ns/frame, worst call %2 us")
+                    .arg(static_cast<double>(m_totalNanos) / m_calls / m_bufferFrames,
+                            0, 'f', 2)
+                    .arg(m_maxNanos / 1000.0, 0, 'f', 1)
+                    .toStdString());
+        }
+    }
+
+  private:
+    void bindWorker(EngineBufferScale*) {
+    }
+    void bindWorker(EngineBufferScaleRubberBandPipelined* pScaler) {
+        pScaler->bindWorker(&m_workerScheduler);
+        pScaler->setSelected(true);
+    }
+
+    // The worker of the pipelined scaler runs outside of the callback, so
+    // it is excluded from the measured time
+    void runWorkers(EngineBufferScale*) {
+    }
+    void runWorkers(EngineBufferScaleRubberBandPipelined*) {
+        m_state.PauseTiming();
+        m_workerScheduler.waitForIdleWorkers();
+        m_state.ResumeTiming();
+    }
+
+    benchmark::State& m_state;
+    ReadAheadManagerFake m_readAheadManager;
+    EngineWorkerScheduler m_workerScheduler;
+    Scaler m_scaler;
+    const SINT m_bufferFrames;
+    CSAMPLE* m_pBuffer;
+    PerformanceTimer m_timer;
+    qint64 m_calls;
+    qint64 m_totalNanos;
+    qint64 m_maxNanos;
+};
+
+// Playback at a constant rate. The first argument is the buffer size in
+// frames, the second is the rate in percent. The keylock scalers keep the
+// pitch.
+template<typename Scaler, bool keylock>
+static void BM_EngineBufferScale_Rate(benchmark::State& state) {
+    ScalerBenchmark<Scaler> scaler(state, state.range_x());
+    const double rate = state.range_y() / 100.0;
+    scaler.setScaleParameters(rate, keylock ? 1.0 : rate);
+    while (state.KeepRunning()) {
+        scaler.process();
+    }
+    scaler.report();
+}
+
+void RateArguments(benchmark::internal::Benchmark* b) {
+    for (int frames = 64; frames <= 4096; frames *= 4) {
+        for (int ratePercent : {50, 92, 100, 108, 200}) {
+            b->ArgPair(frames, ratePercent);
+        }
+    }
+}
+
+// Pitch shifting at the original tempo. The first argument is the buffer
+// size in frames, the second is the pitch shift in semitones.
+template<typename Scaler>
+static void BM_EngineBufferScale_Pitch(benchmark::State& state) {
+    ScalerBenchmark<Scaler> scaler(state, state.range_x());
+    scaler.setScaleParameters(1.0, pow(2.0, state.range_y() / 12.0));
+    while (state.KeepRunning()) {
+        scaler.process();
+    }
+    scaler.report();
+}
+
+void PitchArguments(benchmark::internal::Benchmark* b) {
+    for (int frames = 64; frames <= 4096; frames *= 4) {
+        for (int semitones : {-12, -3, 2, 12}) {
+            b->ArgPair(frames, semitones);
+        }
+    }
+}
+
+// A new rate in every callback, like scratching or nudging with a jog
+// wheel. The vinyl scalers move back and forth through zero, the keylock
+// scalers, which the engine only uses away from zero, between half and
+// one and a half of the original tempo. The argument is the buffer size in
+// frames.
+template<typename Scaler, bool keylock>
+static void BM_EngineBufferScale_Scratch(benchmark::State& state) {
+    ScalerBenchmark<Scaler> scaler(state, state.range_x());
+    // One back and forth movement every 40 callbacks
+    const double kPhaseIncrement = 2 * M_PI / 40;
+    double phase = 0;
+    while (state.KeepRunning()) {
+        const double rate = keylock ?
+                1.0 + 0.5 * sin(phase) :
+                2.0 * sin(phase);
+        scaler.setScaleParameters(rate, keylock ? 1.0 : rate);
+        scaler.process();
+        phase += kPhaseIncrement;
+    }
+    scaler.report();
+}
+
+void ScratchArguments(benchmark::internal::Benchmark* b) {
+    for (int frames = 64; frames <= 4096; frames *= 4) {
+        b->Arg(frames);
+    }
+}
+
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Rate, EngineBufferScaleLinear, false)
+        ->Apply(RateArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Rate, EngineBufferScaleCubic, false)
+        ->Apply(RateArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Rate, EngineBufferScaleST, true)
+        ->Apply(RateArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Rate, EngineBufferScaleRubberBand, true)
+        ->Apply(RateArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Rate, EngineBufferScaleRubberBandPipelined, true)
+        ->Apply(RateArguments);
+
+BENCHMARK_TEMPLATE(BM_EngineBufferScale_Pitch, EngineBufferScaleST)
+        ->Apply(PitchArguments);
+BENCHMARK_TEMPLATE(BM_EngineBufferScale_Pitch, EngineBufferScaleRubberBand)
+        ->Apply(PitchArguments);
+BENCHMARK_TEMPLATE(BM_EngineBufferScale_Pitch, EngineBufferScaleRubberBandPipelined)
+        ->Apply(PitchArguments);
+
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Scratch, EngineBufferScaleLinear, false)
+        ->Apply(ScratchArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Scratch, EngineBufferScaleCubic, false)
+        ->Apply(ScratchArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Scratch, EngineBufferScaleST, true)
+        ->Apply(ScratchArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Scratch, EngineBufferScaleRubberBand, true)
+        ->Apply(ScratchArguments);
+BENCHMARK_TEMPLATE2(BM_EngineBufferScale_Scratch, EngineBufferScaleRubberBandPipelined, true)
+        ->Apply(ScratchArguments);
+
+}  // namespace
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "engine/enginebufferscalecubic.h"
+#include "engine/enginebufferscalelinear.h"
+#include "engine/readaheadmanager.h"
+#include "test/signalpathtest.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+const SINT kSampleRate = 44100;
+const SINT kBufferSamples = 1024;
+// High enough that the interpolation error is clearly audible
+const double kSineFrequency = 5000.0;
+
+// Reads an endless sine on the left and a cosine on the right channel in
+// both directions, like the ReadAheadManager reads a track.
+class ReadAheadManagerFake : public ReadAheadManager {
+  public:
+    ReadAheadManagerFake()
+            : ReadAheadManager(),
+              m_frame(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            if (dRate < 0) {
+                --m_frame;
+            }
+            buffer[i] = static_cast<CSAMPLE>(0.5 * sin(phase(m_frame)));
+            buffer[i + 1] = static_cast<CSAMPLE>(0.5 * cos(phase(m_frame)));
+            if (dRate >= 0) {
+                ++m_frame;
+            }
+        }
+        return requested_samples;
+    }
+
+    static double phase(double frame) {
+        return 2 * M_PI * kSineFrequency * frame / kSampleRate;
+    }
+
+  private:
+    SINT m_frame;
+};
+
+// Derived from BaseSignalPathTest for the comparison with the reference
+// buffers only. The scalers are tested without an engine.
+class EngineBufferScaleCubicTest : public BaseSignalPathTest {
+  protected:
+    template<typename Scaler>
+    std::unique_ptr<EngineBufferScale> newScaler() {
+        std::unique_ptr<EngineBufferScale> pScaler =
+                std::make_unique<Scaler>(&m_readAheadManager);
+        pScaler->setSampleRate(kSampleRate);
+        setRate(pScaler.get(), 1.0);
+        return pScaler;
+    }
+
+    static void setRate(EngineBufferScale* pScaler, double rate) {
+        double tempoRatio = rate;
+        double pitchRatio = rate;
+        pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    // The RMS deviation of the left channel from the best fitting sine of
+    // the expected frequency, with any phase and amplitude
+    static double sineFitResidual(const QVector<CSAMPLE>& samples,
+            double rate, CSAMPLE* pAmplitude) {
+        const double w = ReadAheadManagerFake::phase(rate);
+        double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+        for (int k = 0; k < samples.size(); ++k) {
+            const double s = sin(w * k);
+            const double c = cos(w * k);
+            ss += s * s;
+            sc += s * c;
+            cc += c * c;
+            ys += samples[k] * s;
+            yc += samples[k] * c;
+        }
+        const double det = ss * cc - sc * sc;
+        const double a = (ys * cc - yc * sc) / det;
+        const double b = (yc * ss - ys * sc) / det;
+        double residual = 0;
+        for (int k = 0; k < samples.size(); ++k) {
+            const double error = samples[k] - a * sin(w * k) - b * cos(w * k);
+            residual += error * error;
+        }
+        *pAmplitude = static_cast<CSAMPLE>(sqrt(a * a + b * b));
+        return sqrt(residual / samples.size());
+    }
+
+    // Scales a few buffers at a constant rate and returns the left channel
+    // once the scaler has settled
+    QVector<CSAMPLE> scaleLeftChannel(EngineBufferScale* pScaler, double rate) {
+        setRate(pScaler, rate);
+        pScaler->scaleBuffer(m_buffer, kBufferSamples);
+        QVector<CSAMPLE> samples;
+        for (int i = 0; i < 4; ++i) {
+            pScaler->scaleBuffer(m_buffer, kBufferSamples);
+            for (SINT j = 0; j < kBufferSamples; j += 2) {
+                samples.append(m_buffer[j]);
+            }
+        }
+        return samples;
+    }
+
+    ReadAheadManagerFake m_readAheadManager;
+    CSAMPLE m_buffer[kBufferSamples];
+};
+
+TEST_F(EngineBufferScaleCubicTest, UnityRateCopiesInput) {
+    auto pScaler = newScaler<EngineBufferScaleCubic>();
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    for (SINT i = 0; i < kBufferSamples; i += 2) {
+        const SINT frame = i / 2;
+        EXPECT_FLOAT_EQ(static_cast<CSAMPLE>(
+                0.5 * sin(ReadAheadManagerFake::phase(frame))), m_buffer[i]);
+        EXPECT_FLOAT_EQ(static_cast<CSAMPLE>(
+                0.5 * cos(ReadAheadManagerFake::phase(frame))), m_buffer[i + 1]);
+    }
+}
+
+TEST_F(EngineBufferScaleCubicTest, ReadsFramesOfRate) {
+    // Once the frames around the position have been read ahead
+    auto pScaler = newScaler<EngineBufferScaleCubic>();
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    EXPECT_EQ(kBufferSamples / 2, pScaler->scaleBuffer(m_buffer, kBufferSamples));
+    setRate(pScaler.get(), 0.5);
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    EXPECT_EQ(kBufferSamples / 4, pScaler->scaleBuffer(m_buffer, kBufferSamples));
+    setRate(pScaler.get(), 2.0);
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    EXPECT_EQ(kBufferSamples, pScaler->scaleBuffer(m_buffer, kBufferSamples));
+}
+
+TEST_F(EngineBufferScaleCubicTest, MoreAccurateThanLinear) {
+    auto pLinear = newScaler<EngineBufferScaleLinear>();
+    auto pCubic = newScaler<EngineBufferScaleCubic>();
+    for (double rate : {0.5, 0.77, 1.5}) {
+        CSAMPLE linearAmplitude;
+        const double linearResidual = sineFitResidual(
+                scaleLeftChannel(pLinear.get(), rate), rate, &linearAmplitude);
+        CSAMPLE cubicAmplitude;
+        const double cubicResidual = sineFitResidual(
+                scaleLeftChannel(pCubic.get(), rate), rate, &cubicAmplitude);
+        EXPECT_GT(linearResidual * 0.6, cubicResidual) << "rate " << rate;
+        // Linear interpolation also attenuates the high frequencies
+        EXPECT_NEAR(0.5, cubicAmplitude, 0.005) << "rate " << rate;
+        EXPECT_LT(linearAmplitude, cubicAmplitude) << "rate " << rate;
+    }
+}
+
+TEST_F(EngineBufferScaleCubicTest, RampRate) {
+    auto pScaler = newScaler<EngineBufferScaleCubic>();
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    setRate(pScaler.get(), 0.63);
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    assertBufferMatchesReference(m_buffer, kBufferSamples, "CubicScalerTest");
+}
+
+TEST_F(EngineBufferScaleCubicTest, Reverse) {
+    // Confirm that changing the direction smoothly transitions.
+    auto pScaler = newScaler<EngineBufferScaleCubic>();
+    setRate(pScaler.get(), 0.9);
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    setRate(pScaler.get(), -0.9);
+    pScaler->scaleBuffer(m_buffer, kBufferSamples);
+    assertBufferMatchesReference(m_buffer, kBufferSamples, "CubicScalerReverseTest");
+}
+
+}  // namespace
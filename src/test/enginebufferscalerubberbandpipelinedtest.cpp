@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "engine/enginebufferscalerubberbandpipelined.h"
+#include "engine/engineworkerscheduler.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+const SINT kSampleRate = 44100;
+const SINT kBufferSamples = 1024;
+
+// Reads a sine wave of endless length, unless a length is set
+class ReadAheadManagerFake : public ReadAheadManager {
+  public:
+    ReadAheadManagerFake()
+            : ReadAheadManager(),
+              m_samplesRead(0),
+              m_samplesAvailable(-1) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer, SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        if (m_samplesAvailable >= 0) {
+            requested_samples = math_min(requested_samples,
+                    m_samplesAvailable - m_samplesRead);
+        }
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            const SINT frame = (m_samplesRead + i) / 2;
+            buffer[i] = buffer[i + 1] = static_cast<CSAMPLE>(
+                    0.5 * sin(2 * M_PI * 440.0 * frame / kSampleRate));
+        }
+        m_samplesRead += requested_samples;
+        return requested_samples;
+    }
+
+    SINT samplesRead() const {
+        return m_samplesRead;
+    }
+
+    void setSamplesAvailable(SINT samples) {
+        m_samplesAvailable = samples;
+    }
+
+  private:
+    SINT m_samplesRead;
+    SINT m_samplesAvailable;
+};
+
+class EngineBufferScaleRubberBandPipelinedTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pScaler = std::make_unique<EngineBufferScaleRubberBandPipelined>(
+                &m_readAheadManager);
+        m_pScaler->bindWorker(&m_scheduler);
+        m_pScaler->setSelected(true);
+        m_pScaler->setSampleRate(kSampleRate);
+        setTempoRatio(1.0);
+        SampleUtil::clear(m_buffer, kBufferSamples);
+    }
+
+    void setTempoRatio(double tempoRatio) {
+        double pitchRatio = 1.0;
+        m_pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    void TearDown() override {
+        m_pScaler.reset();
+    }
+
+    // Processes one callback and lets the worker run afterwards like the
+    // EngineWorkerScheduler would
+    double process() {
+        const double framesRead = m_pScaler->scaleBuffer(m_buffer, kBufferSamples);
+        m_scheduler.waitForIdleWorkers();
+        return framesRead;
+    }
+
+    bool isSilent() const {
+        for (SINT i = 0; i < kBufferSamples; ++i) {
+            if (m_buffer[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ReadAheadManagerFake m_readAheadManager;
+    EngineWorkerScheduler m_scheduler;
+    std::unique_ptr<EngineBufferScaleRubberBandPipelined> m_pScaler;
+    CSAMPLE m_buffer[kBufferSamples];
+};
+
+TEST_F(EngineBufferScaleRubberBandPipelinedTest, OutputLagsBehindInput) {
+    // Nothing has been stretched for the first callback
+    EXPECT_EQ(0.0, process());
+    EXPECT_TRUE(isSilent());
+    EXPECT_LT(0, m_readAheadManager.samplesRead());
+
+    double framesRead = 0;
+    for (int i = 0; i < 50; ++i) {
+        framesRead += process();
+    }
+    // Keeps up with the engine once the pipeline is filled
+    EXPECT_EQ(kBufferSamples / 2, process());
+    EXPECT_FALSE(isSilent());
+
+    // The consumed frames only include the audible frames, so the reported
+    // position lags behind the frames that have been read ahead.
+    const SINT framesReadAhead = m_readAheadManager.samplesRead() / 2;
+    const double latencyFrames = framesReadAhead - framesRead - kBufferSamples / 2;
+    EXPECT_LE(EngineBufferScaleRubberBandPipelined::kBuffersAhead * kBufferSamples / 2,
+            latencyFrames);
+    // Including the latency of RubberBand
+    EXPECT_GT(kSampleRate / 2, latencyFrames);
+}
+
+TEST_F(EngineBufferScaleRubberBandPipelinedTest, RateChangesInPipeline) {
+    // Two seconds of audio
+    m_readAheadManager.setSamplesAvailable(kSampleRate * 4);
+
+    double framesRead = 0;
+    for (int i = 0; i < 20; ++i) {
+        framesRead += process();
+    }
+    // The frames in the pipeline have been read at the old rate. They are
+    // accounted for with the rate they have been stretched with.
+    setTempoRatio(1.25);
+    for (int i = 0; i < 10; ++i) {
+        framesRead += process();
+    }
+    setTempoRatio(0.8);
+    for (int i = 0; i < 40; ++i) {
+        framesRead += process();
+    }
+    // Once the pipeline only contains frames read at the new rate
+    const double frames = process();
+    EXPECT_NEAR(0.8 * kBufferSamples / 2, frames, 1e-6);
+    framesRead += frames;
+    EXPECT_GT(m_readAheadManager.samplesRead() / 2, framesRead);
+
+    // All frames that have been read are consumed after the end of the
+    // track, so the position does not drift from the audio
+    for (int i = 0; i < 300; ++i) {
+        framesRead += process();
+    }
+    EXPECT_EQ(kSampleRate * 4, m_readAheadManager.samplesRead());
+    EXPECT_NEAR(kSampleRate * 2, framesRead, 1e-6);
+}
+
+TEST_F(EngineBufferScaleRubberBandPipelinedTest, WorkerOnlyRunsWhileSelected) {
+    EXPECT_TRUE(m_pScaler->isWorkerRunning());
+    m_pScaler->setSelected(false);
+    // The worker is not stopped while the engine may still be inside the
+    // scaler, but after the next callback
+    EXPECT_TRUE(m_pScaler->isWorkerRunning());
+    process();
+    EXPECT_FALSE(m_pScaler->isWorkerRunning());
+
+    // Selecting the scaler again restarts the worker
+    m_pScaler->setSelected(true);
+    EXPECT_TRUE(m_pScaler->isWorkerRunning());
+    m_pScaler->clear();
+    for (int i = 0; i < 50; ++i) {
+        process();
+    }
+    EXPECT_FALSE(isSilent());
+
+    // A scaler that is not bound yet does not start its worker
+    EngineWorkerScheduler scheduler;
+    EngineBufferScaleRubberBandPipelined scaler(&m_readAheadManager);
+    scaler.setSelected(true);
+    EXPECT_FALSE(scaler.isWorkerRunning());
+    scaler.bindWorker(&scheduler);
+    EXPECT_TRUE(scaler.isWorkerRunning());
+}
+
+TEST_F(EngineBufferScaleRubberBandPipelinedTest, ClearDropsStretchedAudio) {
+    for (int i = 0; i < 50; ++i) {
+        process();
+    }
+    EXPECT_FALSE(isSilent());
+
+    // Stretching starts over with the new position
+    m_pScaler->clear();
+    EXPECT_EQ(0.0, process());
+    EXPECT_TRUE(isSilent());
+}
+
+}  // namespace
@@ -274,6 +274,35 @@ TEST_F(EngineBufferE2ETest, ReverseTest) {
                                  kProcessBufferSize, "ReverseTest");
 }
 
+TEST_F(EngineBufferE2ETest, CubicVinylScalerTest) {
+    // The vinyl scaler can be changed during playback and is also used
+    // for reverse playback.
+    EngineBuffer* pEngineBuffer = m_pChannel1->getEngineBuffer();
+    ControlObject::set(ConfigKey(m_sGroup1, "rate"), 0.05);
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    ProcessBuffer();
+    EXPECT_EQ(pEngineBuffer->m_pScaleLinear, pEngineBuffer->m_pScale);
+
+    ControlObject::set(ConfigKey(m_sGroup1, "vinyl_scaler"),
+                       static_cast<double>(EngineBuffer::VINYL_SCALER_CUBIC));
+    ProcessBuffer();
+    EXPECT_EQ(pEngineBuffer->m_pScaleCubic, pEngineBuffer->m_pScale);
+    CSAMPLE absL, absR;
+    SampleUtil::sumAbsPerChannel(&absL, &absR,
+            m_pEngineMaster->masterBuffer(), kProcessBufferSize);
+    EXPECT_LT(0.0, absL);
+    EXPECT_LT(0.0, absR);
+
+    ControlObject::set(ConfigKey(m_sGroup1, "reverse"), 1.0);
+    ProcessBuffer();
+    EXPECT_EQ(pEngineBuffer->m_pScaleCubic, pEngineBuffer->m_pScale);
+
+    ControlObject::set(ConfigKey(m_sGroup1, "vinyl_scaler"),
+                       static_cast<double>(EngineBuffer::VINYL_SCALER_LINEAR));
+    ProcessBuffer();
+    EXPECT_EQ(pEngineBuffer->m_pScaleLinear, pEngineBuffer->m_pScale);
+}
+
 // DISABLED: This test is too dependent on the sound touch library version.
 TEST_F(EngineBufferE2ETest, DISABLED_SoundTouchToggleTest) {
    // Test various cases where SoundTouch toggles on and off.
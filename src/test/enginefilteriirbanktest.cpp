@@ -0,0 +1,161 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QVector>
+
+#include "engine/enginefilterbessel4.h"
+#include "engine/enginefilteriirbank.h"
+#include "engine/enginefilterlinkwitzriley8.h"
+#include "util/sample.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+const int kBufferSize = 1024;
+
+void fillWithNoise(CSAMPLE* pBuffer, int size, unsigned int* pSeed) {
+    for (int i = 0; i < size; ++i) {
+        *pSeed = *pSeed * 1103515245 + 12345;
+        pBuffer[i] = static_cast<CSAMPLE>((*pSeed >> 16) & 0x7fff) / 0x4000 - 1;
+    }
+}
+
+class EngineFilterIIRBankTest : public testing::Test {
+  protected:
+    void assertBuffersNear(const QVector<CSAMPLE>& expected,
+            const QVector<CSAMPLE>& actual, CSAMPLE tolerance) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (int i = 0; i < expected.size(); ++i) {
+            ASSERT_NEAR(expected[i], actual[i], tolerance) << "at sample " << i;
+        }
+    }
+};
+
+TEST_F(EngineFilterIIRBankTest, MatchesSeparateFilters) {
+    EngineFilterLinkwitzRiley8High high(kSampleRate, 2484);
+    EngineFilterLinkwitzRiley8Low low(kSampleRate, 246);
+    EngineFilterIIRBank<8, 2> bank;
+    bank.setCoefs(0, high);
+    bank.setCoefs(1, low);
+
+    QVector<CSAMPLE> input(kBufferSize);
+    QVector<CSAMPLE> highOut(kBufferSize);
+    QVector<CSAMPLE> lowOut(kBufferSize);
+    QVector<CSAMPLE> bankHighOut(kBufferSize);
+    QVector<CSAMPLE> bankLowOut(kBufferSize);
+    unsigned int seed = 1;
+    for (int buffer = 0; buffer < 8; ++buffer) {
+        if (buffer == 4) {
+            // Changing the corner ramps to the new filter
+            high.setFrequencyCorners(kSampleRate, 1000);
+            bank.setCoefs(0, high);
+        }
+        fillWithNoise(input.data(), kBufferSize, &seed);
+        high.process(input.constData(), highOut.data(), kBufferSize);
+        low.process(input.constData(), lowOut.data(), kBufferSize);
+        const CSAMPLE* const pIn[] = {input.constData(), input.constData()};
+        CSAMPLE* const pOut[] = {bankHighOut.data(), bankLowOut.data()};
+        bank.process(pIn, pOut, kBufferSize);
+        assertBuffersNear(highOut, bankHighOut, 1e-5f);
+        assertBuffersNear(lowOut, bankLowOut, 1e-5f);
+    }
+
+    // Pausing fades out and restarts from silence
+    const CSAMPLE* const pIn[] = {input.constData(), input.constData()};
+    CSAMPLE* const pOut[] = {bankHighOut.data(), bankLowOut.data()};
+    high.processAndPauseFilter(input.constData(), highOut.data(), kBufferSize);
+    low.processAndPauseFilter(input.constData(), lowOut.data(), kBufferSize);
+    bank.processAndPauseFilter(pIn, pOut, kBufferSize);
+    assertBuffersNear(highOut, bankHighOut, 1e-5f);
+    assertBuffersNear(lowOut, bankLowOut, 1e-5f);
+    high.process(input.constData(), highOut.data(), kBufferSize);
+    low.process(input.constData(), lowOut.data(), kBufferSize);
+    bank.process(pIn, pOut, kBufferSize);
+    assertBuffersNear(highOut, bankHighOut, 1e-5f);
+    assertBuffersNear(lowOut, bankLowOut, 1e-5f);
+}
+
+TEST_F(EngineFilterIIRBankTest, InPlace) {
+    EngineFilterBessel4Low low(kSampleRate, 2484);
+    EngineFilterIIRBank<4, 1> bank;
+    bank.setCoefs(0, low);
+
+    QVector<CSAMPLE> input(kBufferSize);
+    QVector<CSAMPLE> expected(kBufferSize);
+    unsigned int seed = 2;
+    for (int buffer = 0; buffer < 4; ++buffer) {
+        fillWithNoise(input.data(), kBufferSize, &seed);
+        low.process(input.constData(), expected.data(), kBufferSize);
+        const CSAMPLE* const pIn[] = {input.constData()};
+        CSAMPLE* const pOut[] = {input.data()};
+        bank.process(pIn, pOut, kBufferSize);
+        assertBuffersNear(expected, input, 1e-5f);
+    }
+}
+
+TEST_F(EngineFilterIIRBankTest, SinglePrecision) {
+    EngineFilterBessel4Low low(kSampleRate, 2484);
+    EngineFilterIIRBank<4, 1> bank;
+    EngineFilterIIRBank<4, 1, float> floatBank;
+    bank.setCoefs(0, low);
+    floatBank.setCoefs(0, low);
+
+    QVector<CSAMPLE> input(kBufferSize);
+    QVector<CSAMPLE> expected(kBufferSize);
+    QVector<CSAMPLE> output(kBufferSize);
+    unsigned int seed = 3;
+    for (int buffer = 0; buffer < 16; ++buffer) {
+        fillWithNoise(input.data(), kBufferSize, &seed);
+        const CSAMPLE* const pIn[] = {input.constData()};
+        CSAMPLE* const pExpected[] = {expected.data()};
+        CSAMPLE* const pOut[] = {output.data()};
+        bank.process(pIn, pExpected, kBufferSize);
+        floatBank.process(pIn, pOut, kBufferSize);
+        assertBuffersNear(expected, output, 1e-3f);
+    }
+}
+
+// Processes a three band EQ (two stereo filters) with separate filters
+// and with a filter bank in double and single precision
+static void BM_EngineFilterIIR_Separate(benchmark::State& state) {
+    const int size = state.range_x();
+    EngineFilterLinkwitzRiley8High high(kSampleRate, 2484);
+    EngineFilterLinkwitzRiley8Low low(kSampleRate, 246);
+    high.assumeSettled();
+    low.assumeSettled();
+    QVector<CSAMPLE> input(size);
+    QVector<CSAMPLE> highOut(size);
+    QVector<CSAMPLE> lowOut(size);
+    unsigned int seed = 4;
+    fillWithNoise(input.data(), size, &seed);
+    while (state.KeepRunning()) {
+        high.process(input.constData(), highOut.data(), size);
+        low.process(input.constData(), lowOut.data(), size);
+    }
+}
+BENCHMARK(BM_EngineFilterIIR_Separate)->Range(64, 4096);
+
+template<typename SAMPLE>
+static void BM_EngineFilterIIRBank(benchmark::State& state) {
+    const int size = state.range_x();
+    EngineFilterLinkwitzRiley8High high(kSampleRate, 2484);
+    EngineFilterLinkwitzRiley8Low low(kSampleRate, 246);
+    EngineFilterIIRBank<8, 2, SAMPLE> bank;
+    bank.setCoefs(0, high);
+    bank.setCoefs(1, low);
+    bank.assumeSettled();
+    QVector<CSAMPLE> input(size);
+    QVector<CSAMPLE> highOut(size);
+    QVector<CSAMPLE> lowOut(size);
+    unsigned int seed = 4;
+    fillWithNoise(input.data(), size, &seed);
+    const CSAMPLE* const pIn[] = {input.constData(), input.constData()};
+    CSAMPLE* const pOut[] = {highOut.data(), lowOut.data()};
+    while (state.KeepRunning()) {
+        bank.process(pIn, pOut, size);
+    }
+}
+BENCHMARK_TEMPLATE(BM_EngineFilterIIRBank, double)->Range(64, 4096);
+BENCHMARK_TEMPLATE(BM_EngineFilterIIRBank, float)->Range(64, 4096);
+
+}  // namespace
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "engine/enginethreadpool.h"
+
+namespace {
+
+class CountingTask : public EngineThreadPool::Task {
+  public:
+    explicit CountingTask(int count)
+            : m_runs(count) {
+        for (auto& runs : m_runs) {
+            runs.store(0);
+        }
+    }
+
+    void run(int index) override {
+        m_runs[index].fetch_add(1);
+    }
+
+    int runs(int index) const {
+        return m_runs[index].load();
+    }
+
+  private:
+    std::vector<std::atomic<int>> m_runs;
+};
+
+TEST(EngineThreadPoolTest, RunsEveryIndexExactlyOnce) {
+    EngineThreadPool pool(3);
+    EXPECT_EQ(3, pool.helperThreadCount());
+
+    const int kTaskCount = 17;
+    CountingTask task(kTaskCount);
+    // Run many jobs back to back to exercise the spin handoff and the join.
+    const int kJobCount = 1000;
+    for (int job = 0; job < kJobCount; ++job) {
+        pool.run(&task, kTaskCount);
+    }
+    for (int i = 0; i < kTaskCount; ++i) {
+        EXPECT_EQ(kJobCount, task.runs(i));
+    }
+}
+
+TEST(EngineThreadPoolTest, NoHelperThreads) {
+    EngineThreadPool pool(0);
+    EXPECT_EQ(0, pool.helperThreadCount());
+
+    CountingTask task(4);
+    pool.run(&task, 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(1, task.runs(i));
+    }
+}
+
+TEST(EngineThreadPoolTest, EmptyJob) {
+    EngineThreadPool pool(2);
+    CountingTask task(1);
+    pool.run(&task, 0);
+    EXPECT_EQ(0, task.runs(0));
+}
+
+TEST(EngineThreadPoolTest, HelperThreadCountIsCapped) {
+    EngineThreadPool pool(kMaxEngineHelperThreads + 10);
+    EXPECT_EQ(kMaxEngineHelperThreads, pool.helperThreadCount());
+}
+
+}  // namespace
@@ -0,0 +1,218 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QHash>
+#include <QLinkedList>
+#include <QVector>
+
+#include "util/fixedcapacityhash.h"
+
+namespace {
+
+struct Chunk {
+    Chunk()
+            : index(-1),
+              pPrev(nullptr),
+              pNext(nullptr) {
+    }
+    SINT index;
+    Chunk* pPrev;
+    Chunk* pNext;
+};
+
+TEST(FixedCapacityHashTest, InsertAndRemove) {
+    const int kCapacity = 80;
+    QVector<Chunk> chunks(kCapacity);
+    FixedCapacityHash<Chunk> hash(kCapacity);
+    EXPECT_TRUE(hash.isEmpty());
+    for (int i = 0; i < kCapacity; ++i) {
+        // Colliding multiples of the table size and consecutive keys
+        EXPECT_TRUE(hash.insert(i % 2 ? i * 256 : i, &chunks[i]));
+    }
+    EXPECT_EQ(kCapacity, hash.size());
+    Chunk another;
+    EXPECT_FALSE(hash.insert(-1, &another));
+    // Replacing does not need another entry
+    EXPECT_TRUE(hash.insert(0, &another));
+    EXPECT_EQ(&another, hash.value(0));
+    EXPECT_TRUE(hash.insert(0, &chunks[0]));
+
+    for (int i = 0; i < kCapacity; i += 3) {
+        EXPECT_EQ(&chunks[i], hash.remove(i % 2 ? i * 256 : i));
+    }
+    EXPECT_EQ(nullptr, hash.remove(3 * 256));
+    for (int i = 0; i < kCapacity; ++i) {
+        const SINT key = i % 2 ? i * 256 : i;
+        if (i % 3 == 0) {
+            EXPECT_EQ(nullptr, hash.value(key));
+        } else {
+            EXPECT_EQ(&chunks[i], hash.value(key));
+        }
+    }
+
+    hash.clear();
+    EXPECT_TRUE(hash.isEmpty());
+    EXPECT_EQ(nullptr, hash.value(1));
+}
+
+TEST(FixedCapacityHashTest, MatchesQHash) {
+    const int kCapacity = 32;
+    QVector<Chunk> chunks(kCapacity);
+    FixedCapacityHash<Chunk> hash(kCapacity);
+    QHash<SINT, Chunk*> expected;
+    unsigned int seed = 1;
+    for (int i = 0; i < 100000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        const SINT key = (seed >> 16) % 97 - 8;
+        Chunk* pChunk = &chunks[(seed >> 8) % kCapacity];
+        if ((seed >> 24) % 2 || expected.size() == kCapacity) {
+            ASSERT_EQ(expected.take(key), hash.remove(key));
+        } else {
+            expected.insert(key, pChunk);
+            ASSERT_TRUE(hash.insert(key, pChunk));
+        }
+        ASSERT_EQ(expected.size(), hash.size());
+        for (auto it = expected.constBegin(); it != expected.constEnd(); ++it) {
+            ASSERT_EQ(it.value(), hash.value(it.key()));
+        }
+    }
+}
+
+// Simulates the cache of CachingReader with hints that wander through a
+// track: Looks up each hinted chunk and moves it to the front of the LRU
+// list. A missing chunk is taken from the free list or replaces the LRU
+// chunk. Both variants share the intrusive LRU list and only differ in the
+// index and the free list.
+class ChunkCache {
+  public:
+    explicit ChunkCache(int capacity)
+            : m_chunks(capacity),
+              m_pMru(nullptr),
+              m_pLru(nullptr) {
+    }
+
+  protected:
+    void freshen(Chunk* pChunk) {
+        unlink(pChunk);
+        pChunk->pNext = m_pMru;
+        if (m_pMru) {
+            m_pMru->pPrev = pChunk;
+        }
+        m_pMru = pChunk;
+        if (m_pLru == nullptr) {
+            m_pLru = pChunk;
+        }
+    }
+
+    void unlink(Chunk* pChunk) {
+        if (pChunk->pPrev) {
+            pChunk->pPrev->pNext = pChunk->pNext;
+        }
+        if (pChunk->pNext) {
+            pChunk->pNext->pPrev = pChunk->pPrev;
+        }
+        if (m_pMru == pChunk) {
+            m_pMru = pChunk->pNext;
+        }
+        if (m_pLru == pChunk) {
+            m_pLru = pChunk->pPrev;
+        }
+        pChunk->pPrev = nullptr;
+        pChunk->pNext = nullptr;
+    }
+
+    QVector<Chunk> m_chunks;
+    Chunk* m_pMru;
+    Chunk* m_pLru;
+};
+
+class QHashChunkCache : public ChunkCache {
+  public:
+    explicit QHashChunkCache(int capacity)
+            : ChunkCache(capacity) {
+        m_index.reserve(capacity);
+        for (auto& chunk: m_chunks) {
+            m_free.push_back(&chunk);
+        }
+    }
+
+    void hint(SINT index) {
+        Chunk* pChunk = m_index.value(index, nullptr);
+        if (pChunk == nullptr) {
+            if (m_free.isEmpty()) {
+                Chunk* pLru = m_pLru;
+                m_index.remove(pLru->index);
+                unlink(pLru);
+                m_free.push_back(pLru);
+            }
+            pChunk = m_free.takeFirst();
+            pChunk->index = index;
+            m_index.insert(index, pChunk);
+        }
+        freshen(pChunk);
+    }
+
+  private:
+    QHash<int, Chunk*> m_index;
+    QLinkedList<Chunk*> m_free;
+};
+
+class FixedCapacityChunkCache : public ChunkCache {
+  public:
+    explicit FixedCapacityChunkCache(int capacity)
+            : ChunkCache(capacity),
+              m_index(capacity),
+              m_pFree(nullptr) {
+        for (auto& chunk: m_chunks) {
+            chunk.pNext = m_pFree;
+            m_pFree = &chunk;
+        }
+    }
+
+    void hint(SINT index) {
+        Chunk* pChunk = m_index.value(index);
+        if (pChunk == nullptr) {
+            if (m_pFree == nullptr) {
+                Chunk* pLru = m_pLru;
+                m_index.remove(pLru->index);
+                unlink(pLru);
+                m_pFree = pLru;
+            }
+            pChunk = m_pFree;
+            m_pFree = pChunk->pNext;
+            pChunk->pNext = nullptr;
+            pChunk->index = index;
+            m_index.insert(index, pChunk);
+        }
+        freshen(pChunk);
+    }
+
+  private:
+    FixedCapacityHash<Chunk> m_index;
+    Chunk* m_pFree;
+};
+
+template<typename Cache>
+static void BM_ChunkCacheHint(benchmark::State& state) {
+    // The capacity of CachingReader
+    Cache cache(80);
+    // Each callback hints the chunks around the play position and a few cue
+    // points, and every now and then the play position moves to a new chunk.
+    const SINT kCues[] = {0, 7, 42, 133};
+    SINT position = 0;
+    while (state.KeepRunning()) {
+        for (int callback = 0; callback < 64; ++callback) {
+            const SINT chunk = position / 64;
+            cache.hint(chunk);
+            cache.hint(chunk + 1);
+            for (SINT cue: kCues) {
+                cache.hint(cue);
+            }
+            position += state.range_x();
+        }
+    }
+}
+BENCHMARK_TEMPLATE(BM_ChunkCacheHint, QHashChunkCache)->Arg(1)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ChunkCacheHint, FixedCapacityChunkCache)->Arg(1)->Arg(64);
+
+}  // namespace
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "util/latencyhistogram.h"
+
+namespace {
+
+class LatencyHistogramTest : public testing::Test {
+};
+
+TEST_F(LatencyHistogramTest, BucketBounds) {
+    // Every duration lies below the upper bound of its bucket and at or
+    // above the upper bound of the previous one
+    for (qint64 micros = 0; micros < 100000; ++micros) {
+        const int bucket = LatencyHistogram::bucketForMicros(micros);
+        ASSERT_LT(micros, LatencyHistogram::bucketUpperBoundMicros(bucket))
+                << micros;
+        if (bucket > 0) {
+            ASSERT_GE(micros,
+                    LatencyHistogram::bucketUpperBoundMicros(bucket - 1))
+                    << micros;
+        }
+    }
+    EXPECT_EQ(0, LatencyHistogram::bucketForMicros(-5));
+    EXPECT_EQ(LatencyHistogram::kNumBuckets - 1,
+            LatencyHistogram::bucketForMicros(Q_INT64_C(1) << 40));
+}
+
+TEST_F(LatencyHistogramTest, Percentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(mixxx::Duration::empty(), histogram.percentile(50));
+
+    for (int micros = 1; micros <= 1000; ++micros) {
+        histogram.record(mixxx::Duration::fromMicros(micros));
+    }
+    EXPECT_EQ(1000u, histogram.count());
+    EXPECT_EQ(mixxx::Duration::fromMicros(1000), histogram.max());
+
+    // Percentiles are rounded up to the end of their bucket, which is at
+    // most 12.5% off
+    const double p50 = histogram.percentile(50).toDoubleMicros();
+    EXPECT_GE(p50, 500.0);
+    EXPECT_LE(p50, 500.0 * 1.125);
+    const double p90 = histogram.percentile(90).toDoubleMicros();
+    EXPECT_GE(p90, 900.0);
+    EXPECT_LE(p90, 900.0 * 1.125);
+    // Never above the maximum
+    EXPECT_EQ(mixxx::Duration::fromMicros(1000), histogram.percentile(99));
+    EXPECT_EQ(mixxx::Duration::fromMicros(1000), histogram.percentile(100));
+
+    histogram.reset();
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(mixxx::Duration::empty(), histogram.max());
+}
+
+}  // namespace
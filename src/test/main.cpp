@@ -2,6 +2,7 @@
 
 #include "mixxxtest.h"
 #include "errordialoghandler.h"
+#include "util/sample.h"
 
 int main(int argc, char **argv) {
     // We never want to popup error dialogs when running tests.
@@ -23,6 +24,7 @@ int main(int argc, char **argv) {
 
     // Otherwise, run the test suite:
     MixxxTest::ApplicationScope applicationScope(argc, argv);
+    SampleUtil::initialize();
 
     if (run_benchmarks) {
         benchmark::RunSpecifiedBenchmarks();
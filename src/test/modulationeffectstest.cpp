@@ -0,0 +1,590 @@
+#include <gtest/gtest.h>
+
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QtDebug>
+
+#include "effects/builtin/autopaneffect.h"
+#include "effects/builtin/flangereffect.h"
+#include "effects/builtin/phasereffect.h"
+#include "effects/builtin/tremoloeffect.h"
+#include "effects/effectinstantiator.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/groupfeaturestate.h"
+#include "test/baseeffecttest.h"
+#include "util/math.h"
+#include "util/rampingvalue.h"
+#include "util/samplebuffer.h"
+
+// The LFO driven effects compute their modulation per block and interpolate
+// it in between. These tests compare them with the scalar implementations
+// that evaluated the LFO for every frame, which are kept here as reference.
+
+namespace {
+
+typedef QMap<QString, double> ParameterValues;
+
+const SINT kSampleRate = 44100;
+// Including sizes that are not a multiple of the block size
+const SINT kBufferFrames[] = {1024, 1024, 100, 333, 2048, 64, 1, 512, 1024};
+
+// Creates the processor like EffectProcessorInstantiator, but keeps a
+// pointer to it. The processor is owned by the EngineEffect.
+template<typename Effect>
+class TestEffectInstantiator : public EffectInstantiator {
+  public:
+    TestEffectInstantiator()
+            : m_pEffect(nullptr) {
+    }
+
+    EffectProcessor* instantiate(EngineEffect* pEngineEffect,
+            EffectManifestPointer pManifest) override {
+        Q_UNUSED(pManifest);
+        m_pEffect = new Effect(pEngineEffect);
+        return m_pEffect;
+    }
+
+    Effect* effect() const {
+        return m_pEffect;
+    }
+
+  private:
+    Effect* m_pEffect;
+};
+
+void referenceTremolo(TremoloState* pState,
+        const CSAMPLE* pInput, CSAMPLE* pOutput,
+        const mixxx::EngineParameters& bufferParameters,
+        const EffectEnableState enableState,
+        const GroupFeatureState& groupFeatures,
+        ParameterValues parameters) {
+    const double kMaxGainIncrement = 0.001;
+
+    const double width = parameters["width"];
+    const double smooth = parameters["waveform"];
+    const double depth = parameters["depth"];
+    const bool quantize = parameters["quantize"] != 0;
+    const bool triplet = parameters["triplet"] != 0;
+
+    unsigned int currentFrame = pState->currentFrame;
+    double gain = pState->gain;
+
+    const GroupFeatureState& gf = groupFeatures;
+
+    bool quantizeEnabling = !pState->quantizeEnabled && quantize;
+    bool tripletDisabling = pState->tripletEnabled && !triplet;
+
+    if (enableState == EffectEnableState::Enabling
+     || quantizeEnabling
+     || tripletDisabling) {
+        if (gf.has_beat_length_sec && gf.has_beat_fraction) {
+            currentFrame = gf.beat_fraction * gf.beat_length_sec * bufferParameters.sampleRate();
+        } else {
+            currentFrame = 0;
+        }
+        gain = 0;
+    }
+
+    int framePerPeriod;
+    double rate = parameters["rate"];
+    if (gf.has_beat_length_sec && gf.has_beat_fraction) {
+        if (quantize) {
+            int divider = log2(rate);
+            rate = pow(2, divider);
+
+            if (triplet) {
+                rate *= 3.0;
+            }
+        }
+        int framePerBeat = gf.beat_length_sec * bufferParameters.sampleRate();
+        framePerPeriod = framePerBeat / rate;
+    } else {
+        framePerPeriod = bufferParameters.sampleRate() / rate;
+    }
+
+    unsigned int phaseOffsetFrame = parameters["phase"] * framePerPeriod;
+    currentFrame = currentFrame % framePerPeriod;
+
+    for (unsigned int i = 0;
+            i < bufferParameters.samplesPerBuffer();
+            i += bufferParameters.channelCount()) {
+        unsigned int positionFrame = (currentFrame - phaseOffsetFrame);
+        positionFrame = positionFrame % framePerPeriod;
+
+        double position = static_cast<double>(positionFrame) / framePerPeriod;
+        if (position < width) {
+            position = 0.5 / width * position;
+        } else {
+            position = 0.5 + 0.5 * (position - width) / (1 - width);
+        }
+
+        double gainTarget = 1.0 - (depth / 2.0)
+                + (atan(sin(2.0 * M_PI * position) / smooth) / (2 * atan(1 / smooth)))
+                    * depth;
+
+        if (gainTarget > gain + kMaxGainIncrement) {
+            gain += kMaxGainIncrement;
+        } else if (gainTarget < gain - kMaxGainIncrement) {
+            gain -= kMaxGainIncrement;
+        } else {
+            gain = gainTarget;
+        }
+
+        for (int channel = 0; channel < bufferParameters.channelCount(); channel++) {
+            pOutput[i+channel] = gain * pInput[i+channel];
+        }
+
+        currentFrame++;
+    }
+
+    pState->currentFrame = currentFrame;
+    pState->gain = gain;
+    pState->quantizeEnabled = quantize;
+    pState->tripletEnabled = triplet;
+}
+
+inline CSAMPLE tanh_approx(CSAMPLE input) {
+    return input / (1 + input * input / (3 + input * input / 5));
+}
+
+void referenceFlanger(FlangerGroupState* pState,
+        const CSAMPLE* pInput, CSAMPLE* pOutput,
+        const mixxx::EngineParameters& bufferParameters,
+        const EffectEnableState enableState,
+        const GroupFeatureState& groupFeatures,
+        ParameterValues parameters) {
+    const double kGainCorrection = 1.4125375446227544;
+
+    double lfoPeriodParameter = parameters["speed"];
+    double lfoPeriodFrames;
+    if (groupFeatures.has_beat_length_sec) {
+        lfoPeriodParameter = std::max(roundToFraction(lfoPeriodParameter, 2.0), kMinLfoBeats);
+        if (parameters["triplet"] != 0) {
+            lfoPeriodParameter /= 3.0;
+        }
+        lfoPeriodFrames = lfoPeriodParameter * groupFeatures.beat_length_sec
+                * bufferParameters.sampleRate();
+    } else {
+        lfoPeriodFrames = std::max(lfoPeriodParameter, kMinLfoBeats)
+                * bufferParameters.sampleRate();
+    }
+
+    if (pState->previousPeriodFrames != -1.0) {
+        pState->lfoFrames *= lfoPeriodFrames / pState->previousPeriodFrames;
+    }
+    pState->previousPeriodFrames = lfoPeriodFrames;
+
+    CSAMPLE_GAIN mix = parameters["mix"];
+    RampingValue<CSAMPLE_GAIN> mixRamped(
+            pState->prev_mix, mix, bufferParameters.framesPerBuffer());
+    pState->prev_mix = mix;
+
+    CSAMPLE_GAIN regen = parameters["regen"];
+    RampingValue<CSAMPLE_GAIN> regenRamped(
+            pState->prev_regen, regen, bufferParameters.framesPerBuffer());
+    pState->prev_regen = regen;
+
+    double width = parameters["width"];
+    double manual = parameters["manual"];
+    double maxManual = kCenterDelayMs + (kMaxLfoWidthMs - width) / 2;
+    double minManual = kCenterDelayMs - (kMaxLfoWidthMs - width) / 2;
+    manual = math_clamp(manual, minManual, maxManual);
+
+    RampingValue<double> widthRamped(
+            pState->prev_width, width, bufferParameters.framesPerBuffer());
+    pState->prev_width = width;
+
+    RampingValue<double> manualRamped(
+            pState->prev_manual, manual, bufferParameters.framesPerBuffer());
+    pState->prev_manual = manual;
+
+    CSAMPLE* delayLeft = pState->delayLeft;
+    CSAMPLE* delayRight = pState->delayRight;
+
+    for (unsigned int i = 0;
+            i < bufferParameters.samplesPerBuffer();
+            i += bufferParameters.channelCount()) {
+        CSAMPLE_GAIN mix_ramped = mixRamped.getNext();
+        CSAMPLE_GAIN regen_ramped = regenRamped.getNext();
+        double width_ramped = widthRamped.getNext();
+        double manual_ramped = manualRamped.getNext();
+
+        pState->lfoFrames++;
+        if (pState->lfoFrames >= lfoPeriodFrames) {
+            pState->lfoFrames = 0;
+        }
+
+        float periodFraction = static_cast<float>(pState->lfoFrames) / lfoPeriodFrames;
+        double delayMs = manual_ramped + width_ramped / 2 * sin(M_PI * 2.0f * periodFraction);
+        double delayFrames = delayMs * bufferParameters.sampleRate() / 1000;
+
+        SINT framePrev = (pState->delayPos - static_cast<SINT>(floor(delayFrames))
+                + kBufferLenth) % kBufferLenth;
+        SINT frameNext = (pState->delayPos - static_cast<SINT>(ceil(delayFrames))
+                + kBufferLenth) % kBufferLenth;
+        CSAMPLE prevLeft = delayLeft[framePrev];
+        CSAMPLE nextLeft = delayLeft[frameNext];
+
+        CSAMPLE prevRight = delayRight[framePrev];
+        CSAMPLE nextRight = delayRight[frameNext];
+
+        CSAMPLE frac = delayFrames - floorf(delayFrames);
+        CSAMPLE delayedSampleLeft = prevLeft + frac * (nextLeft - prevLeft);
+        CSAMPLE delayedSampleRight = prevRight + frac * (nextRight - prevRight);
+
+        delayLeft[pState->delayPos] = tanh_approx(pInput[i] + regen_ramped * delayedSampleLeft);
+        delayRight[pState->delayPos] = tanh_approx(pInput[i + 1] + regen_ramped * delayedSampleRight);
+
+        pState->delayPos = (pState->delayPos + 1) % kBufferLenth;
+
+        double gain = (1 - mix_ramped + kGainCorrection * mix_ramped);
+        pOutput[i] = (pInput[i] + mix_ramped * delayedSampleLeft) / gain;
+        pOutput[i + 1] = (pInput[i + 1] + mix_ramped * delayedSampleRight) / gain;
+    }
+
+    if (enableState == EffectEnableState::Disabling) {
+        SampleUtil::clear(delayLeft, kBufferLenth);
+        SampleUtil::clear(delayRight, kBufferLenth);
+        pState->previousPeriodFrames = -1;
+        pState->prev_regen = 0;
+        pState->prev_mix = 0;
+    }
+}
+
+inline CSAMPLE processPhaserSample(CSAMPLE input, CSAMPLE* oldIn, CSAMPLE* oldOut,
+        CSAMPLE mainCoef, int stages) {
+    for (int j = 0; j < stages; j++) {
+        oldOut[j] = (mainCoef * input) + (mainCoef * oldOut[j]) - oldIn[j];
+        oldIn[j] = input;
+        input = oldOut[j];
+    }
+    return input;
+}
+
+void referencePhaser(PhaserGroupState* pState,
+        const CSAMPLE* pInput, CSAMPLE* pOutput,
+        const mixxx::EngineParameters& bufferParameters,
+        const EffectEnableState enableState,
+        const GroupFeatureState& groupFeatures,
+        ParameterValues parameters) {
+    const unsigned int updateCoef = 32;
+
+    if (enableState == EffectEnableState::Enabling) {
+        pState->clear();
+    }
+
+    CSAMPLE depth = 0;
+    if (enableState != EffectEnableState::Disabling) {
+        depth = parameters["depth"];
+    }
+
+    double periodParameter = parameters["lfo_period"];
+    double periodSamples;
+    if (groupFeatures.has_beat_length_sec) {
+        periodParameter = std::max(roundToFraction(periodParameter, 2.0), 1/4.0);
+        if (parameters["triplet"] != 0) {
+            periodParameter /= 3.0;
+        }
+        periodSamples = periodParameter * groupFeatures.beat_length_sec * bufferParameters.sampleRate();
+    } else {
+        periodSamples = std::max(periodParameter, 1/4.0) * bufferParameters.sampleRate();
+    }
+    CSAMPLE freqSkip = 1.0 / periodSamples * 2.0 * M_PI;
+
+    CSAMPLE feedback = parameters["feedback"];
+    CSAMPLE range = parameters["range"];
+    int stages = 2 * parameters["stages"];
+
+    CSAMPLE* oldInLeft = pState->oldInLeft;
+    CSAMPLE* oldOutLeft = pState->oldOutLeft;
+    CSAMPLE* oldInRight = pState->oldInRight;
+    CSAMPLE* oldOutRight = pState->oldOutRight;
+
+    CSAMPLE filterCoefLeft = 0;
+    CSAMPLE filterCoefRight = 0;
+
+    CSAMPLE left = 0, right = 0;
+
+    CSAMPLE_GAIN oldDepth = pState->oldDepth;
+    const CSAMPLE_GAIN depthDelta = (depth - oldDepth)
+            / bufferParameters.framesPerBuffer();
+    const CSAMPLE_GAIN depthStart = oldDepth + depthDelta;
+
+    int stereoCheck = parameters["stereo"];
+    int counter = 0;
+
+    for (unsigned int i = 0;
+            i < bufferParameters.samplesPerBuffer();
+            i += bufferParameters.channelCount()) {
+        left = pInput[i] + tanh(left * feedback);
+        right = pInput[i + 1] + tanh(right * feedback);
+
+        pState->leftPhase = fmodf(pState->leftPhase + freqSkip, 2.0 * M_PI);
+        pState->rightPhase = fmodf(pState->rightPhase + freqSkip + M_PI * stereoCheck, 2.0 * M_PI);
+
+        if ((counter++) % updateCoef == 0) {
+                CSAMPLE delayLeft = 0.5 + 0.5 * sin(pState->leftPhase);
+                CSAMPLE delayRight = 0.5 + 0.5 * sin(pState->rightPhase);
+
+                CSAMPLE wLeft = range * delayLeft;
+                CSAMPLE wRight = range * delayRight;
+
+                CSAMPLE tanwLeft = tanh(wLeft / 2);
+                CSAMPLE tanwRight = tanh(wRight / 2);
+
+                filterCoefLeft = (1.0 - tanwLeft) / (1.0 + tanwLeft);
+                filterCoefRight = (1.0 - tanwRight) / (1.0 + tanwRight);
+        }
+
+        left = processPhaserSample(left, oldInLeft, oldOutLeft, filterCoefLeft, stages);
+        right = processPhaserSample(right, oldInRight, oldOutRight, filterCoefRight, stages);
+
+        const CSAMPLE_GAIN depth = depthStart + depthDelta * (i / bufferParameters.channelCount());
+
+        pOutput[i] = pInput[i] * (1.0 - 0.5 * depth) + left * depth * 0.5;
+        pOutput[i + 1] = pInput[i + 1] * (1.0 - 0.5 * depth) + right * depth * 0.5;
+    }
+
+    pState->oldDepth = depth;
+}
+
+void referenceAutoPan(AutoPanGroupState* pGroupState,
+        const CSAMPLE* pInput, CSAMPLE* pOutput,
+        const mixxx::EngineParameters& bufferParameters,
+        const EffectEnableState enableState,
+        const GroupFeatureState& groupFeatures,
+        ParameterValues parameters) {
+    const float kPositionRampingThreshold = 0.002f;
+
+    if (enableState == EffectEnableState::Disabled) {
+        return;
+    }
+
+    AutoPanGroupState& gs = *pGroupState;
+    double width = parameters["width"];
+    double period = parameters["period"];
+    double smoothing = 0.5 - parameters["smoothing"];
+
+    if (groupFeatures.has_beat_length_sec) {
+        double beats = std::max(roundToFraction(period, 2), 0.25);
+        period = beats * groupFeatures.beat_length_sec * bufferParameters.sampleRate();
+    } else {
+        period = std::max(period, 0.25) * bufferParameters.sampleRate();
+    }
+
+    if (gs.m_dPreviousPeriod != -1.0) {
+        gs.time *= period / gs.m_dPreviousPeriod;
+    }
+    gs.m_dPreviousPeriod = period;
+
+    if (gs.time >= period || enableState == EffectEnableState::Enabling) {
+        gs.time = 0;
+    }
+
+    float a = smoothing != 0.5f ? 1.0f / (1.0f - smoothing * 2.0f) : 1.0f;
+    float u = (0.5f - smoothing) / 2.0f;
+
+    gs.frac.setRampingThreshold(kPositionRampingThreshold);
+
+    double sinusoid = 0;
+
+    for (unsigned int i = 0; i + 1 < bufferParameters.samplesPerBuffer(); i += 2) {
+        CSAMPLE periodFraction = CSAMPLE(gs.time) / period;
+        float quarter = floorf(periodFraction * 4.0f);
+        CSAMPLE stepsFractionPart = floorf((quarter + 1.0f) / 2.0f) * smoothing;
+        float inStepInterval = fmod(periodFraction, 0.5f);
+
+        CSAMPLE angleFraction;
+        if (inStepInterval > u && inStepInterval < (u + smoothing)) {
+            angleFraction = quarter < 2.0f ? 0.25f : 0.75f;
+        } else {
+            angleFraction = (periodFraction - stepsFractionPart) * a;
+        }
+
+        sinusoid = sin(M_PI * 2.0f * angleFraction) * width;
+        gs.frac.setWithRampingApplied((sinusoid + 1.0f) / 2.0f);
+
+        gs.delay->process(&pInput[i], &pOutput[i],
+                -0.005 * math_clamp(((gs.frac * 2.0) - 1.0f), -1.0, 1.0) * bufferParameters.sampleRate());
+
+        double lawCoef = 1 + 1 / sqrt(std::abs(sinusoid) + 1);
+        pOutput[i] *= gs.frac * lawCoef;
+        pOutput[i+1] *= (1.0f - gs.frac) * lawCoef;
+
+        gs.time++;
+        while (gs.time >= period) {
+            gs.time -= period;
+        }
+    }
+}
+
+class ModulationEffectsTest : public BaseEffectTest {
+  protected:
+    ModulationEffectsTest() {
+        // A track at 128 BPM
+        m_beatFeatures.has_beat_length_sec = true;
+        m_beatFeatures.beat_length_sec = 60.0 / 128;
+        m_beatFeatures.has_beat_fraction = true;
+        m_beatFeatures.beat_fraction = 0.3;
+    }
+
+    // Processes a stereo sine in buffers of varying size with the effect
+    // and the reference and returns the largest difference of the output
+    // samples. The parameters are changed after the first buffers to
+    // exercise the ramping.
+    template<typename Effect, typename State, typename Reference>
+    CSAMPLE maxDeviationFromReference(Reference reference,
+            const ParameterValues& parameters,
+            const ParameterValues& changedParameters,
+            const GroupFeatureState& groupFeatures) {
+        auto pInstantiator = QSharedPointer<TestEffectInstantiator<Effect>>::create();
+        EngineEffect engineEffect(Effect::getManifest(),
+                QSet<ChannelHandleAndGroup>(),
+                m_pEffectsManager,
+                pInstantiator);
+        Effect* pEffect = pInstantiator->effect();
+        ChannelHandle handle = m_pChannelHandleFactory->getOrCreateHandle("[Channel1]");
+
+        const mixxx::EngineParameters stateParameters(
+                mixxx::AudioSignal::SampleRate(kSampleRate), MAX_BUFFER_LEN / 2);
+        State state(stateParameters);
+        State referenceState(stateParameters);
+
+        mixxx::SampleBuffer input(MAX_BUFFER_LEN);
+        mixxx::SampleBuffer output(MAX_BUFFER_LEN);
+        mixxx::SampleBuffer referenceOutput(MAX_BUFFER_LEN);
+
+        ParameterValues values = parameters;
+        SINT frame = 0;
+        CSAMPLE maxDeviation = 0;
+        for (size_t buffer = 0; buffer < sizeof(kBufferFrames) / sizeof(SINT); ++buffer) {
+            if (buffer == 4) {
+                for (auto it = changedParameters.begin(); it != changedParameters.end(); ++it) {
+                    values[it.key()] = it.value();
+                }
+            }
+            for (auto it = values.begin(); it != values.end(); ++it) {
+                engineEffect.getParameterById(it.key())->setValue(it.value());
+            }
+
+            const SINT frames = kBufferFrames[buffer];
+            for (SINT i = 0; i < frames; ++i, ++frame) {
+                const double phase = 2 * M_PI * 440.0 * frame / kSampleRate;
+                input[i * 2] = static_cast<CSAMPLE>(0.5 * sin(phase));
+                input[i * 2 + 1] = static_cast<CSAMPLE>(0.5 * cos(phase));
+            }
+
+            const mixxx::EngineParameters bufferParameters(
+                    mixxx::AudioSignal::SampleRate(kSampleRate), frames);
+            const EffectEnableState enableState = buffer == 0 ?
+                    EffectEnableState::Enabling : EffectEnableState::Enabled;
+            pEffect->processChannel(handle, &state, input.data(), output.data(),
+                    bufferParameters, enableState, groupFeatures);
+            reference(&referenceState, input.data(), referenceOutput.data(),
+                    bufferParameters, enableState, groupFeatures, values);
+
+            for (SINT i = 0; i < frames * 2; ++i) {
+                maxDeviation = math_max(maxDeviation,
+                        std::abs(output[i] - referenceOutput[i]));
+            }
+        }
+        return maxDeviation;
+    }
+
+    GroupFeatureState m_beatFeatures;
+};
+
+TEST_F(ModulationEffectsTest, Tremolo) {
+    ParameterValues parameters;
+    parameters["depth"] = 1.0;
+    parameters["rate"] = 1.0;
+    parameters["width"] = 0.5;
+    parameters["waveform"] = 0.5;
+    parameters["phase"] = 0.0;
+    parameters["quantize"] = 1.0;
+    parameters["triplet"] = 0.0;
+    ParameterValues changed;
+    changed["rate"] = 8.0;
+    changed["width"] = 0.1;
+    // Almost a square wave
+    changed["waveform"] = 0.005;
+    changed["phase"] = 0.4;
+
+    // The gain may only change by 0.001 per frame, so the output deviates by
+    // a few of these steps where the gain follows a steep edge of the curve.
+    EXPECT_GT(5e-3, (maxDeviationFromReference<TremoloEffect, TremoloState>(
+            referenceTremolo, parameters, changed, GroupFeatureState())));
+    EXPECT_GT(5e-3, (maxDeviationFromReference<TremoloEffect, TremoloState>(
+            referenceTremolo, parameters, changed, m_beatFeatures)));
+}
+
+TEST_F(ModulationEffectsTest, Flanger) {
+    ParameterValues parameters;
+    parameters["speed"] = 8.0;
+    parameters["width"] = kMaxLfoWidthMs / 2;
+    parameters["manual"] = kCenterDelayMs;
+    parameters["regen"] = 0.25;
+    parameters["mix"] = 1.0;
+    parameters["triplet"] = 0.0;
+    ParameterValues changed;
+    changed["speed"] = kMinLfoBeats;
+    changed["width"] = kMaxLfoWidthMs;
+    changed["regen"] = 0.9;
+    changed["mix"] = 0.5;
+    changed["triplet"] = 1.0;
+
+    // A triplet of a quarter beat is the fastest LFO, where the
+    // interpolation of the delay deviates most
+    EXPECT_GT(1e-3, (maxDeviationFromReference<FlangerEffect, FlangerGroupState>(
+            referenceFlanger, parameters, changed, GroupFeatureState())));
+    EXPECT_GT(5e-3, (maxDeviationFromReference<FlangerEffect, FlangerGroupState>(
+            referenceFlanger, parameters, changed, m_beatFeatures)));
+}
+
+TEST_F(ModulationEffectsTest, Phaser) {
+    ParameterValues parameters;
+    parameters["lfo_period"] = 1.0;
+    parameters["feedback"] = 0.0;
+    parameters["range"] = 1.0;
+    parameters["stages"] = 3.5;
+    parameters["depth"] = 0.5;
+    parameters["triplet"] = 0.0;
+    parameters["stereo"] = 0.0;
+    ParameterValues changed;
+    changed["lfo_period"] = 0.25;
+    changed["feedback"] = 0.8;
+    changed["stages"] = 6.0;
+    changed["depth"] = 1.0;
+
+    EXPECT_GT(1e-3, (maxDeviationFromReference<PhaserEffect, PhaserGroupState>(
+            referencePhaser, parameters, changed, GroupFeatureState())));
+    EXPECT_GT(1e-3, (maxDeviationFromReference<PhaserEffect, PhaserGroupState>(
+            referencePhaser, parameters, changed, m_beatFeatures)));
+
+    // The reference accumulates the phase of the right channel in single
+    // precision and adds half a period in every frame, so it drifts away from
+    // the exact phase that is computed now.
+    changed["stereo"] = 1.0;
+    EXPECT_GT(3e-2, (maxDeviationFromReference<PhaserEffect, PhaserGroupState>(
+            referencePhaser, parameters, changed, GroupFeatureState())));
+}
+
+TEST_F(ModulationEffectsTest, AutoPan) {
+    ParameterValues parameters;
+    parameters["period"] = 2.0;
+    parameters["smoothing"] = 0.5;
+    parameters["width"] = 0.5;
+    ParameterValues changed;
+    changed["period"] = 0.25;
+    // Almost a square curve
+    changed["smoothing"] = 0.25;
+    changed["width"] = 1.0;
+
+    EXPECT_GT(1e-3, (maxDeviationFromReference<AutoPanEffect, AutoPanGroupState>(
+            referenceAutoPan, parameters, changed, GroupFeatureState())));
+    EXPECT_GT(1e-3, (maxDeviationFromReference<AutoPanEffect, AutoPanGroupState>(
+            referenceAutoPan, parameters, changed, m_beatFeatures)));
+}
+
+}  // namespace
@@ -1,97 +1,285 @@
-#if 0
-// TODO: make this work again
+// Benchmarks of all effects that are registered by the BuiltInBackend and,
+// in builds with LV2 support, of all LV2 plugins that are installed. Run
+// them with
+//   mixxx-test --benchmark --benchmark_filter=BM_.*Effect
+// Each effect processes a sine through its EngineEffect while all of its
+// parameters are swept between their minimum and their maximum. The label
+// of each benchmark reports the effect and the time per frame.
+//
+// src/test/effects_benchmark_baseline.csv holds the results of a reference
+// run. Compare a run against it with
+//   mixxx-test --benchmark --benchmark_filter=BM_.*Effect \
+//           --benchmark_format=csv > effects.csv
+//   scripts/compare_effects_benchmark.py src/test/effects_benchmark_baseline.csv effects.csv
+
 #include <benchmark/benchmark.h>
-#include <gtest/gtest.h>
+
+#include <QList>
+#include <QScopedPointer>
+#include <QString>
+#include <QTemporaryDir>
 
 #include "control/controlpotmeter.h"
-#include "effects/builtin/autopaneffect.h"
-#include "effects/builtin/bessel4lvmixeqeffect.h"
-#include "effects/builtin/bessel8lvmixeqeffect.h"
-#include "effects/builtin/bitcrushereffect.h"
-#include "effects/builtin/echoeffect.h"
-#include "effects/builtin/filtereffect.h"
-#include "effects/builtin/flangereffect.h"
-#include "effects/builtin/graphiceqeffect.h"
-#include "effects/builtin/linkwitzriley8eqeffect.h"
-#include "effects/builtin/moogladder4filtereffect.h"
-#include "effects/builtin/phasereffect.h"
-#include "effects/builtin/reverbeffect.h"
+#include "effects/builtin/builtinbackend.h"
+#include "effects/effectsmanager.h"
+#ifdef __LILV__
+#include "effects/lv2/lv2backend.h"
+#endif
 #include "engine/channelhandle.h"
+#include "engine/effects/engineeffect.h"
 #include "engine/effects/groupfeaturestate.h"
-#include "test/baseeffecttest.h"
+#include "engine/effects/message.h"
+#include "util/fifo.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
 #include "util/samplebuffer.h"
+#include "util/types.h"
 
 namespace {
 
-class EffectsBenchmarkTest : public BaseEffectTest {
-  protected:
-    void SetUp() override {
-        registerTestBackend();
+const SINT kBufferFrames[] = {64, 256, 1024, 4096};
+
+// All parameters are swept from their minimum to their maximum and back
+// within this many callbacks
+const int kAutomationPeriod = 64;
+
+// A track at 128 BPM
+const double kBeatLengthSec = 60.0 / 128;
+
+BuiltInBackend* builtInBackend() {
+    static BuiltInBackend s_backend(nullptr);
+    return &s_backend;
+}
+
+#ifdef __LILV__
+// Loading all installed plugins is expensive, so the backend is only
+// created when an LV2 benchmark runs
+LV2Backend* lv2Backend() {
+    static LV2Backend s_backend(nullptr);
+    return &s_backend;
+}
+#endif
+
+// The environment that an effect needs for being processed outside of
+// an EngineEffectChain
+class EffectsFixture {
+  public:
+    EffectsFixture()
+            // The EQs read their crossover frequencies from these controls
+            : m_loEqFrequency(ConfigKey("[Mixer Profile]", "LoEQFrequency"), 0., 22040),
+              m_hiEqFrequency(ConfigKey("[Mixer Profile]", "HiEQFrequency"), 0., 22040),
+              // The EffectsManager saves effects.xml next to the config
+              m_effectsManager(nullptr,
+                      UserSettingsPointer(new UserSettings(
+                              m_settingsDir.filePath("mixxx.cfg"))),
+                      &m_channelHandleFactory),
+              m_channel(ChannelHandleAndGroup(
+                      m_channelHandleFactory.getOrCreateHandle("[Channel1]"),
+                      "[Channel1]")) {
+        m_loEqFrequency.set(250.0);
+        m_hiEqFrequency.set(2500.0);
+        m_effectsManager.registerInputChannel(m_channel);
+        m_effectsManager.registerOutputChannel(m_channel);
     }
+
+    // Returns an enabled EngineEffect with preallocated states for the
+    // channel
+    EngineEffect* createEngineEffect(EffectsBackend* pBackend,
+            const QString& effectId) {
+        QSet<ChannelHandleAndGroup> activeInputChannels;
+        activeInputChannels.insert(m_channel);
+        EngineEffect* pEffect = new EngineEffect(
+                pBackend->getManifest(effectId),
+                activeInputChannels,
+                &m_effectsManager,
+                pBackend->getInstantiator(effectId));
+
+        // Enable the effect the same way the EffectsManager does
+        QPair<MessagePipe<EffectsRequest*, EffectsResponse>*,
+              MessagePipe<EffectsResponse, EffectsRequest*>*> pipes =
+                TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                        1, 1, false, false);
+        QScopedPointer<MessagePipe<EffectsRequest*, EffectsResponse>> pRequestPipe(
+                pipes.first);
+        QScopedPointer<EffectsResponsePipe> pResponsePipe(pipes.second);
+        EffectsRequest request;
+        request.type = EffectsRequest::SET_EFFECT_PARAMETERS;
+        request.pTargetEffect = pEffect;
+        request.SetEffectParameters.enabled = true;
+        pEffect->processEffectsRequest(request, pResponsePipe.data());
+        return pEffect;
+    }
+
+    const ChannelHandle& channel() const {
+        return m_channel.handle();
+    }
+
+  private:
+    QTemporaryDir m_settingsDir;
+    ControlPotmeter m_loEqFrequency;
+    ControlPotmeter m_hiEqFrequency;
+    ChannelHandleFactory m_channelHandleFactory;
+    EffectsManager m_effectsManager;
+    ChannelHandleAndGroup m_channel;
 };
 
-template <class EffectType>
-void benchmarkBuiltInEffectDefaultParameters(const mixxx::EngineParameters& bufferParameters,
-                                            benchmark::State* pState, EffectsManager* pEffectsManager) {
-    EffectManifestPointer pManifest = EffectType::getManifest();
-
-    ChannelHandleFactory factory;
-    QSet<ChannelHandleAndGroup> activeInputChannels;
-
-    QString channel1_group = QString("[Channel1]");
-    ChannelHandle channel1 = factory.getOrCreateHandle(channel1_group);
-    ChannelHandleAndGroup handle_and_group(channel1, channel1_group);
-    pEffectsManager->registerInputChannel(handle_and_group);
-    pEffectsManager->registerOutputChannel(handle_and_group);
-    activeInputChannels.insert(handle_and_group);
-    EffectInstantiatorPointer pInstantiator = EffectInstantiatorPointer(
-        new EffectProcessorInstantiator<EffectType>());
-    EngineEffect effect(pManifest, activeInputChannels, pEffectsManager, pInstantiator);
-
-    GroupFeatureState featureState;
-    EffectEnableState enableState = EffectEnableState::Enabled;
-
-    mixxx::SampleBuffer input(bufferParameters.samplesPerBuffer());
-    mixxx::SampleBuffer output(bufferParameters.samplesPerBuffer());
-
-    while (pState->KeepRunning()) {
-        effect.process(channel1, channel1, input.data(), output.data(),
-                       bufferParameters.samplesPerBuffer(),
-                       bufferParameters.sampleRate(),
-                       enableState, featureState);
+// Processes buffers of a fixed size with one effect and automates all of
+// its parameters
+class EffectBenchmark {
+  public:
+    EffectBenchmark(EffectsFixture* pFixture, EffectsBackend* pBackend,
+            const QString& effectId, SINT sampleRate, SINT bufferFrames)
+            : m_pFixture(pFixture),
+              m_pEffect(pFixture->createEngineEffect(pBackend, effectId)),
+              m_sampleRate(sampleRate),
+              m_bufferFrames(bufferFrames),
+              m_input(bufferFrames * 2),
+              m_output(bufferFrames * 2),
+              m_calls(0),
+              m_frame(0),
+              m_totalNanos(0) {
+        for (const auto& pManifestParameter : m_pEffect->getManifest()->parameters()) {
+            m_parameters.append(m_pEffect->getParameterById(pManifestParameter->id()));
+        }
+        for (SINT i = 0; i < bufferFrames; ++i) {
+            const double phase = 2 * M_PI * 440.0 * i / sampleRate;
+            m_input[i * 2] = static_cast<CSAMPLE>(0.5 * sin(phase));
+            m_input[i * 2 + 1] = static_cast<CSAMPLE>(0.5 * cos(phase));
+        }
+        m_groupFeatures.has_beat_length_sec = true;
+        m_groupFeatures.beat_length_sec = kBeatLengthSec;
+        m_groupFeatures.has_beat_fraction = true;
+    }
+
+    void process() {
+        automateParameters();
+        m_timer.restart();
+        m_pEffect->process(m_pFixture->channel(), m_pFixture->channel(),
+                m_input.data(), m_output.data(),
+                m_bufferFrames * 2, m_sampleRate,
+                EffectEnableState::Enabled, m_groupFeatures);
+        m_totalNanos += m_timer.elapsed().toIntegerNanos();
+        ++m_calls;
+    }
+
+    double nanosPerFrame() const {
+        if (m_calls == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(m_totalNanos) / m_calls / m_bufferFrames;
+    }
+
+  private:
+    void automateParameters() {
+        for (int i = 0; i < m_parameters.size(); ++i) {
+            EngineEffectParameter* pParameter = m_parameters[i];
+            // A triangle with a different phase for every parameter
+            const int step = (m_calls + i * kAutomationPeriod / 5) % kAutomationPeriod;
+            const double position = 2.0 * math_min(step, kAutomationPeriod - step)
+                    / kAutomationPeriod;
+            pParameter->setValue(pParameter->minimum()
+                    + position * (pParameter->maximum() - pParameter->minimum()));
+        }
+        const double beats = static_cast<double>(m_frame) / m_sampleRate / kBeatLengthSec;
+        m_groupFeatures.beat_fraction = beats - floor(beats);
+        m_frame += m_bufferFrames;
+    }
+
+    EffectsFixture* m_pFixture;
+    QScopedPointer<EngineEffect> m_pEffect;
+    QList<EngineEffectParameter*> m_parameters;
+    const SINT m_sampleRate;
+    const SINT m_bufferFrames;
+    mixxx::SampleBuffer m_input;
+    mixxx::SampleBuffer m_output;
+    GroupFeatureState m_groupFeatures;
+    PerformanceTimer m_timer;
+    qint64 m_calls;
+    qint64 m_frame;
+    qint64 m_totalNanos;
+};
+
+void EffectArguments(benchmark::internal::Benchmark* b, int numEffects) {
+    for (int effect = 0; effect < numEffects; ++effect) {
+        for (SINT frames : kBufferFrames) {
+            b->ArgPair(effect, frames);
+        }
     }
 }
 
-#define FOR_COMMON_BUFFER_SIZES(bm) bm->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(512)->Arg(1024)->Arg(2048)->Arg(4096);
-
-#define DECLARE_EFFECT_BENCHMARK(EffectName)                           \
-TEST_F(EffectsBenchmarkTest, BM_BuiltInEffects_DefaultParameters_##EffectName) { \
-    ControlPotmeter loEqFrequency(                                     \
-        ConfigKey("[Mixer Profile]", "LoEQFrequency"), 0., 22040);     \
-    loEqFrequency.setDefaultValue(250.0);                              \
-    ControlPotmeter hiEqFrequency(                                     \
-        ConfigKey("[Mixer Profile]", "HiEQFrequency"), 0., 22040);     \
-    hiEqFrequency.setDefaultValue(2500.0);                             \
-    mixxx::EngineParameters bufferParameters(                          \
-        mixxx::AudioSignal::SampleRate(44100),                         \
-        state.range_x());                                              \
-    benchmarkBuiltInEffectDefaultParameters<EffectName>(                \
-        bufferParameters, &state, m_pEffectsManager);                                     \
-}                                                                      \
-FOR_COMMON_BUFFER_SIZES(BENCHMARK(BM_BuiltInEffects_DefaultParameters_##EffectName));
-
-DECLARE_EFFECT_BENCHMARK(Bessel4LVMixEQEffect)
-DECLARE_EFFECT_BENCHMARK(Bessel8LVMixEQEffect)
-DECLARE_EFFECT_BENCHMARK(BitCrusherEffect)
-DECLARE_EFFECT_BENCHMARK(EchoEffect)
-DECLARE_EFFECT_BENCHMARK(FilterEffect)
-DECLARE_EFFECT_BENCHMARK(FlangerEffect)
-DECLARE_EFFECT_BENCHMARK(GraphicEQEffect)
-DECLARE_EFFECT_BENCHMARK(LinkwitzRiley8EQEffect)
-DECLARE_EFFECT_BENCHMARK(MoogLadder4FilterEffect)
-DECLARE_EFFECT_BENCHMARK(PhaserEffect)
-DECLARE_EFFECT_BENCHMARK(ReverbEffect)
+// The effects are addressed by their index in BuiltInBackend::getEffectIds(),
+// so new effects are covered without touching this file. The label reports
+// the id of the effect.
+void BuiltInEffectArguments(benchmark::internal::Benchmark* b) {
+    EffectArguments(b, builtInBackend()->getEffectIds().size());
+}
 
-}  // namespace
+template<int sampleRate>
+static void BM_BuiltInEffect(benchmark::State& state) {
+    const QString effectId = builtInBackend()->getEffectIds().at(state.range_x());
+    EffectsFixture fixture;
+    EffectBenchmark effect(&fixture, builtInBackend(), effectId,
+            sampleRate, state.range_y());
+    while (state.KeepRunning()) {
+        effect.process();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range_y());
+    state.SetLabel(QString("%1 %2 ns/frame")
+            .arg(effectId)
+            .arg(effect.nanosPerFrame(), 0, 'f', 2)
+            .toStdString());
+}
+
+BENCHMARK_TEMPLATE(BM_BuiltInEffect, 44100)->Apply(BuiltInEffectArguments);
+BENCHMARK_TEMPLATE(BM_BuiltInEffect, 48000)->Apply(BuiltInEffectArguments);
+BENCHMARK_TEMPLATE(BM_BuiltInEffect, 96000)->Apply(BuiltInEffectArguments);
+
+#ifdef __LILV__
+// The installed plugins are only known after loading them, which is too
+// expensive to do for every run of mixxx-test. So one benchmark processes
+// all plugins in turn and the label reports the time of the slowest one.
+template<int sampleRate>
+static void BM_LV2Effects(benchmark::State& state) {
+    EffectsFixture fixture;
+    QList<EffectBenchmark*> effects;
+    QList<QString> effectIds;
+    for (const QString& effectId : lv2Backend()->getEffectIds()) {
+        effects.append(new EffectBenchmark(&fixture, lv2Backend(), effectId,
+                sampleRate, state.range_x()));
+        effectIds.append(effectId);
+    }
+    while (state.KeepRunning()) {
+        for (EffectBenchmark* pEffect : effects) {
+            pEffect->process();
+        }
+    }
+    int slowest = -1;
+    for (int i = 0; i < effects.size(); ++i) {
+        if (slowest < 0 ||
+                effects[i]->nanosPerFrame() > effects[slowest]->nanosPerFrame()) {
+            slowest = i;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * effects.size() * state.range_x());
+    if (slowest >= 0) {
+        state.SetLabel(QString("%1 plugins, slowest %2 %3 ns/frame")
+                .arg(effects.size())
+                .arg(effectIds[slowest])
+                .arg(effects[slowest]->nanosPerFrame(), 0, 'f', 2)
+                .toStdString());
+    }
+    qDeleteAll(effects);
+}
+
+void LV2EffectArguments(benchmark::internal::Benchmark* b) {
+    for (SINT frames : kBufferFrames) {
+        b->Arg(frames);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_LV2Effects, 44100)->Apply(LV2EffectArguments);
+BENCHMARK_TEMPLATE(BM_LV2Effects, 48000)->Apply(LV2EffectArguments);
+BENCHMARK_TEMPLATE(BM_LV2Effects, 96000)->Apply(LV2EffectArguments);
 #endif
 
+}  // namespace
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "offlinerenderer.h"
+
+namespace {
+
+class OfflineRendererTest : public testing::Test {
+};
+
+TEST_F(OfflineRendererTest, ParseScript) {
+    const QString script(
+            "# A two deck mix\n"
+            "\n"
+            "0 load [Channel1] /music/first track.mp3\n"
+            "  60.5\tset [Master] crossfader -0.25  \n"
+            "120 stop\n"
+            "0 set [Channel1] play 1\n");
+    QList<RenderEvent> events;
+    QString errorMessage;
+    ASSERT_TRUE(OfflineRenderer::parseScript(script, &events, &errorMessage))
+            << errorMessage.toStdString();
+    ASSERT_EQ(4, events.size());
+
+    // Sorted by time, the order of the script is kept for the same time
+    EXPECT_EQ(RenderEvent::Type::Load, events[0].type);
+    EXPECT_EQ(0.0, events[0].seconds);
+    EXPECT_EQ(QString("[Channel1]"), events[0].group);
+    EXPECT_EQ(QString("/music/first track.mp3"), events[0].location);
+
+    EXPECT_EQ(RenderEvent::Type::Set, events[1].type);
+    EXPECT_EQ(0.0, events[1].seconds);
+    EXPECT_EQ(QString("[Channel1]"), events[1].group);
+    EXPECT_EQ(QString("play"), events[1].item);
+    EXPECT_EQ(1.0, events[1].value);
+
+    EXPECT_EQ(RenderEvent::Type::Set, events[2].type);
+    EXPECT_EQ(60.5, events[2].seconds);
+    EXPECT_EQ(QString("[Master]"), events[2].group);
+    EXPECT_EQ(QString("crossfader"), events[2].item);
+    EXPECT_EQ(-0.25, events[2].value);
+
+    EXPECT_EQ(RenderEvent::Type::Stop, events[3].type);
+    EXPECT_EQ(120.0, events[3].seconds);
+}
+
+TEST_F(OfflineRendererTest, ParseScriptErrors) {
+    QList<RenderEvent> events;
+    QString errorMessage;
+    // No stop event
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "0 set [Channel1] play 1\n", &events, &errorMessage));
+    // Invalid time
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "soon set [Channel1] play 1\n10 stop\n", &events, &errorMessage));
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "-1 set [Channel1] play 1\n10 stop\n", &events, &errorMessage));
+    // Invalid value
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "0 set [Channel1] play on\n10 stop\n", &events, &errorMessage));
+    // Missing arguments
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "0 set [Channel1] play\n10 stop\n", &events, &errorMessage));
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "0 load [Channel1]\n10 stop\n", &events, &errorMessage));
+    // Unknown event
+    EXPECT_FALSE(OfflineRenderer::parseScript(
+            "0 eject [Channel1]\n10 stop\n", &events, &errorMessage));
+    EXPECT_TRUE(events.isEmpty());
+    EXPECT_FALSE(errorMessage.isEmpty());
+}
+
+}  // namespace
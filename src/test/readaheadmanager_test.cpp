@@ -127,3 +127,72 @@ TEST_F(ReadAheadManagerTest, FractionalFrameLoop) {
     // The rounding error must not exceed a half frame (one samples in stereo)
     EXPECT_NEAR(16, m_pReadAheadManager->getPlaypos(), 1);
 }
+
+TEST_F(ReadAheadManagerTest, HintWindowScalesWithRate) {
+    const SINT kFrame = 100 * CachingReaderChunk::kFrames;
+    m_pReadAheadManager->notifySeek(kFrame * 2);
+
+    HintVector hints;
+    m_pReadAheadManager->hintReader(1.0, &hints);
+    ASSERT_EQ(2, hints.size());
+    EXPECT_EQ(Hint::kPriorityImminent, hints[0].priority);
+    EXPECT_EQ(kFrame, hints[0].frame);
+    const SINT normalFrameCount = hints[0].frameCount;
+    EXPECT_EQ(2 * CachingReaderChunk::kFrames, normalFrameCount);
+    // Followed by the lookahead with a lower priority
+    EXPECT_EQ(Hint::kPriorityLookahead, hints[1].priority);
+    EXPECT_EQ(kFrame + normalFrameCount, hints[1].frame);
+
+    hints.clear();
+    m_pReadAheadManager->hintReader(3.0, &hints);
+    ASSERT_EQ(2, hints.size());
+    EXPECT_EQ(kFrame, hints[0].frame);
+    EXPECT_EQ(3 * normalFrameCount, hints[0].frameCount);
+
+    // Fast reverse ends at the play position
+    hints.clear();
+    m_pReadAheadManager->hintReader(-3.0, &hints);
+    ASSERT_EQ(2, hints.size());
+    EXPECT_EQ(3 * normalFrameCount, hints[0].frameCount);
+    EXPECT_EQ(kFrame, hints[0].frame + hints[0].frameCount);
+    EXPECT_EQ(hints[0].frame, hints[1].frame + hints[1].frameCount);
+}
+
+TEST_F(ReadAheadManagerTest, HintWindowFollowsScalerDemand) {
+    const SINT kFrame = 100 * CachingReaderChunk::kFrames;
+    m_pReadAheadManager->notifySeek(kFrame * 2);
+
+    // The scaler reads much more than the rate suggests, e.g. RubberBand
+    // filling its input buffer
+    const SINT kDemandSamples = CachingReaderChunk::kSamples / 4;
+    m_pLoopControl->pushTriggerReturnValue(kNoTrigger);
+    m_pLoopControl->pushTargetReturnValue(kNoTrigger);
+    EXPECT_EQ(kDemandSamples,
+            m_pReadAheadManager->getNextSamples(1.0, m_pBuffer, kDemandSamples));
+
+    HintVector hints;
+    m_pReadAheadManager->hintReader(1.0, &hints);
+    ASSERT_FALSE(hints.isEmpty());
+    // Enough for 16 callbacks
+    EXPECT_EQ(4 * CachingReaderChunk::kFrames, hints[0].frameCount);
+
+    // The demand is measured per callback
+    hints.clear();
+    m_pReadAheadManager->hintReader(1.0, &hints);
+    ASSERT_FALSE(hints.isEmpty());
+    EXPECT_EQ(2 * CachingReaderChunk::kFrames, hints[0].frameCount);
+}
+
+TEST_F(ReadAheadManagerTest, HintWindowShrinksWhenPaused) {
+    const SINT kFrame = 100 * CachingReaderChunk::kFrames;
+    m_pReadAheadManager->notifySeek(kFrame * 2);
+
+    HintVector hints;
+    m_pReadAheadManager->hintReader(0.0, &hints);
+    ASSERT_EQ(1, hints.size());
+    EXPECT_EQ(Hint::kPriorityImminent, hints[0].priority);
+    EXPECT_EQ(CachingReaderChunk::kFrames, hints[0].frameCount);
+    // Around the play position
+    EXPECT_LT(hints[0].frame, kFrame);
+    EXPECT_GT(hints[0].frame + hints[0].frameCount, kFrame);
+}
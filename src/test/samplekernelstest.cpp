@@ -0,0 +1,409 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QVector>
+
+#include "util/sample.h"
+#include "util/samplekernels.h"
+
+using mixxx::CpuFeatures;
+using mixxx::RampingGainSource;
+using mixxx::SampleKernels;
+
+namespace {
+
+const CpuFeatures::SimdLevel kSimdLevels[] = {
+    CpuFeatures::SimdLevel::Sse2,
+    CpuFeatures::SimdLevel::Avx2,
+    CpuFeatures::SimdLevel::Avx512,
+};
+
+// Compares the SIMD kernels for every instruction set supported by this
+// machine with the scalar reference implementation.
+class SampleKernelsTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        // Odd and not a multiple of any vector width to cover the tails.
+        m_numSamples = 1023;
+        m_pSrc1 = SampleUtil::alloc(m_numSamples * 2);
+        m_pSrc2 = SampleUtil::alloc(m_numSamples * 2);
+        m_pExpected = SampleUtil::alloc(m_numSamples * 2);
+        m_pActual = SampleUtil::alloc(m_numSamples * 2);
+        m_pExpected2 = SampleUtil::alloc(m_numSamples);
+        m_pActual2 = SampleUtil::alloc(m_numSamples);
+        for (int i = 0; i < m_numSamples * 2; ++i) {
+            // Deterministic values in [-1.5, 1.5] with both signs
+            m_pSrc1[i] = static_cast<CSAMPLE>((i * 37) % 301 - 150) / 100;
+            m_pSrc2[i] = static_cast<CSAMPLE>((i * 53) % 211 - 105) / 100;
+        }
+    }
+
+    void TearDown() override {
+        SampleUtil::free(m_pSrc1);
+        SampleUtil::free(m_pSrc2);
+        SampleUtil::free(m_pExpected);
+        SampleUtil::free(m_pActual);
+        SampleUtil::free(m_pExpected2);
+        SampleUtil::free(m_pActual2);
+    }
+
+    QVector<const SampleKernels*> supportedSimdKernels() const {
+        QVector<const SampleKernels*> kernels;
+        for (CpuFeatures::SimdLevel level : kSimdLevels) {
+            const SampleKernels* pKernels = SampleKernels::forLevel(level);
+            if (pKernels) {
+                kernels.append(pKernels);
+            } else {
+                qDebug() << "Skipping unsupported"
+                         << CpuFeatures::simdLevelName(level) << "kernels";
+            }
+        }
+        return kernels;
+    }
+
+    void resetOutputs() {
+        SampleUtil::copy(m_pExpected, m_pSrc2, m_numSamples * 2);
+        SampleUtil::copy(m_pActual, m_pSrc2, m_numSamples * 2);
+    }
+
+    void assertOutputsEqual(const SampleKernels& kernels, int numSamples) {
+        for (int i = 0; i < numSamples; ++i) {
+            ASSERT_FLOAT_EQ(m_pExpected[i], m_pActual[i])
+                    << CpuFeatures::simdLevelName(kernels.level)
+                    << " sample " << i;
+        }
+    }
+
+    int m_numSamples;
+    CSAMPLE* m_pSrc1;
+    CSAMPLE* m_pSrc2;
+    CSAMPLE* m_pExpected;
+    CSAMPLE* m_pActual;
+    CSAMPLE* m_pExpected2;
+    CSAMPLE* m_pActual2;
+};
+
+TEST_F(SampleKernelsTest, activeKernelsAreSupported) {
+    const SampleKernels& active = SampleKernels::active();
+    EXPECT_TRUE(CpuFeatures::supports(active.level));
+    EXPECT_EQ(&active, SampleKernels::forLevel(active.level));
+}
+
+TEST_F(SampleKernelsTest, gain) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        resetOutputs();
+        scalar.applyGain(m_pExpected, 0.3f, m_numSamples);
+        pKernels->applyGain(m_pActual, 0.3f, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+
+        scalar.copyWithGain(m_pExpected, m_pSrc1, 0.7f, m_numSamples);
+        pKernels->copyWithGain(m_pActual, m_pSrc1, 0.7f, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+
+        scalar.add(m_pExpected, m_pSrc1, m_numSamples);
+        pKernels->add(m_pActual, m_pSrc1, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+
+        scalar.addWithGain(m_pExpected, m_pSrc1, 1.3f, m_numSamples);
+        pKernels->addWithGain(m_pActual, m_pSrc1, 1.3f, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+    }
+}
+
+TEST_F(SampleKernelsTest, rampingGain) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    const int numFrames = m_numSamples / 2;
+    const CSAMPLE_GAIN startGain = 0.1f;
+    const CSAMPLE_GAIN gainDelta = 0.9f / numFrames;
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        resetOutputs();
+        scalar.applyRampingGain(m_pExpected, startGain, gainDelta, numFrames);
+        pKernels->applyRampingGain(m_pActual, startGain, gainDelta, numFrames);
+        assertOutputsEqual(*pKernels, m_numSamples);
+
+        scalar.copyWithRampingGain(m_pExpected, m_pSrc1,
+                startGain, gainDelta, numFrames);
+        pKernels->copyWithRampingGain(m_pActual, m_pSrc1,
+                startGain, gainDelta, numFrames);
+        assertOutputsEqual(*pKernels, m_numSamples);
+
+        scalar.addWithRampingGain(m_pExpected, m_pSrc1,
+                startGain, -gainDelta, numFrames);
+        pKernels->addWithRampingGain(m_pActual, m_pSrc1,
+                startGain, -gainDelta, numFrames);
+        assertOutputsEqual(*pKernels, m_numSamples);
+    }
+}
+
+TEST_F(SampleKernelsTest, mixWithRampingGains) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    const int numFrames = m_numSamples / 2;
+    // An unaligned block in the middle of the buffers, as mixed by ChannelMixer
+    const int firstFrame = 3;
+    const int endFrame = numFrames - 2;
+    const int numSources = SampleKernels::kMaxMixSources;
+    CSAMPLE* expectedSources[numSources];
+    CSAMPLE* actualSources[numSources];
+    for (int j = 0; j < numSources; ++j) {
+        expectedSources[j] = SampleUtil::alloc(m_numSamples);
+        actualSources[j] = SampleUtil::alloc(m_numSamples);
+    }
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        for (int n = 1; n <= numSources; ++n) {
+            for (int writeBack = 0; writeBack < 2; ++writeBack) {
+                RampingGainSource expected[numSources];
+                RampingGainSource actual[numSources];
+                for (int j = 0; j < n; ++j) {
+                    SampleUtil::copy(expectedSources[j],
+                            (j % 2) ? m_pSrc1 : m_pSrc2, m_numSamples);
+                    SampleUtil::copy(actualSources[j],
+                            (j % 2) ? m_pSrc1 : m_pSrc2, m_numSamples);
+                    expected[j].pBuffer = expectedSources[j];
+                    expected[j].startGain = 0.1f * j;
+                    expected[j].gainDelta = (j % 3 - 1) * 0.5f / numFrames;
+                    actual[j] = expected[j];
+                    actual[j].pBuffer = actualSources[j];
+                }
+                const SampleKernels::MixWithRampingGainsFunction* expectedMix =
+                        writeBack ? scalar.applyAndMixWithRampingGains :
+                        scalar.mixWithRampingGains;
+                const SampleKernels::MixWithRampingGainsFunction* actualMix =
+                        writeBack ? pKernels->applyAndMixWithRampingGains :
+                        pKernels->mixWithRampingGains;
+
+                resetOutputs();
+                expectedMix[n - 1](m_pExpected, false, expected,
+                        firstFrame, endFrame);
+                actualMix[n - 1](m_pActual, false, actual,
+                        firstFrame, endFrame);
+                assertOutputsEqual(*pKernels, m_numSamples);
+                expectedMix[n - 1](m_pExpected, true, expected,
+                        firstFrame, endFrame);
+                actualMix[n - 1](m_pActual, true, actual,
+                        firstFrame, endFrame);
+                assertOutputsEqual(*pKernels, m_numSamples);
+                for (int j = 0; j < n; ++j) {
+                    for (int i = 0; i < m_numSamples; ++i) {
+                        ASSERT_FLOAT_EQ(expectedSources[j][i],
+                                actualSources[j][i]);
+                    }
+                }
+            }
+        }
+    }
+    for (int j = 0; j < numSources; ++j) {
+        SampleUtil::free(expectedSources[j]);
+        SampleUtil::free(actualSources[j]);
+    }
+}
+
+TEST_F(SampleKernelsTest, sumAbsPerChannel) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    const int numFrames = m_numSamples / 2;
+    CSAMPLE expectedAbsL, expectedAbsR, expectedPeakL, expectedPeakR;
+    scalar.sumAbsPerChannel(&expectedAbsL, &expectedAbsR,
+            &expectedPeakL, &expectedPeakR, m_pSrc1, numFrames);
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        CSAMPLE absL, absR, peakL, peakR;
+        pKernels->sumAbsPerChannel(&absL, &absR,
+                &peakL, &peakR, m_pSrc1, numFrames);
+        // The summation order differs, so allow for rounding errors.
+        EXPECT_NEAR(expectedAbsL, absL, expectedAbsL * 1e-5);
+        EXPECT_NEAR(expectedAbsR, absR, expectedAbsR * 1e-5);
+        EXPECT_FLOAT_EQ(expectedPeakL, peakL);
+        EXPECT_FLOAT_EQ(expectedPeakR, peakR);
+    }
+}
+
+TEST_F(SampleKernelsTest, interleave) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        scalar.interleaveBuffer(m_pExpected, m_pSrc1, m_pSrc2, m_numSamples);
+        pKernels->interleaveBuffer(m_pActual, m_pSrc1, m_pSrc2, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples * 2);
+
+        scalar.deinterleaveBuffer(m_pExpected, m_pExpected2, m_pSrc1,
+                m_numSamples);
+        pKernels->deinterleaveBuffer(m_pActual, m_pActual2, m_pSrc1,
+                m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+        for (int i = 0; i < m_numSamples; ++i) {
+            ASSERT_FLOAT_EQ(m_pExpected2[i], m_pActual2[i]);
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, hermiteInterpolate) {
+    const SampleKernels& scalar = *SampleKernels::forLevel(
+            CpuFeatures::SimdLevel::Scalar);
+    CSAMPLE* pFraction = SampleUtil::alloc(m_numSamples);
+    for (int i = 0; i < m_numSamples; ++i) {
+        pFraction[i] = static_cast<CSAMPLE>((i * 29) % 100) / 100;
+    }
+    for (const SampleKernels* pKernels : supportedSimdKernels()) {
+        // The taps of EngineBufferScaleCubic are not aligned.
+        scalar.hermiteInterpolate(m_pExpected, m_pSrc1, m_pSrc2,
+                m_pSrc1 + 1, m_pSrc2 + 3, pFraction, m_numSamples);
+        pKernels->hermiteInterpolate(m_pActual, m_pSrc1, m_pSrc2,
+                m_pSrc1 + 1, m_pSrc2 + 3, pFraction, m_numSamples);
+        assertOutputsEqual(*pKernels, m_numSamples);
+    }
+    // The interpolation passes through the samples next to the position.
+    const CSAMPLE zero[] = {0, 0};
+    const CSAMPLE one[] = {1, 1};
+    scalar.hermiteInterpolate(m_pExpected, m_pSrc1, m_pSrc2,
+            m_pSrc1 + 1, m_pSrc2 + 3, zero, 2);
+    EXPECT_FLOAT_EQ(m_pSrc2[0], m_pExpected[0]);
+    EXPECT_FLOAT_EQ(m_pSrc2[1], m_pExpected[1]);
+    scalar.hermiteInterpolate(m_pExpected, m_pSrc1, m_pSrc2,
+            m_pSrc1 + 1, m_pSrc2 + 3, one, 2);
+    EXPECT_NEAR(m_pSrc1[1], m_pExpected[0], 1e-5);
+    EXPECT_NEAR(m_pSrc1[2], m_pExpected[1], 1e-5);
+    SampleUtil::free(pFraction);
+}
+
+// Benchmarks of every kernel variant. The first argument is the SimdLevel,
+// where 0 is the scalar reference implementation that SampleUtil used before
+// the kernels were dispatched at runtime, the second is the buffer size.
+void SampleKernelsArguments(benchmark::internal::Benchmark* b) {
+    for (int level = static_cast<int>(CpuFeatures::SimdLevel::Scalar);
+            level <= static_cast<int>(CpuFeatures::SimdLevel::Avx512);
+            ++level) {
+        for (int size = 64; size <= 4096; size *= 8) {
+            b->ArgPair(level, size);
+        }
+    }
+}
+
+const SampleKernels* benchmarkKernels(benchmark::State& state) {
+    const CpuFeatures::SimdLevel level =
+            static_cast<CpuFeatures::SimdLevel>(state.range_x());
+    return SampleKernels::forLevel(level);
+}
+
+void setBenchmarkLabel(benchmark::State& state, const SampleKernels* pKernels) {
+    if (pKernels) {
+        state.SetLabel(CpuFeatures::simdLevelName(pKernels->level));
+    } else {
+        state.SetLabel("not supported");
+    }
+}
+
+static void BM_SampleKernels_ApplyRampingGain(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->applyRampingGain(buffer, 1.0f, 0.0f, size / 2);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SampleKernels_ApplyRampingGain)->Apply(SampleKernelsArguments);
+
+static void BM_SampleKernels_AddWithRampingGain(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->addWithRampingGain(buffer, buffer2, 0.5f, 0.001f, size / 2);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_SampleKernels_AddWithRampingGain)->Apply(SampleKernelsArguments);
+
+static void BM_SampleKernels_CopyWithGain(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->copyWithGain(buffer, buffer2, 0.7f, size);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_SampleKernels_CopyWithGain)->Apply(SampleKernelsArguments);
+
+static void BM_SampleKernels_SumAbsPerChannel(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, -0.5f, size);
+    CSAMPLE absL, absR, peakL, peakR;
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->sumAbsPerChannel(&absL, &absR, &peakL, &peakR,
+                    buffer, size / 2);
+            benchmark::DoNotOptimize(absL);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SampleKernels_SumAbsPerChannel)->Apply(SampleKernelsArguments);
+
+static void BM_SampleKernels_InterleaveBuffer(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size * 2);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+    CSAMPLE* buffer3 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer3, -0.5f, size);
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->interleaveBuffer(buffer, buffer2, buffer3, size);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+    SampleUtil::free(buffer3);
+}
+BENCHMARK(BM_SampleKernels_InterleaveBuffer)->Apply(SampleKernelsArguments);
+
+static void BM_SampleKernels_HermiteInterpolate(benchmark::State& state) {
+    const SampleKernels* pKernels = benchmarkKernels(state);
+    const SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    CSAMPLE* taps = SampleUtil::alloc(size + 3);
+    SampleUtil::fill(taps, 0.5f, size + 3);
+    CSAMPLE* fraction = SampleUtil::alloc(size);
+    SampleUtil::fill(fraction, 0.25f, size);
+    while (state.KeepRunning()) {
+        if (pKernels) {
+            pKernels->hermiteInterpolate(buffer,
+                    taps, taps + 1, taps + 2, taps + 3, fraction, size);
+        }
+    }
+    setBenchmarkLabel(state, pKernels);
+    SampleUtil::free(buffer);
+    SampleUtil::free(taps);
+    SampleUtil::free(fraction);
+}
+BENCHMARK(BM_SampleKernels_HermiteInterpolate)->Apply(SampleKernelsArguments);
+
+}  // namespace
@@ -200,6 +200,36 @@ TEST_F(SampleUtilTest, copyWithGainAliased) {
     }
 }
 
+TEST_F(SampleUtilTest, copyWithStereoGains) {
+    for (int i : evenBuffers) {
+        CSAMPLE* buffer = buffers[i];
+        int size = sizes[i];
+        int frames = size / 2;
+        FillBuffer(buffer, 1.0f, size);
+        CSAMPLE* gainsLeft = SampleUtil::alloc(frames);
+        CSAMPLE* gainsRight = SampleUtil::alloc(frames);
+        for (int j = 0; j < frames; ++j) {
+            gainsLeft[j] = j;
+            gainsRight[j] = -j;
+        }
+        CSAMPLE* buffer2 = SampleUtil::alloc(size);
+        SampleUtil::copyWithStereoGains(buffer2, buffer, gainsLeft, gainsRight, frames);
+        for (int j = 0; j < frames; ++j) {
+            EXPECT_FLOAT_EQ(j, buffer2[j * 2]);
+            EXPECT_FLOAT_EQ(-j, buffer2[j * 2 + 1]);
+        }
+        // Aliased
+        SampleUtil::copyWithStereoGains(buffer2, buffer2, gainsLeft, gainsRight, frames);
+        for (int j = 0; j < frames; ++j) {
+            EXPECT_FLOAT_EQ(j * j, buffer2[j * 2]);
+            EXPECT_FLOAT_EQ(j * j, buffer2[j * 2 + 1]);
+        }
+        SampleUtil::free(buffer2);
+        SampleUtil::free(gainsRight);
+        SampleUtil::free(gainsLeft);
+    }
+}
+
 TEST_F(SampleUtilTest, copy2WithGain) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
@@ -341,6 +371,24 @@ TEST_F(SampleUtilTest, sumAbsPerChannel) {
     }
 }
 
+TEST_F(SampleUtilTest, isSilent) {
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        int j = evenBuffers[i];
+        CSAMPLE* buffer = buffers[j];
+        int size = sizes[j];
+        FillBuffer(buffer, 0.0f, size);
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size, 0.0f));
+        // A single sample above the threshold in either channel, with
+        // either sign
+        buffer[size - 1] = -0.01f;
+        EXPECT_FALSE(SampleUtil::isSilent(buffer, size, 0.001f));
+        EXPECT_TRUE(SampleUtil::isSilent(buffer, size, 0.01f));
+        buffer[size - 1] = 0.0f;
+        buffer[size - 2] = 0.01f;
+        EXPECT_FALSE(SampleUtil::isSilent(buffer, size, 0.001f));
+    }
+}
+
 TEST_F(SampleUtilTest, interleaveBuffer) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
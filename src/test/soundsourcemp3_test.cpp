@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QUrl>
+
+#include "sources/seekindexstore.h"
+#include "util/math.h"
+#include "util/samplebuffer.h"
+
+#ifdef __MAD__
+#include "sources/soundsourcemp3.h"
+#endif // __MAD__
+
+namespace {
+
+#ifdef __MAD__
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+class InMemorySeekIndexStore : public mixxx::SeekIndexStore {
+  public:
+    InMemorySeekIndexStore()
+            : m_saveCount(0) {
+    }
+
+    QByteArray loadSeekIndex(const QString& key) const override {
+        QMutexLocker locker(&m_mutex);
+        return m_seekIndices.value(key);
+    }
+
+    bool saveSeekIndex(const QString& key, const QByteArray& data) override {
+        QMutexLocker locker(&m_mutex);
+        m_seekIndices.insert(key, data);
+        ++m_saveCount;
+        return true;
+    }
+
+    void corruptSeekIndices() {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_seekIndices.begin(); it != m_seekIndices.end(); ++it) {
+            it.value() = qCompress(QByteArray(64, '\x5A'));
+        }
+    }
+
+    int saveCount() const {
+        QMutexLocker locker(&m_mutex);
+        return m_saveCount;
+    }
+
+  private:
+    mutable QMutex m_mutex;
+    QHash<QString, QByteArray> m_seekIndices;
+    int m_saveCount;
+};
+
+class SoundSourceMp3Test : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_pStore = std::make_shared<InMemorySeekIndexStore>();
+        mixxx::SeekIndexStore::setInstance(m_pStore);
+    }
+
+    void TearDown() override {
+        mixxx::SeekIndexStore::setInstance(nullptr);
+    }
+
+    static mixxx::AudioSourcePointer openMp3() {
+        auto pSoundSource = std::make_shared<mixxx::SoundSourceMp3>(
+                QUrl::fromLocalFile(kTestDir.absoluteFilePath("cover-test-png.mp3")));
+        EXPECT_EQ(mixxx::AudioSource::OpenResult::Succeeded,
+                pSoundSource->open(mixxx::AudioSource::OpenMode::Strict));
+        return pSoundSource;
+    }
+
+    // Decodes the end of the file to verify the restored seek frames
+    static std::vector<CSAMPLE> readTail(const mixxx::AudioSourcePointer& pAudioSource) {
+        const SINT frameCount = math_min(SINT(10000), pAudioSource->frameLength());
+        mixxx::SampleBuffer buffer(pAudioSource->frames2samples(frameCount));
+        const auto frames = pAudioSource->readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        mixxx::IndexRange::forward(
+                                pAudioSource->frameIndexMax() - frameCount,
+                                frameCount),
+                        mixxx::SampleBuffer::WritableSlice(buffer)));
+        return std::vector<CSAMPLE>(frames.readableData(),
+                frames.readableData() + frames.readableLength());
+    }
+
+    std::shared_ptr<InMemorySeekIndexStore> m_pStore;
+};
+
+TEST_F(SoundSourceMp3Test, RestoreSeekIndex) {
+    const auto pScanned = openMp3();
+    EXPECT_EQ(1, m_pStore->saveCount());
+
+    // The stored index is reused without saving it again
+    const auto pRestored = openMp3();
+    EXPECT_EQ(1, m_pStore->saveCount());
+
+    EXPECT_EQ(pScanned->frameIndexRange(), pRestored->frameIndexRange());
+    EXPECT_EQ(SINT(pScanned->sampleRate()), SINT(pRestored->sampleRate()));
+    EXPECT_EQ(SINT(pScanned->channelCount()), SINT(pRestored->channelCount()));
+    EXPECT_EQ(SINT(pScanned->bitrate()), SINT(pRestored->bitrate()));
+    EXPECT_EQ(readTail(pScanned), readTail(pRestored));
+}
+
+TEST_F(SoundSourceMp3Test, RescanInvalidSeekIndex) {
+    const auto pScanned = openMp3();
+    EXPECT_EQ(1, m_pStore->saveCount());
+
+    m_pStore->corruptSeekIndices();
+
+    // Falls back to scanning the file and replaces the stored index
+    const auto pRescanned = openMp3();
+    EXPECT_EQ(2, m_pStore->saveCount());
+    EXPECT_EQ(pScanned->frameIndexRange(), pRescanned->frameIndexRange());
+}
+
+#endif // __MAD__
+
+}  // namespace
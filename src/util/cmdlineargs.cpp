@@ -58,6 +58,15 @@ bool CmdlineArgs::Parse(int &argc, char **argv) {
         } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
             m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
             i++;
+        } else if (argv[i] == QString("--controlTracePath") && i+1 < argc) {
+            m_controlTracePath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--render") && i+1 < argc) {
+            m_renderScriptPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--renderOutput") && i+1 < argc) {
+            m_renderOutputPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
         } else if (argv[i] == QString("--logLevel") && i+1 < argc) {
             logLevelSet = true;
             auto level = QLatin1String(argv[i+1]);
@@ -166,6 +175,26 @@ void CmdlineArgs::printUsage() {
 --logFlushLevel LEVEL   Sets the the logging level at which the log buffer\n\
                         is flushed to mixxx.log. LEVEL is one of the values\n\
                         defined at --logLevel above.\n\
+\n\
+--controlTracePath FILE Traces the value changes of all controls and\n\
+                        writes the controls that take the longest to\n\
+                        notify their listeners to the csv file FILE on\n\
+                        exit. Adds some overhead to every change.\n\
+\n\
+--render SCRIPT         Renders the mix described by the render script\n\
+                        SCRIPT as fast as possible without a GUI or sound\n\
+                        hardware and reports the throughput of the engine.\n\
+                        Each line of SCRIPT is an event at a time in seconds:\n\
+                          SECONDS load [GROUP] FILE\n\
+                          SECONDS set [GROUP] ITEM VALUE\n\
+                          SECONDS stop\n\
+                        Events take effect at the next engine callback.\n\
+                        The settings, effect chains and the sample rate\n\
+                        and buffer size of the sound configuration are\n\
+                        taken from --settingsPath.\n\
+\n\
+--renderOutput FILE     Writes the master output of --render to the\n\
+                        WAV file FILE (32 bit float).\n\
 \n"
 #ifdef MIXXX_BUILD_DEBUG
 "\
@@ -37,6 +37,11 @@ class CmdlineArgs final {
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getControlTraceEnabled() const { return !m_controlTracePath.isEmpty(); }
+    const QString& getControlTracePath() const { return m_controlTracePath; }
+    bool getRenderEnabled() const { return !m_renderScriptPath.isEmpty(); }
+    const QString& getRenderScriptPath() const { return m_renderScriptPath; }
+    const QString& getRenderOutputPath() const { return m_renderOutputPath; }
 
   private:
     CmdlineArgs();
@@ -55,6 +60,9 @@ class CmdlineArgs final {
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_controlTracePath;
+    QString m_renderScriptPath;
+    QString m_renderOutputPath;
 };
 
 #endif /* CMDLINEARGS_H */
@@ -0,0 +1,123 @@
+#include "util/cpufeatures.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MIXXX_CPUFEATURES_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace mixxx {
+
+namespace {
+
+#ifdef MIXXX_CPUFEATURES_X86
+
+// CPUID feature bits, see the Intel 64 and IA-32 Architectures Software
+// Developer's Manual, Volume 2A, CPUID.
+const unsigned int kLeaf1EdxSse2 = 1u << 26;
+const unsigned int kLeaf1EcxOsxsave = 1u << 27;
+const unsigned int kLeaf1EcxAvx = 1u << 28;
+const unsigned int kLeaf7EbxAvx2 = 1u << 5;
+const unsigned int kLeaf7EbxAvx512f = 1u << 16;
+
+// XCR0 bits that the OS sets if it saves the corresponding register state
+// on context switches.
+const unsigned long long kXcr0SseAvx = 0x06; // XMM | YMM
+const unsigned long long kXcr0Avx512 = 0xE6; // XMM | YMM | opmask | ZMM
+
+// Returns false if the requested leaf is not supported.
+bool cpuid(unsigned int leaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (static_cast<unsigned int>(info[0]) < leaf) {
+        return false;
+    }
+    __cpuidex(info, leaf, 0);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(info[i]);
+    }
+    return true;
+#else
+    if (__get_cpuid_max(0, nullptr) < leaf) {
+        return false;
+    }
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+    return true;
+#endif
+}
+
+unsigned long long xgetbv0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+#endif // MIXXX_CPUFEATURES_X86
+
+} // anonymous namespace
+
+// static
+CpuFeatures::SimdLevel CpuFeatures::simdLevel() {
+    static const SimdLevel s_simdLevel = detectSimdLevel();
+    return s_simdLevel;
+}
+
+// static
+CpuFeatures::SimdLevel CpuFeatures::detectSimdLevel() {
+    SimdLevel level = SimdLevel::Scalar;
+#ifdef MIXXX_CPUFEATURES_X86
+    // EAX, EBX, ECX, EDX
+    unsigned int leaf1[4] = {0, 0, 0, 0};
+    if (!cpuid(1, leaf1) || !(leaf1[3] & kLeaf1EdxSse2)) {
+        return level;
+    }
+    level = SimdLevel::Sse2;
+
+    const bool osxsave = leaf1[2] & kLeaf1EcxOsxsave;
+    const bool avx = leaf1[2] & kLeaf1EcxAvx;
+    if (!osxsave || !avx) {
+        return level;
+    }
+    const unsigned long long xcr0 = xgetbv0();
+    if ((xcr0 & kXcr0SseAvx) != kXcr0SseAvx) {
+        return level;
+    }
+
+    unsigned int leaf7[4] = {0, 0, 0, 0};
+    if (!cpuid(7, leaf7) || !(leaf7[1] & kLeaf7EbxAvx2)) {
+        return level;
+    }
+    level = SimdLevel::Avx2;
+
+    if ((leaf7[1] & kLeaf7EbxAvx512f) &&
+            (xcr0 & kXcr0Avx512) == kXcr0Avx512) {
+        level = SimdLevel::Avx512;
+    }
+#endif
+    return level;
+}
+
+// static
+const char* CpuFeatures::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Sse2:
+        return "SSE2";
+    case SimdLevel::Avx2:
+        return "AVX2";
+    case SimdLevel::Avx512:
+        return "AVX-512";
+    }
+    return "unknown";
+}
+
+} // namespace mixxx
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace mixxx {
+
+// Runtime detection of the SIMD instruction sets that are supported by
+// both the CPU and the operating system. This allows a single portable
+// binary to pick the fastest code path for the machine it runs on.
+class CpuFeatures {
+  public:
+    // Ordered from the least to the most capable instruction set.
+    enum class SimdLevel {
+        Scalar = 0,
+        Sse2,
+        Avx2,
+        Avx512,
+    };
+
+    // The best SIMD level usable on this machine. The detection runs once
+    // and the result is cached.
+    static SimdLevel simdLevel();
+
+    static bool supports(SimdLevel level) {
+        return static_cast<int>(level) <= static_cast<int>(simdLevel());
+    }
+
+    static const char* simdLevelName(SimdLevel level);
+
+  private:
+    static SimdLevel detectSimdLevel();
+};
+
+} // namespace mixxx
@@ -0,0 +1,140 @@
+#ifndef FIXEDCAPACITYHASH_H
+#define FIXEDCAPACITYHASH_H
+
+#include <vector>
+
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/types.h"
+
+// FixedCapacityHash maps integer keys to pointers for at most a fixed number
+// of entries that is given at construction. All memory is allocated by the
+// constructor, so value(), insert() and remove() never allocate and are safe
+// to use in the audio callback, unlike QHash which may rehash on insert.
+//
+// The table uses open addressing with linear probing in a flat array that is
+// kept at most half full, so a lookup usually touches a single cache line.
+// Removed entries are not marked as deleted but the following entries of the
+// probe sequence are shifted back, so lookups never get slower over time.
+//
+// Null pointers are not allowed as values because they mark empty slots.
+//
+// WARNING: FixedCapacityHash is not thread-safe.
+template <typename T>
+class FixedCapacityHash {
+  public:
+    explicit FixedCapacityHash(int capacity)
+            : m_capacity(capacity),
+              m_size(0),
+              m_mask(roundUpToPowerOf2(2 * math_max(capacity, 1)) - 1),
+              m_shift(32),
+              m_slots(m_mask + 1) {
+        for (int size = m_mask + 1; size > 1; size >>= 1) {
+            --m_shift;
+        }
+    }
+
+    int capacity() const {
+        return m_capacity;
+    }
+
+    int size() const {
+        return m_size;
+    }
+
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+
+    // Returns the value for key or nullptr if the key is not present
+    T* value(SINT key) const {
+        for (int slot = homeSlot(key); ; slot = (slot + 1) & m_mask) {
+            const Slot& entry = m_slots[slot];
+            if (entry.pValue == nullptr || entry.key == key) {
+                return entry.pValue;
+            }
+        }
+    }
+
+    // Inserts or replaces the value for key. Returns false if the key is not
+    // present and the hash already holds capacity() entries.
+    bool insert(SINT key, T* pValue) {
+        DEBUG_ASSERT(pValue != nullptr);
+        int slot = homeSlot(key);
+        for (; m_slots[slot].pValue != nullptr; slot = (slot + 1) & m_mask) {
+            if (m_slots[slot].key == key) {
+                m_slots[slot].pValue = pValue;
+                return true;
+            }
+        }
+        if (m_size >= m_capacity) {
+            return false;
+        }
+        m_slots[slot].key = key;
+        m_slots[slot].pValue = pValue;
+        ++m_size;
+        return true;
+    }
+
+    // Removes the key and returns its value or nullptr if the key was not
+    // present.
+    T* remove(SINT key) {
+        int hole = homeSlot(key);
+        for (; m_slots[hole].key != key; hole = (hole + 1) & m_mask) {
+            if (m_slots[hole].pValue == nullptr) {
+                return nullptr;
+            }
+        }
+        T* pValue = m_slots[hole].pValue;
+        if (pValue == nullptr) {
+            return nullptr;
+        }
+        // Close the hole by moving back every following entry of the
+        // cluster that would not be found anymore otherwise, i.e. whose home
+        // slot is not between the hole and its current slot.
+        for (int slot = (hole + 1) & m_mask;
+                m_slots[slot].pValue != nullptr;
+                slot = (slot + 1) & m_mask) {
+            const int home = homeSlot(m_slots[slot].key);
+            if (((slot - home) & m_mask) >= ((slot - hole) & m_mask)) {
+                m_slots[hole] = m_slots[slot];
+                hole = slot;
+            }
+        }
+        m_slots[hole].pValue = nullptr;
+        --m_size;
+        return pValue;
+    }
+
+    void clear() {
+        for (auto& entry: m_slots) {
+            entry.pValue = nullptr;
+        }
+        m_size = 0;
+    }
+
+  private:
+    struct Slot {
+        Slot()
+                : key(0),
+                  pValue(nullptr) {
+        }
+        SINT key;
+        T* pValue;
+    };
+
+    int homeSlot(SINT key) const {
+        // Fibonacci hashing: The upper bits of the product depend on all bits
+        // of the key. The table has at least 2 slots, so m_shift < 32.
+        return static_cast<int>(
+                (static_cast<quint32>(key) * 2654435769u) >> m_shift);
+    }
+
+    const int m_capacity;
+    int m_size;
+    const int m_mask;
+    int m_shift;
+    std::vector<Slot> m_slots;
+};
+
+#endif // FIXEDCAPACITYHASH_H
@@ -0,0 +1,85 @@
+#include "util/latencyhistogram.h"
+
+#include "util/math.h"
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < kNumBuckets; ++i) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_maxNanos.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::record(mixxx::Duration duration) {
+    // There is only a single writer, so plain loads and stores are enough
+    // and cheaper than read-modify-write operations.
+    std::atomic<quint32>& bucket =
+            m_buckets[bucketForMicros(duration.toIntegerMicros())];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+    m_count.store(m_count.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+    const qint64 nanos = duration.toIntegerNanos();
+    if (nanos > m_maxNanos.load(std::memory_order_relaxed)) {
+        m_maxNanos.store(nanos, std::memory_order_relaxed);
+    }
+}
+
+mixxx::Duration LatencyHistogram::percentile(double percent) const {
+    quint64 total = 0;
+    quint32 counts[kNumBuckets];
+    for (int i = 0; i < kNumBuckets; ++i) {
+        counts[i] = bucketCount(i);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return mixxx::Duration::empty();
+    }
+    const quint64 rank = static_cast<quint64>(
+            math_clamp(percent, 0.0, 100.0) / 100.0 * total + 0.5);
+    quint64 sum = 0;
+    int bucket = 0;
+    for (; bucket < kNumBuckets - 1; ++bucket) {
+        sum += counts[bucket];
+        if (sum >= rank && sum > 0) {
+            break;
+        }
+    }
+    const mixxx::Duration upperBound =
+            mixxx::Duration::fromMicros(bucketUpperBoundMicros(bucket));
+    const mixxx::Duration maxDuration = max();
+    return upperBound < maxDuration ? upperBound : maxDuration;
+}
+
+// static
+int LatencyHistogram::bucketForMicros(qint64 micros) {
+    if (micros < kSubBuckets) {
+        return micros > 0 ? static_cast<int>(micros) : 0;
+    }
+    if (micros >= (Q_INT64_C(1) << kMaxBits)) {
+        return kNumBuckets - 1;
+    }
+    int bits = kSubBucketBits;
+    while ((micros >> (bits + 1)) != 0) {
+        ++bits;
+    }
+    // The sub bucket is given by the kSubBucketBits bits below the highest
+    // set bit
+    const int subBucket = static_cast<int>(
+            (micros >> (bits - kSubBucketBits)) & (kSubBuckets - 1));
+    return kSubBuckets + (bits - kSubBucketBits) * kSubBuckets + subBucket;
+}
+
+// static
+qint64 LatencyHistogram::bucketUpperBoundMicros(int bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket + 1;
+    }
+    const int octave = (bucket - kSubBuckets) / kSubBuckets;
+    const int subBucket = (bucket - kSubBuckets) % kSubBuckets;
+    return static_cast<qint64>(kSubBuckets + subBucket + 1) << octave;
+}
@@ -0,0 +1,59 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+
+#include <QtGlobal>
+
+#include "util/duration.h"
+
+// A histogram of durations that is written from the audio callback without
+// locks, allocations or system calls and can be read from any other thread
+// at the same time. There must only be a single writer.
+//
+// Durations are counted in microseconds. Below 8 us every microsecond has
+// its own bucket, above that every power of two is split into 8 buckets,
+// so percentiles are accurate to 12.5%. Durations from 2^24 us (~17 s) on
+// are all counted in the last bucket.
+class LatencyHistogram {
+  public:
+    static const int kSubBuckets = 8;
+    static const int kSubBucketBits = 3;
+    static const int kMaxBits = 24;
+    static const int kNumBuckets =
+            kSubBuckets + (kMaxBits - kSubBucketBits) * kSubBuckets;
+
+    LatencyHistogram();
+
+    // Writer only
+    void record(mixxx::Duration duration);
+    void reset();
+
+    // Any thread. While the writer is active these are a snapshot that may
+    // be off by the durations that are recorded concurrently.
+    quint64 count() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    mixxx::Duration max() const {
+        return mixxx::Duration::fromNanos(
+                m_maxNanos.load(std::memory_order_relaxed));
+    }
+    quint32 bucketCount(int bucket) const {
+        return m_buckets[bucket].load(std::memory_order_relaxed);
+    }
+    // Returns the smallest duration that is at least as long as the given
+    // percentage (0 to 100) of all recorded durations, rounded up to the end
+    // of its bucket but never above max().
+    mixxx::Duration percentile(double percent) const;
+
+    static int bucketForMicros(qint64 micros);
+    // The first duration in microseconds that is counted in the next bucket
+    static qint64 bucketUpperBoundMicros(int bucket);
+
+  private:
+    std::atomic<quint32> m_buckets[kNumBuckets];
+    std::atomic<quint64> m_count;
+    std::atomic<qint64> m_maxNanos;
+};
+
+#endif // LATENCYHISTOGRAM_H
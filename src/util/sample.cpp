@@ -3,6 +3,7 @@
 
 #include "util/sample.h"
 #include "util/math.h"
+#include "util/samplekernels.h"
 
 #ifdef __WINDOWS__
 #include <QtGlobal>
@@ -16,6 +17,10 @@ typedef qint32 int32_t;
 // https://gcc.gnu.org/projects/tree-ssa/vectorization.html
 // This also utilizes AVX registers when compiled for a recent 64-bit CPU
 // using scons optimize=native.
+//
+// The hottest loops are not implemented here but in mixxx::SampleKernels,
+// which picks explicit SSE2, AVX2 or AVX-512 implementations at runtime
+// depending on the CPU, independent of the optimization level of the build.
 
 namespace {
 
@@ -36,6 +41,11 @@ constexpr bool useAlignedAlloc() {
 
 } // anonymous namespace
 
+// static
+void SampleUtil::initialize() {
+    mixxx::SampleKernels::selectBestLevel();
+}
+
 // static
 CSAMPLE* SampleUtil::alloc(SINT size) {
     // To speed up vectorization we align our sample buffers to 16-byte (128
@@ -110,10 +120,7 @@ void SampleUtil::applyGain(CSAMPLE* pBuffer, CSAMPLE_GAIN gain,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pBuffer[i] *= gain;
-    }
+    mixxx::SampleKernels::active().applyGain(pBuffer, gain, numSamples);
 }
 
 // static
@@ -129,20 +136,13 @@ void SampleUtil::applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
 
     const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
             / CSAMPLE_GAIN(numSamples / 2);
+    const mixxx::SampleKernels& kernels = mixxx::SampleKernels::active();
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            // a loop counter i += 2 prevents vectorizing.
-            pBuffer[i * 2] *= gain;
-            pBuffer[i * 2 + 1] *= gain;
-        }
+        kernels.applyRampingGain(pBuffer, start_gain, gain_delta,
+                numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pBuffer[i] *= old_gain;
-        }
+        kernels.applyGain(pBuffer, old_gain, numSamples);
     }
 }
 
@@ -207,10 +207,7 @@ void SampleUtil::applyRampingAlternatingGain(CSAMPLE* pBuffer,
 void SampleUtil::add(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numSamples) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i];
-    }
+    mixxx::SampleKernels::active().add(pDest, pSrc, numSamples);
 }
 
 // static
@@ -221,10 +218,7 @@ void SampleUtil::addWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i] * gain;
-    }
+    mixxx::SampleKernels::active().addWithGain(pDest, pSrc, gain, numSamples);
 }
 
 void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
@@ -237,19 +231,13 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
 
     const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
             / CSAMPLE_GAIN(numSamples / 2);
+    const mixxx::SampleKernels& kernels = mixxx::SampleKernels::active();
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
+        kernels.addWithRampingGain(pDest, pSrc, start_gain, gain_delta,
+                numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pDest[i] += pSrc[i] * old_gain;
-        }
+        kernels.addWithGain(pDest, pSrc, old_gain, numSamples);
     }
 }
 
@@ -303,10 +291,7 @@ void SampleUtil::copyWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = pSrc[i] * gain;
-    }
+    mixxx::SampleKernels::active().copyWithGain(pDest, pSrc, gain, numSamples);
 
     // OR! need to test which fares better
     // copy(pDest, pSrc, iNumSamples);
@@ -330,19 +315,13 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
 
     const CSAMPLE_GAIN gain_delta = (new_gain - old_gain)
             / CSAMPLE_GAIN(numSamples / 2);
+    const mixxx::SampleKernels& kernels = mixxx::SampleKernels::active();
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i"
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
+        kernels.copyWithRampingGain(pDest, pSrc, start_gain, gain_delta,
+                numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (SINT i = 0; i < numSamples; ++i) {
-            pDest[i] = pSrc[i] * old_gain;
-        }
+        kernels.copyWithGain(pDest, pSrc, old_gain, numSamples);
     }
 
     // OR! need to test which fares better
@@ -350,6 +329,17 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
     // applyRampingGain(pDest, gain);
 }
 
+// static
+void SampleUtil::copyWithStereoGains(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        const CSAMPLE_GAIN* pGainsLeft, const CSAMPLE_GAIN* pGainsRight,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[i * 2] = pSrc[i * 2] * pGainsLeft[i];
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * pGainsRight[i];
+    }
+}
+
 // static
 void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
         const SAMPLE* M_RESTRICT pSrc, SINT numSamples) {
@@ -378,34 +368,33 @@ void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
+    CSAMPLE fPeakL;
+    CSAMPLE fPeakR;
+    mixxx::SampleKernels::active().sumAbsPerChannel(pfAbsL, pfAbsR,
+            &fPeakL, &fPeakR, pBuffer, numSamples / 2);
 
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
     SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
+    if (fPeakL > CSAMPLE_PEAK) {
         clipping |= SampleUtil::CLIPPING_LEFT;
     }
-    if (clippedR > 0) {
+    if (fPeakR > CSAMPLE_PEAK) {
         clipping |= SampleUtil::CLIPPING_RIGHT;
     }
     return clipping;
 }
 
+// static
+bool SampleUtil::isSilent(const CSAMPLE* pBuffer, SINT numSamples,
+        CSAMPLE threshold) {
+    CSAMPLE fAbsL;
+    CSAMPLE fAbsR;
+    CSAMPLE fPeakL;
+    CSAMPLE fPeakR;
+    mixxx::SampleKernels::active().sumAbsPerChannel(&fAbsL, &fAbsR,
+            &fPeakL, &fPeakR, pBuffer, numSamples / 2);
+    return fPeakL <= threshold && fPeakR <= threshold;
+}
+
 // static
 void SampleUtil::copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
@@ -420,11 +409,8 @@ void SampleUtil::interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc1,
         const CSAMPLE* M_RESTRICT pSrc2,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest[2 * i] = pSrc1[i];
-        pDest[2 * i + 1] = pSrc2[i];
-    }
+    mixxx::SampleKernels::active().interleaveBuffer(
+            pDest, pSrc1, pSrc2, numFrames);
 }
 
 // static
@@ -432,11 +418,17 @@ void SampleUtil::deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
         CSAMPLE* M_RESTRICT pDest2,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest1[i] = pSrc[i * 2];
-        pDest2[i] = pSrc[i * 2 + 1];
-    }
+    mixxx::SampleKernels::active().deinterleaveBuffer(
+            pDest1, pDest2, pSrc, numFrames);
+}
+
+// static
+void SampleUtil::interpolateHermite(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pXm1, const CSAMPLE* M_RESTRICT pX0,
+        const CSAMPLE* M_RESTRICT pX1, const CSAMPLE* M_RESTRICT pX2,
+        const CSAMPLE* M_RESTRICT pFraction, SINT numSamples) {
+    mixxx::SampleKernels::active().hermiteInterpolate(
+            pDest, pXm1, pX0, pX1, pX2, pFraction, numSamples);
 }
 
 // static
@@ -26,6 +26,10 @@ class SampleUtil {
     // This is some legacy, we cannot easily revert.
     static constexpr double kPlayPositionChannels = 2.0;
 
+    // Selects the fastest implementations for this CPU. Must be called once
+    // at startup, before the audio threads are started.
+    static void initialize();
+
     // Allocated a buffer of CSAMPLE's with length size. Ensures that the buffer
     // is 16-byte aligned for SSE enhancement.
     static CSAMPLE* alloc(SINT size);
@@ -161,6 +165,13 @@ class SampleUtil {
             CSAMPLE_GAIN old_gain, CSAMPLE_GAIN new_gain,
             SINT numSamples);
 
+    // Copy the stereo frames of pSrc to pDest and multiply the left and the
+    // right sample of each frame by the gain for that frame in pGainsLeft and
+    // pGainsRight. pDest may be an alias of pSrc.
+    static void copyWithStereoGains(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            const CSAMPLE_GAIN* pGainsLeft, const CSAMPLE_GAIN* pGainsRight,
+            SINT numFrames);
+
     // Add pSrc to pDest
     static void add(CSAMPLE* pDest, const CSAMPLE* pSrc, SINT numSamples);
 
@@ -202,6 +213,11 @@ class SampleUtil {
     static CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
             const CSAMPLE* pBuffer, SINT numSamples);
 
+    // Returns true if the absolute value of no sample in the interleaved
+    // stereo buffer pBuffer exceeds threshold.
+    static bool isSilent(const CSAMPLE* pBuffer, SINT numSamples,
+            CSAMPLE threshold);
+
     // Copies every sample in pSrc to pDest, limiting the values in pDest
     // to the valid range of CSAMPLE. If pDest and pSrc are aliases, will
     // not copy will only clamp. Returns true if any samples in pSrc were
@@ -223,6 +239,14 @@ class SampleUtil {
     static void deinterleaveBuffer(CSAMPLE* pDest1, CSAMPLE* pDest2,
             const CSAMPLE* pSrc, SINT numSamples);
 
+    // Interpolates each sample of pDest between pX0 and pX1 at the position
+    // in pFraction with a 4-point cubic Hermite spline through the samples
+    // in pXm1, pX0, pX1 and pX2. All buffers must have numSamples samples.
+    static void interpolateHermite(CSAMPLE* pDest,
+            const CSAMPLE* pXm1, const CSAMPLE* pX0,
+            const CSAMPLE* pX1, const CSAMPLE* pX2,
+            const CSAMPLE* pFraction, SINT numSamples);
+
     // Crossfade two buffers together and put the result in pDest.  All the
     // buffers must be the same length.  pDest may be an alias of the source
     // buffers.  It is preferable to use the copyWithRamping functions, but
@@ -0,0 +1,263 @@
+#include "util/samplekernels.h"
+
+#include <QtDebug>
+
+#include "util/math.h"
+#include "util/platform.h"
+
+// The scalar reference implementation of the SampleUtil kernels. These are
+// the loops that SampleUtil used before the kernels were dispatched at
+// runtime and still rely on the compiler to auto-vectorize them for the
+// baseline instruction set of the build.
+//
+// LOOP VECTORIZED below marks the loops that are processed with the 128 bit SSE
+// registers as tested with gcc 4.6 and the -ftree-vectorizer-verbose=2 flag on
+// an Intel i5 CPU. When changing, be careful to not disturb the vectorization.
+
+namespace mixxx {
+
+namespace {
+
+void applyGainScalar(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void applyRampingGainScalar(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        // a loop counter i += 2 prevents vectorizing.
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void copyWithGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+void copyWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+    // note: LOOP VECTORIZED only with "int i"
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void addScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i];
+    }
+}
+
+void addWithGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+void addWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void sumAbsPerChannelScalar(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+        CSAMPLE* pfPeakL, CSAMPLE* pfPeakR,
+        const CSAMPLE* pBuffer, SINT numFrames) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE fPeakL = CSAMPLE_ZERO;
+    CSAMPLE fPeakR = CSAMPLE_ZERO;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        fPeakL = math_max(fPeakL, absl);
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        fPeakR = math_max(fPeakR, absr);
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    *pfPeakL = fPeakL;
+    *pfPeakR = fPeakR;
+}
+
+void interleaveBufferScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveBufferScalar(CSAMPLE* M_RESTRICT pDest1,
+        CSAMPLE* M_RESTRICT pDest2,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+// laurent de soras - punked from musicdsp.org (mad props)
+void hermiteInterpolateScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pXm1, const CSAMPLE* M_RESTRICT pX0,
+        const CSAMPLE* M_RESTRICT pX1, const CSAMPLE* M_RESTRICT pX2,
+        const CSAMPLE* M_RESTRICT pFraction, SINT numSamples) {
+    for (SINT i = 0; i < numSamples; ++i) {
+        const CSAMPLE c = (pX1[i] - pXm1[i]) * 0.5f;
+        const CSAMPLE v = pX0[i] - pX1[i];
+        const CSAMPLE w = c + v;
+        const CSAMPLE a = w + v + (pX2[i] - pX0[i]) * 0.5f;
+        const CSAMPLE bNeg = w + a;
+        const CSAMPLE fraction = pFraction[i];
+        pDest[i] = ((a * fraction - bNeg) * fraction + c) * fraction + pX0[i];
+    }
+}
+
+template<int kNumSources, bool kWriteBack>
+void mixWithRampingGainsScalar(CSAMPLE* M_RESTRICT pDest, bool accumulate,
+        const RampingGainSource* pSources, SINT firstFrame, SINT endFrame) {
+    CSAMPLE* pBuffers[kNumSources];
+    CSAMPLE_GAIN startGains[kNumSources];
+    CSAMPLE_GAIN gainDeltas[kNumSources];
+    for (int j = 0; j < kNumSources; ++j) {
+        pBuffers[j] = pSources[j].pBuffer;
+        startGains[j] = pSources[j].startGain;
+        gainDeltas[j] = pSources[j].gainDelta;
+    }
+    for (int i = firstFrame; i < endFrame; ++i) {
+        CSAMPLE left = accumulate ? pDest[i * 2] : CSAMPLE_ZERO;
+        CSAMPLE right = accumulate ? pDest[i * 2 + 1] : CSAMPLE_ZERO;
+        for (int j = 0; j < kNumSources; ++j) {
+            const CSAMPLE_GAIN gain = startGains[j] + gainDeltas[j] * i;
+            const CSAMPLE sourceLeft = pBuffers[j][i * 2] * gain;
+            const CSAMPLE sourceRight = pBuffers[j][i * 2 + 1] * gain;
+            if (kWriteBack) {
+                pBuffers[j][i * 2] = sourceLeft;
+                pBuffers[j][i * 2 + 1] = sourceRight;
+            }
+            left += sourceLeft;
+            right += sourceRight;
+        }
+        pDest[i * 2] = left;
+        pDest[i * 2 + 1] = right;
+    }
+}
+
+static_assert(SampleKernels::kMaxMixSources == 8,
+        "the kernel tables must list a mixing kernel for every source count");
+
+const SampleKernels kScalarKernels = {
+    CpuFeatures::SimdLevel::Scalar,
+    applyGainScalar,
+    applyRampingGainScalar,
+    copyWithGainScalar,
+    copyWithRampingGainScalar,
+    addScalar,
+    addWithGainScalar,
+    addWithRampingGainScalar,
+    sumAbsPerChannelScalar,
+    interleaveBufferScalar,
+    deinterleaveBufferScalar,
+    hermiteInterpolateScalar,
+    {
+        mixWithRampingGainsScalar<1, false>,
+        mixWithRampingGainsScalar<2, false>,
+        mixWithRampingGainsScalar<3, false>,
+        mixWithRampingGainsScalar<4, false>,
+        mixWithRampingGainsScalar<5, false>,
+        mixWithRampingGainsScalar<6, false>,
+        mixWithRampingGainsScalar<7, false>,
+        mixWithRampingGainsScalar<8, false>,
+    },
+    {
+        mixWithRampingGainsScalar<1, true>,
+        mixWithRampingGainsScalar<2, true>,
+        mixWithRampingGainsScalar<3, true>,
+        mixWithRampingGainsScalar<4, true>,
+        mixWithRampingGainsScalar<5, true>,
+        mixWithRampingGainsScalar<6, true>,
+        mixWithRampingGainsScalar<7, true>,
+        mixWithRampingGainsScalar<8, true>,
+    },
+};
+
+} // anonymous namespace
+
+const SampleKernels& scalarSampleKernels() {
+    return kScalarKernels;
+}
+
+// Constant initialized, so SampleUtil works before selectBestLevel()
+// static
+const SampleKernels* SampleKernels::s_pActive = &kScalarKernels;
+
+// static
+const SampleKernels* SampleKernels::forLevel(CpuFeatures::SimdLevel level) {
+    if (!CpuFeatures::supports(level)) {
+        return nullptr;
+    }
+    switch (level) {
+    case CpuFeatures::SimdLevel::Scalar:
+        return &scalarSampleKernels();
+#ifdef __SIMDKERNELS__
+    case CpuFeatures::SimdLevel::Sse2:
+        return &sse2SampleKernels();
+    case CpuFeatures::SimdLevel::Avx2:
+        return &avx2SampleKernels();
+    case CpuFeatures::SimdLevel::Avx512:
+        return &avx512SampleKernels();
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+// static
+void SampleKernels::selectBestLevel() {
+    const SampleKernels* pKernels = nullptr;
+    for (int level = static_cast<int>(CpuFeatures::simdLevel());
+            pKernels == nullptr && level >= 0; --level) {
+        pKernels = forLevel(static_cast<CpuFeatures::SimdLevel>(level));
+    }
+    VERIFY_OR_DEBUG_ASSERT(pKernels != nullptr) {
+        return;
+    }
+    qDebug() << "SampleUtil: Using"
+             << CpuFeatures::simdLevelName(pKernels->level)
+             << "kernels";
+    s_pActive = pKernels;
+}
+
+} // namespace mixxx
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "util/cpufeatures.h"
+#include "util/types.h"
+
+namespace mixxx {
+
+// An interleaved stereo buffer that is mixed with a gain ramp, see
+// SampleKernels::mixWithRampingGains. The gain of frame i is
+// startGain + gainDelta * i, where i counts from the start of the buffer
+// also when only a part of it is mixed.
+struct RampingGainSource {
+    CSAMPLE* pBuffer;
+    CSAMPLE_GAIN startGain;
+    CSAMPLE_GAIN gainDelta;
+};
+
+// The inner loops of the hot SampleUtil functions, implemented once as a
+// scalar reference and once per SIMD instruction set. SampleUtil handles
+// the special cases (unity gain, zero gain, ...) and then calls into the
+// kernels that have been selected for the CPU at startup.
+//
+// The ramping kernels work on interleaved stereo frames: the gain of frame i
+// is startGain + gainDelta * i and is applied to both of its samples.
+struct SampleKernels {
+    // The number of sources for which the mixing kernels are specialized
+    static const int kMaxMixSources = 8;
+
+    typedef void (*MixWithRampingGainsFunction)(CSAMPLE* pDest, bool accumulate,
+            const RampingGainSource* pSources, SINT firstFrame, SINT endFrame);
+
+    CpuFeatures::SimdLevel level;
+
+    void (*applyGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN gain, SINT numSamples);
+    void (*applyRampingGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames);
+    void (*copyWithGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain, SINT numSamples);
+    void (*copyWithRampingGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames);
+    void (*add)(CSAMPLE* pDest, const CSAMPLE* pSrc, SINT numSamples);
+    void (*addWithGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain, SINT numSamples);
+    void (*addWithRampingGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames);
+    // Sums up and finds the peak of the absolute sample values of each
+    // channel of an interleaved stereo buffer.
+    void (*sumAbsPerChannel)(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+            CSAMPLE* pfPeakL, CSAMPLE* pfPeakR,
+            const CSAMPLE* pBuffer, SINT numFrames);
+    void (*interleaveBuffer)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1, const CSAMPLE* pSrc2, SINT numFrames);
+    void (*deinterleaveBuffer)(CSAMPLE* pDest1, CSAMPLE* pDest2,
+            const CSAMPLE* pSrc, SINT numFrames);
+    // 4-point cubic Hermite interpolation between pX0[i] and pX1[i] at
+    // pFraction[i], with the neighbors pXm1[i] and pX2[i].
+    void (*hermiteInterpolate)(CSAMPLE* pDest,
+            const CSAMPLE* pXm1, const CSAMPLE* pX0,
+            const CSAMPLE* pX1, const CSAMPLE* pX2,
+            const CSAMPLE* pFraction, SINT numSamples);
+    // mixWithRampingGains[n - 1] fades n sources with their gain ramps and
+    // sums them up in order into the frames [firstFrame, endFrame) of pDest,
+    // either replacing or accumulating the existing samples. All sources are
+    // processed in a single pass over pDest.
+    MixWithRampingGainsFunction mixWithRampingGains[kMaxMixSources];
+    // Like mixWithRampingGains, but also replaces the samples of the sources
+    // with their faded samples like applyRampingGain.
+    MixWithRampingGainsFunction applyAndMixWithRampingGains[kMaxMixSources];
+
+    // The kernels used by SampleUtil: the best ones available for the
+    // instruction sets supported by this CPU once selectBestLevel() has
+    // been called, the scalar ones before.
+    static const SampleKernels& active() {
+        return *s_pActive;
+    }
+
+    // Selects the best kernels for this CPU and logs them. Called once by
+    // SampleUtil::initialize() at startup, before any other thread uses
+    // SampleUtil.
+    static void selectBestLevel();
+
+    // The kernels for a specific instruction set, or nullptr if they were
+    // not built into this binary or the CPU does not support them. Used by
+    // tests and benchmarks to compare the implementations.
+    static const SampleKernels* forLevel(CpuFeatures::SimdLevel level);
+
+  private:
+    static const SampleKernels* s_pActive;
+};
+
+// The per instruction set tables. Only those for which the build enables
+// the corresponding source files (see __SIMDKERNELS__) exist.
+const SampleKernels& scalarSampleKernels();
+const SampleKernels& sse2SampleKernels();
+const SampleKernels& avx2SampleKernels();
+const SampleKernels& avx512SampleKernels();
+
+} // namespace mixxx
@@ -0,0 +1,73 @@
+// Compiled with AVX2 enabled, see SimdKernels in build/depends.py
+#include <immintrin.h>
+
+#include "util/samplekernels_simd.h"
+
+namespace mixxx {
+
+namespace {
+
+struct Avx2 {
+    typedef __m256 Vec;
+    static const SINT kWidth = 8;
+
+    static Vec load(const CSAMPLE* p) {
+        return _mm256_loadu_ps(p);
+    }
+    static void store(CSAMPLE* p, Vec v) {
+        _mm256_storeu_ps(p, v);
+    }
+    static Vec set1(CSAMPLE value) {
+        return _mm256_set1_ps(value);
+    }
+    static Vec zero() {
+        return _mm256_setzero_ps();
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm256_add_ps(a, b);
+    }
+    static Vec sub(Vec a, Vec b) {
+        return _mm256_sub_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm256_mul_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm256_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+    }
+    static Vec frameOffsets() {
+        return _mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        // unpack works within the two 128 bit lanes:
+        // lo = a0 b0 a1 b1 | a4 b4 a5 b5, hi = a2 b2 a3 b3 | a6 b6 a7 b7
+        const Vec lo = _mm256_unpacklo_ps(a, b);
+        const Vec hi = _mm256_unpackhi_ps(a, b);
+        *pLo = _mm256_permute2f128_ps(lo, hi, 0x20);
+        *pHi = _mm256_permute2f128_ps(lo, hi, 0x31);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEven, Vec* pOdd) {
+        // shuffle works within the two 128 bit lanes:
+        // even = x0 x2 y0 y2 | x4 x6 y4 y6, which needs to be reordered
+        // as pairs of 64 bit values.
+        const Vec even = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const Vec odd = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+        *pEven = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                _mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+        *pOdd = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                _mm256_castps_pd(odd), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+
+} // anonymous namespace
+
+const SampleKernels& avx2SampleKernels() {
+    static const SampleKernels s_kernels =
+            SimdSampleKernels<Avx2>::kernels(CpuFeatures::SimdLevel::Avx2);
+    return s_kernels;
+}
+
+} // namespace mixxx
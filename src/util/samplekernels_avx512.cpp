@@ -0,0 +1,72 @@
+// Compiled with AVX-512F enabled, see SimdKernels in build/depends.py
+#include <immintrin.h>
+
+#include "util/samplekernels_simd.h"
+
+namespace mixxx {
+
+namespace {
+
+struct Avx512 {
+    typedef __m512 Vec;
+    static const SINT kWidth = 16;
+
+    static Vec load(const CSAMPLE* p) {
+        return _mm512_loadu_ps(p);
+    }
+    static void store(CSAMPLE* p, Vec v) {
+        _mm512_storeu_ps(p, v);
+    }
+    static Vec set1(CSAMPLE value) {
+        return _mm512_set1_ps(value);
+    }
+    static Vec zero() {
+        return _mm512_setzero_ps();
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm512_add_ps(a, b);
+    }
+    static Vec sub(Vec a, Vec b) {
+        return _mm512_sub_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm512_mul_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm512_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        return _mm512_abs_ps(v);
+    }
+    static Vec frameOffsets() {
+        return _mm512_setr_ps(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        // Indices >= 16 select from b
+        const __m512i loIndices = _mm512_setr_epi32(
+                0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i hiIndices = _mm512_setr_epi32(
+                8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        *pLo = _mm512_permutex2var_ps(a, loIndices, b);
+        *pHi = _mm512_permutex2var_ps(a, hiIndices, b);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEven, Vec* pOdd) {
+        // Indices >= 16 select from y
+        const __m512i evenIndices = _mm512_setr_epi32(
+                0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i oddIndices = _mm512_setr_epi32(
+                1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        *pEven = _mm512_permutex2var_ps(x, evenIndices, y);
+        *pOdd = _mm512_permutex2var_ps(x, oddIndices, y);
+    }
+};
+
+} // anonymous namespace
+
+const SampleKernels& avx512SampleKernels() {
+    static const SampleKernels s_kernels =
+            SimdSampleKernels<Avx512>::kernels(CpuFeatures::SimdLevel::Avx512);
+    return s_kernels;
+}
+
+} // namespace mixxx
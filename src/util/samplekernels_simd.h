@@ -0,0 +1,353 @@
+#pragma once
+
+// The SIMD implementation of the SampleKernels, written once against a
+// small vector abstraction V. Every samplekernels_<isa>.cpp file is compiled
+// with the compiler flags for its instruction set, defines V for it and
+// instantiates these templates.
+//
+// Everything in here has internal linkage on purpose: the same template
+// instantiated in different translation units with different instruction
+// sets must never be merged by the linker. For the same reason this file
+// must not call any non-intrinsic inline functions from other headers
+// (e.g. std::max), that could end up being shared with baseline code.
+//
+// Apart from sumAbsPerChannel, which sums up in a different order, the
+// results match the scalar reference bit by bit.
+
+#include "util/samplekernels.h"
+
+namespace mixxx {
+
+namespace {
+
+template<typename V>
+class SimdSampleKernels {
+  public:
+    typedef typename V::Vec Vec;
+
+    static const SINT kWidth = V::kWidth;
+    // The number of interleaved stereo frames per vector
+    static const SINT kFrames = V::kWidth / 2;
+
+    static void applyGain(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN gain, SINT numSamples) {
+        const Vec vGain = V::set1(gain);
+        SINT i = 0;
+        for (; i + kWidth <= numSamples; i += kWidth) {
+            V::store(pBuffer + i, V::mul(V::load(pBuffer + i), vGain));
+        }
+        for (; i < numSamples; ++i) {
+            pBuffer[i] *= gain;
+        }
+    }
+
+    static void applyRampingGain(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+        const RampingGain ramp(startGain, gainDelta);
+        SINT frame = 0;
+        for (; frame + kFrames <= numFrames; frame += kFrames) {
+            CSAMPLE* pFrames = pBuffer + frame * 2;
+            V::store(pFrames, V::mul(V::load(pFrames), ramp.at(frame)));
+        }
+        for (; frame < numFrames; ++frame) {
+            const CSAMPLE_GAIN gain = startGain + gainDelta * static_cast<int>(frame);
+            pBuffer[frame * 2] *= gain;
+            pBuffer[frame * 2 + 1] *= gain;
+        }
+    }
+
+    static void copyWithGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain, SINT numSamples) {
+        const Vec vGain = V::set1(gain);
+        SINT i = 0;
+        for (; i + kWidth <= numSamples; i += kWidth) {
+            V::store(pDest + i, V::mul(V::load(pSrc + i), vGain));
+        }
+        for (; i < numSamples; ++i) {
+            pDest[i] = pSrc[i] * gain;
+        }
+    }
+
+    static void copyWithRampingGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+        const RampingGain ramp(startGain, gainDelta);
+        SINT frame = 0;
+        for (; frame + kFrames <= numFrames; frame += kFrames) {
+            V::store(pDest + frame * 2,
+                    V::mul(V::load(pSrc + frame * 2), ramp.at(frame)));
+        }
+        for (; frame < numFrames; ++frame) {
+            const CSAMPLE_GAIN gain = startGain + gainDelta * static_cast<int>(frame);
+            pDest[frame * 2] = pSrc[frame * 2] * gain;
+            pDest[frame * 2 + 1] = pSrc[frame * 2 + 1] * gain;
+        }
+    }
+
+    static void add(CSAMPLE* pDest, const CSAMPLE* pSrc, SINT numSamples) {
+        SINT i = 0;
+        for (; i + kWidth <= numSamples; i += kWidth) {
+            V::store(pDest + i, V::add(V::load(pDest + i), V::load(pSrc + i)));
+        }
+        for (; i < numSamples; ++i) {
+            pDest[i] += pSrc[i];
+        }
+    }
+
+    static void addWithGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain, SINT numSamples) {
+        const Vec vGain = V::set1(gain);
+        SINT i = 0;
+        for (; i + kWidth <= numSamples; i += kWidth) {
+            V::store(pDest + i, V::add(V::load(pDest + i),
+                    V::mul(V::load(pSrc + i), vGain)));
+        }
+        for (; i < numSamples; ++i) {
+            pDest[i] += pSrc[i] * gain;
+        }
+    }
+
+    static void addWithRampingGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta, SINT numFrames) {
+        const RampingGain ramp(startGain, gainDelta);
+        SINT frame = 0;
+        for (; frame + kFrames <= numFrames; frame += kFrames) {
+            CSAMPLE* pFrames = pDest + frame * 2;
+            V::store(pFrames, V::add(V::load(pFrames),
+                    V::mul(V::load(pSrc + frame * 2), ramp.at(frame))));
+        }
+        for (; frame < numFrames; ++frame) {
+            const CSAMPLE_GAIN gain = startGain + gainDelta * static_cast<int>(frame);
+            pDest[frame * 2] += pSrc[frame * 2] * gain;
+            pDest[frame * 2 + 1] += pSrc[frame * 2 + 1] * gain;
+        }
+    }
+
+    static void sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+            CSAMPLE* pfPeakL, CSAMPLE* pfPeakR,
+            const CSAMPLE* pBuffer, SINT numFrames) {
+        Vec vSum = V::zero();
+        Vec vPeak = V::zero();
+        SINT frame = 0;
+        for (; frame + kFrames <= numFrames; frame += kFrames) {
+            const Vec vAbs = V::abs(V::load(pBuffer + frame * 2));
+            vSum = V::add(vSum, vAbs);
+            vPeak = V::max(vPeak, vAbs);
+        }
+
+        // Even lanes hold the left, odd lanes the right channel.
+        alignas(64) CSAMPLE sums[kWidth];
+        alignas(64) CSAMPLE peaks[kWidth];
+        V::store(sums, vSum);
+        V::store(peaks, vPeak);
+        CSAMPLE fAbsL = CSAMPLE_ZERO;
+        CSAMPLE fAbsR = CSAMPLE_ZERO;
+        CSAMPLE fPeakL = CSAMPLE_ZERO;
+        CSAMPLE fPeakR = CSAMPLE_ZERO;
+        for (SINT i = 0; i < kWidth; i += 2) {
+            fAbsL += sums[i];
+            fAbsR += sums[i + 1];
+            fPeakL = maxScalar(fPeakL, peaks[i]);
+            fPeakR = maxScalar(fPeakR, peaks[i + 1]);
+        }
+
+        for (; frame < numFrames; ++frame) {
+            const CSAMPLE absl = absScalar(pBuffer[frame * 2]);
+            fAbsL += absl;
+            fPeakL = maxScalar(fPeakL, absl);
+            const CSAMPLE absr = absScalar(pBuffer[frame * 2 + 1]);
+            fAbsR += absr;
+            fPeakR = maxScalar(fPeakR, absr);
+        }
+        *pfAbsL = fAbsL;
+        *pfAbsR = fAbsR;
+        *pfPeakL = fPeakL;
+        *pfPeakR = fPeakR;
+    }
+
+    static void interleaveBuffer(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1, const CSAMPLE* pSrc2, SINT numFrames) {
+        SINT i = 0;
+        for (; i + kWidth <= numFrames; i += kWidth) {
+            Vec lo, hi;
+            V::interleave(V::load(pSrc1 + i), V::load(pSrc2 + i), &lo, &hi);
+            V::store(pDest + 2 * i, lo);
+            V::store(pDest + 2 * i + kWidth, hi);
+        }
+        for (; i < numFrames; ++i) {
+            pDest[2 * i] = pSrc1[i];
+            pDest[2 * i + 1] = pSrc2[i];
+        }
+    }
+
+    static void deinterleaveBuffer(CSAMPLE* pDest1, CSAMPLE* pDest2,
+            const CSAMPLE* pSrc, SINT numFrames) {
+        SINT i = 0;
+        for (; i + kWidth <= numFrames; i += kWidth) {
+            Vec even, odd;
+            V::deinterleave(V::load(pSrc + 2 * i), V::load(pSrc + 2 * i + kWidth),
+                    &even, &odd);
+            V::store(pDest1 + i, even);
+            V::store(pDest2 + i, odd);
+        }
+        for (; i < numFrames; ++i) {
+            pDest1[i] = pSrc[i * 2];
+            pDest2[i] = pSrc[i * 2 + 1];
+        }
+    }
+
+    static void hermiteInterpolate(CSAMPLE* pDest,
+            const CSAMPLE* pXm1, const CSAMPLE* pX0,
+            const CSAMPLE* pX1, const CSAMPLE* pX2,
+            const CSAMPLE* pFraction, SINT numSamples) {
+        const Vec half = V::set1(0.5f);
+        SINT i = 0;
+        for (; i + kWidth <= numSamples; i += kWidth) {
+            const Vec xm1 = V::load(pXm1 + i);
+            const Vec x0 = V::load(pX0 + i);
+            const Vec x1 = V::load(pX1 + i);
+            const Vec x2 = V::load(pX2 + i);
+            const Vec c = V::mul(V::sub(x1, xm1), half);
+            const Vec v = V::sub(x0, x1);
+            const Vec w = V::add(c, v);
+            const Vec a = V::add(V::add(w, v), V::mul(V::sub(x2, x0), half));
+            const Vec bNeg = V::add(w, a);
+            const Vec fraction = V::load(pFraction + i);
+            V::store(pDest + i, V::add(V::mul(V::add(V::mul(
+                    V::sub(V::mul(a, fraction), bNeg), fraction), c), fraction), x0));
+        }
+        for (; i < numSamples; ++i) {
+            const CSAMPLE c = (pX1[i] - pXm1[i]) * 0.5f;
+            const CSAMPLE v = pX0[i] - pX1[i];
+            const CSAMPLE w = c + v;
+            const CSAMPLE a = w + v + (pX2[i] - pX0[i]) * 0.5f;
+            const CSAMPLE bNeg = w + a;
+            const CSAMPLE fraction = pFraction[i];
+            pDest[i] = ((a * fraction - bNeg) * fraction + c) * fraction + pX0[i];
+        }
+    }
+
+    template<int kNumSources, bool kWriteBack>
+    static void mixWithRampingGains(CSAMPLE* pDest, bool accumulate,
+            const RampingGainSource* pSources, SINT firstFrame, SINT endFrame) {
+        CSAMPLE* pBuffers[kNumSources];
+        Vec startGains[kNumSources];
+        Vec gainDeltas[kNumSources];
+        for (int j = 0; j < kNumSources; ++j) {
+            pBuffers[j] = pSources[j].pBuffer;
+            startGains[j] = V::set1(pSources[j].startGain);
+            gainDeltas[j] = V::set1(pSources[j].gainDelta);
+        }
+        const Vec offsets = V::frameOffsets();
+        SINT frame = firstFrame;
+        for (; frame + kFrames <= endFrame; frame += kFrames) {
+            const Vec index = V::add(
+                    V::set1(static_cast<CSAMPLE>(static_cast<int>(frame))),
+                    offsets);
+            Vec sum = accumulate ? V::load(pDest + frame * 2) : V::zero();
+            for (int j = 0; j < kNumSources; ++j) {
+                CSAMPLE* pFrames = pBuffers[j] + frame * 2;
+                const Vec gain = V::add(startGains[j],
+                        V::mul(gainDeltas[j], index));
+                const Vec samples = V::mul(V::load(pFrames), gain);
+                if (kWriteBack) {
+                    V::store(pFrames, samples);
+                }
+                sum = V::add(sum, samples);
+            }
+            V::store(pDest + frame * 2, sum);
+        }
+        for (; frame < endFrame; ++frame) {
+            CSAMPLE left = accumulate ? pDest[frame * 2] : CSAMPLE_ZERO;
+            CSAMPLE right = accumulate ? pDest[frame * 2 + 1] : CSAMPLE_ZERO;
+            for (int j = 0; j < kNumSources; ++j) {
+                const CSAMPLE_GAIN gain = pSources[j].startGain +
+                        pSources[j].gainDelta * static_cast<int>(frame);
+                const CSAMPLE sourceLeft = pBuffers[j][frame * 2] * gain;
+                const CSAMPLE sourceRight = pBuffers[j][frame * 2 + 1] * gain;
+                if (kWriteBack) {
+                    pBuffers[j][frame * 2] = sourceLeft;
+                    pBuffers[j][frame * 2 + 1] = sourceRight;
+                }
+                left += sourceLeft;
+                right += sourceRight;
+            }
+            pDest[frame * 2] = left;
+            pDest[frame * 2 + 1] = right;
+        }
+    }
+
+    static SampleKernels kernels(CpuFeatures::SimdLevel level) {
+        static_assert(SampleKernels::kMaxMixSources == 8,
+                "the kernel table must list a mixing kernel for every source count");
+        const SampleKernels kernels = {
+            level,
+            applyGain,
+            applyRampingGain,
+            copyWithGain,
+            copyWithRampingGain,
+            add,
+            addWithGain,
+            addWithRampingGain,
+            sumAbsPerChannel,
+            interleaveBuffer,
+            deinterleaveBuffer,
+            hermiteInterpolate,
+            {
+                mixWithRampingGains<1, false>,
+                mixWithRampingGains<2, false>,
+                mixWithRampingGains<3, false>,
+                mixWithRampingGains<4, false>,
+                mixWithRampingGains<5, false>,
+                mixWithRampingGains<6, false>,
+                mixWithRampingGains<7, false>,
+                mixWithRampingGains<8, false>,
+            },
+            {
+                mixWithRampingGains<1, true>,
+                mixWithRampingGains<2, true>,
+                mixWithRampingGains<3, true>,
+                mixWithRampingGains<4, true>,
+                mixWithRampingGains<5, true>,
+                mixWithRampingGains<6, true>,
+                mixWithRampingGains<7, true>,
+                mixWithRampingGains<8, true>,
+            },
+        };
+        return kernels;
+    }
+
+  private:
+    // Calculates the gains of kFrames consecutive stereo frames the same way
+    // as the scalar loops: startGain + gainDelta * frame
+    class RampingGain {
+      public:
+        RampingGain(CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta)
+                : m_start(V::set1(startGain)),
+                  m_delta(V::set1(gainDelta)),
+                  m_offsets(V::frameOffsets()) {
+        }
+        Vec at(SINT frame) const {
+            const Vec index = V::add(
+                    V::set1(static_cast<CSAMPLE>(static_cast<int>(frame))),
+                    m_offsets);
+            return V::add(m_start, V::mul(m_delta, index));
+        }
+      private:
+        const Vec m_start;
+        const Vec m_delta;
+        // {0, 0, 1, 1, 2, 2, ...}
+        const Vec m_offsets;
+    };
+
+    static CSAMPLE absScalar(CSAMPLE value) {
+        return value < CSAMPLE_ZERO ? -value : value;
+    }
+
+    static CSAMPLE maxScalar(CSAMPLE a, CSAMPLE b) {
+        return a < b ? b : a;
+    }
+};
+
+} // anonymous namespace
+
+} // namespace mixxx
@@ -0,0 +1,62 @@
+// Compiled with SSE2 enabled, see SimdKernels in build/depends.py
+#include <emmintrin.h>
+
+#include "util/samplekernels_simd.h"
+
+namespace mixxx {
+
+namespace {
+
+struct Sse2 {
+    typedef __m128 Vec;
+    static const SINT kWidth = 4;
+
+    static Vec load(const CSAMPLE* p) {
+        return _mm_loadu_ps(p);
+    }
+    static void store(CSAMPLE* p, Vec v) {
+        _mm_storeu_ps(p, v);
+    }
+    static Vec set1(CSAMPLE value) {
+        return _mm_set1_ps(value);
+    }
+    static Vec zero() {
+        return _mm_setzero_ps();
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm_add_ps(a, b);
+    }
+    static Vec sub(Vec a, Vec b) {
+        return _mm_sub_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm_mul_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    }
+    static Vec frameOffsets() {
+        return _mm_setr_ps(0, 0, 1, 1);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        *pLo = _mm_unpacklo_ps(a, b);
+        *pHi = _mm_unpackhi_ps(a, b);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEven, Vec* pOdd) {
+        *pEven = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        *pOdd = _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+};
+
+} // anonymous namespace
+
+const SampleKernels& sse2SampleKernels() {
+    static const SampleKernels s_kernels =
+            SimdSampleKernels<Sse2>::kernels(CpuFeatures::SimdLevel::Sse2);
+    return s_kernels;
+}
+
+} // namespace mixxx
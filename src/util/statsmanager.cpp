@@ -3,8 +3,10 @@
 #include <QTextStream>
 #include <QFile>
 #include <QMetaType>
+#include <QStringList>
 
 #include "util/statsmanager.h"
+#include "control/control.h"
 #include "util/compatibility.h"
 #include "util/cmdlineargs.h"
 
@@ -12,9 +14,20 @@
 const int kStatsPipeSize = 1 << 10;
 const int kProcessLength = kStatsPipeSize * 4 / 5;
 
+// Hot controls like the play position are set once per callback and deck,
+// so the control trace pipes fill much faster than the stats pipes.
+const int kControlTracePipeSize = 1 << 14;
+const int kControlTraceProcessLength = kControlTracePipeSize * 4 / 5;
+
+// The number of controls in the control trace report at shutdown
+const int kControlTraceReportSize = 100;
+
 // static
 bool StatsManager::s_bStatsManagerEnabled = false;
 
+// static
+std::atomic<bool> StatsManager::s_bControlTracingEnabled(false);
+
 StatsPipe::StatsPipe(StatsManager* pManager)
         : FIFO<StatReport>(kStatsPipeSize),
           m_pManager(pManager) {
@@ -27,10 +40,31 @@ StatsPipe::~StatsPipe() {
     }
 }
 
+ControlTracePipe::ControlTracePipe(StatsManager* pManager)
+        : FIFO<ControlTraceReport>(kControlTracePipeSize),
+          m_pManager(pManager),
+          m_threadName(QThread::currentThread()->objectName()) {
+    // Threads that have not been started by Qt, like the callback threads
+    // of PortAudio, have no name
+    if (m_threadName.isEmpty()) {
+        m_threadName = QString("Thread %1").arg(
+                reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    }
+}
+
+ControlTracePipe::~ControlTracePipe() {
+    if (m_pManager) {
+        m_pManager->onControlTracePipeDestroyed(this);
+    }
+}
+
 StatsManager::StatsManager()
         : QThread(),
           m_quit(0) {
     s_bStatsManagerEnabled = true;
+    if (CmdlineArgs::Instance().getControlTraceEnabled()) {
+        setControlTracingEnabled(true);
+    }
     setObjectName("StatsManager");
     moveToThread(this);
     start(QThread::LowPriority);
@@ -38,6 +72,7 @@ StatsManager::StatsManager()
 
 StatsManager::~StatsManager() {
     s_bStatsManagerEnabled = false;
+    setControlTracingEnabled(false);
     m_quit = 1;
     m_statsPipeCondition.wakeAll();
     wait();
@@ -74,6 +109,11 @@ StatsManager::~StatsManager() {
     if (CmdlineArgs::Instance().getTimelineEnabled()) {
         writeTimeline(CmdlineArgs::Instance().getTimelinePath());
     }
+
+    if (CmdlineArgs::Instance().getControlTraceEnabled()) {
+        writeControlTraceReport(CmdlineArgs::Instance().getControlTracePath(),
+                kControlTraceReportSize);
+    }
 }
 
 class OrderByTime {
@@ -197,6 +237,133 @@ bool StatsManager::maybeWriteReport(const StatReport& report) {
     return success;
 }
 
+void StatsManager::setControlTracingEnabled(bool enabled) {
+    s_bControlTracingEnabled.store(enabled);
+}
+
+void StatsManager::onControlTracePipeDestroyed(ControlTracePipe* pPipe) {
+    QMutexLocker locker(&m_statsPipeLock);
+    processIncomingControlTraces();
+    m_controlTracePipes.removeAll(pPipe);
+}
+
+ControlTracePipe* StatsManager::getControlTracePipeForThread() {
+    if (m_threadControlTracePipes.hasLocalData()) {
+        return m_threadControlTracePipes.localData();
+    }
+    ControlTracePipe* pResult = new ControlTracePipe(this);
+    m_threadControlTracePipes.setLocalData(pResult);
+    QMutexLocker locker(&m_statsPipeLock);
+    m_controlTracePipes.push_back(pResult);
+    return pResult;
+}
+
+bool StatsManager::maybeWriteControlTrace(const ControlTraceReport& report) {
+    ControlTracePipe* pPipe = getControlTracePipeForThread();
+    if (pPipe == NULL) {
+        return false;
+    }
+    bool success = pPipe->write(&report, 1) == 1;
+    if (pPipe->writeAvailable() < kControlTraceProcessLength) {
+        m_statsPipeCondition.wakeAll();
+    }
+    static bool warnedAboutOverflow = false;
+    if (!success && !warnedAboutOverflow) {
+        qWarning() << "StatsManager control trace FIFO for thread"
+                   << pPipe->threadName() << "overflowed at least once."
+                   << "The control traces are incomplete.";
+        warnedAboutOverflow = true;
+    }
+    return success;
+}
+
+void StatsManager::processIncomingControlTraces() {
+    ControlTraceReport report;
+    foreach (ControlTracePipe* pPipe, m_controlTracePipes) {
+        while (pPipe->read(&report, 1) == 1) {
+            ControlTrace& trace = m_controlTraces[report.controlId];
+            if (trace.controlId < 0) {
+                trace.controlId = report.controlId;
+                QSharedPointer<ControlDoublePrivate> pControl =
+                        ControlDoublePrivate::getControlById(report.controlId);
+                if (pControl) {
+                    const ConfigKey key = pControl->getKey();
+                    trace.group = key.group;
+                    trace.item = key.item;
+                }
+            }
+            ++trace.sets;
+            trace.dispatchNanos += report.dispatchNanos;
+            trace.maxDispatchNanos = math_max(trace.maxDispatchNanos,
+                    report.dispatchNanos);
+            trace.maxListeners = math_max(trace.maxListeners, report.listeners);
+            ++trace.setsByThread[pPipe->threadName()];
+        }
+    }
+}
+
+class OrderByDispatchTime {
+  public:
+    inline bool operator()(const ControlTrace& t1, const ControlTrace& t2) {
+        return t1.dispatchNanos > t2.dispatchNanos;
+    }
+};
+
+QList<ControlTrace> StatsManager::getControlTraces(int topN) {
+    QList<ControlTrace> traces;
+    {
+        QMutexLocker locker(&m_statsPipeLock);
+        processIncomingControlTraces();
+        traces = m_controlTraces.values();
+    }
+    qSort(traces.begin(), traces.end(), OrderByDispatchTime());
+    if (traces.size() > topN) {
+        traces.erase(traces.begin() + topN, traces.end());
+    }
+    return traces;
+}
+
+void StatsManager::clearControlTraces() {
+    QMutexLocker locker(&m_statsPipeLock);
+    processIncomingControlTraces();
+    m_controlTraces.clear();
+}
+
+bool StatsManager::writeControlTraceReport(const QString& filename, int topN) {
+    QFile report(filename);
+    if (!report.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Could not open control trace report for writing:"
+                   << report.fileName();
+        return false;
+    }
+
+    QTextStream out(&report);
+    out << "group,item,sets,dispatch_total_ns,dispatch_mean_ns,"
+        << "dispatch_max_ns,max_listeners,sets_by_thread\n";
+    for (const ControlTrace& trace : getControlTraces(topN)) {
+        QStringList threads;
+        for (auto it = trace.setsByThread.constBegin();
+                it != trace.setsByThread.constEnd(); ++it) {
+            threads << QString("%1: %2").arg(it.key()).arg(it.value());
+        }
+        // The group and the item of a control contain no commas. Controls
+        // that could not be resolved get an empty group and their id as
+        // item, so the columns stay aligned.
+        const QString item = trace.group.isEmpty()
+                ? QString("control_id_%1").arg(trace.controlId)
+                : trace.item;
+        out << trace.group << ","
+            << item << ","
+            << trace.sets << ","
+            << trace.dispatchNanos << ","
+            << trace.dispatchNanos / math_max<qint64>(trace.sets, 1) << ","
+            << trace.maxDispatchNanos << ","
+            << trace.maxListeners << ","
+            << "\"" << threads.join("; ") << "\"\n";
+    }
+    return true;
+}
+
 void StatsManager::processIncomingStatReports() {
     StatReport report;
     foreach (StatsPipe* pStatsPipe, m_statsPipes) {
@@ -246,6 +413,7 @@ void StatsManager::run() {
         // We want to process reports even when we are about to quit since we
         // want to print the most accurate stat report on shutdown.
         processIncomingStatReports();
+        processIncomingControlTraces();
         m_statsPipeLock.unlock();
 
         if (load_atomic(m_emitAllStats) == 1) {
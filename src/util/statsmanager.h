@@ -1,6 +1,7 @@
 #ifndef STATSMANAGER_H
 #define STATSMANAGER_H
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QString>
@@ -12,6 +13,8 @@
 #include <QThreadStorage>
 #include <QList>
 
+#include <atomic>
+
 #include "util/fifo.h"
 #include "util/singleton.h"
 #include "util/stat.h"
@@ -27,6 +30,63 @@ class StatsPipe : public FIFO<StatReport> {
     StatsManager* m_pManager;
 };
 
+// Reported for every value change of a control while control tracing is
+// enabled, see ControlDoublePrivate::setInner().
+struct ControlTraceReport {
+    int controlId;
+    // The number of connections to the valueChanged() signal
+    int listeners;
+    // The time it took to emit valueChanged()
+    qint64 dispatchNanos;
+};
+
+// The reports of one control, aggregated by the StatsManager
+struct ControlTrace {
+    ControlTrace()
+            : controlId(-1),
+              sets(0),
+              dispatchNanos(0),
+              maxDispatchNanos(0),
+              maxListeners(0) {
+    }
+
+    // "[Group],item", or "Control <id>" if the control could not be
+    // resolved
+    QString name() const {
+        if (group.isEmpty()) {
+            return QString("Control %1").arg(controlId);
+        }
+        return group + "," + item;
+    }
+
+    int controlId;
+    // Resolved when the first report arrives. Both are empty if the control
+    // has been deleted before.
+    QString group;
+    QString item;
+    qint64 sets;
+    qint64 dispatchNanos;
+    qint64 maxDispatchNanos;
+    int maxListeners;
+    // The number of sets by the name of the setting thread
+    QMap<QString, qint64> setsByThread;
+};
+
+class ControlTracePipe : public FIFO<ControlTraceReport> {
+  public:
+    ControlTracePipe(StatsManager* pManager);
+    virtual ~ControlTracePipe();
+
+    // The name of the thread that writes into the pipe
+    const QString& threadName() const {
+        return m_threadName;
+    }
+
+  private:
+    StatsManager* m_pManager;
+    QString m_threadName;
+};
+
 class StatsManager : public QThread, public Singleton<StatsManager> {
     Q_OBJECT
   public:
@@ -47,6 +107,25 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
         m_statsPipeCondition.wakeAll();
     }
 
+    // Control tracing records for every control how often it is set, from
+    // which threads, by how many listeners it is connected and how long it
+    // takes to dispatch its valueChanged() signal. It is off by default,
+    // because it times every set of every control.
+    static bool controlTracingEnabled() {
+        return s_bControlTracingEnabled.load(std::memory_order_relaxed);
+    }
+    void setControlTracingEnabled(bool enabled);
+
+    // Returns true if write succeeds.
+    bool maybeWriteControlTrace(const ControlTraceReport& report);
+
+    // Returns the traces of the topN controls with the longest total
+    // dispatch time, the longest first. Thread safe.
+    QList<ControlTrace> getControlTraces(int topN);
+    void clearControlTraces();
+    // Writes the result of getControlTraces() as csv into filename
+    bool writeControlTraceReport(const QString& filename, int topN);
+
   signals:
     void statUpdated(const Stat& stat);
 
@@ -58,6 +137,11 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     StatsPipe* getStatsPipeForThread();
     void onStatsPipeDestroyed(StatsPipe* pPipe);
     void writeTimeline(const QString& filename);
+    void processIncomingControlTraces();
+    ControlTracePipe* getControlTracePipeForThread();
+    void onControlTracePipeDestroyed(ControlTracePipe* pPipe);
+
+    static std::atomic<bool> s_bControlTracingEnabled;
 
     QAtomicInt m_emitAllStats;
     QAtomicInt m_quit;
@@ -71,7 +155,13 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     QList<StatsPipe*> m_statsPipes;
     QThreadStorage<StatsPipe*> m_threadStatsPipes;
 
+    // The control traces are guarded by m_statsPipeLock, too
+    QHash<int, ControlTrace> m_controlTraces;
+    QList<ControlTracePipe*> m_controlTracePipes;
+    QThreadStorage<ControlTracePipe*> m_threadControlTracePipes;
+
     friend class StatsPipe;
+    friend class ControlTracePipe;
 };
 
 
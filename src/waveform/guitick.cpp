@@ -21,4 +21,6 @@ void GuiTick::process() {
         m_lastUpdateTime = m_cpuTimeLastTick;
         m_pCOGuiTick50ms->set(cpuTimeLastTickSeconds);
     }
+
+    m_controlDispatcher.process();
 }
@@ -3,6 +3,7 @@
 
 #include <QObject>
 
+#include "control/controlguidispatcher.h"
 #include "control/controlobject.h"
 #include "util/duration.h"
 #include "util/memory.h"
@@ -10,6 +11,7 @@
 
 // A helper class that manages the "guiTickTime" COs, that drive updates of the
 // GUI from the VsyncThread at the user's configured FPS (possibly downsampled).
+// It also delivers the coalesced control changes of the ControlGuiDispatcher.
 class GuiTick : public QObject {
     Q_OBJECT
   public:
@@ -19,6 +21,7 @@ class GuiTick : public QObject {
   private:
     std::unique_ptr<ControlObject> m_pCOGuiTickTime;
     std::unique_ptr<ControlObject> m_pCOGuiTick50ms;
+    ControlGuiDispatcher m_controlDispatcher;
     PerformanceTimer m_cpuTimer;
     mixxx::Duration m_lastUpdateTime;
     mixxx::Duration m_cpuTimeLastTick;
@@ -13,7 +13,8 @@ ControlWidgetConnection::ControlWidgetConnection(
         : m_pWidget(pBaseWidget),
           m_pValueTransformer(pTransformer) {
     m_pControl = new ControlProxy(key, this);
-    m_pControl->connectValueChanged(SLOT(slotControlValueChanged(double)));
+    // Widgets only need the latest value when they are painted
+    m_pControl->connectValueChangedCoalesced(SLOT(slotControlValueChanged(double)));
 }
 
 void ControlWidgetConnection::setControlParameter(double parameter) {